@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace AK {
+
+// A bloom filter with small counters instead of bits, so that keys can be removed again.
+// Counters that overflow stay saturated forever, which only ever causes false positives.
+template<size_t key_bits = 12>
+class CountingBloomFilter {
+public:
+    static constexpr size_t table_size = 1 << key_bits;
+
+    void add(u32 hash)
+    {
+        increment(m_counters[first_slot(hash)]);
+        increment(m_counters[second_slot(hash)]);
+    }
+
+    void remove(u32 hash)
+    {
+        decrement(m_counters[first_slot(hash)]);
+        decrement(m_counters[second_slot(hash)]);
+    }
+
+    bool may_contain(u32 hash) const
+    {
+        return m_counters[first_slot(hash)] && m_counters[second_slot(hash)];
+    }
+
+    void clear()
+    {
+        for (auto& counter : m_counters)
+            counter = 0;
+    }
+
+private:
+    static constexpr u8 max_count = 0xff;
+    static constexpr u32 key_mask = table_size - 1;
+
+    static size_t first_slot(u32 hash) { return hash & key_mask; }
+    static size_t second_slot(u32 hash) { return (hash >> key_bits) & key_mask; }
+
+    static void increment(u8& counter)
+    {
+        if (counter < max_count)
+            ++counter;
+    }
+
+    static void decrement(u8& counter)
+    {
+        if (counter && counter < max_count)
+            --counter;
+    }
+
+    u8 m_counters[table_size] {};
+};
+
+}
+
+using AK::CountingBloomFilter;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/CountingBloomFilter.h>
+
+TEST_CASE(construct_empty)
+{
+    CountingBloomFilter filter;
+    EXPECT(!filter.may_contain(0x12345678));
+}
+
+TEST_CASE(add_and_remove)
+{
+    CountingBloomFilter filter;
+    filter.add(0x12345678);
+    EXPECT(filter.may_contain(0x12345678));
+    filter.add(0x12345678);
+    filter.remove(0x12345678);
+    EXPECT(filter.may_contain(0x12345678));
+    filter.remove(0x12345678);
+    EXPECT(!filter.may_contain(0x12345678));
+}
+
+TEST_CASE(saturated_counters_stick)
+{
+    CountingBloomFilter filter;
+    for (int i = 0; i < 300; ++i)
+        filter.add(42);
+    for (int i = 0; i < 300; ++i)
+        filter.remove(42);
+    EXPECT(filter.may_contain(42));
+    filter.clear();
+    EXPECT(!filter.may_contain(42));
+}
+
+TEST_CASE(no_false_negatives)
+{
+    CountingBloomFilter filter;
+    for (u32 i = 0; i < 1000; ++i)
+        filter.add(i * 2654435761u);
+    for (u32 i = 0; i < 1000; ++i)
+        EXPECT(filter.may_contain(i * 2654435761u));
+}
+
+TEST_MAIN(CountingBloomFilter)
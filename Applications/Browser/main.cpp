@@ -38,9 +38,11 @@
 #include <LibGUI/TabWidget.h>
 #include <LibGUI/Window.h>
 #include <LibGfx/Bitmap.h>
+#include <LibWeb/Layout/ParallelLayout.h>
 #include <LibWeb/Loader/ResourceLoader.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 namespace Browser {
 
@@ -58,7 +60,7 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    if (pledge("stdio shared_buffer accept unix cpath rpath wpath fattr", nullptr) < 0) {
+    if (pledge("stdio shared_buffer accept unix cpath rpath wpath fattr thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -76,7 +78,7 @@ int main(int argc, char** argv)
     Web::ResourceLoader::the();
 
     // FIXME: Once there is a standalone Download Manager, we can drop the "unix" pledge.
-    if (pledge("stdio shared_buffer accept unix cpath rpath wpath", nullptr) < 0) {
+    if (pledge("stdio shared_buffer accept unix cpath rpath wpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -117,6 +119,11 @@ int main(int argc, char** argv)
     auto m_config = Core::ConfigFile::get_for_app("Browser");
     Browser::g_home_url = m_config->read_entry("Preferences", "Home", "about:blank");
 
+    if (m_config->read_bool_entry("Preferences", "ParallelLayout", false)) {
+        long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        Web::set_layout_thread_count(processor_count > 0 ? processor_count : 1);
+    }
+
     bool bookmarksbar_enabled = true;
     auto bookmarks_bar = Browser::BookmarksBarWidget::construct(Browser::bookmarks_filename, bookmarksbar_enabled);
 
@@ -52,14 +52,14 @@
 
 int main(int argc, char* argv[])
 {
-    if (pledge("stdio shared_buffer accept rpath unix cpath fattr", nullptr) < 0) {
+    if (pledge("stdio shared_buffer accept rpath unix cpath fattr thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
 
     auto app = GUI::Application::construct(argc, argv);
 
-    if (pledge("stdio shared_buffer accept rpath unix", nullptr) < 0) {
+    if (pledge("stdio shared_buffer accept rpath unix thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
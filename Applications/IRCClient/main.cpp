@@ -32,7 +32,7 @@
 
 int main(int argc, char** argv)
 {
-    if (pledge("stdio inet dns unix shared_buffer cpath rpath fattr wpath cpath", nullptr) < 0) {
+    if (pledge("stdio inet dns unix shared_buffer cpath rpath fattr wpath cpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -44,7 +44,7 @@ int main(int argc, char** argv)
 
     auto app = GUI::Application::construct(argc, argv);
 
-    if (pledge("stdio inet dns unix shared_buffer rpath wpath cpath", nullptr) < 0) {
+    if (pledge("stdio inet dns unix shared_buffer rpath wpath cpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -42,11 +42,13 @@
 #include <LibGUI/ToolBarContainer.h>
 #include <LibGUI/Window.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/JPGLoader.h>
 #include <LibGfx/Palette.h>
 #include <LibGfx/Rect.h>
 #include <spawn.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 int main(int argc, char** argv)
 {
@@ -62,6 +64,10 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    // Big photos are what this is for, and we may use threads, so decode them on all CPUs.
+    long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    Gfx::set_jpg_decoder_thread_count(processor_count > 0 ? processor_count : 1);
+
     const char* path = nullptr;
     Core::ArgsParser args_parser;
     args_parser.add_positional_argument(path, "The image file to be displayed.", "file", Core::ArgsParser::Required::No);
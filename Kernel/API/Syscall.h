@@ -36,6 +36,9 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct epoll_event;
+struct io_ring_params;
+struct iovec;
 struct pollfd;
 struct timeval;
 struct timespec;
@@ -194,7 +197,19 @@ namespace Kernel {
     __ENUMERATE_SYSCALL(sendfd)             \
     __ENUMERATE_SYSCALL(recvfd)             \
     __ENUMERATE_SYSCALL(sysconf)            \
-    __ENUMERATE_SYSCALL(set_process_name)
+    __ENUMERATE_SYSCALL(set_process_name)   \
+    __ENUMERATE_SYSCALL(epoll_create)       \
+    __ENUMERATE_SYSCALL(epoll_ctl)          \
+    __ENUMERATE_SYSCALL(epoll_wait)         \
+    __ENUMERATE_SYSCALL(sendfile)           \
+    __ENUMERATE_SYSCALL(splice)             \
+    __ENUMERATE_SYSCALL(io_ring_setup)      \
+    __ENUMERATE_SYSCALL(io_ring_enter)      \
+    __ENUMERATE_SYSCALL(readv)              \
+    __ENUMERATE_SYSCALL(pread)              \
+    __ENUMERATE_SYSCALL(pwrite)             \
+    __ENUMERATE_SYSCALL(preadv)             \
+    __ENUMERATE_SYSCALL(pwritev)
 
 namespace Syscall {
 
@@ -286,6 +301,62 @@ struct SC_poll_params {
     const u32* sigmask;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    const struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    const struct timespec* timeout;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    ssize_t* offset;
+    size_t count;
+};
+
+struct SC_splice_params {
+    int in_fd;
+    ssize_t* in_offset;
+    int out_fd;
+    ssize_t* out_offset;
+    size_t count;
+    unsigned flags;
+};
+
+struct SC_pread_params {
+    int fd;
+    MutableBufferArgument<void, size_t> buffer;
+    ssize_t offset;
+};
+
+struct SC_pwrite_params {
+    int fd;
+    ImmutableBufferArgument<void, size_t> data;
+    ssize_t offset;
+};
+
+struct SC_preadv_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    ssize_t offset;
+};
+
+struct SC_pwritev_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    ssize_t offset;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
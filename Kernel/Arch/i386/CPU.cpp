@@ -944,6 +944,7 @@ void Processor::early_initialize(u32 cpu)
     m_idle_thread = nullptr;
     m_current_thread = nullptr;
     m_mm_data = nullptr;
+    m_timer_wheel = nullptr;
     m_info = nullptr;
 
     m_halt_requested = false;
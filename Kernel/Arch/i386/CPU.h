@@ -623,6 +623,7 @@ static_assert(GDT_SELECTOR_CODE0 + 16 == GDT_SELECTOR_CODE3); // CS3 = CS0 + 16
 static_assert(GDT_SELECTOR_CODE0 + 24 == GDT_SELECTOR_DATA3); // SS3 = CS0 + 32
 
 class ProcessorInfo;
+class TimerWheel;
 struct MemoryManagerData;
 struct ProcessorMessageEntry;
 
@@ -683,6 +684,7 @@ class Processor {
 
     ProcessorInfo* m_info;
     MemoryManagerData* m_mm_data;
+    TimerWheel* m_timer_wheel;
     Thread* m_current_thread;
     Thread* m_idle_thread;
 
@@ -780,6 +782,16 @@ public:
         return *m_mm_data;
     }
 
+    ALWAYS_INLINE void set_timer_wheel(TimerWheel& timer_wheel)
+    {
+        m_timer_wheel = &timer_wheel;
+    }
+
+    ALWAYS_INLINE TimerWheel* timer_wheel() const
+    {
+        return m_timer_wheel;
+    }
+
     ALWAYS_INLINE Thread* idle_thread() const
     {
         return m_idle_thread;
@@ -29,11 +29,23 @@
 
 namespace Kernel {
 
+#define IRQ_COM1_COM3 4
+#define IRQ_COM2_COM4 3
+
+static u8 irq_for_base_addr(int base_addr)
+{
+    if (base_addr == SERIAL_COM2_ADDR || base_addr == SERIAL_COM4_ADDR)
+        return IRQ_COM2_COM4;
+    return IRQ_COM1_COM3;
+}
+
 SerialDevice::SerialDevice(int base_addr, unsigned minor)
-    : CharacterDevice(4, minor)
+    : IRQHandler(irq_for_base_addr(base_addr))
+    , CharacterDevice(4, minor)
     , m_base_addr(base_addr)
 {
     initialize();
+    enable_irq();
 }
 
 SerialDevice::~SerialDevice()
@@ -76,13 +88,23 @@ ssize_t SerialDevice::write(FileDescription&, size_t, const u8* buffer, ssize_t
     return 1;
 }
 
+void SerialDevice::handle_irq(const RegisterState&)
+{
+    // Reading the interrupt identification register acknowledges a
+    // transmitter-empty interrupt; received data stays pending until read.
+    IO::in8(m_base_addr + 2);
+    did_change_readiness();
+}
+
 void SerialDevice::initialize()
 {
     set_interrupts(0);
     set_baud(Baud38400);
     set_line_control(None, One, EightBits);
     set_fifo_control(EnableFIFO | ClearReceiveFIFO | ClearTransmitFIFO | TriggerLevel4);
-    set_modem_control(RequestToSend | DataTerminalReady);
+    // OUT2 gates the UART's interrupt line to the PIC.
+    set_modem_control(RequestToSend | DataTerminalReady | AuxiliaryOutput2);
+    set_interrupts(ReceivedDataAvailableInterrupt | TransmitterHoldingRegisterEmptyInterrupt);
 }
 
 void SerialDevice::set_interrupts(char interrupt_enable)
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <Kernel/Devices/CharacterDevice.h>
+#include <Kernel/Interrupts/IRQHandler.h>
 
 namespace Kernel {
 
@@ -35,7 +36,8 @@ namespace Kernel {
 #define SERIAL_COM3_ADDR 0x3E8
 #define SERIAL_COM4_ADDR 0x2E8
 
-class SerialDevice final : public CharacterDevice {
+class SerialDevice final : public IRQHandler
+    , public CharacterDevice {
     AK_MAKE_ETERNAL
 public:
     SerialDevice(int base_addr, unsigned minor);
@@ -47,6 +49,8 @@ public:
     virtual bool can_write(const FileDescription&, size_t) const override;
     virtual ssize_t write(FileDescription&, size_t, const u8*, ssize_t) override;
 
+    virtual const char* purpose() const override { return class_name(); }
+
     enum InterruptEnable {
         LowPowerMode = 0x01 << 5,
         SleepMode = 0x01 << 4,
@@ -124,6 +128,9 @@ public:
     };
 
 private:
+    // ^IRQHandler
+    virtual void handle_irq(const RegisterState&) override;
+
     // ^CharacterDevice
     virtual const char* class_name() const override { return "SerialDevice"; }
 
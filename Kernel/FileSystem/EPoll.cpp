@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+//#define EPOLL_DEBUG
+
+namespace Kernel {
+
+EPollWatch::EPollWatch(EPoll& epoll, int fd, FileDescription& description, const epoll_event& event)
+    : m_epoll(epoll)
+    , m_fd(fd)
+    , m_description(&description)
+    , m_file(description.file())
+    , m_events(event.events)
+    , m_data(event.data)
+{
+}
+
+u32 EPollWatch::poll_events() const
+{
+    ASSERT(m_description);
+    u32 events = 0;
+    if ((m_events & EPOLLIN) && m_description->can_read())
+        events |= EPOLLIN;
+    if ((m_events & EPOLLOUT) && m_description->can_write())
+        events |= EPOLLOUT;
+    return events;
+}
+
+NonnullRefPtr<EPoll> EPoll::create()
+{
+    return adopt(*new EPoll);
+}
+
+EPoll::EPoll()
+{
+}
+
+EPoll::~EPoll()
+{
+    for (auto& it : m_watches)
+        it.value->file().unregister_epoll_watch({}, it.value);
+}
+
+bool EPoll::can_read(const FileDescription&, size_t) const
+{
+    return has_queued_watches();
+}
+
+void EPoll::enqueue_if_needed(EPollWatch& watch)
+{
+    ASSERT(m_lock.is_locked());
+    if (watch.m_disabled || !watch.m_description || watch.m_ready_list_node.is_in_list())
+        return;
+    m_ready_list.append(watch);
+    if (m_on_watch_queued)
+        m_on_watch_queued();
+}
+
+KResult EPoll::add_watch(int fd, FileDescription& description, const epoll_event& event)
+{
+    if (description.file().is_epoll())
+        return KResult(-EINVAL);
+
+    LOCKER(m_watches_lock);
+    RefPtr<EPollWatch> stale_watch;
+    if (auto it = m_watches.find(fd); it != m_watches.end()) {
+        // The fd number may have been closed and reused since it was added.
+        // In that case the old watch is stale and gets replaced.
+        if (it->value->m_description == &description)
+            return KResult(-EEXIST);
+        stale_watch = it->value;
+    }
+
+    // Detach the stale watch from its File before dropping it, so that no
+    // notification can still be in flight for it once it's gone.
+    if (stale_watch)
+        stale_watch->file().unregister_epoll_watch({}, *stale_watch);
+
+    auto watch = adopt(*new EPollWatch(*this, fd, description, event));
+    {
+        ScopedSpinLock lock(m_lock);
+        if (stale_watch && stale_watch->m_ready_list_node.is_in_list())
+            m_ready_list.remove(*stale_watch);
+        m_watches.set(fd, watch);
+        // Queue the watch right away, so that anything that's already
+        // ready gets reported by the next epoll_wait().
+        enqueue_if_needed(watch);
+    }
+    description.file().register_epoll_watch({}, watch);
+
+#ifdef EPOLL_DEBUG
+    dbg() << "EPoll{" << this << "}: watching fd " << fd << " (" << description.absolute_path() << ") for events " << String::format("%x", event.events);
+#endif
+    return KSuccess;
+}
+
+KResult EPoll::modify_watch(int fd, FileDescription& description, const epoll_event& event)
+{
+    LOCKER(m_watches_lock);
+    ScopedSpinLock lock(m_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end() || it->value->m_description != &description)
+        return KResult(-ENOENT);
+    auto& watch = *it->value;
+    watch.m_events = event.events;
+    watch.m_data = event.data;
+    watch.m_disabled = false;
+    enqueue_if_needed(watch);
+    return KSuccess;
+}
+
+KResult EPoll::remove_watch(int fd)
+{
+    LOCKER(m_watches_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end())
+        return KResult(-ENOENT);
+    NonnullRefPtr<EPollWatch> watch = it->value;
+
+    watch->file().unregister_epoll_watch({}, watch);
+
+    ScopedSpinLock lock(m_lock);
+    if (watch->m_ready_list_node.is_in_list())
+        m_ready_list.remove(watch);
+    m_watches.remove(fd);
+    return KSuccess;
+}
+
+size_t EPoll::collect_ready_events(epoll_event* events, size_t max_events)
+{
+    ScopedSpinLock lock(m_lock);
+
+    // Level-triggered watches that are reported stay queued, but we put them
+    // on the back of the list only after this pass so we don't report them twice.
+    IntrusiveList<EPollWatch, &EPollWatch::m_ready_list_node> still_ready;
+
+    size_t count = 0;
+    while (count < max_events) {
+        auto* watch = m_ready_list.take_first();
+        if (!watch)
+            break;
+        if (!watch->m_description || watch->m_disabled)
+            continue;
+        u32 ready_events = watch->poll_events();
+        if (!ready_events)
+            continue;
+
+        events[count].events = ready_events;
+        events[count].data = watch->m_data;
+        ++count;
+
+        if (watch->m_events & EPOLLONESHOT)
+            watch->m_disabled = true;
+        else if (!(watch->m_events & EPOLLET))
+            still_ready.append(*watch);
+    }
+
+    while (auto* watch = still_ready.take_first())
+        m_ready_list.append(*watch);
+
+    return count;
+}
+
+void EPoll::enqueue_watch(Badge<File>, EPollWatch& watch)
+{
+    ScopedSpinLock lock(m_lock);
+    enqueue_if_needed(watch);
+}
+
+void EPoll::detach_watch(Badge<File>, EPollWatch& watch)
+{
+    ScopedSpinLock lock(m_lock);
+    watch.m_description = nullptr;
+    if (watch.m_ready_list_node.is_in_list())
+        m_ready_list.remove(watch);
+}
+
+}
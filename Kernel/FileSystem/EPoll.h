@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/RefCounted.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// An EPollWatch is the registration of interest in one file descriptor.
+// It is attached to the watched File, which pushes it onto the owning EPoll's
+// ready list from did_change_readiness(). Readiness is only re-evaluated for
+// queued watches, so collecting events costs O(ready) instead of O(watched).
+class EPollWatch : public RefCounted<EPollWatch> {
+public:
+    EPollWatch(EPoll&, int fd, FileDescription&, const epoll_event&);
+
+    int fd() const { return m_fd; }
+    EPoll& epoll() { return m_epoll; }
+    File& file() { return *m_file; }
+    const FileDescription* description() const { return m_description; }
+
+private:
+    friend class EPoll;
+
+    u32 poll_events() const;
+
+    EPoll& m_epoll;
+    int m_fd { -1 };
+
+    // Nulled out when the description is destroyed, see File::detach_epoll_watches().
+    FileDescription* m_description { nullptr };
+    NonnullRefPtr<File> m_file;
+
+    u32 m_events { 0 };
+    epoll_data_t m_data;
+    bool m_disabled { false };
+
+    IntrusiveListNode m_ready_list_node;
+};
+
+class EPoll final : public File {
+public:
+    static NonnullRefPtr<EPoll> create();
+    virtual ~EPoll() override;
+
+    KResult add_watch(int fd, FileDescription&, const epoll_event&);
+    KResult modify_watch(int fd, FileDescription&, const epoll_event&);
+    KResult remove_watch(int fd);
+
+    size_t collect_ready_events(epoll_event* events, size_t max_events);
+    bool has_queued_watches() const { return !m_ready_list.is_empty(); }
+
+    void enqueue_watch(Badge<File>, EPollWatch&);
+    void detach_watch(Badge<File>, EPollWatch&);
+
+    // Invoked with the ready list locked whenever a watch gets queued, possibly
+    // from interrupt context. Used by IORing to hand ready requests to a worker.
+    void set_on_watch_queued(Function<void()> callback) { m_on_watch_queued = move(callback); }
+
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual ssize_t read(FileDescription&, size_t, u8*, ssize_t) override { return -EINVAL; }
+    virtual ssize_t write(FileDescription&, size_t, const u8*, ssize_t) override { return -EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "epoll"; }
+    virtual const char* class_name() const override { return "EPoll"; }
+    virtual bool is_epoll() const override { return true; }
+
+private:
+    EPoll();
+
+    void enqueue_if_needed(EPollWatch&);
+
+    // m_watches_lock serializes epoll_ctl() operations, m_lock protects the ready list
+    // (which is also touched from interrupt context through enqueue_watch()).
+    Lock m_watches_lock { "EPoll" };
+    mutable SpinLock<u8> m_lock;
+    HashMap<int, NonnullRefPtr<EPollWatch>> m_watches;
+    IntrusiveList<EPollWatch, &EPollWatch::m_ready_list_node> m_ready_list;
+    Function<void()> m_on_watch_queued;
+};
+
+}
@@ -116,6 +116,7 @@ void FIFO::attach(Direction direction)
         klog() << "open writer (" << m_writers << ")";
 #endif
     }
+    did_change_readiness();
 }
 
 void FIFO::detach(Direction direction)
@@ -133,6 +134,7 @@ void FIFO::detach(Direction direction)
         ASSERT(m_writers);
         --m_writers;
     }
+    did_change_readiness();
 }
 
 bool FIFO::can_read(const FileDescription&, size_t) const
@@ -156,6 +158,7 @@ ssize_t FIFO::read(FileDescription&, size_t, u8* buffer, ssize_t size)
 #ifdef FIFO_DEBUG
     dbg() << "   -> read (" << String::format("%c", buffer[0]) << ") " << nread;
 #endif
+    did_change_readiness();
     return nread;
 }
 
@@ -168,7 +171,9 @@ ssize_t FIFO::write(FileDescription&, size_t, const u8* buffer, ssize_t size)
 #ifdef FIFO_DEBUG
     dbg() << "fifo: write(" << (const void*)buffer << ", " << size << ")";
 #endif
-    return m_buffer.write(buffer, size);
+    ssize_t nwritten = m_buffer.write(buffer, size);
+    did_change_readiness();
+    return nwritten;
 }
 
 String FIFO::absolute_path(const FileDescription&) const
@@ -25,6 +25,7 @@
  */
 
 #include <AK/StringView.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/FileSystem/FileDescription.h>
 
@@ -61,4 +62,41 @@ KResultOr<Region*> File::mmap(Process&, FileDescription&, VirtualAddress, size_t
     return KResult(-ENODEV);
 }
 
+void File::did_change_readiness()
+{
+    ScopedSpinLock lock(m_epoll_watches_lock);
+    for (auto* watch : m_epoll_watches)
+        watch->epoll().enqueue_watch({}, *watch);
+}
+
+void File::register_epoll_watch(Badge<EPoll>, EPollWatch& watch)
+{
+    ScopedSpinLock lock(m_epoll_watches_lock);
+    ASSERT(!m_epoll_watches.contains(&watch));
+    m_epoll_watches.set(&watch);
+}
+
+void File::unregister_epoll_watch(Badge<EPoll>, EPollWatch& watch)
+{
+    ScopedSpinLock lock(m_epoll_watches_lock);
+    // The watch may already be gone if its description was destroyed first.
+    m_epoll_watches.remove(&watch);
+}
+
+void File::detach_epoll_watches(Badge<FileDescription>, FileDescription& description)
+{
+    ScopedSpinLock lock(m_epoll_watches_lock);
+    if (m_epoll_watches.is_empty())
+        return;
+    Vector<EPollWatch*, 4> detached_watches;
+    for (auto* watch : m_epoll_watches) {
+        if (watch->description() == &description)
+            detached_watches.append(watch);
+    }
+    for (auto* watch : detached_watches) {
+        watch->epoll().detach_watch({}, *watch);
+        m_epoll_watches.remove(watch);
+    }
+}
+
 }
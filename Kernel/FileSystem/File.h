@@ -26,12 +26,15 @@
 
 #pragma once
 
+#include <AK/Badge.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
 #include <AK/Types.h>
 #include <Kernel/Forward.h>
 #include <Kernel/KResult.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/VirtualAddress.h>
 
@@ -51,6 +54,8 @@ namespace Kernel {
 //   - Return true if read() or write() would succeed, respectively.
 //   - Note that can_read() should return true in EOF conditions,
 //     and a subsequent call to read() should return 0.
+//   - Whenever the answer of either may have changed, call did_change_readiness()
+//     so that EPoll instances watching this File get notified.
 //
 // ioctl()
 //
@@ -97,9 +102,21 @@ public:
     virtual bool is_block_device() const { return false; }
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
+    virtual bool is_epoll() const { return false; }
+    virtual bool is_io_ring() const { return false; }
+
+    void did_change_readiness();
+
+    void register_epoll_watch(Badge<EPoll>, EPollWatch&);
+    void unregister_epoll_watch(Badge<EPoll>, EPollWatch&);
+    void detach_epoll_watches(Badge<FileDescription>, FileDescription&);
 
 protected:
     File();
+
+private:
+    SpinLock<u8> m_epoll_watches_lock;
+    HashTable<EPollWatch*> m_epoll_watches;
 };
 
 }
@@ -66,6 +66,7 @@ FileDescription::FileDescription(File& file)
 
 FileDescription::~FileDescription()
 {
+    m_file->detach_epoll_watches({}, *this);
     if (is_socket())
         socket()->detach(*this);
     if (is_fifo())
@@ -148,6 +149,31 @@ ssize_t FileDescription::write(const u8* data, ssize_t size)
     return nwritten;
 }
 
+ssize_t FileDescription::read(u8* buffer, off_t offset, ssize_t count)
+{
+    // No need to take m_lock here, as we never touch m_current_offset.
+    if (!m_file->is_seekable())
+        return -ESPIPE;
+    if (offset < 0)
+        return -EINVAL;
+    if ((offset + count) < 0)
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    return m_file->read(*this, offset, buffer, count);
+}
+
+ssize_t FileDescription::write(const u8* data, off_t offset, ssize_t size)
+{
+    if (!m_file->is_seekable())
+        return -ESPIPE;
+    if (offset < 0)
+        return -EINVAL;
+    if ((offset + size) < 0)
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    return m_file->write(*this, offset, data, size);
+}
+
 bool FileDescription::can_write() const
 {
     return m_file->can_write(*this, offset());
@@ -70,6 +70,10 @@ public:
     off_t seek(off_t, int whence);
     ssize_t read(u8*, ssize_t);
     ssize_t write(const u8* data, ssize_t);
+
+    // Positional I/O, which leaves the current offset alone.
+    ssize_t read(u8*, off_t offset, ssize_t);
+    ssize_t write(const u8* data, off_t offset, ssize_t);
     KResult fstat(stat&);
 
     KResult chmod(mode_t);
@@ -0,0 +1,737 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
+
+//#define IO_RING_DEBUG
+
+namespace Kernel {
+
+static constexpr u32 max_ring_entries = 4096;
+static constexpr u32 max_buffer_size = 16 * MB;
+static constexpr u32 max_iovec_count = 1024;
+static constexpr u32 max_worker_count = 32;
+static constexpr size_t max_events_per_pass = 32;
+
+static SpinLock<u8> s_work_lock;
+static IORing::WorkList* s_work_list;
+static Process* s_worker_process;
+static Atomic<u32> s_worker_count;
+static Atomic<u32> s_idle_worker_count;
+static Atomic<bool> s_spawning_worker;
+
+static void worker_main();
+
+static NonnullRefPtr<IORing> take_work()
+{
+    for (;;) {
+        {
+            ScopedSpinLock lock(s_work_lock);
+            // The reference taken by IORing::schedule() is now ours.
+            if (auto* ring = s_work_list->take_first())
+                return adopt(*ring);
+        }
+        ++s_idle_worker_count;
+        (void)Thread::current()->block_until("IORing (idle)", [] {
+            return !s_work_list->is_empty();
+        });
+        --s_idle_worker_count;
+    }
+}
+
+static void spawn_worker_if_needed()
+{
+    // Rings get queued from interrupt context, where we can't create threads,
+    // so there is always at least one worker once a request has been parked.
+    // More are added while the queue backs up behind busy workers.
+    if (s_worker_count) {
+        if (s_idle_worker_count || s_worker_count >= max_worker_count)
+            return;
+        ScopedSpinLock lock(s_work_lock);
+        if (s_work_list->is_empty())
+            return;
+    }
+    // If somebody else is already spawning a worker, let them.
+    bool expected = false;
+    if (!s_spawning_worker.compare_exchange_strong(expected, true))
+        return;
+    ++s_worker_count;
+    if (!s_worker_process) {
+        Thread* thread = nullptr;
+        s_worker_process = Process::create_kernel_process(thread, "IORingWorker", worker_main);
+    } else {
+        s_worker_process->create_kernel_thread(worker_main, THREAD_PRIORITY_NORMAL, "IORingWorker", THREAD_AFFINITY_DEFAULT, false);
+    }
+    s_spawning_worker = false;
+}
+
+static void worker_main()
+{
+    for (;;) {
+        auto ring = take_work();
+        spawn_worker_if_needed();
+        ring->run_ready_requests();
+    }
+}
+
+IORingRequest::IORingRequest(IORing& ring, const io_ring_sqe& sqe, RefPtr<FileDescription> description)
+    : m_ring(ring)
+    , m_sqe(sqe)
+    , m_description(move(description))
+{
+}
+
+bool IORingRequest::must_run_in_worker() const
+{
+    // This may take a while even when there is nothing to wait for.
+    return m_sqe.opcode == IO_RING_OP_FSYNC;
+}
+
+bool IORingRequest::is_ready() const
+{
+    switch (m_sqe.opcode) {
+    case IO_RING_OP_READ:
+    case IO_RING_OP_READV:
+        return is_positional() || m_description->can_read();
+    case IO_RING_OP_WRITE:
+    case IO_RING_OP_WRITEV:
+        return is_positional() || m_description->can_write();
+    case IO_RING_OP_ACCEPT:
+        return m_description->socket()->can_accept();
+    case IO_RING_OP_CONNECT:
+        return !m_connect_started || m_description->socket()->setup_state() == Socket::SetupState::Completed;
+    case IO_RING_OP_TIMEOUT:
+        return !m_sqe.offset || m_timer_fired;
+    default:
+        return true;
+    }
+}
+
+u32 IORingRequest::watched_events() const
+{
+    switch (m_sqe.opcode) {
+    case IO_RING_OP_WRITE:
+    case IO_RING_OP_WRITEV:
+        return EPOLLOUT;
+    case IO_RING_OP_CONNECT:
+        // A failed connection attempt only ever becomes readable.
+        return EPOLLIN | EPOLLOUT;
+    default:
+        return EPOLLIN;
+    }
+}
+
+static bool is_power_of_two(u32 value)
+{
+    return value && !(value & (value - 1));
+}
+
+static bool has_promised(Pledge pledge)
+{
+    auto& process = *Process::current();
+    return !process.has_promises() || process.has_promised(pledge);
+}
+
+KResultOr<NonnullRefPtr<IORing>> IORing::create(io_ring_params& params)
+{
+    if (!params.sq_entries || params.sq_entries > max_ring_entries || !is_power_of_two(params.sq_entries))
+        return KResult(-EINVAL);
+    if (!params.cq_entries)
+        params.cq_entries = params.sq_entries * 2;
+    if (params.cq_entries < params.sq_entries || params.cq_entries > max_ring_entries * 2 || !is_power_of_two(params.cq_entries))
+        return KResult(-EINVAL);
+    if (params.buffer_size > max_buffer_size || params.flags)
+        return KResult(-EINVAL);
+
+    params.sq_offset = sizeof(io_ring_header);
+    params.cq_offset = params.sq_offset + params.sq_entries * sizeof(io_ring_sqe);
+    params.buffer_offset = PAGE_ROUND_UP(params.cq_offset + params.cq_entries * sizeof(io_ring_cqe));
+    params.ring_size = PAGE_ROUND_UP(params.buffer_offset + params.buffer_size);
+
+    auto region = MM.allocate_kernel_region(params.ring_size, "IORing", Region::Access::Read | Region::Access::Write, false, true);
+    if (!region)
+        return KResult(-ENOMEM);
+
+    {
+        ScopedSpinLock lock(s_work_lock);
+        if (!s_work_list)
+            s_work_list = new IORing::WorkList;
+    }
+    return adopt(*new IORing(region.release_nonnull(), params));
+}
+
+IORing::IORing(NonnullOwnPtr<Region> region, const io_ring_params& params)
+    : m_region(move(region))
+    , m_sq_entries(params.sq_entries)
+    , m_cq_entries(params.cq_entries)
+    , m_sq_offset(params.sq_offset)
+    , m_cq_offset(params.cq_offset)
+    , m_buffer_offset(params.buffer_offset)
+    , m_buffer_size(params.buffer_size)
+    , m_readiness(EPoll::create())
+{
+    m_readiness->set_on_watch_queued([this] {
+        schedule();
+    });
+
+    auto& header = this->header();
+    header.sq_mask = m_sq_entries - 1;
+    header.sq_entries = m_sq_entries;
+    header.cq_mask = m_cq_entries - 1;
+    header.cq_entries = m_cq_entries;
+}
+
+IORing::~IORing()
+{
+}
+
+KResult IORing::close()
+{
+    if (m_cancelled.exchange(true))
+        return KSuccess;
+
+    // Parked requests keep a reference to us, drop them to break the cycle.
+    Vector<OwnPtr<IORingRequest>> waiting_requests;
+    Vector<NonnullOwnPtr<IORingRequest>> pending_accepts;
+    {
+        LOCKER(m_waiting_lock);
+        {
+            ScopedSpinLock lock(m_lock);
+            while (m_ready_requests.take_first())
+                ;
+            for (auto& it : m_waiting_requests)
+                waiting_requests.append(move(it.value));
+            m_waiting_requests.clear();
+            pending_accepts = move(m_pending_accepts);
+        }
+        for (auto& request : waiting_requests)
+            stop_waiting(*request);
+    }
+
+    // A timer that was already firing on another processor may still be looking for its request.
+    while (m_armed_timers.load())
+        Processor::wait_check();
+    return KSuccess;
+}
+
+KResultOr<Region*> IORing::mmap(Process& process, FileDescription&, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared)
+{
+    if (!shared || offset != 0 || size != m_region->size())
+        return KResult(-EINVAL);
+    auto* region = process.allocate_region_with_vmobject(preferred_vaddr, size, m_region->vmobject(), 0, "IORing", prot);
+    if (!region)
+        return KResult(-ENOMEM);
+    return region;
+}
+
+bool IORing::can_read(const FileDescription&, size_t) const
+{
+    return completion_count() || has_pending_accepts() || has_overflowed_completions();
+}
+
+size_t IORing::completion_count() const
+{
+    auto head = AK::atomic_load(&const_cast<io_ring_header&>(header()).cq_head, AK::memory_order_acquire);
+    // Userspace could have written anything into the head, don't trust it too much.
+    return min(m_cq_tail - head, m_cq_entries);
+}
+
+bool IORing::has_pending_accepts() const
+{
+    ScopedSpinLock lock(m_lock);
+    return !m_pending_accepts.is_empty();
+}
+
+bool IORing::validate_buffer(u32 offset, u32 length) const
+{
+    return offset <= m_buffer_size && length <= m_buffer_size - offset;
+}
+
+KResultOr<NonnullOwnPtr<IORingRequest>> IORing::prepare_request(const io_ring_sqe& sqe)
+{
+    RefPtr<FileDescription> description;
+    if (sqe.opcode != IO_RING_OP_NOP && sqe.opcode != IO_RING_OP_TIMEOUT && sqe.opcode != IO_RING_OP_CANCEL) {
+        description = Process::current()->file_description(sqe.fd);
+        if (!description)
+            return KResult(-EBADF);
+        if (description->file().is_io_ring())
+            return KResult(-EINVAL);
+    }
+
+    auto request = make<IORingRequest>(*this, sqe, description);
+    bool is_positional = request->is_positional();
+
+    switch (sqe.opcode) {
+    case IO_RING_OP_NOP:
+        break;
+    case IO_RING_OP_READ:
+    case IO_RING_OP_WRITE:
+    case IO_RING_OP_READV:
+    case IO_RING_OP_WRITEV: {
+        bool is_write = sqe.opcode == IO_RING_OP_WRITE || sqe.opcode == IO_RING_OP_WRITEV;
+        if (is_write ? !description->is_writable() : !description->is_readable())
+            return KResult(-EBADF);
+        if (description->is_directory())
+            return KResult(-EISDIR);
+        if (is_positional) {
+            if (!description->file().is_seekable())
+                return KResult(-ESPIPE);
+            if (sqe.offset > (u64)NumericLimits<off_t>::max())
+                return KResult(-EOVERFLOW);
+        }
+        if (sqe.opcode == IO_RING_OP_READ || sqe.opcode == IO_RING_OP_WRITE) {
+            if (!validate_buffer(sqe.buffer, sqe.length))
+                return KResult(-EFAULT);
+            break;
+        }
+        if (!sqe.length || sqe.length > max_iovec_count)
+            return KResult(-EINVAL);
+        if (!validate_buffer(sqe.buffer, sqe.length * sizeof(io_ring_iovec)))
+            return KResult(-EFAULT);
+        request->m_iovecs.resize(sqe.length);
+        memcpy(request->m_iovecs.data(), buffer_area() + sqe.buffer, sqe.length * sizeof(io_ring_iovec));
+        u64 total_length = 0;
+        for (auto& vec : request->m_iovecs) {
+            if (!validate_buffer(vec.buffer, vec.length))
+                return KResult(-EFAULT);
+            total_length += vec.length;
+        }
+        if (total_length > NumericLimits<i32>::max())
+            return KResult(-EINVAL);
+        break;
+    }
+    case IO_RING_OP_ACCEPT:
+        if (!description->is_socket())
+            return KResult(-ENOTSOCK);
+        if (!has_promised(Pledge::accept))
+            return KResult(-EPERM);
+        break;
+    case IO_RING_OP_CONNECT:
+        if (!description->is_socket())
+            return KResult(-ENOTSOCK);
+        // Local sockets can't connect without blocking until the connection is accepted.
+        if (description->socket()->domain() != AF_INET)
+            return KResult(-EOPNOTSUPP);
+        if (!has_promised(Pledge::inet))
+            return KResult(-EPERM);
+        if (sqe.length != sizeof(sockaddr_in) || !validate_buffer(sqe.buffer, sqe.length))
+            return KResult(-EINVAL);
+        memcpy(request->m_address, buffer_area() + sqe.buffer, sizeof(sockaddr_in));
+        break;
+    case IO_RING_OP_FSYNC:
+        if (!description->inode())
+            return KResult(-EINVAL);
+        break;
+    case IO_RING_OP_TIMEOUT:
+    case IO_RING_OP_CANCEL:
+        break;
+    default:
+        return KResult(-EINVAL);
+    }
+    return request;
+}
+
+int IORing::submit(unsigned to_submit)
+{
+    LOCKER(m_submission_lock);
+    auto& header = this->header();
+    u32 tail = AK::atomic_load(&header.sq_tail, AK::memory_order_acquire);
+    if (tail - m_sq_head > m_sq_entries)
+        return -EINVAL;
+
+    unsigned submitted = 0;
+    while (submitted < to_submit && m_sq_head != tail) {
+        // Copy the entry out first, userspace may keep scribbling over the ring.
+        io_ring_sqe sqe = submission_entries()[m_sq_head & (m_sq_entries - 1)];
+        ++m_sq_head;
+        ++submitted;
+
+#ifdef IO_RING_DEBUG
+        dbg() << "IORing{" << this << "}: submit opcode " << sqe.opcode << " fd " << sqe.fd;
+#endif
+        auto request_or_error = prepare_request(sqe);
+        if (request_or_error.is_error()) {
+            post_completion(sqe.user_data, request_or_error.error());
+            continue;
+        }
+        dispatch(move(request_or_error.value()));
+    }
+    AK::atomic_store(&header.sq_head, m_sq_head, AK::memory_order_release);
+    return submitted;
+}
+
+void IORing::dispatch(NonnullOwnPtr<IORingRequest>&& request)
+{
+    if (!request->must_run_in_worker() && request->is_ready()) {
+        run_request(move(request));
+        return;
+    }
+    park(move(request));
+}
+
+void IORing::run_request(NonnullOwnPtr<IORingRequest>&& request)
+{
+    u64 user_data = request->sqe().user_data;
+    if (m_cancelled) {
+        post_completion(user_data, -EINTR);
+        return;
+    }
+    auto result = perform(request);
+    if (result.has_value())
+        post_completion(user_data, result.value());
+}
+
+void IORing::park(NonnullOwnPtr<IORingRequest>&& request)
+{
+    LOCKER(m_waiting_lock);
+    if (m_cancelled) {
+        post_completion(request->sqe().user_data, -EINTR);
+        return;
+    }
+
+    auto& parked = *request;
+    u32 id = m_next_request_id++;
+    parked.m_id = id;
+    {
+        ScopedSpinLock lock(m_lock);
+        m_waiting_requests.set(id, move(request));
+        if (parked.must_run_in_worker())
+            m_ready_requests.append(parked);
+    }
+
+    if (parked.must_run_in_worker()) {
+        schedule();
+    } else if (parked.sqe().opcode == IO_RING_OP_TIMEOUT) {
+        u64 nanoseconds = parked.sqe().offset;
+        timeval timeout { (time_t)(nanoseconds / 1'000'000'000), (suseconds_t)(nanoseconds % 1'000'000'000 / 1000) };
+        ++m_armed_timers;
+        parked.m_timer_id = TimerQueue::the().add_timer(timeout, [this, id] {
+            timer_fired(id);
+        });
+    } else {
+        epoll_event event;
+        event.events = parked.watched_events() | EPOLLONESHOT;
+        event.data.u32 = id;
+        auto result = m_readiness->add_watch(id, *parked.description(), event);
+        if (result.is_error()) {
+            u64 user_data = parked.sqe().user_data;
+            {
+                ScopedSpinLock lock(m_lock);
+                take_waiting_request(id);
+            }
+            post_completion(user_data, result.error());
+            return;
+        }
+        parked.m_is_watched = true;
+    }
+    spawn_worker_if_needed();
+}
+
+OwnPtr<IORingRequest> IORing::take_waiting_request(u32 id)
+{
+    ASSERT(m_lock.is_locked());
+    auto it = m_waiting_requests.find(id);
+    if (it == m_waiting_requests.end())
+        return nullptr;
+    auto request = move(it->value);
+    m_waiting_requests.remove(it);
+    if (request->m_ready_list_node.is_in_list())
+        m_ready_requests.remove(*request);
+    return request;
+}
+
+void IORing::stop_waiting(IORingRequest& request)
+{
+    ASSERT(m_waiting_lock.is_locked());
+    if (request.m_is_watched) {
+        (void)m_readiness->remove_watch(request.m_id);
+        request.m_is_watched = false;
+    }
+    // If this fails, the timer is already firing and will find nothing to wake up.
+    if (request.sqe().opcode == IO_RING_OP_TIMEOUT && TimerQueue::the().cancel_timer(request.m_timer_id))
+        --m_armed_timers;
+}
+
+void IORing::timer_fired(u32 id)
+{
+    // This runs in interrupt context, so all we do is mark the request as ready.
+    bool found = false;
+    {
+        ScopedSpinLock lock(m_lock);
+        auto it = m_waiting_requests.find(id);
+        if (it != m_waiting_requests.end()) {
+            it->value->m_timer_fired = true;
+            m_ready_requests.append(*it->value);
+            found = true;
+        }
+    }
+    if (found)
+        schedule();
+    --m_armed_timers;
+}
+
+void IORing::schedule()
+{
+    ScopedSpinLock lock(s_work_lock);
+    if (m_work_list_node.is_in_list())
+        return;
+    // Keep ourselves alive until a worker has picked us up, see take_work().
+    ref();
+    s_work_list->append(*this);
+}
+
+void IORing::run_ready_requests()
+{
+    epoll_event events[max_events_per_pass];
+    size_t event_count;
+    do {
+        event_count = m_readiness->collect_ready_events(events, max_events_per_pass);
+        ScopedSpinLock lock(m_lock);
+        for (size_t i = 0; i < event_count; ++i) {
+            auto it = m_waiting_requests.find(events[i].data.u32);
+            if (it != m_waiting_requests.end() && !it->value->m_ready_list_node.is_in_list())
+                m_ready_requests.append(*it->value);
+        }
+    } while (event_count == max_events_per_pass);
+
+    for (;;) {
+        OwnPtr<IORingRequest> request;
+        {
+            LOCKER(m_waiting_lock);
+            {
+                ScopedSpinLock lock(m_lock);
+                auto* ready_request = m_ready_requests.take_first();
+                if (!ready_request)
+                    return;
+                request = take_waiting_request(ready_request->m_id);
+            }
+            stop_waiting(*request);
+        }
+        // Somebody else may have consumed whatever made us ready.
+        if (request->must_run_in_worker() || request->is_ready())
+            run_request(request.release_nonnull());
+        else
+            park(request.release_nonnull());
+    }
+}
+
+int IORing::cancel(u64 user_data)
+{
+    OwnPtr<IORingRequest> request;
+    {
+        LOCKER(m_waiting_lock);
+        {
+            ScopedSpinLock lock(m_lock);
+            for (auto& it : m_waiting_requests) {
+                if (it.value->sqe().user_data == user_data) {
+                    request = take_waiting_request(it.key);
+                    break;
+                }
+            }
+            for (size_t i = 0; !request && i < m_pending_accepts.size(); ++i) {
+                if (m_pending_accepts[i]->sqe().user_data == user_data)
+                    request = m_pending_accepts.take(i);
+            }
+        }
+        // Requests that a worker is already running can't be cancelled anymore.
+        if (!request)
+            return -ENOENT;
+        stop_waiting(*request);
+    }
+    post_completion(user_data, -EINTR);
+    return 0;
+}
+
+Optional<int> IORing::perform(NonnullOwnPtr<IORingRequest>& request)
+{
+    auto& sqe = request->sqe();
+    switch (sqe.opcode) {
+    case IO_RING_OP_NOP:
+        return 0;
+    case IO_RING_OP_READ:
+    case IO_RING_OP_WRITE:
+        return transfer(*request, sqe.buffer, sqe.length, sqe.offset);
+    case IO_RING_OP_READV:
+    case IO_RING_OP_WRITEV: {
+        int ntransferred = 0;
+        for (auto& vec : request->m_iovecs) {
+            u64 offset = request->is_positional() ? sqe.offset + ntransferred : IO_RING_CURRENT_OFFSET;
+            ssize_t rc = transfer(*request, vec.buffer, vec.length, offset);
+            if (rc < 0)
+                return ntransferred ? ntransferred : rc;
+            ntransferred += rc;
+            if ((u32)rc < vec.length)
+                break;
+        }
+        return ntransferred;
+    }
+    case IO_RING_OP_ACCEPT: {
+        {
+            ScopedSpinLock lock(m_lock);
+            m_pending_accepts.append(move(request));
+        }
+        did_change_readiness();
+        return {};
+    }
+    case IO_RING_OP_CONNECT: {
+        auto& description = *request->description();
+        auto& socket = *description.socket();
+        if (request->m_connect_started)
+            return socket.is_connected() ? 0 : -ECONNREFUSED;
+        request->m_connect_started = true;
+        auto result = socket.connect(description, (const sockaddr*)request->m_address, sizeof(sockaddr_in), ShouldBlock::No);
+        if (result.error() != -EINPROGRESS)
+            return result.error();
+        park(move(request));
+        return {};
+    }
+    case IO_RING_OP_FSYNC: {
+        auto& inode = *request->description()->inode();
+        inode.flush_metadata();
+        inode.fs().flush_writes();
+        return 0;
+    }
+    case IO_RING_OP_TIMEOUT:
+        return -ETIMEDOUT;
+    case IO_RING_OP_CANCEL:
+        return cancel(sqe.offset);
+    }
+    ASSERT_NOT_REACHED();
+}
+
+ssize_t IORing::transfer(IORingRequest& request, u32 buffer, u32 length, u64 offset)
+{
+    auto& description = *request.description();
+    u8* data = buffer_area() + buffer;
+    bool is_write = request.sqe().opcode == IO_RING_OP_WRITE || request.sqe().opcode == IO_RING_OP_WRITEV;
+
+    if (offset != IO_RING_CURRENT_OFFSET) {
+        if (is_write)
+            return description.write(data, offset, length);
+        return description.read(data, offset, length);
+    }
+
+    if (is_write) {
+        if (description.should_append())
+            description.seek(0, SEEK_END);
+        return description.write(data, length);
+    }
+    return description.read(data, length);
+}
+
+void IORing::complete_pending_accepts(Process& process)
+{
+    Vector<NonnullOwnPtr<IORingRequest>> pending_accepts;
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_pending_accepts.is_empty())
+            return;
+        pending_accepts = move(m_pending_accepts);
+    }
+
+    for (auto& request : pending_accepts) {
+        auto& accepting_description = *request->description();
+        auto& socket = *accepting_description.socket();
+        if (!socket.can_accept()) {
+            // Somebody else got to the connection first, go back to waiting.
+            dispatch(move(request));
+            continue;
+        }
+
+        int fd = process.alloc_fd();
+        if (fd < 0) {
+            post_completion(request->sqe().user_data, fd);
+            continue;
+        }
+
+        auto accepted_socket = socket.accept();
+        ASSERT(accepted_socket);
+        auto accepted_description = FileDescription::create(*accepted_socket);
+        accepted_description->set_readable(true);
+        accepted_description->set_writable(true);
+        accepted_description->set_blocking(accepting_description.is_blocking());
+        process.m_fds[fd].set(move(accepted_description));
+
+        // NOTE: Moving this state to Completed is what causes connect() to unblock on the client side.
+        accepted_socket->set_setup_state(Socket::SetupState::Completed);
+        post_completion(request->sqe().user_data, fd);
+    }
+}
+
+void IORing::post_completion(u64 user_data, int result)
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        move_overflowed_completions_to_queue();
+        if (!m_overflowed_completions.is_empty() || completion_count() == m_cq_entries) {
+            // Keep it around until userspace makes room.
+            m_overflowed_completions.append({ user_data, result, 0 });
+        } else {
+            completion_entries()[m_cq_tail & (m_cq_entries - 1)] = { user_data, result, 0 };
+            AK::atomic_store(&header().cq_tail, ++m_cq_tail, AK::memory_order_release);
+        }
+    }
+    did_change_readiness();
+}
+
+void IORing::flush_overflowed_completions()
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_overflowed_completions.is_empty())
+            return;
+        move_overflowed_completions_to_queue();
+    }
+    did_change_readiness();
+}
+
+bool IORing::has_overflowed_completions() const
+{
+    ScopedSpinLock lock(m_lock);
+    return !m_overflowed_completions.is_empty();
+}
+
+bool IORing::can_flush_overflowed_completions() const
+{
+    ScopedSpinLock lock(m_lock);
+    return !m_overflowed_completions.is_empty() && completion_count() < m_cq_entries;
+}
+
+void IORing::move_overflowed_completions_to_queue()
+{
+    ASSERT(m_lock.is_locked());
+    while (!m_overflowed_completions.is_empty() && completion_count() < m_cq_entries) {
+        completion_entries()[m_cq_tail & (m_cq_entries - 1)] = m_overflowed_completions.take_first();
+        AK::atomic_store(&header().cq_tail, ++m_cq_tail, AK::memory_order_release);
+    }
+}
+
+}
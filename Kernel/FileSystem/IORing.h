@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/TimerQueue.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// An IORingRequest is one submission queue entry that has been validated and
+// copied out of the shared ring, so userspace can no longer change it under us.
+class IORingRequest {
+public:
+    IORingRequest(IORing&, const io_ring_sqe&, RefPtr<FileDescription>);
+
+    IORing& ring() { return *m_ring; }
+    const io_ring_sqe& sqe() const { return m_sqe; }
+    FileDescription* description() { return m_description.ptr(); }
+
+    bool is_positional() const { return m_sqe.offset != IO_RING_CURRENT_OFFSET; }
+    bool must_run_in_worker() const;
+    bool is_ready() const;
+    u32 watched_events() const;
+
+private:
+    friend class IORing;
+
+    NonnullRefPtr<IORing> m_ring;
+    io_ring_sqe m_sqe;
+    RefPtr<FileDescription> m_description;
+    Vector<io_ring_iovec, 4> m_iovecs;
+    u8 m_address[sizeof(sockaddr_in)];
+
+    // Set while the request is parked in IORing::m_waiting_requests.
+    u32 m_id { 0 };
+    bool m_is_watched { false };
+    TimerId m_timer_id { 0 };
+    bool m_timer_fired { false };
+    bool m_connect_started { false };
+
+    IntrusiveListNode m_ready_list_node;
+};
+
+// IORing is a pair of submission and completion queues shared with userspace.
+// Requests that can complete right away are performed while submitting them.
+// Everything else is parked on the ring until an EPoll watch or a timer says
+// it's ready, and is then handed to a pool of kernel worker threads. Workers
+// never wait for readiness themselves.
+class IORing final : public File {
+public:
+    static KResultOr<NonnullRefPtr<IORing>> create(io_ring_params&);
+    virtual ~IORing() override;
+
+    // Consumes up to to_submit entries from the submission queue.
+    // Returns the number of entries consumed.
+    int submit(unsigned to_submit);
+
+    // Accepting a connection has to happen in the context of the process that
+    // owns the new file descriptor, so workers only wait for the listening
+    // socket to become ready and leave the rest to the next io_ring_enter().
+    void complete_pending_accepts(Process&);
+    bool has_pending_accepts() const;
+
+    // Completions that didn't fit into the completion queue are kept around
+    // until userspace makes room and calls io_ring_enter().
+    void flush_overflowed_completions();
+    bool has_overflowed_completions() const;
+    bool can_flush_overflowed_completions() const;
+
+    size_t completion_count() const;
+    u32 completion_queue_size() const { return m_cq_entries; }
+    bool is_cancelled() const { return m_cancelled; }
+
+    // Called by the worker pool.
+    void run_ready_requests();
+
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual ssize_t read(FileDescription&, size_t, u8*, ssize_t) override { return -EINVAL; }
+    virtual ssize_t write(FileDescription&, size_t, const u8*, ssize_t) override { return -EINVAL; }
+    virtual KResultOr<Region*> mmap(Process&, FileDescription&, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared) override;
+    virtual KResult close() override;
+    virtual String absolute_path(const FileDescription&) const override { return "io_ring"; }
+    virtual const char* class_name() const override { return "IORing"; }
+    virtual bool is_io_ring() const override { return true; }
+
+private:
+    IORing(NonnullOwnPtr<Region>, const io_ring_params&);
+
+    io_ring_header& header() { return *reinterpret_cast<io_ring_header*>(m_region->vaddr().as_ptr()); }
+    const io_ring_header& header() const { return *reinterpret_cast<const io_ring_header*>(m_region->vaddr().as_ptr()); }
+    io_ring_sqe* submission_entries() { return reinterpret_cast<io_ring_sqe*>(m_region->vaddr().offset(m_sq_offset).as_ptr()); }
+    io_ring_cqe* completion_entries() { return reinterpret_cast<io_ring_cqe*>(m_region->vaddr().offset(m_cq_offset).as_ptr()); }
+    u8* buffer_area() { return m_region->vaddr().offset(m_buffer_offset).as_ptr(); }
+
+    KResultOr<NonnullOwnPtr<IORingRequest>> prepare_request(const io_ring_sqe&);
+    bool validate_buffer(u32 offset, u32 length) const;
+    void dispatch(NonnullOwnPtr<IORingRequest>&&);
+    void run_request(NonnullOwnPtr<IORingRequest>&&);
+    Optional<int> perform(NonnullOwnPtr<IORingRequest>&);
+    ssize_t transfer(IORingRequest&, u32 buffer, u32 length, u64 offset);
+    int cancel(u64 user_data);
+
+    void park(NonnullOwnPtr<IORingRequest>&&);
+    OwnPtr<IORingRequest> take_waiting_request(u32 id);
+    void stop_waiting(IORingRequest&);
+    void timer_fired(u32 id);
+    void schedule();
+
+    void post_completion(u64 user_data, int result);
+    void move_overflowed_completions_to_queue();
+
+    NonnullOwnPtr<Region> m_region;
+    u32 m_sq_entries { 0 };
+    u32 m_cq_entries { 0 };
+    u32 m_sq_offset { 0 };
+    u32 m_cq_offset { 0 };
+    u32 m_buffer_offset { 0 };
+    u32 m_buffer_size { 0 };
+
+    // The kernel's own view of the queue heads and tails. Userspace only gets to
+    // move the submission tail and the completion head.
+    u32 m_sq_head { 0 };
+    u32 m_cq_tail { 0 };
+
+    Lock m_submission_lock { "IORing" };
+
+    // m_lock protects the completion queue and everything queued up for it.
+    // m_waiting_requests is only modified with both m_waiting_lock and m_lock
+    // held, so that timers can find their request from interrupt context.
+    mutable SpinLock<u8> m_lock;
+    Vector<io_ring_cqe> m_overflowed_completions;
+    Vector<NonnullOwnPtr<IORingRequest>> m_pending_accepts;
+
+    Lock m_waiting_lock { "IORing waiting" };
+    HashMap<u32, OwnPtr<IORingRequest>> m_waiting_requests;
+    IntrusiveList<IORingRequest, &IORingRequest::m_ready_list_node> m_ready_requests;
+    u32 m_next_request_id { 1 };
+
+    // Watches the descriptions of parked requests, keyed by request id.
+    NonnullRefPtr<EPoll> m_readiness;
+    Atomic<u32> m_armed_timers { 0 };
+
+    Atomic<bool> m_cancelled { false };
+
+    IntrusiveListNode m_work_list_node;
+
+public:
+    typedef IntrusiveList<IORing, &IORing::m_work_list_node> WorkList;
+};
+
+}
@@ -88,18 +88,21 @@ void InodeWatcher::notify_inode_event(Badge<Inode>, Event::Type event_type)
 {
     LOCKER(m_lock);
     m_queue.enqueue({ event_type, {} });
+    did_change_readiness();
 }
 
 void InodeWatcher::notify_child_added(Badge<Inode>, const String& child_name)
 {
     LOCKER(m_lock);
     m_queue.enqueue({ Event::Type::ChildAdded, child_name });
+    did_change_readiness();
 }
 
 void InodeWatcher::notify_child_removed(Badge<Inode>, const String& child_name)
 {
     LOCKER(m_lock);
     m_queue.enqueue({ Event::Type::ChildRemoved, child_name });
+    did_change_readiness();
 }
 
 }
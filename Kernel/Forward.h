@@ -34,8 +34,11 @@ class Custody;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EPoll;
+class EPollWatch;
 class File;
 class FileDescription;
+class IORing;
 class IPv4Socket;
 class Inode;
 class InodeIdentifier;
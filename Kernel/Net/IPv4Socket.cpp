@@ -387,6 +387,7 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
         m_can_read = true;
     }
     m_bytes_received += packet_size;
+    did_change_readiness();
 #ifdef IPV4_SOCKET_DEBUG
     if (buffer_mode() == BufferMode::Bytes)
         dbg() << "IPv4Socket(" << this << "): did_receive " << packet_size << " bytes, total_received=" << m_bytes_received;
@@ -580,6 +581,7 @@ void IPv4Socket::shut_down_for_reading()
 {
     Socket::shut_down_for_reading();
     m_can_read = true;
+    did_change_readiness();
 }
 
 }
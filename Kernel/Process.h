@@ -211,8 +211,13 @@ public:
     int sys$open(const Syscall::SC_open_params*);
     int sys$close(int fd);
     ssize_t sys$read(int fd, Userspace<u8*>, ssize_t);
+    ssize_t sys$readv(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$pread(const Syscall::SC_pread_params*);
+    ssize_t sys$preadv(const Syscall::SC_preadv_params*);
     ssize_t sys$write(int fd, const u8*, ssize_t);
     ssize_t sys$writev(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$pwrite(const Syscall::SC_pwrite_params*);
+    ssize_t sys$pwritev(const Syscall::SC_pwritev_params*);
     int sys$fstat(int fd, stat*);
     int sys$stat(Userspace<const Syscall::SC_stat_params*>);
     int sys$lseek(int fd, off_t, int whence);
@@ -229,6 +234,13 @@ public:
     int sys$purge(int mode);
     int sys$select(const Syscall::SC_select_params*);
     int sys$poll(const Syscall::SC_poll_params*);
+    int sys$epoll_create(int flags);
+    int sys$epoll_ctl(const Syscall::SC_epoll_ctl_params*);
+    int sys$epoll_wait(const Syscall::SC_epoll_wait_params*);
+    ssize_t sys$sendfile(const Syscall::SC_sendfile_params*);
+    ssize_t sys$splice(const Syscall::SC_splice_params*);
+    int sys$io_ring_setup(io_ring_params*);
+    int sys$io_ring_enter(int fd, unsigned to_submit, unsigned min_complete);
     ssize_t sys$get_dir_entries(int fd, void*, ssize_t);
     int sys$getcwd(Userspace<char*>, ssize_t);
     int sys$chdir(Userspace<const char*>, size_t);
@@ -564,6 +576,7 @@ public:
     KResult poke_user_data(u32* address, u32 data);
 
 private:
+    friend class IORing;
     friend class MemoryManager;
     friend class Scheduler;
     friend class Region;
@@ -580,6 +593,8 @@ private:
 
     int do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags);
     ssize_t do_write(FileDescription&, const u8*, int data_size);
+    KResult copy_and_validate_iovecs(Vector<iovec, 32>&, const struct iovec* user_iov, int iov_count, bool buffers_must_be_writable);
+    ssize_t do_splice(FileDescription& in, off_t* in_offset, FileDescription& out, off_t* out_offset, size_t count);
 
     KResultOr<NonnullRefPtr<FileDescription>> find_elf_interpreter_for_executable(const String& path, char (&first_page)[PAGE_SIZE], int nread, size_t file_size);
     Vector<AuxiliaryValue> generate_auxiliary_vector() const;
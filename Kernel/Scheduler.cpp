@@ -179,6 +179,23 @@ bool Thread::ReadBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
     return blocked_description().can_read();
 }
 
+Thread::EPollBlocker::EPollBlocker(const FileDescription& description, const timespec& deadline, bool has_deadline)
+    : FileDescriptionBlocker(description)
+    , m_deadline(deadline)
+    , m_has_deadline(has_deadline)
+{
+}
+
+bool Thread::EPollBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
+{
+    if (m_has_deadline) {
+        if (now_sec > m_deadline.tv_sec || (now_sec == m_deadline.tv_sec && now_usec * 1000 >= m_deadline.tv_nsec))
+            return true;
+    }
+    // An EPoll is readable when it has queued watches, which only costs a list check.
+    return blocked_description().can_read();
+}
+
 Thread::ConditionBlocker::ConditionBlocker(const char* state_string, Function<bool()>&& condition)
     : m_block_until_condition(move(condition))
     , m_state_string(state_string)
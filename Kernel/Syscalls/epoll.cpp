@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Time.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+int Process::sys$epoll_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+    if ((flags & EPOLL_CLOEXEC) != flags)
+        return -EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    m_fds[fd].set(FileDescription::create(EPoll::create()), (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0);
+    m_fds[fd].description()->set_readable(true);
+    return fd;
+}
+
+int Process::sys$epoll_ctl(const Syscall::SC_epoll_ctl_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_ctl_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    auto epoll_description = file_description(params.epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_epoll())
+        return -EINVAL;
+    auto& epoll = static_cast<EPoll&>(epoll_description->file());
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+
+    if (params.op == EPOLL_CTL_DEL)
+        return epoll.remove_watch(params.fd);
+
+    epoll_event event;
+    if (!validate_read_and_copy_typed(&event, params.event))
+        return -EFAULT;
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return epoll.add_watch(params.fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return epoll.modify_watch(params.fd, *description, event);
+    default:
+        return -EINVAL;
+    }
+}
+
+int Process::sys$epoll_wait(const Syscall::SC_epoll_wait_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_wait_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if (params.max_events <= 0)
+        return -EINVAL;
+    if (!validate_write_typed(params.events, params.max_events))
+        return -EFAULT;
+
+    timespec timeout;
+    if (params.timeout && !validate_read_and_copy_typed(&timeout, params.timeout))
+        return -EFAULT;
+
+    auto epoll_description = file_description(params.epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_epoll())
+        return -EINVAL;
+    auto& epoll = static_cast<EPoll&>(epoll_description->file());
+
+    timespec deadline;
+    bool has_deadline = false;
+    bool should_block = true;
+    if (params.timeout) {
+        if (timeout.tv_sec || timeout.tv_nsec) {
+            timespec ts_since_boot;
+            timeval_to_timespec(Scheduler::time_since_boot(), ts_since_boot);
+            timespec_add(ts_since_boot, timeout, deadline);
+            has_deadline = true;
+        } else {
+            should_block = false;
+        }
+    }
+
+    // FIXME: Batch the copy-out instead of bouncing through a kernel buffer.
+    static constexpr size_t max_events_per_call = 256;
+    Vector<epoll_event, 32> events;
+    events.resize(min((size_t)params.max_events, max_events_per_call));
+
+    for (;;) {
+        size_t count = epoll.collect_ready_events(events.data(), events.size());
+        if (count) {
+            copy_to_user(params.events, events.data(), count * sizeof(epoll_event));
+            return count;
+        }
+        if (!should_block)
+            return 0;
+        if (has_deadline) {
+            timespec now;
+            timeval_to_timespec(Scheduler::time_since_boot(), now);
+            if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec))
+                return 0;
+        }
+
+        if (Thread::current()->block<Thread::EPollBlocker>(*epoll_description, deadline, has_deadline).was_interrupted())
+            return -EINTR;
+
+        // While we blocked, the process lock was dropped. This gave other threads
+        // the opportunity to unmap the output buffer, so we need to re-validate it.
+        if (!validate_write_typed(params.events, params.max_events))
+            return -EFAULT;
+    }
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+int Process::sys$io_ring_setup(io_ring_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    io_ring_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    auto ring_or_error = IORing::create(params);
+    if (ring_or_error.is_error())
+        return ring_or_error.error();
+
+    if (!validate_write_typed(user_params))
+        return -EFAULT;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    auto description = FileDescription::create(ring_or_error.release_value());
+    description->set_readable(true);
+    description->set_writable(true);
+    m_fds[fd].set(move(description));
+
+    copy_to_user(user_params, &params);
+    return fd;
+}
+
+int Process::sys$io_ring_enter(int fd, unsigned to_submit, unsigned min_complete)
+{
+    REQUIRE_PROMISE(stdio);
+    auto description = file_description(fd);
+    if (!description)
+        return -EBADF;
+    if (!description->file().is_io_ring())
+        return -EINVAL;
+    auto& ring = static_cast<IORing&>(description->file());
+
+    int submitted = ring.submit(to_submit);
+    if (submitted < 0)
+        return submitted;
+    ring.flush_overflowed_completions();
+    ring.complete_pending_accepts(*this);
+
+    // The queue can't hold more than this, anything beyond it is waiting in the overflow list.
+    min_complete = min(min_complete, ring.completion_queue_size());
+    while (ring.completion_count() < min_complete) {
+        if (Thread::current()->block_until("IORing", [&] {
+                return ring.completion_count() >= min_complete || ring.has_pending_accepts() || ring.can_flush_overflowed_completions();
+            }).was_interrupted()) {
+            return submitted ? submitted : -EINTR;
+        }
+        ring.flush_overflowed_completions();
+        ring.complete_pending_accepts(*this);
+    }
+    return submitted;
+}
+
+}
@@ -60,4 +60,99 @@ ssize_t Process::sys$read(int fd, Userspace<u8*> buffer, ssize_t size)
     return description->read(buffer.unsafe_userspace_ptr(), size);
 }
 
+ssize_t Process::sys$readv(int fd, const struct iovec* iov, int iov_count)
+{
+    REQUIRE_PROMISE(stdio);
+    Vector<iovec, 32> vecs;
+    auto result = copy_and_validate_iovecs(vecs, iov, iov_count, true);
+    if (result.is_error())
+        return result;
+
+    auto description = file_description(fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+    if (description->is_directory())
+        return -EISDIR;
+
+    int nread = 0;
+    for (auto& vec : vecs) {
+        // Only block for the first buffer, like a single read() would.
+        if (description->is_blocking() && !nread) {
+            if (!description->can_read()) {
+                if (Thread::current()->block<Thread::ReadBlocker>(*description).was_interrupted())
+                    return -EINTR;
+                if (!description->can_read())
+                    return -EAGAIN;
+            }
+        } else if (nread && !description->can_read()) {
+            break;
+        }
+        int rc = description->read((u8*)vec.iov_base, vec.iov_len);
+        if (rc < 0)
+            return nread ? nread : rc;
+        nread += rc;
+        if ((size_t)rc < vec.iov_len)
+            break;
+    }
+    return nread;
+}
+
+ssize_t Process::sys$pread(const Syscall::SC_pread_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_pread_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if ((ssize_t)params.buffer.size < 0)
+        return -EINVAL;
+    if (!params.buffer.size)
+        return 0;
+    if (!validate(params.buffer))
+        return -EFAULT;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+    if (description->is_directory())
+        return -EISDIR;
+    return description->read((u8*)params.buffer.data, params.offset, params.buffer.size);
+}
+
+ssize_t Process::sys$preadv(const Syscall::SC_preadv_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_preadv_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    Vector<iovec, 32> vecs;
+    auto result = copy_and_validate_iovecs(vecs, params.iov, params.iov_count, true);
+    if (result.is_error())
+        return result;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+    if (description->is_directory())
+        return -EISDIR;
+
+    off_t offset = params.offset;
+    int nread = 0;
+    for (auto& vec : vecs) {
+        int rc = description->read((u8*)vec.iov_base, offset + nread, vec.iov_len);
+        if (rc < 0)
+            return nread ? nread : rc;
+        nread += rc;
+        if ((size_t)rc < vec.iov_len)
+            break;
+    }
+    return nread;
+}
+
 }
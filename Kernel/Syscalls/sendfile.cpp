@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr size_t splice_chunk_size = 64 * KB;
+
+ssize_t Process::do_splice(FileDescription& in, off_t* in_offset, FileDescription& out, off_t* out_offset, size_t count)
+{
+    if (!count)
+        return 0;
+
+    // The data is bounced through a single kernel buffer, so it never has to
+    // make the round trip through userspace.
+    auto buffer = KBuffer::create_with_size(min(count, splice_chunk_size), Region::Access::Read | Region::Access::Write, "Splice");
+
+    size_t ntransferred = 0;
+    while (ntransferred < count) {
+        ssize_t chunk_size = min(count - ntransferred, buffer.size());
+
+        ssize_t nread;
+        if (in_offset) {
+            nread = in.read(buffer.data(), *in_offset, chunk_size);
+        } else {
+            if (!in.can_read()) {
+                // Never block once we have moved some data; report a short transfer instead.
+                if (ntransferred || !in.is_blocking())
+                    break;
+                if (Thread::current()->block<Thread::ReadBlocker>(in).was_interrupted())
+                    return -EINTR;
+                if (!in.can_read())
+                    return -EAGAIN;
+            }
+            nread = in.read(buffer.data(), chunk_size);
+        }
+        if (nread < 0)
+            return ntransferred ? ntransferred : nread;
+        if (nread == 0)
+            break;
+
+        ssize_t nwritten;
+        if (out_offset)
+            nwritten = out.write(buffer.data(), *out_offset, nread);
+        else
+            nwritten = do_write(out, buffer.data(), nread);
+
+        if (nwritten < 0) {
+            // Put back what we consumed from a seekable input so the caller can retry.
+            if (!in_offset && in.file().is_seekable())
+                in.seek(-nread, SEEK_CUR);
+            return ntransferred ? ntransferred : nwritten;
+        }
+
+        ntransferred += nwritten;
+        if (in_offset)
+            *in_offset += nwritten;
+        if (out_offset)
+            *out_offset += nwritten;
+
+        if (nwritten < nread) {
+            if (!in_offset && in.file().is_seekable())
+                in.seek(nwritten - nread, SEEK_CUR);
+            break;
+        }
+    }
+    return ntransferred;
+}
+
+ssize_t Process::sys$sendfile(const Syscall::SC_sendfile_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if ((ssize_t)params.count < 0)
+        return -EINVAL;
+
+    auto in_description = file_description(params.in_fd);
+    if (!in_description || !in_description->is_readable())
+        return -EBADF;
+    auto out_description = file_description(params.out_fd);
+    if (!out_description || !out_description->is_writable())
+        return -EBADF;
+
+    // Like other systems, we only support sending from regular files.
+    if (!in_description->file().is_inode() || in_description->is_directory())
+        return -EINVAL;
+
+    if (!params.offset)
+        return do_splice(*in_description, nullptr, *out_description, nullptr, params.count);
+
+    off_t offset;
+    if (!validate_read_and_copy_typed(&offset, params.offset))
+        return -EFAULT;
+    if (offset < 0)
+        return -EINVAL;
+    if (!validate_write_typed(params.offset))
+        return -EFAULT;
+
+    ssize_t rc = do_splice(*in_description, &offset, *out_description, nullptr, params.count);
+
+    // We may have blocked while writing, so make sure the offset is still writable.
+    if (!validate_write_typed(params.offset))
+        return -EFAULT;
+    copy_to_user(params.offset, &offset);
+    return rc;
+}
+
+ssize_t Process::sys$splice(const Syscall::SC_splice_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_splice_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if (params.flags)
+        return -EINVAL;
+    if ((ssize_t)params.count < 0)
+        return -EINVAL;
+
+    auto in_description = file_description(params.in_fd);
+    if (!in_description || !in_description->is_readable())
+        return -EBADF;
+    auto out_description = file_description(params.out_fd);
+    if (!out_description || !out_description->is_writable())
+        return -EBADF;
+    if (in_description->is_directory())
+        return -EISDIR;
+
+    // At least one end has to be a pipe.
+    if (!in_description->is_fifo() && !out_description->is_fifo())
+        return -EINVAL;
+
+    off_t in_offset = 0;
+    off_t out_offset = 0;
+    if (params.in_offset) {
+        if (!in_description->file().is_seekable())
+            return -ESPIPE;
+        if (!validate_read_and_copy_typed(&in_offset, params.in_offset) || !validate_write_typed(params.in_offset))
+            return -EFAULT;
+        if (in_offset < 0)
+            return -EINVAL;
+    }
+    if (params.out_offset) {
+        if (!out_description->file().is_seekable())
+            return -ESPIPE;
+        if (!validate_read_and_copy_typed(&out_offset, params.out_offset) || !validate_write_typed(params.out_offset))
+            return -EFAULT;
+        if (out_offset < 0)
+            return -EINVAL;
+    }
+
+    ssize_t rc = do_splice(*in_description, params.in_offset ? &in_offset : nullptr, *out_description, params.out_offset ? &out_offset : nullptr, params.count);
+
+    if (params.in_offset) {
+        if (!validate_write_typed(params.in_offset))
+            return -EFAULT;
+        copy_to_user(params.in_offset, &in_offset);
+    }
+    if (params.out_offset) {
+        if (!validate_write_typed(params.out_offset))
+            return -EFAULT;
+        copy_to_user(params.out_offset, &out_offset);
+    }
+    return rc;
+}
+
+}
@@ -30,26 +30,34 @@
 
 namespace Kernel {
 
-ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+KResult Process::copy_and_validate_iovecs(Vector<iovec, 32>& vecs, const struct iovec* user_iov, int iov_count, bool buffers_must_be_writable)
 {
-    REQUIRE_PROMISE(stdio);
     if (iov_count < 0)
-        return -EINVAL;
+        return KResult(-EINVAL);
 
-    if (!validate_read_typed(iov, iov_count))
-        return -EFAULT;
+    if (!validate_read_typed(user_iov, iov_count))
+        return KResult(-EFAULT);
 
     u64 total_length = 0;
-    Vector<iovec, 32> vecs;
     vecs.resize(iov_count);
-    copy_from_user(vecs.data(), iov, iov_count * sizeof(iovec));
+    copy_from_user(vecs.data(), user_iov, iov_count * sizeof(iovec));
     for (auto& vec : vecs) {
-        if (!validate_read(vec.iov_base, vec.iov_len))
-            return -EFAULT;
+        if (buffers_must_be_writable ? !validate_write(vec.iov_base, vec.iov_len) : !validate_read(vec.iov_base, vec.iov_len))
+            return KResult(-EFAULT);
         total_length += vec.iov_len;
         if (total_length > NumericLimits<i32>::max())
-            return -EINVAL;
+            return KResult(-EINVAL);
     }
+    return KSuccess;
+}
+
+ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+{
+    REQUIRE_PROMISE(stdio);
+    Vector<iovec, 32> vecs;
+    auto result = copy_and_validate_iovecs(vecs, iov, iov_count, false);
+    if (result.is_error())
+        return result;
 
     auto description = file_description(fd);
     if (!description)
@@ -72,6 +80,58 @@ ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
     return nwritten;
 }
 
+ssize_t Process::sys$pwrite(const Syscall::SC_pwrite_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_pwrite_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if ((ssize_t)params.data.size < 0)
+        return -EINVAL;
+    if (!params.data.size)
+        return 0;
+    if (!validate(params.data))
+        return -EFAULT;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_writable())
+        return -EBADF;
+    return description->write((const u8*)params.data.data, params.offset, params.data.size);
+}
+
+ssize_t Process::sys$pwritev(const Syscall::SC_pwritev_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_pwritev_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    Vector<iovec, 32> vecs;
+    auto result = copy_and_validate_iovecs(vecs, params.iov, params.iov_count, false);
+    if (result.is_error())
+        return result;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_writable())
+        return -EBADF;
+
+    off_t offset = params.offset;
+    int nwritten = 0;
+    for (auto& vec : vecs) {
+        int rc = description->write((const u8*)vec.iov_base, offset + nwritten, vec.iov_len);
+        if (rc < 0)
+            return nwritten ? nwritten : rc;
+        nwritten += rc;
+        if ((size_t)rc < vec.iov_len)
+            break;
+    }
+    return nwritten;
+}
+
 ssize_t Process::do_write(FileDescription& description, const u8* data, int data_size)
 {
     ssize_t nwritten = 0;
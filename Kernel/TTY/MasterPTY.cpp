@@ -64,7 +64,11 @@ ssize_t MasterPTY::read(FileDescription&, size_t, u8* buffer, ssize_t size)
 {
     if (!m_slave && m_buffer.is_empty())
         return 0;
-    return m_buffer.read(buffer, size);
+    ssize_t nread = m_buffer.read(buffer, size);
+    // The slave may have been waiting for room in the buffer.
+    if (nread > 0 && m_slave)
+        m_slave->did_change_readiness();
+    return nread;
 }
 
 ssize_t MasterPTY::write(FileDescription&, size_t, const u8* buffer, ssize_t size)
@@ -94,8 +98,11 @@ void MasterPTY::notify_slave_closed(Badge<SlavePTY>)
 #endif
     // +1 ref for my MasterPTY::m_slave
     // +1 ref for FileDescription::m_device
-    if (m_slave->ref_count() == 2)
+    if (m_slave->ref_count() == 2) {
         m_slave = nullptr;
+        // Reads now report EOF.
+        did_change_readiness();
+    }
 }
 
 ssize_t MasterPTY::on_slave_write(const u8* data, ssize_t size)
@@ -103,6 +110,7 @@ ssize_t MasterPTY::on_slave_write(const u8* data, ssize_t size)
     if (m_closed)
         return -EIO;
     m_buffer.write(data, size);
+    did_change_readiness();
     return size;
 }
 
@@ -120,6 +128,8 @@ KResult MasterPTY::close()
         // After the closing FileDescription dies, slave is the only thing keeping me alive.
         // From this point, let's consider ourselves closed.
         m_closed = true;
+        // Reads on the slave now report EOF, and writes are discarded.
+        m_slave->did_change_readiness();
 
         m_slave->hang_up();
     }
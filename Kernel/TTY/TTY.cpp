@@ -162,6 +162,7 @@ void TTY::emit(u8 ch)
             //We use '\0' to delimit the end
             //of a line.
             m_input_buffer.enqueue('\0');
+            did_change_readiness();
             return;
         }
         if (is_kill(ch)) {
@@ -181,6 +182,7 @@ void TTY::emit(u8 ch)
         }
     }
     m_input_buffer.enqueue(ch);
+    did_change_readiness();
     echo(ch);
 }
 
@@ -264,6 +266,8 @@ void TTY::flush_input()
 void TTY::set_termios(const termios& t)
 {
     m_termios = t;
+    // Switching canonical mode changes whether buffered input can be read.
+    did_change_readiness();
 #ifdef TTY_DEBUG
     dbg() << tty_name() << " set_termios: "
           << "ECHO=" << should_echo_input()
@@ -200,6 +200,17 @@ public:
         Optional<timeval> m_deadline;
     };
 
+    class EPollBlocker final : public FileDescriptionBlocker {
+    public:
+        EPollBlocker(const FileDescription&, const timespec& deadline, bool has_deadline);
+        virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual const char* state_string() const override { return "EPolling"; }
+
+    private:
+        timespec m_deadline;
+        bool m_has_deadline { false };
+    };
+
     class ConditionBlocker final : public Blocker {
     public:
         ConditionBlocker(const char* state_string, Function<bool()>&& condition);
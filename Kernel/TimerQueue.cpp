@@ -35,43 +35,119 @@ namespace Kernel {
 
 static TimerQueue* s_the;
 
-TimerQueue& TimerQueue::the()
+// Timer ids carry the id of the processor whose wheel holds the timer in
+// their low bits, so cancel_timer() can go straight to the right wheel.
+static constexpr u64 timer_id_cpu_bits = 8;
+static constexpr u64 timer_id_cpu_mask = (1 << timer_id_cpu_bits) - 1;
+
+TimerWheel::TimerWheel(u32 cpu, u64 now)
+    : m_cpu(cpu)
+    , m_next_tick(now)
 {
-    if (!s_the)
-        s_the = new TimerQueue;
-    return *s_the;
+    ASSERT(cpu <= timer_id_cpu_mask);
 }
 
-TimerQueue::TimerQueue()
+TimerId TimerWheel::add_timer(NonnullOwnPtr<Timer>&& timer)
 {
-    m_ticks_per_second = TimeManagement::the().ticks_per_second();
+    ScopedSpinLock lock(m_lock);
+    auto id = (++m_timer_id_count << timer_id_cpu_bits) | m_cpu;
+    timer->id = id;
+    auto* raw_timer = timer.leak_ptr();
+    m_timers.set(id, raw_timer);
+    insert(*raw_timer);
+    return id;
 }
 
-TimerId TimerQueue::add_timer(NonnullOwnPtr<Timer>&& timer)
+void TimerWheel::insert(Timer& timer)
 {
-    u64 timer_expiration = timer->expires;
-    ASSERT(timer_expiration >= g_uptime);
+    u64 expires = max(timer.expires, m_next_tick);
+    u64 delta = expires - m_next_tick;
+    // Timers beyond the reach of the wheel park in the furthest slot,
+    // and get re-hashed when that slot cascades.
+    if (delta >= max_range)
+        expires = m_next_tick + max_range - 1;
+
+    size_t level = 0;
+    while (level < level_count - 1 && (expires - m_next_tick) >= ((u64)1 << (slot_bits * (level + 1))))
+        ++level;
+
+    size_t slot = (expires >> (slot_bits * level)) & (slot_count - 1);
+    timer.slot = &m_slots[level][slot];
+    timer.slot->append(&timer);
+}
 
-    timer->id = ++m_timer_id_count;
+bool TimerWheel::cancel_timer(TimerId id)
+{
+    ScopedSpinLock lock(m_lock);
+    auto it = m_timers.find(id);
+    if (it == m_timers.end())
+        return false;
 
-    if (m_timer_queue.is_empty()) {
-        m_timer_queue.append(move(timer));
-        m_next_timer_due = timer_expiration;
-    } else {
-        auto following_timer = m_timer_queue.find([&timer_expiration](auto& other) { return other->expires > timer_expiration; });
+    auto* timer = it->value;
+    m_timers.remove(it);
+    timer->slot->remove(timer);
+    delete timer;
+    return true;
+}
 
-        if (following_timer.is_end()) {
-            m_timer_queue.append(move(timer));
-        } else {
-            auto next_timer_needs_update = following_timer.is_begin();
-            m_timer_queue.insert_before(following_timer, move(timer));
+void TimerWheel::cascade(size_t level, size_t slot)
+{
+    auto& list = m_slots[level][slot];
+    while (auto* timer = list.remove_head())
+        insert(*timer);
+}
+
+void TimerWheel::advance(u64 now, InlineLinkedList<Timer>& expired)
+{
+    ScopedSpinLock lock(m_lock);
+    while (m_next_tick < now) {
+        if (m_timers.is_empty()) {
+            m_next_tick = now;
+            break;
+        }
+
+        size_t index = m_next_tick & (slot_count - 1);
+        for (size_t level = 1; index == 0 && level < level_count; ++level) {
+            index = (m_next_tick >> (slot_bits * level)) & (slot_count - 1);
+            cascade(level, index);
+        }
 
-            if (next_timer_needs_update)
-                m_next_timer_due = timer_expiration;
+        auto& slot = m_slots[0][m_next_tick & (slot_count - 1)];
+        while (auto* timer = slot.remove_head()) {
+            m_timers.remove(timer->id);
+            expired.append(timer);
         }
+        ++m_next_tick;
     }
+}
+
+TimerQueue& TimerQueue::the()
+{
+    if (!s_the)
+        s_the = new TimerQueue;
+    return *s_the;
+}
 
-    return m_timer_id_count;
+TimerQueue::TimerQueue()
+{
+    m_ticks_per_second = TimeManagement::the().ticks_per_second();
+}
+
+TimerWheel& TimerQueue::wheel_for_current_processor()
+{
+    // Only the owning processor ever creates its wheel, so there is no race
+    // here. Other processors may briefly observe it as missing in fire().
+    ScopedCritical critical;
+    auto& processor = Processor::current();
+    if (!processor.timer_wheel())
+        processor.set_timer_wheel(*new TimerWheel(processor.id(), g_uptime));
+    return *processor.timer_wheel();
+}
+
+TimerId TimerQueue::add_timer(NonnullOwnPtr<Timer>&& timer)
+{
+    ASSERT(timer->expires >= g_uptime);
+    return wheel_for_current_processor().add_timer(move(timer));
 }
 
 TimerId TimerQueue::add_timer(timeval& deadline, Function<void()>&& callback)
@@ -84,40 +160,34 @@ TimerId TimerQueue::add_timer(timeval& deadline, Function<void()>&& callback)
 
 bool TimerQueue::cancel_timer(TimerId id)
 {
-    auto it = m_timer_queue.find([id](auto& timer) { return timer->id == id; });
-    if (it.is_end())
+    u32 cpu = id & timer_id_cpu_mask;
+    if (cpu >= Processor::count())
         return false;
-
-    auto was_next_timer = it.is_begin();
-    m_timer_queue.remove(it);
-
-    if (was_next_timer)
-        update_next_timer_due();
-
-    return true;
+    auto* wheel = Processor::by_id(cpu).timer_wheel();
+    if (!wheel)
+        return false;
+    return wheel->cancel_timer(id);
 }
 
 void TimerQueue::fire()
 {
-    if (m_timer_queue.is_empty())
-        return;
-
-    ASSERT(m_next_timer_due == m_timer_queue.first()->expires);
-
-    while (!m_timer_queue.is_empty() && g_uptime > m_timer_queue.first()->expires) {
-        auto timer = m_timer_queue.take_first();
-        timer->callback();
-    }
-
-    update_next_timer_due();
-}
-
-void TimerQueue::update_next_timer_due()
-{
-    if (m_timer_queue.is_empty())
-        m_next_timer_due = 0;
-    else
-        m_next_timer_due = m_timer_queue.first()->expires;
+    // Only the boot processor receives the system timer interrupt, so it
+    // advances every processor's wheel. The callbacks run after the wheel
+    // lock has been dropped, since they typically take the scheduler lock,
+    // which is held while arming timers.
+    Processor::for_each([&](Processor& processor) {
+        auto* wheel = processor.timer_wheel();
+        if (!wheel)
+            return IterationDecision::Continue;
+
+        InlineLinkedList<Timer> expired;
+        wheel->advance(g_uptime, expired);
+        while (auto* timer = expired.remove_head()) {
+            timer->callback();
+            delete timer;
+        }
+        return IterationDecision::Continue;
+    });
 }
 
 }
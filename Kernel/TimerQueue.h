@@ -27,31 +27,65 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/InlineLinkedList.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
-#include <AK/SinglyLinkedList.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
 typedef u64 TimerId;
 
-struct Timer {
+struct Timer : public InlineLinkedListNode<Timer> {
     TimerId id;
     u64 expires;
     Function<void()> callback;
-    bool operator<(const Timer& rhs) const
-    {
-        return expires < rhs.expires;
-    }
-    bool operator>(const Timer& rhs) const
-    {
-        return expires > rhs.expires;
-    }
-    bool operator==(const Timer& rhs) const
-    {
-        return id == rhs.id;
-    }
+
+    // The wheel slot this timer is currently queued in.
+    InlineLinkedList<Timer>* slot { nullptr };
+
+    // For InlineLinkedListNode
+    Timer* m_next { nullptr };
+    Timer* m_prev { nullptr };
+};
+
+// A hierarchical timing wheel, one per processor. Each level has 64 slots,
+// and each slot on a level spans the whole range of the level below it.
+// Timers are hashed into a slot by their expiry tick, so arming and
+// cancelling are O(1). Timers on the upper levels are cascaded down one
+// level every time the level below wraps around.
+class TimerWheel {
+    AK_MAKE_NONCOPYABLE(TimerWheel);
+    AK_MAKE_NONMOVABLE(TimerWheel);
+
+public:
+    static constexpr size_t slot_bits = 6;
+    static constexpr size_t slot_count = 1 << slot_bits;
+    static constexpr size_t level_count = 4;
+    static constexpr u64 max_range = (u64)1 << (slot_bits * level_count);
+
+    TimerWheel(u32 cpu, u64 now);
+
+    TimerId add_timer(NonnullOwnPtr<Timer>&&);
+    bool cancel_timer(TimerId);
+
+    // Moves every timer that expired before `now` into `expired`.
+    void advance(u64 now, InlineLinkedList<Timer>& expired);
+
+    bool is_empty() const { return m_timers.is_empty(); }
+
+private:
+    void insert(Timer&);
+    void cascade(size_t level, size_t slot);
+
+    SpinLock<u8> m_lock;
+    u32 m_cpu { 0 };
+    u64 m_next_tick { 0 };
+    u64 m_timer_id_count { 0 };
+    InlineLinkedList<Timer> m_slots[level_count][slot_count];
+    HashMap<TimerId, Timer*> m_timers;
 };
 
 class TimerQueue {
@@ -66,15 +100,12 @@ public:
 private:
     TimerQueue();
 
-    void update_next_timer_due();
+    TimerWheel& wheel_for_current_processor();
 
-    u64 microseconds_to_ticks(u64 micro_seconds) { return micro_seconds * (m_ticks_per_second / 1'000'000); }
+    u64 microseconds_to_ticks(u64 micro_seconds) { return micro_seconds * m_ticks_per_second / 1'000'000; }
     u64 seconds_to_ticks(u64 seconds) { return seconds * m_ticks_per_second; }
 
-    u64 m_next_timer_due { 0 };
-    u64 m_timer_id_count { 0 };
     u64 m_ticks_per_second { 0 };
-    SinglyLinkedList<NonnullOwnPtr<Timer>> m_timer_queue;
 };
 
 }
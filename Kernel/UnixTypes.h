@@ -431,6 +431,93 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLLIN (1u << 0)
+#define EPOLLPRI (1u << 2)
+#define EPOLLOUT (1u << 3)
+#define EPOLLERR (1u << 4)
+#define EPOLLHUP (1u << 5)
+#define EPOLLONESHOT (1u << 30)
+#define EPOLLET (1u << 31)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLL_CLOEXEC O_CLOEXEC
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct [[gnu::packed]] epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+};
+
+#define IO_RING_OP_NOP 0
+#define IO_RING_OP_READ 1
+#define IO_RING_OP_WRITE 2
+#define IO_RING_OP_READV 3
+#define IO_RING_OP_WRITEV 4
+#define IO_RING_OP_ACCEPT 5
+#define IO_RING_OP_CONNECT 6
+#define IO_RING_OP_FSYNC 7
+#define IO_RING_OP_TIMEOUT 8
+#define IO_RING_OP_CANCEL 9
+
+#define IO_RING_CURRENT_OFFSET ((uint64_t)-1)
+
+// All buffers referenced by submissions live in the ring's buffer area
+// and are addressed by their offset into it.
+struct io_ring_sqe {
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t reserved;
+    int32_t fd;
+    uint64_t offset; // File offset or IO_RING_CURRENT_OFFSET, timeout in nanoseconds for IO_RING_OP_TIMEOUT,
+                     // user_data of the request to cancel for IO_RING_OP_CANCEL.
+    uint32_t buffer;
+    uint32_t length; // Number of io_ring_iovecs for IO_RING_OP_READV and IO_RING_OP_WRITEV.
+    uint64_t user_data;
+};
+
+struct io_ring_iovec {
+    uint32_t buffer;
+    uint32_t length;
+};
+
+struct io_ring_cqe {
+    uint64_t user_data;
+    int32_t result;
+    uint32_t flags;
+};
+
+struct io_ring_header {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    uint32_t cq_mask;
+    uint32_t cq_entries;
+};
+
+struct io_ring_params {
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+    uint32_t buffer_size;
+    uint32_t flags;
+    // Filled in by io_ring_setup().
+    uint32_t sq_offset;
+    uint32_t cq_offset;
+    uint32_t buffer_offset;
+    uint32_t ring_size;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
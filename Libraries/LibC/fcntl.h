@@ -93,6 +93,7 @@ int openat_with_path_length(int dirfd, const char* path, size_t path_length, int
 
 int fcntl(int fd, int cmd, ...);
 int watch_file(const char* path, size_t path_length);
+ssize_t splice(int in_fd, off_t* in_offset, int out_fd, off_t* out_offset, size_t count, unsigned flags);
 
 #define F_RDLCK 0
 #define F_WRLCK 1
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+#define IO_RING_OP_NOP 0
+#define IO_RING_OP_READ 1
+#define IO_RING_OP_WRITE 2
+#define IO_RING_OP_READV 3
+#define IO_RING_OP_WRITEV 4
+#define IO_RING_OP_ACCEPT 5
+#define IO_RING_OP_CONNECT 6
+#define IO_RING_OP_FSYNC 7
+#define IO_RING_OP_TIMEOUT 8
+#define IO_RING_OP_CANCEL 9
+
+#define IO_RING_CURRENT_OFFSET ((uint64_t)-1)
+
+// All buffers referenced by submissions live in the ring's buffer area
+// and are addressed by their offset into it.
+struct io_ring_sqe {
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t reserved;
+    int32_t fd;
+    uint64_t offset; // File offset or IO_RING_CURRENT_OFFSET, timeout in nanoseconds for IO_RING_OP_TIMEOUT,
+                     // user_data of the request to cancel for IO_RING_OP_CANCEL.
+    uint32_t buffer;
+    uint32_t length; // Number of io_ring_iovecs for IO_RING_OP_READV and IO_RING_OP_WRITEV.
+    uint64_t user_data;
+};
+
+struct io_ring_iovec {
+    uint32_t buffer;
+    uint32_t length;
+};
+
+struct io_ring_cqe {
+    uint64_t user_data;
+    int32_t result;
+    uint32_t flags;
+};
+
+struct io_ring_header {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    uint32_t cq_mask;
+    uint32_t cq_entries;
+};
+
+struct io_ring_params {
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+    uint32_t buffer_size;
+    uint32_t flags;
+    // Filled in by io_ring_setup().
+    uint32_t sq_offset;
+    uint32_t cq_offset;
+    uint32_t buffer_offset;
+    uint32_t ring_size;
+};
+
+int io_ring_setup(struct io_ring_params*);
+int io_ring_enter(int fd, unsigned to_submit, unsigned min_complete);
+
+__END_DECLS
@@ -726,12 +726,16 @@ int unveil(const char* path, const char* permissions)
 
 ssize_t pread(int fd, void* buf, size_t count, off_t offset)
 {
-    // FIXME: This is not thread safe and should be implemented in the kernel instead.
-    off_t old_offset = lseek(fd, 0, SEEK_CUR);
-    lseek(fd, offset, SEEK_SET);
-    ssize_t nread = read(fd, buf, count);
-    lseek(fd, old_offset, SEEK_SET);
-    return nread;
+    Syscall::SC_pread_params params { fd, { buf, count }, offset };
+    int rc = syscall(SC_pread, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset)
+{
+    Syscall::SC_pwrite_params params { fd, { buf, count }, offset };
+    int rc = syscall(SC_pwrite, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
 char* getpass(const char* prompt)
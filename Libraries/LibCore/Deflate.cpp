@@ -0,0 +1,800 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Assertions.h>
+#include <AK/StdLibExtras.h>
+#include <LibCore/Deflate.h>
+#include <string.h>
+
+namespace Core {
+
+static constexpr size_t window_size = 32 * KB;
+static constexpr size_t window_mask = window_size - 1;
+static constexpr size_t buffer_size = 2 * window_size;
+static constexpr u32 min_match = 3;
+static constexpr u32 max_match = 258;
+static constexpr size_t min_lookahead = max_match + min_match + 1;
+static constexpr u32 hash_bits = 15;
+static constexpr size_t max_tokens = 16 * KB - 1;
+static constexpr size_t max_stored_block_size = 65535;
+static constexpr u32 too_far = 4096;
+
+// Tuning parameters per compression level, borrowed from zlib.
+// Levels 1-3 take the first good match; 4-9 defer each match by one byte
+// to see whether a longer one starts there. For the greedy levels,
+// max_lazy limits which matches get their positions hashed.
+struct CompressionConfig {
+    u16 good_length;
+    u16 max_lazy;
+    u16 nice_length;
+    u16 max_chain;
+    bool lazy;
+};
+
+static const CompressionConfig s_configs[Deflate::max_level + 1] = {
+    { 0, 0, 0, 0, false },
+    { 4, 4, 8, 4, false },
+    { 4, 5, 16, 8, false },
+    { 4, 6, 32, 32, false },
+    { 4, 4, 16, 16, true },
+    { 8, 16, 32, 32, true },
+    { 8, 16, 128, 128, true },
+    { 8, 32, 128, 256, true },
+    { 32, 128, 258, 1024, true },
+    { 32, 258, 258, 4096, true },
+};
+
+static const u16 length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const u8 length_extra_bits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const u16 distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const u8 distance_extra_bits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const u8 code_length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static u16 reverse_bits(u32 code, u32 length)
+{
+    u32 reversed = 0;
+    for (u32 i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
+// Assigns canonical codes to a set of code lengths, bit-reversed since
+// DEFLATE sends Huffman codes starting with the most significant bit.
+static void build_codes(const u8* lengths, size_t count, u16* reversed_codes)
+{
+    u16 length_counts[16] = {};
+    for (size_t i = 0; i < count; ++i)
+        length_counts[lengths[i]]++;
+    length_counts[0] = 0;
+
+    u16 next_code[16] = {};
+    u32 code = 0;
+    for (size_t bits = 1; bits < 16; ++bits) {
+        code = (code + length_counts[bits - 1]) << 1;
+        next_code[bits] = code;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (lengths[i])
+            reversed_codes[i] = reverse_bits(next_code[lengths[i]]++, lengths[i]);
+    }
+}
+
+// Computes Huffman code lengths no longer than max_length. If the optimal
+// tree is too deep, the frequencies are flattened and the tree rebuilt,
+// which converges quickly and costs very little compression in practice.
+static void build_code_lengths(const u32* frequencies, size_t count, u8 max_length, u8* lengths)
+{
+    ASSERT(count <= 288);
+    memset(lengths, 0, count);
+
+    u32 weights[2 * 288];
+    u16 symbols[288];
+    u32 scaled_frequencies[288];
+    memcpy(scaled_frequencies, frequencies, count * sizeof(u32));
+
+    for (;;) {
+        size_t leaf_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (scaled_frequencies[i])
+                symbols[leaf_count++] = i;
+        }
+        if (leaf_count == 0)
+            return;
+        if (leaf_count == 1) {
+            lengths[symbols[0]] = 1;
+            return;
+        }
+
+        // Insertion sort is plenty for at most 288 symbols.
+        for (size_t i = 1; i < leaf_count; ++i) {
+            auto symbol = symbols[i];
+            size_t j = i;
+            for (; j > 0 && scaled_frequencies[symbols[j - 1]] > scaled_frequencies[symbol]; --j)
+                symbols[j] = symbols[j - 1];
+            symbols[j] = symbol;
+        }
+
+        // Two-queue Huffman construction: the leaves are sorted, and the
+        // internal nodes are created in order of increasing weight.
+        u16 parents[2 * 288];
+        for (size_t i = 0; i < leaf_count; ++i)
+            weights[i] = scaled_frequencies[symbols[i]];
+        size_t next_leaf = 0;
+        size_t next_internal = leaf_count;
+        size_t node_count = 2 * leaf_count - 1;
+        for (size_t node = leaf_count; node < node_count; ++node) {
+            auto take_smallest = [&] {
+                if (next_leaf < leaf_count && (next_internal >= node || weights[next_leaf] <= weights[next_internal]))
+                    return next_leaf++;
+                return next_internal++;
+            };
+            auto first = take_smallest();
+            auto second = take_smallest();
+            weights[node] = weights[first] + weights[second];
+            parents[first] = node;
+            parents[second] = node;
+        }
+
+        // Parents always come after their children, so walk backwards.
+        u8 depths[2 * 288];
+        depths[node_count - 1] = 0;
+        u8 deepest = 0;
+        for (size_t node = node_count - 1; node-- > 0;) {
+            depths[node] = depths[parents[node]] + 1;
+            if (node < leaf_count)
+                deepest = max(deepest, depths[node]);
+        }
+
+        if (deepest <= max_length) {
+            for (size_t i = 0; i < leaf_count; ++i)
+                lengths[symbols[i]] = depths[i];
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            if (scaled_frequencies[i])
+                scaled_frequencies[i] = (scaled_frequencies[i] + 1) / 2;
+        }
+    }
+}
+
+struct EncoderTables {
+    EncoderTables()
+    {
+        for (u8 code = 0; code < 29; ++code) {
+            u32 end = code == 28 ? 259 : length_base[code + 1];
+            // Length 258 has a code of its own, even though code 27 could reach it.
+            for (u32 length = length_base[code]; length < end && length <= 258; ++length)
+                length_codes[length] = code;
+        }
+        length_codes[258] = 28;
+
+        for (u8 code = 0; code < 30; ++code) {
+            u32 end = distance_base[code] + (1 << distance_extra_bits[code]);
+            for (u32 distance = distance_base[code]; distance < end; ++distance) {
+                if (distance <= 256)
+                    small_distance_codes[distance] = code;
+                else
+                    large_distance_codes[(distance - 1) >> 7] = code;
+            }
+        }
+
+        size_t symbol = 0;
+        for (; symbol < 144; ++symbol)
+            fixed_literal_lengths[symbol] = 8;
+        for (; symbol < 256; ++symbol)
+            fixed_literal_lengths[symbol] = 9;
+        for (; symbol < 280; ++symbol)
+            fixed_literal_lengths[symbol] = 7;
+        for (; symbol < 288; ++symbol)
+            fixed_literal_lengths[symbol] = 8;
+        build_codes(fixed_literal_lengths, 288, fixed_literal_codes);
+
+        for (symbol = 0; symbol < 30; ++symbol)
+            fixed_distance_lengths[symbol] = 5;
+        build_codes(fixed_distance_lengths, 30, fixed_distance_codes);
+
+        for (u32 n = 0; n < 256; ++n) {
+            u32 value = n;
+            for (int i = 0; i < 8; ++i)
+                value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1);
+            crc32_table[n] = value;
+        }
+    }
+
+    u8 distance_code(u32 distance) const
+    {
+        if (distance <= 256)
+            return small_distance_codes[distance];
+        return large_distance_codes[(distance - 1) >> 7];
+    }
+
+    u8 length_codes[259];
+    u8 small_distance_codes[257];
+    u8 large_distance_codes[256];
+    u8 fixed_literal_lengths[288];
+    u16 fixed_literal_codes[288];
+    u8 fixed_distance_lengths[30];
+    u16 fixed_distance_codes[30];
+    u32 crc32_table[256];
+};
+
+static const EncoderTables& tables()
+{
+    static EncoderTables tables;
+    return tables;
+}
+
+Deflate::Deflate(int level, Format format)
+    : m_level(clamp(level, 0, max_level))
+    , m_format(format)
+{
+    m_buffer = ByteBuffer::create_uninitialized(buffer_size);
+    m_head.resize(1 << hash_bits);
+    m_prev.resize(window_size);
+    memset(m_head.data(), 0, m_head.size() * sizeof(u32));
+    memset(m_prev.data(), 0, m_prev.size() * sizeof(u32));
+    m_tokens.resize(max_tokens);
+    memset(m_literal_frequencies, 0, sizeof(m_literal_frequencies));
+    memset(m_distance_frequencies, 0, sizeof(m_distance_frequencies));
+}
+
+Deflate::~Deflate()
+{
+}
+
+u32 Deflate::update_crc32(u32 crc, ReadonlyBytes data)
+{
+    auto& crc32_table = tables().crc32_table;
+    crc = ~crc;
+    for (size_t i = 0; i < data.size(); ++i)
+        crc = crc32_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+ByteBuffer Deflate::compress_all(ReadonlyBytes data, int level, Format format)
+{
+    Deflate deflate(level, format);
+    deflate.write(data);
+    deflate.finish();
+    return deflate.take_output();
+}
+
+void Deflate::write(ReadonlyBytes data)
+{
+    ASSERT(!m_finished);
+    if (!m_header_written)
+        write_header();
+
+    if (m_format == Format::Gzip) {
+        m_crc32 = update_crc32(m_crc32, data);
+    } else if (m_format == Format::Zlib) {
+        // 5552 is the most bytes we can sum up before the 32-bit sums could overflow.
+        for (size_t offset = 0; offset < data.size(); offset += 5552) {
+            size_t end = min(data.size(), offset + 5552);
+            for (size_t i = offset; i < end; ++i) {
+                m_adler_a += data[i];
+                m_adler_b += m_adler_a;
+            }
+            m_adler_a %= 65521;
+            m_adler_b %= 65521;
+        }
+    }
+    m_total_in += data.size();
+
+    size_t offset = 0;
+    while (offset < data.size()) {
+        if (m_end == buffer_size) {
+            process(false);
+            slide_window();
+        }
+        size_t count = min(data.size() - offset, buffer_size - m_end);
+        memcpy(m_buffer.data() + m_end, data.data() + offset, count);
+        m_end += count;
+        offset += count;
+    }
+    process(false);
+}
+
+void Deflate::finish()
+{
+    ASSERT(!m_finished);
+    if (!m_header_written)
+        write_header();
+    process(true);
+    flush_block(true);
+    align_to_byte();
+    flush_bits();
+    write_trailer();
+    m_finished = true;
+}
+
+ByteBuffer Deflate::take_output()
+{
+    if (!m_output_size)
+        return {};
+    auto output = ByteBuffer::copy(m_output.data(), m_output_size);
+    m_output_size = 0;
+    return output;
+}
+
+void Deflate::write_header()
+{
+    m_header_written = true;
+    if (m_format == Format::Zlib) {
+        // CM 8 with a 32 KiB window, plus a hint about the compression level.
+        u8 level_hint = m_level < 2 ? 0 : m_level < 6 ? 1 : m_level == 6 ? 2 : 3;
+        u8 header[2] = { 0x78, (u8)(level_hint << 6) };
+        header[1] += 31 - ((header[0] << 8) | header[1]) % 31;
+        append_output(header, sizeof(header));
+    } else if (m_format == Format::Gzip) {
+        u8 extra_flags = m_level == max_level ? 2 : m_level == 1 ? 4 : 0;
+        // Magic, CM 8, no flags, no modification time, unknown OS.
+        u8 header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, extra_flags, 255 };
+        append_output(header, sizeof(header));
+    }
+}
+
+void Deflate::write_trailer()
+{
+    if (m_format == Format::Zlib) {
+        u32 adler = (m_adler_b << 16) | m_adler_a;
+        u8 trailer[4] = { (u8)(adler >> 24), (u8)(adler >> 16), (u8)(adler >> 8), (u8)adler };
+        append_output(trailer, sizeof(trailer));
+    } else if (m_format == Format::Gzip) {
+        u32 crc = m_crc32;
+        u8 trailer[8] = {
+            (u8)crc, (u8)(crc >> 8), (u8)(crc >> 16), (u8)(crc >> 24),
+            (u8)m_total_in, (u8)(m_total_in >> 8), (u8)(m_total_in >> 16), (u8)(m_total_in >> 24)
+        };
+        append_output(trailer, sizeof(trailer));
+    }
+}
+
+void Deflate::process(bool flush)
+{
+    if (m_level == 0)
+        process_stored(flush);
+    else if (s_configs[m_level].lazy)
+        process_lazy(flush);
+    else
+        process_greedy(flush);
+}
+
+void Deflate::slide_window()
+{
+    if (m_index <= window_size)
+        return;
+    size_t shift = m_index - window_size;
+
+    // The bytes of the current block may still be needed for a stored block.
+    if (m_block_start < m_buffer_position + shift)
+        flush_block(false);
+
+    memmove(m_buffer.data(), m_buffer.data() + shift, m_end - shift);
+    m_buffer_position += shift;
+    m_index -= shift;
+    m_end -= shift;
+}
+
+ALWAYS_INLINE void Deflate::insert_hash(size_t index)
+{
+    const u8* bytes = m_buffer.data() + index;
+    u32 hash = ((bytes[0] | bytes[1] << 8 | bytes[2] << 16) * 2654435761u) >> (32 - hash_bits);
+    size_t position = m_buffer_position + index;
+    m_prev[position & window_mask] = m_head[hash];
+    m_head[hash] = position + 1;
+}
+
+u32 Deflate::longest_match(size_t index, u32 previous_length, u32& match_distance)
+{
+    auto& config = s_configs[m_level];
+    const u8* buffer = m_buffer.data();
+    const u8* scan = buffer + index;
+    size_t position = m_buffer_position + index;
+
+    u32 limit = min((size_t)max_match, m_end - index);
+    u32 nice_length = min((u32)config.nice_length, limit);
+    u32 chain_length = config.max_chain;
+    if (previous_length >= config.good_length)
+        chain_length >>= 2;
+
+    u32 best_length = previous_length;
+    // The head entry was just replaced by this position; follow its chain.
+    u32 candidate = m_prev[position & window_mask];
+    while (candidate && chain_length--) {
+        size_t candidate_position = candidate - 1;
+        if (candidate_position < m_buffer_position || position - candidate_position > window_size)
+            break;
+        if (best_length >= limit)
+            break;
+
+        const u8* match = buffer + (candidate_position - m_buffer_position);
+        if (match[best_length] == scan[best_length] && match[0] == scan[0] && match[1] == scan[1]) {
+            u32 length = 2;
+            while (length < limit && match[length] == scan[length])
+                ++length;
+            if (length > best_length) {
+                best_length = length;
+                match_distance = position - candidate_position;
+                if (length >= nice_length)
+                    break;
+            }
+        }
+
+        u32 next = m_prev[candidate_position & window_mask];
+        // The slot was reused by a newer position, so the chain ends here.
+        if (next >= candidate)
+            break;
+        candidate = next;
+    }
+    return best_length;
+}
+
+void Deflate::process_stored(bool)
+{
+    m_block_size += m_end - m_index;
+    m_index = m_end;
+}
+
+void Deflate::process_greedy(bool flush)
+{
+    auto& config = s_configs[m_level];
+    while (m_index < m_end) {
+        size_t lookahead = m_end - m_index;
+        if (lookahead < min_lookahead && !flush)
+            return;
+
+        u32 match_length = 0;
+        u32 match_distance = 0;
+        if (lookahead >= min_match) {
+            insert_hash(m_index);
+            match_length = longest_match(m_index, min_match - 1, match_distance);
+        }
+
+        if (match_length >= min_match) {
+            emit_match(match_length, match_distance);
+            if (match_length <= config.max_lazy) {
+                for (size_t i = m_index + 1; i < m_index + match_length && m_end - i >= min_match; ++i)
+                    insert_hash(i);
+            }
+            m_index += match_length;
+        } else {
+            emit_literal(m_buffer[m_index++]);
+        }
+    }
+}
+
+void Deflate::process_lazy(bool flush)
+{
+    auto& config = s_configs[m_level];
+    while (m_index < m_end) {
+        size_t lookahead = m_end - m_index;
+        if (lookahead < min_lookahead && !flush)
+            return;
+
+        u32 match_length = min_match - 1;
+        u32 match_distance = 0;
+        if (lookahead >= min_match) {
+            insert_hash(m_index);
+            if (m_previous_length < config.max_lazy)
+                match_length = longest_match(m_index, max(m_previous_length, min_match - 1), match_distance);
+            // A short match far away costs more than the literals it replaces.
+            if (match_length == min_match && match_distance > too_far)
+                match_length = min_match - 1;
+        }
+
+        if (m_previous_length >= min_match && match_length <= m_previous_length) {
+            // The match starting at the previous byte is at least as good.
+            size_t match_end = m_index - 1 + m_previous_length;
+            emit_match(m_previous_length, m_previous_distance);
+            for (size_t i = m_index + 1; i < match_end && m_end - i >= min_match; ++i)
+                insert_hash(i);
+            m_index = match_end;
+            m_match_available = false;
+            m_previous_length = min_match - 1;
+            continue;
+        }
+
+        if (m_match_available)
+            emit_literal(m_buffer[m_index - 1]);
+        m_match_available = true;
+        m_previous_length = match_length;
+        m_previous_distance = match_distance;
+        ++m_index;
+    }
+
+    if (flush && m_match_available) {
+        emit_literal(m_buffer[m_index - 1]);
+        m_match_available = false;
+        m_previous_length = min_match - 1;
+    }
+}
+
+ALWAYS_INLINE void Deflate::emit_literal(u8 literal)
+{
+    m_tokens[m_token_count++] = { literal, 0 };
+    m_literal_frequencies[literal]++;
+    m_block_size++;
+    if (m_token_count == max_tokens)
+        flush_block(false);
+}
+
+ALWAYS_INLINE void Deflate::emit_match(u32 length, u32 distance)
+{
+    m_tokens[m_token_count++] = { (u16)length, (u16)distance };
+    m_literal_frequencies[257 + tables().length_codes[length]]++;
+    m_distance_frequencies[tables().distance_code(distance)]++;
+    m_block_size += length;
+    if (m_token_count == max_tokens)
+        flush_block(false);
+}
+
+void Deflate::flush_block(bool final)
+{
+    ASSERT(m_block_start >= m_buffer_position);
+    const u8* block_data = m_buffer.data() + (m_block_start - m_buffer_position);
+
+    if (m_level == 0)
+        write_stored_block(block_data, m_block_size, final);
+    else if (m_token_count || final)
+        write_huffman_block(final);
+
+    m_block_start += m_block_size;
+    m_block_size = 0;
+    m_token_count = 0;
+    memset(m_literal_frequencies, 0, sizeof(m_literal_frequencies));
+    memset(m_distance_frequencies, 0, sizeof(m_distance_frequencies));
+}
+
+void Deflate::write_stored_block(const u8* data, size_t size, bool final)
+{
+    do {
+        size_t chunk_size = min(size, max_stored_block_size);
+        bool last_chunk = chunk_size == size;
+        write_bits(final && last_chunk, 1);
+        write_bits(0, 2);
+        align_to_byte();
+        flush_bits();
+        u8 header[4] = { (u8)chunk_size, (u8)(chunk_size >> 8), (u8)~chunk_size, (u8)(~chunk_size >> 8) };
+        append_output(header, sizeof(header));
+        append_output(data, chunk_size);
+        data += chunk_size;
+        size -= chunk_size;
+    } while (size);
+}
+
+void Deflate::write_huffman_block(bool final)
+{
+    auto& tables = Core::tables();
+    m_literal_frequencies[256] = 1;
+
+    u8 literal_lengths[286];
+    u8 distance_lengths[30];
+    build_code_lengths(m_literal_frequencies, 286, 15, literal_lengths);
+    build_code_lengths(m_distance_frequencies, 30, 15, distance_lengths);
+
+    size_t literal_count = 286;
+    while (literal_count > 257 && !literal_lengths[literal_count - 1])
+        --literal_count;
+    size_t distance_count = 30;
+    while (distance_count > 1 && !distance_lengths[distance_count - 1])
+        --distance_count;
+    // Even a block without matches needs one distance code.
+    if (distance_count == 1 && !distance_lengths[0])
+        distance_lengths[0] = 1;
+
+    // Run-length encode the code lengths with symbols 16, 17 and 18.
+    u8 all_lengths[286 + 30];
+    memcpy(all_lengths, literal_lengths, literal_count);
+    memcpy(all_lengths + literal_count, distance_lengths, distance_count);
+    size_t all_count = literal_count + distance_count;
+
+    struct CodeLengthSymbol {
+        u8 symbol;
+        u8 extra;
+    };
+    CodeLengthSymbol code_length_symbols[286 + 30];
+    size_t code_length_symbol_count = 0;
+    u32 code_length_frequencies[19] = {};
+    auto emit_code_length = [&](u8 symbol, u8 extra) {
+        code_length_symbols[code_length_symbol_count++] = { symbol, extra };
+        code_length_frequencies[symbol]++;
+    };
+    for (size_t i = 0; i < all_count;) {
+        u8 length = all_lengths[i];
+        size_t run = 1;
+        while (i + run < all_count && all_lengths[i + run] == length)
+            ++run;
+        i += run;
+
+        if (length == 0) {
+            while (run >= 11) {
+                size_t count = min(run, (size_t)138);
+                emit_code_length(18, count - 11);
+                run -= count;
+            }
+            if (run >= 3) {
+                emit_code_length(17, run - 3);
+                run = 0;
+            }
+        } else {
+            emit_code_length(length, 0);
+            --run;
+            while (run >= 3) {
+                size_t count = min(run, (size_t)6);
+                emit_code_length(16, count - 3);
+                run -= count;
+            }
+        }
+        while (run--)
+            emit_code_length(length, 0);
+    }
+
+    u8 code_length_lengths[19];
+    u16 code_length_codes[19];
+    build_code_lengths(code_length_frequencies, 19, 7, code_length_lengths);
+    build_codes(code_length_lengths, 19, code_length_codes);
+    size_t code_length_count = 19;
+    while (code_length_count > 4 && !code_length_lengths[code_length_order[code_length_count - 1]])
+        --code_length_count;
+
+    // Pick whichever encoding of this block comes out smallest.
+    u64 extra_bits = 0;
+    u64 dynamic_bits = 3 + 5 + 5 + 4 + 3 * code_length_count;
+    u64 fixed_bits = 3;
+    for (size_t i = 0; i < code_length_symbol_count; ++i) {
+        u8 symbol = code_length_symbols[i].symbol;
+        dynamic_bits += code_length_lengths[symbol] + (symbol == 16 ? 2 : symbol == 17 ? 3 : symbol == 18 ? 7 : 0);
+    }
+    for (size_t symbol = 0; symbol < 286; ++symbol) {
+        dynamic_bits += (u64)m_literal_frequencies[symbol] * literal_lengths[symbol];
+        fixed_bits += (u64)m_literal_frequencies[symbol] * tables.fixed_literal_lengths[symbol];
+        if (symbol >= 257)
+            extra_bits += (u64)m_literal_frequencies[symbol] * length_extra_bits[symbol - 257];
+    }
+    for (size_t symbol = 0; symbol < 30; ++symbol) {
+        dynamic_bits += (u64)m_distance_frequencies[symbol] * distance_lengths[symbol];
+        fixed_bits += (u64)m_distance_frequencies[symbol] * 5;
+        extra_bits += (u64)m_distance_frequencies[symbol] * distance_extra_bits[symbol];
+    }
+    dynamic_bits += extra_bits;
+    fixed_bits += extra_bits;
+    u64 stored_bits = (m_block_size + 5 * (m_block_size / max_stored_block_size + 1)) * 8 + 7;
+
+    if (stored_bits < min(dynamic_bits, fixed_bits)) {
+        write_stored_block(m_buffer.data() + (m_block_start - m_buffer_position), m_block_size, final);
+        return;
+    }
+
+    const u8* literal_code_lengths = literal_lengths;
+    const u8* distance_code_lengths = distance_lengths;
+    u16 literal_codes[286];
+    u16 distance_codes[30];
+    const u16* literal_code_table = literal_codes;
+    const u16* distance_code_table = distance_codes;
+
+    if (fixed_bits <= dynamic_bits) {
+        write_bits(final, 1);
+        write_bits(1, 2);
+        literal_code_lengths = tables.fixed_literal_lengths;
+        distance_code_lengths = tables.fixed_distance_lengths;
+        literal_code_table = tables.fixed_literal_codes;
+        distance_code_table = tables.fixed_distance_codes;
+    } else {
+        build_codes(literal_lengths, 286, literal_codes);
+        build_codes(distance_lengths, 30, distance_codes);
+
+        write_bits(final, 1);
+        write_bits(2, 2);
+        write_bits(literal_count - 257, 5);
+        write_bits(distance_count - 1, 5);
+        write_bits(code_length_count - 4, 4);
+        for (size_t i = 0; i < code_length_count; ++i)
+            write_bits(code_length_lengths[code_length_order[i]], 3);
+        for (size_t i = 0; i < code_length_symbol_count; ++i) {
+            auto& entry = code_length_symbols[i];
+            write_code(code_length_codes[entry.symbol], code_length_lengths[entry.symbol]);
+            if (entry.symbol == 16)
+                write_bits(entry.extra, 2);
+            else if (entry.symbol == 17)
+                write_bits(entry.extra, 3);
+            else if (entry.symbol == 18)
+                write_bits(entry.extra, 7);
+        }
+    }
+
+    for (size_t i = 0; i < m_token_count; ++i) {
+        auto& token = m_tokens[i];
+        if (!token.distance) {
+            write_code(literal_code_table[token.length_or_literal], literal_code_lengths[token.length_or_literal]);
+            continue;
+        }
+        u8 length_code = tables.length_codes[token.length_or_literal];
+        write_code(literal_code_table[257 + length_code], literal_code_lengths[257 + length_code]);
+        write_bits(token.length_or_literal - length_base[length_code], length_extra_bits[length_code]);
+        u8 distance_code = tables.distance_code(token.distance);
+        write_code(distance_code_table[distance_code], distance_code_lengths[distance_code]);
+        write_bits(token.distance - distance_base[distance_code], distance_extra_bits[distance_code]);
+    }
+    write_code(literal_code_table[256], literal_code_lengths[256]);
+}
+
+ALWAYS_INLINE void Deflate::write_bits(u32 value, u32 count)
+{
+    m_bit_buffer |= (u64)value << m_bit_count;
+    m_bit_count += count;
+    if (m_bit_count >= 32) {
+        ensure_output_capacity(4);
+        u8* output = m_output.data() + m_output_size;
+        output[0] = m_bit_buffer;
+        output[1] = m_bit_buffer >> 8;
+        output[2] = m_bit_buffer >> 16;
+        output[3] = m_bit_buffer >> 24;
+        m_output_size += 4;
+        m_bit_buffer >>= 32;
+        m_bit_count -= 32;
+    }
+}
+
+void Deflate::align_to_byte()
+{
+    if (m_bit_count % 8)
+        write_bits(0, 8 - m_bit_count % 8);
+}
+
+void Deflate::flush_bits()
+{
+    ASSERT(m_bit_count % 8 == 0);
+    while (m_bit_count) {
+        u8 byte = m_bit_buffer;
+        append_output(&byte, 1);
+        m_bit_buffer >>= 8;
+        m_bit_count -= 8;
+    }
+}
+
+void Deflate::append_output(const u8* data, size_t size)
+{
+    ensure_output_capacity(size);
+    memcpy(m_output.data() + m_output_size, data, size);
+    m_output_size += size;
+}
+
+void Deflate::ensure_output_capacity(size_t needed)
+{
+    if (m_output_size + needed <= m_output.size())
+        return;
+    size_t new_capacity = max(m_output.size() * 2, max(m_output_size + needed, (size_t)16 * KB));
+    if (m_output.is_null())
+        m_output = ByteBuffer::create_uninitialized(new_capacity);
+    else
+        m_output.grow(new_capacity);
+}
+
+}
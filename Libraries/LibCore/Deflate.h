@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace Core {
+
+// A streaming DEFLATE (RFC 1951) encoder with optional zlib (RFC 1950) or
+// gzip (RFC 1952) framing. Input may be written in pieces of any size;
+// compressed data is available from take_output() as blocks complete.
+class Deflate {
+public:
+    enum class Format {
+        Raw,
+        Zlib,
+        Gzip,
+    };
+
+    // Levels follow zlib: 0 only stores, 1 is fastest, 9 compresses best.
+    static constexpr int default_level = 6;
+    static constexpr int max_level = 9;
+
+    explicit Deflate(int level = default_level, Format = Format::Raw);
+    ~Deflate();
+
+    void write(ReadonlyBytes);
+
+    // Compresses whatever is still buffered and writes the final block
+    // followed by the trailer. No more input may be written afterwards.
+    void finish();
+    bool is_finished() const { return m_finished; }
+
+    ByteBuffer take_output();
+
+    static ByteBuffer compress_all(ReadonlyBytes, int level = default_level, Format = Format::Raw);
+
+    // The CRC-32 used by the gzip trailer. Start with 0 and feed the previous result back in to continue.
+    static u32 update_crc32(u32 crc, ReadonlyBytes);
+
+    struct Token {
+        u16 length_or_literal;
+        u16 distance;
+    };
+
+private:
+    void write_header();
+    void write_trailer();
+
+    void process(bool flush);
+    void process_stored(bool flush);
+    void process_greedy(bool flush);
+    void process_lazy(bool flush);
+    void slide_window();
+
+    void insert_hash(size_t index);
+    u32 longest_match(size_t index, u32 previous_length, u32& match_distance);
+
+    void emit_literal(u8);
+    void emit_match(u32 length, u32 distance);
+    void flush_block(bool final);
+    void write_stored_block(const u8*, size_t, bool final);
+    void write_huffman_block(bool final);
+
+    void write_bits(u32 value, u32 count);
+    void write_code(u16 reversed_code, u8 length) { write_bits(reversed_code, length); }
+    void align_to_byte();
+    void flush_bits();
+    void append_output(const u8*, size_t);
+    void ensure_output_capacity(size_t);
+
+    int m_level { default_level };
+    Format m_format { Format::Raw };
+    bool m_header_written { false };
+    bool m_finished { false };
+
+    // The sliding window: the last 32 KiB of already compressed input
+    // followed by input that has not been looked at yet.
+    ByteBuffer m_buffer;
+    size_t m_buffer_position { 0 }; // Stream position of m_buffer[0].
+    size_t m_index { 0 };           // Next byte to compress.
+    size_t m_end { 0 };             // End of the buffered input.
+
+    // Hash chains over 3-byte prefixes, keyed by stream position + 1.
+    Vector<u32> m_head;
+    Vector<u32> m_prev;
+
+    // Lazy matching carries a candidate match from one byte to the next.
+    bool m_match_available { false };
+    u32 m_previous_length { 0 };
+    u32 m_previous_distance { 0 };
+
+    // The block being built.
+    Vector<Token> m_tokens;
+    size_t m_token_count { 0 };
+    size_t m_block_start { 0 }; // Stream position of the first byte in the block.
+    size_t m_block_size { 0 };
+    u32 m_literal_frequencies[286];
+    u32 m_distance_frequencies[30];
+
+    u64 m_bit_buffer { 0 };
+    u32 m_bit_count { 0 };
+    ByteBuffer m_output;
+    size_t m_output_size { 0 };
+
+    u32 m_crc32 { 0 };
+    u32 m_adler_a { 1 };
+    u32 m_adler_b { 0 };
+    u32 m_total_in { 0 };
+};
+
+}
@@ -45,7 +45,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -71,6 +71,13 @@ struct EventLoopTimer {
     bool has_expired(const timeval& now) const;
 };
 
+// All notifiers watching the same fd share one epoll registration.
+struct EventLoopFDWatch {
+    HashTable<Notifier*> notifiers;
+    u32 registered_events { 0 };
+    bool always_ready { false };
+};
+
 struct EventLoop::Private {
     LibThread::Lock lock;
 };
@@ -79,8 +86,10 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop*>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
-static HashTable<Notifier*>* s_notifiers;
+static HashMap<int, NonnullOwnPtr<EventLoopFDWatch>>* s_fd_watches;
+static HashTable<int>* s_always_ready_fds;
 int EventLoop::s_wake_pipe_fds[2];
+int EventLoop::s_epoll_fd = -1;
 HashMap<int, EventLoop::SignalHandlers> EventLoop::s_signal_handlers;
 int EventLoop::s_handling_signal = 0;
 int EventLoop::s_next_signal_id = 0;
@@ -226,7 +235,8 @@ EventLoop::EventLoop()
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
-        s_notifiers = new HashTable<Notifier*>;
+        s_fd_watches = new HashMap<int, NonnullOwnPtr<EventLoopFDWatch>>;
+        s_always_ready_fds = new HashTable<int>;
     }
 
     if (!s_main_event_loop) {
@@ -241,6 +251,15 @@ EventLoop::EventLoop()
 
 #endif
         ASSERT(rc == 0);
+
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        ASSERT(s_epoll_fd >= 0);
+        epoll_event wake_event;
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &wake_event);
+        ASSERT(rc == 0);
+
         s_event_loop_stack->append(this);
 
         if (!s_rpc_server) {
@@ -521,31 +540,7 @@ void EventLoop::unregister_signal(int handler_id)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
-    fd_set rfds;
-    fd_set wfds;
 retry:
-    FD_ZERO(&rfds);
-    FD_ZERO(&wfds);
-
-    int max_fd = 0;
-    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
-        FD_SET(fd, &set);
-        if (fd > max_fd)
-            max_fd = fd;
-    };
-
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
-            ASSERT_NOT_REACHED();
-    }
-
     bool queued_events_is_empty;
     {
         LOCKER(m_private->lock);
@@ -553,41 +548,45 @@ retry:
     }
 
     timeval now;
-    struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
-    if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
+    int timeout_ms = 0;
+    if (mode == WaitMode::WaitForEvents && queued_events_is_empty && s_always_ready_fds->is_empty()) {
         auto next_timer_expiration = get_next_timer_expiration();
         if (next_timer_expiration.has_value()) {
             timespec now_spec;
             clock_gettime(CLOCK_MONOTONIC, &now_spec);
             now.tv_sec = now_spec.tv_sec;
             now.tv_usec = now_spec.tv_nsec / 1000;
+            timeval timeout;
             timeval_sub(next_timer_expiration.value(), now, timeout);
-            if (timeout.tv_sec < 0) {
-                timeout.tv_sec = 0;
-                timeout.tv_usec = 0;
+            if (timeout.tv_sec >= 0) {
+                // Round up, so we don't wake up just before the timer is due and spin.
+                timeout_ms = timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
             }
         } else {
-            should_wait_forever = true;
+            timeout_ms = -1;
         }
     }
 
-try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
-    if (marked_fd_count < 0) {
+    epoll_event events[64];
+try_epoll_wait_again:
+    int event_count = epoll_wait(s_epoll_fd, events, sizeof(events) / sizeof(events[0]), timeout_ms);
+    if (event_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
             if (m_exit_requested)
                 return;
-            goto try_select_again;
+            goto try_epoll_wait_again;
         }
 #ifdef EVENTLOOP_DEBUG
-        dbg() << "Core::EventLoop::wait_for_event: " << marked_fd_count << " (" << saved_errno << ": " << strerror(saved_errno) << ")";
+        dbg() << "Core::EventLoop::wait_for_event: " << event_count << " (" << saved_errno << ": " << strerror(saved_errno) << ")";
 #endif
         // Blow up, similar to Core::safe_syscall.
         ASSERT_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+
+    for (int i = 0; i < event_count; ++i) {
+        if (events[i].data.fd != s_wake_pipe_fds[0])
+            continue;
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -596,16 +595,17 @@ try_select_again:
         }
         ASSERT(nread > 0);
         bool wake_requested = false;
-        int event_count = nread / sizeof(wake_events[0]);
-        for (int i = 0; i < event_count; i++) {
-            if (wake_events[i] != 0)
-                dispatch_signal(wake_events[i]);
+        int wake_event_count = nread / sizeof(wake_events[0]);
+        for (int j = 0; j < wake_event_count; j++) {
+            if (wake_events[j] != 0)
+                dispatch_signal(wake_events[j]);
             else
                 wake_requested = true;
         }
 
         if (!wake_requested && nread == sizeof(wake_events))
             goto retry;
+        break;
     }
 
     if (!s_timers->is_empty()) {
@@ -636,19 +636,30 @@ try_select_again:
         }
     }
 
-    if (!marked_fd_count)
-        return;
-
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->event_mask() & Notifier::Event::Read)
-                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
-        }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->event_mask() & Notifier::Event::Write)
-                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+    auto post_notifier_events = [this](int fd, bool readable, bool writable) {
+        auto it = s_fd_watches->find(fd);
+        if (it == s_fd_watches->end())
+            return;
+        for (auto* notifier : it->value->notifiers) {
+            if (readable && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if (writable && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
         }
+    };
+
+    for (int i = 0; i < event_count; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == s_wake_pipe_fds[0])
+            continue;
+        // Hangups and errors are reported as readable, just like select() would.
+        bool readable = events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR);
+        bool writable = events[i].events & EPOLLOUT;
+        post_notifier_events(fd, readable, writable);
     }
+
+    for (int fd : *s_always_ready_fds)
+        post_notifier_events(fd, true, true);
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -709,14 +720,89 @@ bool EventLoop::unregister_timer(int timer_id)
     return true;
 }
 
+void EventLoop::update_fd_watch(int fd, bool force_add)
+{
+    auto it = s_fd_watches->find(fd);
+    ASSERT(it != s_fd_watches->end());
+    auto& watch = *it->value;
+
+    if (watch.notifiers.is_empty()) {
+        // The fd may already be closed, in which case the kernel has dropped it for us.
+        if (!watch.always_ready)
+            epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        s_always_ready_fds->remove(fd);
+        s_fd_watches->remove(it);
+        return;
+    }
+
+    u32 wanted_events = 0;
+    for (auto* notifier : watch.notifiers) {
+        if (notifier->event_mask() & Notifier::Read)
+            wanted_events |= EPOLLIN;
+        if (notifier->event_mask() & Notifier::Write)
+            wanted_events |= EPOLLOUT;
+        if (notifier->event_mask() & Notifier::Exceptional)
+            ASSERT_NOT_REACHED();
+    }
+
+    if (watch.always_ready || (!force_add && wanted_events == watch.registered_events))
+        return;
+
+    epoll_event event;
+    event.events = wanted_events;
+    event.data.fd = fd;
+
+    int rc;
+    if (force_add || !watch.registered_events) {
+        // The fd number may have been closed and reused behind our back,
+        // so always try to (re-)add it when a new notifier shows up.
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        if (rc < 0 && errno == EEXIST)
+            rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    } else {
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    if (rc < 0 && errno == EPERM) {
+        // Some files (e.g. regular files on Linux) can't be watched, but are always ready.
+        watch.always_ready = true;
+        s_always_ready_fds->set(fd);
+        return;
+    }
+    if (rc < 0) {
+#ifdef EVENTLOOP_DEBUG
+        dbg() << "Core::EventLoop: epoll_ctl for fd " << fd << " failed: " << strerror(errno);
+#endif
+        return;
+    }
+    watch.registered_events = wanted_events;
+}
+
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    if (!s_fd_watches->contains(notifier.fd()))
+        s_fd_watches->set(notifier.fd(), make<EventLoopFDWatch>());
+    auto& watch = *s_fd_watches->find(notifier.fd())->value;
+    bool is_new_notifier = !watch.notifiers.contains(&notifier);
+    watch.notifiers.set(&notifier);
+    update_fd_watch(notifier.fd(), is_new_notifier);
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    auto it = s_fd_watches->find(notifier.fd());
+    if (it == s_fd_watches->end() || !it->value->notifiers.contains(&notifier))
+        return;
+    it->value->notifiers.remove(&notifier);
+    update_fd_watch(notifier.fd(), false);
+}
+
+void EventLoop::update_notifier(Badge<Notifier>, Notifier& notifier)
+{
+    auto it = s_fd_watches->find(notifier.fd());
+    if (it == s_fd_watches->end() || !it->value->notifiers.contains(&notifier))
+        return;
+    update_fd_watch(notifier.fd(), false);
 }
 
 void EventLoop::wake()
@@ -67,6 +67,7 @@ public:
 
     static void register_notifier(Badge<Notifier>, Notifier&);
     static void unregister_notifier(Badge<Notifier>, Notifier&);
+    static void update_notifier(Badge<Notifier>, Notifier&);
 
     void quit(int);
     void unquit();
@@ -87,6 +88,7 @@ private:
     Optional<struct timeval> get_next_timer_expiration();
     static void dispatch_signal(int);
     static void handle_signal(int);
+    static void update_fd_watch(int fd, bool force_add);
 
     struct QueuedEvent {
         AK_MAKE_NONCOPYABLE(QueuedEvent);
@@ -155,6 +157,7 @@ private:
     int m_exit_code { 0 };
 
     static int s_wake_pipe_fds[2];
+    static int s_epoll_fd;
 
     struct Private;
     NonnullOwnPtr<Private> m_private;
@@ -100,6 +100,22 @@ bool File::open_impl(IODevice::OpenMode mode, mode_t permissions)
     return true;
 }
 
+ssize_t File::read_at(off_t offset, u8* buffer, size_t length)
+{
+    ssize_t nread = pread(fd(), buffer, length, offset);
+    if (nread < 0)
+        set_error(errno);
+    return nread;
+}
+
+ssize_t File::write_at(off_t offset, const u8* data, size_t length)
+{
+    ssize_t nwritten = pwrite(fd(), data, length, offset);
+    if (nwritten < 0)
+        set_error(errno);
+    return nwritten;
+}
+
 bool File::is_directory() const
 {
     struct stat stat;
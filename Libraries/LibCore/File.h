@@ -57,6 +57,11 @@ public:
     };
     bool open(int fd, IODevice::OpenMode, ShouldCloseFileDescription);
 
+    // Positional I/O. These bypass the read buffer and leave the file offset
+    // alone, so multiple threads can safely share one File.
+    ssize_t read_at(off_t offset, u8* buffer, size_t length);
+    ssize_t write_at(off_t offset, const u8* data, size_t length);
+
 private:
     File(Object* parent = nullptr)
         : IODevice(parent)
@@ -26,8 +26,9 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/Optional.h>
+#include <LibCore/Deflate.h>
 #include <LibCore/Gzip.h>
-#include <LibCore/puff.h>
+#include <LibCore/Inflate.h>
 #include <limits.h>
 #include <stddef.h>
 
@@ -45,9 +46,10 @@ bool Gzip::is_compressed(const ByteBuffer& data)
 static Optional<ByteBuffer> get_gzip_payload(const ByteBuffer& data)
 {
     size_t current = 0;
+    bool truncated = false;
     auto read_byte = [&]() {
         if (current >= data.size()) {
-            ASSERT_NOT_REACHED();
+            truncated = true;
             return (u8)0;
         }
         // dbg() << "read_byte: " << String::format("%x", data[current]);
@@ -76,7 +78,8 @@ static Optional<ByteBuffer> get_gzip_payload(const ByteBuffer& data)
 
     // FEXTRA
     if (flags & 4) {
-        u16 length = read_byte() & read_byte() << 8;
+        u16 length = read_byte();
+        length |= read_byte() << 8;
         dbg() << "get_gzip_payload: Header has FEXTRA flag set. Length = " << length;
         current += length;
     }
@@ -84,14 +87,14 @@ static Optional<ByteBuffer> get_gzip_payload(const ByteBuffer& data)
     // FNAME
     if (flags & 8) {
         dbg() << "get_gzip_payload: Header has FNAME flag set.";
-        while (read_byte() != '\0')
+        while (read_byte() != '\0' && !truncated)
             ;
     }
 
     // FCOMMENT
     if (flags & 16) {
         dbg() << "get_gzip_payload: Header has FCOMMENT flag set.";
-        while (read_byte() != '\0')
+        while (read_byte() != '\0' && !truncated)
             ;
     }
 
@@ -101,14 +104,32 @@ static Optional<ByteBuffer> get_gzip_payload(const ByteBuffer& data)
         current += 2;
     }
 
+    if (truncated || current > data.size()) {
+        dbg() << "get_gzip_payload: Header is truncated.";
+        return Optional<ByteBuffer>();
+    }
+
     auto new_size = data.size() - current;
     dbg() << "get_gzip_payload: Returning slice from " << current << " with size " << new_size;
     return data.slice(current, new_size);
 }
 
+Optional<ByteBuffer> Gzip::deflate_payload(const ByteBuffer& data)
+{
+    if (!is_compressed(data))
+        return {};
+    return get_gzip_payload(data);
+}
+
+static u32 read_u32_le(ReadonlyBytes bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((u32)bytes[3] << 24);
+}
+
 Optional<ByteBuffer> Gzip::decompress(const ByteBuffer& data)
 {
-    ASSERT(is_compressed(data));
+    if (!is_compressed(data))
+        return {};
 
     dbg() << "Gzip::decompress: Decompressing gzip compressed data. Size = " << data.size();
     auto optional_payload = get_gzip_payload(data);
@@ -116,41 +137,33 @@ Optional<ByteBuffer> Gzip::decompress(const ByteBuffer& data)
         return Optional<ByteBuffer>();
     }
 
-    auto source = optional_payload.value();
-    unsigned long source_len = source.size();
-    auto destination = ByteBuffer::create_uninitialized(1024);
-    while (true) {
-        unsigned long destination_len = destination.size();
+    Inflate inflate;
+    if (inflate.write(optional_payload.value().span()) != Inflate::Status::Finished) {
+        dbg() << "Gzip::decompress: Error. The deflate stream is corrupt or truncated.";
+        return {};
+    }
+    auto decompressed = inflate.take_output();
+
+    // The stream is followed by the CRC-32 and the size (modulo 2^32) of the uncompressed data.
+    auto trailer = inflate.remaining_input();
+    if (trailer.size() < 8) {
+        dbg() << "Gzip::decompress: Error. The trailer is truncated.";
+        return {};
+    }
+    if (read_u32_le(trailer) != Deflate::update_crc32(0, decompressed.span()) || read_u32_le(trailer.slice(4, 4)) != (u32)decompressed.size()) {
+        dbg() << "Gzip::decompress: Error. The trailer doesn't match the decompressed data.";
+        return {};
+    }
 
 #ifdef DEBUG_GZIP
-        dbg() << "Gzip::decompress: Calling puff()\n"
-              << "  destination_data = " << destination.data() << "\n"
-              << "  destination_len = " << destination_len << "\n"
-              << "  source_data = " << source.data() << "\n"
-              << "  source_len = " << source_len;
+    dbg() << "Gzip::decompress: Decompression success. Size = " << decompressed.size();
 #endif
+    return decompressed;
+}
 
-        auto puff_ret = puff(
-            destination.data(), &destination_len,
-            source.data(), &source_len);
-
-        if (puff_ret == 0) {
-            dbg() << "Gzip::decompress: Decompression success.";
-            destination.trim(destination_len);
-            break;
-        }
-
-        if (puff_ret == 1) {
-            // FIXME: Find a better way of decompressing without needing to try over and over again.
-            dbg() << "Gzip::decompress: Output buffer exhausted. Growing.";
-            destination.grow(destination.size() * 2);
-        } else {
-            dbg() << "Gzip::decompress: Error. puff() returned: " << puff_ret;
-            ASSERT_NOT_REACHED();
-        }
-    }
-
-    return destination;
+ByteBuffer Gzip::compress(ReadonlyBytes data, int level)
+{
+    return Deflate::compress_all(data, level, Deflate::Format::Gzip);
 }
 
 }
@@ -28,6 +28,7 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/Optional.h>
+#include <AK/Span.h>
 #include <AK/String.h>
 
 namespace Core {
@@ -36,6 +37,10 @@ class Gzip {
 public:
     static bool is_compressed(const ByteBuffer& data);
     static Optional<ByteBuffer> decompress(const ByteBuffer& data);
+    static ByteBuffer compress(ReadonlyBytes data, int level = 6);
+
+    // Strips the gzip header, leaving the raw DEFLATE stream (and the trailer).
+    static Optional<ByteBuffer> deflate_payload(const ByteBuffer& data);
 };
 
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef __serenity__
+
+#    include <AK/Atomic.h>
+#    include <LibCore/IORing.h>
+#    include <LibCore/Notifier.h>
+#    include <netinet/in.h>
+#    include <stdio.h>
+#    include <string.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+
+namespace Core {
+
+RefPtr<IORing> IORing::create(unsigned entries, size_t buffer_size, Object* parent)
+{
+    io_ring_params params;
+    memset(&params, 0, sizeof(params));
+    params.sq_entries = entries;
+    params.buffer_size = buffer_size;
+    int fd = io_ring_setup(&params);
+    if (fd < 0) {
+        perror("io_ring_setup");
+        return nullptr;
+    }
+    auto* ring = (u8*)mmap(nullptr, params.ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return nullptr;
+    }
+    return IORing::construct(fd, params, ring, parent);
+}
+
+IORing::IORing(int fd, const io_ring_params& params, u8* ring, Object* parent)
+    : Object(parent)
+    , m_fd(fd)
+    , m_params(params)
+    , m_ring(ring)
+    , m_header((io_ring_header*)ring)
+    , m_submission_entries((io_ring_sqe*)(ring + params.sq_offset))
+    , m_completion_entries((io_ring_cqe*)(ring + params.cq_offset))
+    , m_buffer(ring + params.buffer_offset)
+{
+    m_sq_tail = m_header->sq_tail;
+    m_notifier = Notifier::construct(m_fd, Notifier::Event::Read, this);
+    m_notifier->on_ready_to_read = [this] {
+        reap_completions();
+    };
+}
+
+IORing::~IORing()
+{
+    munmap(m_ring, m_params.ring_size);
+    close(m_fd);
+}
+
+void IORing::read(int fd, size_t buffer_offset, size_t length, Callback callback, off_t offset)
+{
+    enqueue(IO_RING_OP_READ, fd, offset < 0 ? IO_RING_CURRENT_OFFSET : offset, buffer_offset, length, move(callback));
+}
+
+void IORing::write(int fd, size_t buffer_offset, size_t length, Callback callback, off_t offset)
+{
+    enqueue(IO_RING_OP_WRITE, fd, offset < 0 ? IO_RING_CURRENT_OFFSET : offset, buffer_offset, length, move(callback));
+}
+
+void IORing::readv(int fd, size_t iovecs_offset, size_t iovec_count, Callback callback, off_t offset)
+{
+    enqueue(IO_RING_OP_READV, fd, offset < 0 ? IO_RING_CURRENT_OFFSET : offset, iovecs_offset, iovec_count, move(callback));
+}
+
+void IORing::writev(int fd, size_t iovecs_offset, size_t iovec_count, Callback callback, off_t offset)
+{
+    enqueue(IO_RING_OP_WRITEV, fd, offset < 0 ? IO_RING_CURRENT_OFFSET : offset, iovecs_offset, iovec_count, move(callback));
+}
+
+void IORing::accept(int fd, Callback callback)
+{
+    enqueue(IO_RING_OP_ACCEPT, fd, 0, 0, 0, move(callback));
+}
+
+void IORing::connect(int fd, size_t address_offset, Callback callback)
+{
+    enqueue(IO_RING_OP_CONNECT, fd, 0, address_offset, sizeof(sockaddr_in), move(callback));
+}
+
+void IORing::fsync(int fd, Callback callback)
+{
+    enqueue(IO_RING_OP_FSYNC, fd, 0, 0, 0, move(callback));
+}
+
+void IORing::timeout(int milliseconds, Callback callback)
+{
+    enqueue(IO_RING_OP_TIMEOUT, -1, (u64)milliseconds * 1'000'000, 0, 0, move(callback));
+}
+
+void IORing::nop(Callback callback)
+{
+    enqueue(IO_RING_OP_NOP, -1, 0, 0, 0, move(callback));
+}
+
+void IORing::enqueue(u8 opcode, int fd, u64 offset, size_t buffer_offset, size_t length, Callback callback)
+{
+    // The kernel consumes everything we hand it right away, so a full queue
+    // only means that we haven't submitted in a while.
+    if (m_sq_tail - AK::atomic_load(&m_header->sq_head, AK::memory_order_acquire) >= m_params.sq_entries)
+        submit();
+
+    u64 user_data = m_next_user_data++;
+    auto& sqe = m_submission_entries[m_sq_tail & (m_params.sq_entries - 1)];
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = opcode;
+    sqe.fd = fd;
+    sqe.offset = offset;
+    sqe.buffer = buffer_offset;
+    sqe.length = length;
+    sqe.user_data = user_data;
+    AK::atomic_store(&m_header->sq_tail, ++m_sq_tail, AK::memory_order_release);
+    ++m_unsubmitted_count;
+
+    m_callbacks.set(user_data, move(callback));
+
+    if (m_submit_pending)
+        return;
+    m_submit_pending = true;
+    deferred_invoke([this](auto&) {
+        submit();
+    });
+}
+
+int IORing::submit()
+{
+    m_submit_pending = false;
+    if (!m_unsubmitted_count)
+        return 0;
+    int rc = io_ring_enter(m_fd, m_unsubmitted_count, 0);
+    if (rc < 0) {
+        perror("io_ring_enter");
+        return rc;
+    }
+    m_unsubmitted_count -= rc;
+    return rc;
+}
+
+void IORing::reap_completions()
+{
+    u32 head = m_header->cq_head;
+    u32 tail = AK::atomic_load(&m_header->cq_tail, AK::memory_order_acquire);
+
+    // Accepted connections are only installed into our fd table by the kernel
+    // while we're inside io_ring_enter(), so poke it if that's all we're waiting for.
+    if (head == tail) {
+        if (io_ring_enter(m_fd, 0, 0) < 0)
+            perror("io_ring_enter");
+        tail = AK::atomic_load(&m_header->cq_tail, AK::memory_order_acquire);
+    }
+
+    // Keep ourselves alive in case a callback drops the last reference to us.
+    NonnullRefPtr<IORing> protector(*this);
+    while (head != tail) {
+        auto cqe = m_completion_entries[head & (m_params.cq_entries - 1)];
+        AK::atomic_store(&m_header->cq_head, ++head, AK::memory_order_release);
+
+        auto it = m_callbacks.find(cqe.user_data);
+        if (it == m_callbacks.end())
+            continue;
+        auto callback = move(it->value);
+        m_callbacks.remove(it);
+        if (callback)
+            callback(cqe.result);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <LibCore/Object.h>
+#include <sys/io_ring.h>
+#include <sys/types.h>
+
+namespace Core {
+
+// A wrapper around the kernel's asynchronous I/O ring.
+// All data has to live in the ring's shared buffer, which is addressed by byte offsets.
+// Requests queued up during one event loop iteration are submitted together with a
+// single io_ring_enter(), and completion callbacks are invoked from the event loop.
+class IORing final : public Object {
+    C_OBJECT(IORing)
+public:
+    using Callback = Function<void(int result)>;
+
+    static RefPtr<IORing> create(unsigned entries = 64, size_t buffer_size = 64 * KB, Object* parent = nullptr);
+    virtual ~IORing() override;
+
+    u8* buffer() { return m_buffer; }
+    size_t buffer_size() const { return m_params.buffer_size; }
+
+    // A negative offset means the file's current offset.
+    void read(int fd, size_t buffer_offset, size_t length, Callback, off_t offset = -1);
+    void write(int fd, size_t buffer_offset, size_t length, Callback, off_t offset = -1);
+    // The io_ring_iovecs themselves have to be in the buffer as well.
+    void readv(int fd, size_t iovecs_offset, size_t iovec_count, Callback, off_t offset = -1);
+    void writev(int fd, size_t iovecs_offset, size_t iovec_count, Callback, off_t offset = -1);
+    void accept(int fd, Callback);
+    void connect(int fd, size_t address_offset, Callback);
+    void fsync(int fd, Callback);
+    void timeout(int milliseconds, Callback);
+    void nop(Callback);
+
+    // Hands everything queued so far to the kernel.
+    int submit();
+
+private:
+    IORing(int fd, const io_ring_params&, u8* ring, Object* parent);
+
+    void enqueue(u8 opcode, int fd, u64 offset, size_t buffer_offset, size_t length, Callback);
+    void reap_completions();
+
+    int m_fd { -1 };
+    io_ring_params m_params;
+    u8* m_ring { nullptr };
+    io_ring_header* m_header { nullptr };
+    io_ring_sqe* m_submission_entries { nullptr };
+    io_ring_cqe* m_completion_entries { nullptr };
+    u8* m_buffer { nullptr };
+
+    u32 m_sq_tail { 0 };
+    unsigned m_unsubmitted_count { 0 };
+    bool m_submit_pending { false };
+
+    u64 m_next_user_data { 1 };
+    HashMap<u64, Callback> m_callbacks;
+    RefPtr<Notifier> m_notifier;
+};
+
+}
@@ -0,0 +1,672 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Assertions.h>
+#include <AK/StdLibExtras.h>
+#include <LibCore/Inflate.h>
+#include <string.h>
+
+namespace Core {
+
+static constexpr int max_code_bits = 15;
+static constexpr size_t window_size = 32 * KB;
+static constexpr size_t max_match_length = 258;
+
+// Negative results of the internal decoding steps.
+static constexpr int out_of_input = -1;
+static constexpr int invalid_data = -2;
+
+static const u16 length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const u8 length_extra_bits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const u16 distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const u8 distance_extra_bits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const u8 code_length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static u32 reverse_bits(u32 code, u32 length)
+{
+    u32 reversed = 0;
+    for (u32 i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
+// Builds a canonical Huffman table from a list of code lengths. Returns 0 for
+// a complete code, a positive number for an incomplete code and a negative
+// number for an over-subscribed one.
+static int build_table(Inflate::HuffmanTable& table, const u8* lengths, size_t count)
+{
+    memset(table.count, 0, sizeof(table.count));
+    memset(table.fast, 0, sizeof(table.fast));
+    for (size_t i = 0; i < count; ++i)
+        table.count[lengths[i]]++;
+    if (table.count[0] == count)
+        return 0;
+
+    int left = 1;
+    for (int length = 1; length <= max_code_bits; ++length) {
+        left <<= 1;
+        left -= table.count[length];
+        if (left < 0)
+            return left;
+    }
+
+    u16 offsets[max_code_bits + 1];
+    offsets[1] = 0;
+    for (int length = 1; length < max_code_bits; ++length)
+        offsets[length + 1] = offsets[length] + table.count[length];
+    for (size_t symbol = 0; symbol < count; ++symbol) {
+        if (lengths[symbol])
+            table.symbols[offsets[lengths[symbol]]++] = symbol;
+    }
+
+    // DEFLATE packs codes starting at the most significant bit, but the bit
+    // reader hands them out least significant bit first, so the fast table
+    // is indexed by the reversed code. Every entry whose low bits match the
+    // code resolves to the same symbol.
+    u32 code = 0;
+    size_t index = 0;
+    for (u32 length = 1; length <= Inflate::HuffmanTable::fast_bits; ++length) {
+        for (u32 i = 0; i < table.count[length]; ++i) {
+            u16 entry = (length << 9) | table.symbols[index++];
+            for (u32 fill = reverse_bits(code, length); fill < (1u << Inflate::HuffmanTable::fast_bits); fill += 1u << length)
+                table.fast[fill] = entry;
+            ++code;
+        }
+        code <<= 1;
+    }
+    return left;
+}
+
+struct FixedTables {
+    FixedTables()
+    {
+        u8 lengths[288];
+        size_t symbol = 0;
+        for (; symbol < 144; ++symbol)
+            lengths[symbol] = 8;
+        for (; symbol < 256; ++symbol)
+            lengths[symbol] = 9;
+        for (; symbol < 280; ++symbol)
+            lengths[symbol] = 7;
+        for (; symbol < 288; ++symbol)
+            lengths[symbol] = 8;
+        build_table(literal_table, lengths, 288);
+
+        for (symbol = 0; symbol < 30; ++symbol)
+            lengths[symbol] = 5;
+        build_table(distance_table, lengths, 30);
+    }
+
+    Inflate::HuffmanTable literal_table;
+    Inflate::HuffmanTable distance_table;
+};
+
+static const FixedTables& fixed_tables()
+{
+    static FixedTables tables;
+    return tables;
+}
+
+Inflate::Inflate()
+{
+}
+
+Inflate::~Inflate()
+{
+}
+
+Optional<ByteBuffer> Inflate::decompress_all(ReadonlyBytes data)
+{
+    Inflate inflate;
+    if (inflate.write(data) != Status::Finished)
+        return {};
+    return inflate.take_output();
+}
+
+Inflate::Status Inflate::write(ReadonlyBytes data)
+{
+    if (m_status == Status::Finished) {
+        // Keep collecting trailing data for remaining_input().
+        m_pending_input.append(data.data(), data.size());
+        return m_status;
+    }
+    if (m_status != Status::NeedsMoreInput)
+        return m_status;
+
+    // Anything left over from the last call has to be decoded first.
+    ByteBuffer combined_input;
+    if (!m_pending_input.is_empty()) {
+        combined_input = move(m_pending_input);
+        combined_input.append(data.data(), data.size());
+        m_input = combined_input.span();
+    } else {
+        m_input = data;
+    }
+    m_input_offset = 0;
+
+    m_status = decode();
+
+    ByteBuffer pending_input;
+    if (m_status == Status::Finished) {
+        // The bit reader may have run ahead of the end of the stream, so
+        // hand the whole bytes it holds back to the caller.
+        m_bit_buffer >>= m_bit_count % 8;
+        m_bit_count -= m_bit_count % 8;
+        while (m_bit_count) {
+            u8 byte = m_bit_buffer & 0xff;
+            pending_input.append(&byte, 1);
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
+        }
+    }
+    if (m_status != Status::Error && m_input_offset < m_input.size())
+        pending_input.append(m_input.offset(m_input_offset), m_input.size() - m_input_offset);
+    m_pending_input = move(pending_input);
+    m_input = ReadonlyBytes();
+    m_input_offset = 0;
+
+    return m_status;
+}
+
+ByteBuffer Inflate::take_output()
+{
+    if (m_output_taken == m_output_size)
+        return {};
+
+    if (m_output_taken == 0 && (m_status == Status::Finished || m_status == Status::Error)) {
+        // Nothing will refer back into the window anymore, so give away
+        // the buffer itself instead of copying it.
+        auto output = move(m_output);
+        output.trim(m_output_size);
+        m_output_taken = m_output_size;
+        return output;
+    }
+
+    auto output = ByteBuffer::copy(m_output.data() + m_output_taken, m_output_size - m_output_taken);
+    if (m_output_size > window_size) {
+        memmove(m_output.data(), m_output.data() + m_output_size - window_size, window_size);
+        m_output_size = window_size;
+    }
+    m_output_taken = m_output_size;
+    return output;
+}
+
+void Inflate::ensure_output_capacity(size_t needed)
+{
+    if (m_output_size + needed <= m_output.size())
+        return;
+    size_t new_capacity = max(m_output.size() * 2, max(m_output_size + needed, (size_t)64 * KB));
+    if (m_output.is_null())
+        m_output = ByteBuffer::create_uninitialized(new_capacity);
+    else
+        m_output.grow(new_capacity);
+}
+
+void Inflate::restore(const Checkpoint& checkpoint)
+{
+    m_input_offset = checkpoint.input_offset;
+    m_bit_buffer = checkpoint.bit_buffer;
+    m_bit_count = checkpoint.bit_count;
+}
+
+ALWAYS_INLINE void Inflate::refill()
+{
+    if (m_input_offset + sizeof(u64) <= m_input.size()) {
+        // Top up as many whole bytes as fit with a single load.
+        u64 word;
+        memcpy(&word, m_input.offset(m_input_offset), sizeof(word));
+        size_t byte_count = (63 - m_bit_count) / 8;
+        m_bit_buffer |= word << m_bit_count;
+        m_input_offset += byte_count;
+        m_bit_count += byte_count * 8;
+        m_bit_buffer &= (1ull << m_bit_count) - 1;
+        return;
+    }
+    while (m_bit_count < 56 && m_input_offset < m_input.size()) {
+        m_bit_buffer |= (u64)m_input[m_input_offset++] << m_bit_count;
+        m_bit_count += 8;
+    }
+}
+
+ALWAYS_INLINE bool Inflate::read_bits(u32 count, u32& value)
+{
+    if (m_bit_count < count) {
+        refill();
+        if (m_bit_count < count)
+            return false;
+    }
+    value = m_bit_buffer & ((1ull << count) - 1);
+    m_bit_buffer >>= count;
+    m_bit_count -= count;
+    return true;
+}
+
+ALWAYS_INLINE int Inflate::decode_symbol(const HuffmanTable& table)
+{
+    if (m_bit_count < HuffmanTable::fast_bits)
+        refill();
+
+    // Bits past m_bit_count are always zero, so a hit is only genuine if
+    // the code fits in what we actually have.
+    u16 entry = table.fast[m_bit_buffer & ((1 << HuffmanTable::fast_bits) - 1)];
+    if (entry) {
+        u32 length = entry >> 9;
+        if (length > m_bit_count)
+            return out_of_input;
+        m_bit_buffer >>= length;
+        m_bit_count -= length;
+        return entry & 0x1ff;
+    }
+    return decode_symbol_slow(table);
+}
+
+int Inflate::decode_symbol_slow(const HuffmanTable& table)
+{
+    // Walk the canonical code one bit at a time, like puff does.
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length <= max_code_bits; ++length) {
+        if ((int)m_bit_count < length) {
+            refill();
+            if ((int)m_bit_count < length)
+                return out_of_input;
+        }
+        code |= (m_bit_buffer >> (length - 1)) & 1;
+        int count = table.count[length];
+        if (code - count < first) {
+            m_bit_buffer >>= length;
+            m_bit_count -= length;
+            return table.symbols[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return invalid_data;
+}
+
+Inflate::Status Inflate::decode()
+{
+    for (;;) {
+        int result = 0;
+        switch (m_state) {
+        case State::BlockHeader: {
+            auto checkpoint = save();
+            result = read_block_header();
+            if (result == out_of_input)
+                restore(checkpoint);
+            break;
+        }
+        case State::Stored:
+            result = copy_stored();
+            if (result == 0)
+                m_state = m_final_block ? State::Finished : State::BlockHeader;
+            break;
+        case State::Codes:
+            result = decode_codes();
+            if (result == 0)
+                m_state = m_final_block ? State::Finished : State::BlockHeader;
+            break;
+        case State::Finished:
+            return Status::Finished;
+        }
+
+        if (result == out_of_input)
+            return Status::NeedsMoreInput;
+        if (result < 0)
+            return Status::Error;
+    }
+}
+
+int Inflate::read_block_header()
+{
+    u32 final_block;
+    u32 type;
+    if (!read_bits(1, final_block) || !read_bits(2, type))
+        return out_of_input;
+
+    switch (type) {
+    case 0: {
+        // Stored blocks start on a byte boundary.
+        u32 ignored;
+        read_bits(m_bit_count % 8, ignored);
+        u32 length;
+        u32 complement;
+        if (!read_bits(16, length) || !read_bits(16, complement))
+            return out_of_input;
+        if (length != (~complement & 0xffff))
+            return invalid_data;
+        m_stored_remaining = length;
+        m_state = State::Stored;
+        break;
+    }
+    case 1:
+        m_literal_table = &fixed_tables().literal_table;
+        m_distance_table = &fixed_tables().distance_table;
+        m_state = State::Codes;
+        break;
+    case 2: {
+        int result = read_dynamic_tables();
+        if (result < 0)
+            return result;
+        m_literal_table = &m_dynamic_literal_table;
+        m_distance_table = &m_dynamic_distance_table;
+        m_state = State::Codes;
+        break;
+    }
+    default:
+        return invalid_data;
+    }
+
+    m_final_block = final_block;
+    return 0;
+}
+
+int Inflate::read_dynamic_tables()
+{
+    u32 literal_count;
+    u32 distance_count;
+    u32 code_length_count;
+    if (!read_bits(5, literal_count) || !read_bits(5, distance_count) || !read_bits(4, code_length_count))
+        return out_of_input;
+    literal_count += 257;
+    distance_count += 1;
+    code_length_count += 4;
+    if (literal_count > 286 || distance_count > 30)
+        return invalid_data;
+
+    u8 lengths[286 + 30];
+    memset(lengths, 0, 19);
+    for (u32 i = 0; i < code_length_count; ++i) {
+        u32 length;
+        if (!read_bits(3, length))
+            return out_of_input;
+        lengths[code_length_order[i]] = length;
+    }
+
+    HuffmanTable code_length_table;
+    if (build_table(code_length_table, lengths, 19) != 0)
+        return invalid_data;
+
+    u32 index = 0;
+    while (index < literal_count + distance_count) {
+        int symbol = decode_symbol(code_length_table);
+        if (symbol < 0)
+            return symbol;
+        if (symbol < 16) {
+            lengths[index++] = symbol;
+            continue;
+        }
+
+        u8 length = 0;
+        u32 repeat;
+        if (symbol == 16) {
+            if (index == 0)
+                return invalid_data;
+            length = lengths[index - 1];
+            if (!read_bits(2, repeat))
+                return out_of_input;
+            repeat += 3;
+        } else if (symbol == 17) {
+            if (!read_bits(3, repeat))
+                return out_of_input;
+            repeat += 3;
+        } else {
+            if (!read_bits(7, repeat))
+                return out_of_input;
+            repeat += 11;
+        }
+        if (index + repeat > literal_count + distance_count)
+            return invalid_data;
+        while (repeat--)
+            lengths[index++] = length;
+    }
+
+    // Without an end-of-block code, there is no way to leave this block.
+    if (lengths[256] == 0)
+        return invalid_data;
+
+    // Incomplete codes are only allowed for a single code of length 1.
+    int result = build_table(m_dynamic_literal_table, lengths, literal_count);
+    if (result < 0 || (result > 0 && literal_count != (u32)m_dynamic_literal_table.count[0] + m_dynamic_literal_table.count[1]))
+        return invalid_data;
+    result = build_table(m_dynamic_distance_table, lengths + literal_count, distance_count);
+    if (result < 0 || (result > 0 && distance_count != (u32)m_dynamic_distance_table.count[0] + m_dynamic_distance_table.count[1]))
+        return invalid_data;
+    return 0;
+}
+
+int Inflate::copy_stored()
+{
+    while (m_stored_remaining) {
+        // Drain whatever the bit reader already pulled in, then copy
+        // straight from the input.
+        if (m_bit_count >= 8) {
+            u32 byte;
+            read_bits(8, byte);
+            ensure_output_capacity(1);
+            m_output.data()[m_output_size++] = byte;
+            --m_stored_remaining;
+            continue;
+        }
+        ASSERT(m_bit_count == 0);
+        size_t available = m_input.size() - m_input_offset;
+        if (!available)
+            return out_of_input;
+        size_t count = min((size_t)m_stored_remaining, available);
+        ensure_output_capacity(count);
+        memcpy(m_output.data() + m_output_size, m_input.offset(m_input_offset), count);
+        m_output_size += count;
+        m_input_offset += count;
+        m_stored_remaining -= count;
+    }
+    return 0;
+}
+
+int Inflate::decode_codes_fast()
+{
+    // While at least 8 bytes of input remain, a single refill leaves 56 or
+    // more bits in the buffer, which covers the longest possible
+    // length/distance pair. That lets this loop skip all the out-of-input
+    // checks, and keeping the state in locals stops the compiler from
+    // reloading it after every byte written to the output.
+    const u8* input = m_input.data();
+    size_t input_size = m_input.size();
+    size_t input_offset = m_input_offset;
+    u64 bit_buffer = m_bit_buffer;
+    u32 bit_count = m_bit_count;
+    u8* output = m_output.data();
+    size_t output_size = m_output_size;
+    size_t output_capacity = m_output.size();
+    const HuffmanTable& literal_table = *m_literal_table;
+    const HuffmanTable& distance_table = *m_distance_table;
+    constexpr u32 fast_mask = (1 << HuffmanTable::fast_bits) - 1;
+
+    auto sync_out = [&] {
+        m_input_offset = input_offset;
+        m_bit_buffer = bit_buffer;
+        m_bit_count = bit_count;
+        m_output_size = output_size;
+    };
+    auto sync_in = [&] {
+        input_offset = m_input_offset;
+        bit_buffer = m_bit_buffer;
+        bit_count = m_bit_count;
+        output = m_output.data();
+        output_size = m_output_size;
+        output_capacity = m_output.size();
+    };
+    auto decode = [&](const HuffmanTable& table) -> int {
+        u16 entry = table.fast[bit_buffer & fast_mask];
+        if (entry) {
+            bit_buffer >>= entry >> 9;
+            bit_count -= entry >> 9;
+            return entry & 0x1ff;
+        }
+        sync_out();
+        int symbol = decode_symbol_slow(table);
+        sync_in();
+        return symbol;
+    };
+    auto take_bits = [&](u32 count) -> u32 {
+        u32 value = bit_buffer & ((1ull << count) - 1);
+        bit_buffer >>= count;
+        bit_count -= count;
+        return value;
+    };
+
+    int result = 1;
+    while (input_offset + sizeof(u64) <= input_size) {
+        if (output_size + max_match_length > output_capacity) {
+            sync_out();
+            ensure_output_capacity(max_match_length);
+            sync_in();
+        }
+
+        u64 word;
+        memcpy(&word, input + input_offset, sizeof(word));
+        size_t byte_count = (63 - bit_count) / 8;
+        bit_buffer |= word << bit_count;
+        input_offset += byte_count;
+        bit_count += byte_count * 8;
+        bit_buffer &= (1ull << bit_count) - 1;
+
+        int symbol = decode(literal_table);
+        if (symbol < 256) {
+            if (symbol < 0) {
+                result = symbol;
+                break;
+            }
+            output[output_size++] = symbol;
+            continue;
+        }
+        if (symbol == 256) {
+            result = 0;
+            break;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            result = invalid_data;
+            break;
+        }
+        size_t length = length_base[symbol] + take_bits(length_extra_bits[symbol]);
+
+        symbol = decode(distance_table);
+        if (symbol < 0 || symbol >= 30) {
+            result = invalid_data;
+            break;
+        }
+        size_t distance = distance_base[symbol] + take_bits(distance_extra_bits[symbol]);
+        if (distance > output_size) {
+            result = invalid_data;
+            break;
+        }
+
+        u8* destination = output + output_size;
+        const u8* source = destination - distance;
+        if (distance >= length) {
+            memcpy(destination, source, length);
+        } else {
+            for (size_t i = 0; i < length; ++i)
+                destination[i] = source[i];
+        }
+        output_size += length;
+    }
+
+    sync_out();
+    return result;
+}
+
+int Inflate::decode_codes()
+{
+    int result = decode_codes_fast();
+    if (result <= 0)
+        return result;
+
+    for (;;) {
+        // Nothing is written until a whole literal or match has been read,
+        // so running out of input can simply rewind to here.
+        auto checkpoint = save();
+        ensure_output_capacity(max_match_length);
+
+        int symbol = decode_symbol(*m_literal_table);
+        if (symbol < 0) {
+            if (symbol == out_of_input)
+                restore(checkpoint);
+            return symbol;
+        }
+        if (symbol < 256) {
+            m_output.data()[m_output_size++] = symbol;
+            continue;
+        }
+        if (symbol == 256)
+            return 0;
+
+        symbol -= 257;
+        if (symbol >= 29)
+            return invalid_data;
+        u32 extra;
+        if (!read_bits(length_extra_bits[symbol], extra)) {
+            restore(checkpoint);
+            return out_of_input;
+        }
+        size_t length = length_base[symbol] + extra;
+
+        symbol = decode_symbol(*m_distance_table);
+        if (symbol < 0) {
+            if (symbol == out_of_input)
+                restore(checkpoint);
+            return symbol;
+        }
+        if (symbol >= 30)
+            return invalid_data;
+        if (!read_bits(distance_extra_bits[symbol], extra)) {
+            restore(checkpoint);
+            return out_of_input;
+        }
+        size_t distance = distance_base[symbol] + extra;
+        if (distance > m_output_size)
+            return invalid_data;
+
+        u8* destination = m_output.data() + m_output_size;
+        const u8* source = destination - distance;
+        if (distance >= length) {
+            memcpy(destination, source, length);
+        } else {
+            // Overlapping matches repeat the most recent bytes.
+            for (size_t i = 0; i < length; ++i)
+                destination[i] = source[i];
+        }
+        m_output_size += length;
+    }
+}
+
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Core {
+
+// A streaming decoder for raw DEFLATE data (RFC 1951).
+// Compressed data can be written in arbitrarily sized pieces, and decoding
+// picks up exactly where it left off when more input arrives.
+class Inflate {
+public:
+    enum class Status {
+        NeedsMoreInput,
+        Finished,
+        Error,
+    };
+
+    struct HuffmanTable {
+        // Codes up to this many bits are resolved with a single table lookup.
+        static constexpr size_t fast_bits = 9;
+
+        u16 fast[1 << fast_bits];
+        u16 count[16];
+        u16 symbols[288];
+    };
+
+    Inflate();
+    ~Inflate();
+
+    Status write(ReadonlyBytes);
+    Status status() const { return m_status; }
+    bool is_finished() const { return m_status == Status::Finished; }
+
+    // Hands out everything that was decoded since the last call.
+    ByteBuffer take_output();
+    size_t available_output() const { return m_output_size - m_output_taken; }
+
+    // Whatever followed the final block, e.g. a zlib or gzip trailer.
+    ReadonlyBytes remaining_input() const { return m_pending_input.span(); }
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+
+private:
+    enum class State {
+        BlockHeader,
+        Stored,
+        Codes,
+        Finished,
+    };
+
+    struct Checkpoint {
+        size_t input_offset;
+        u64 bit_buffer;
+        u32 bit_count;
+    };
+
+    Status decode();
+    int read_block_header();
+    int read_dynamic_tables();
+    int copy_stored();
+    int decode_codes();
+    int decode_codes_fast();
+
+    void refill();
+    bool read_bits(u32 count, u32& value);
+    int decode_symbol(const HuffmanTable&);
+    int decode_symbol_slow(const HuffmanTable&);
+
+    void ensure_output_capacity(size_t);
+
+    Checkpoint save() const { return { m_input_offset, m_bit_buffer, m_bit_count }; }
+    void restore(const Checkpoint&);
+
+    Status m_status { Status::NeedsMoreInput };
+    State m_state { State::BlockHeader };
+    bool m_final_block { false };
+    u32 m_stored_remaining { 0 };
+
+    ReadonlyBytes m_input;
+    size_t m_input_offset { 0 };
+    ByteBuffer m_pending_input;
+    u64 m_bit_buffer { 0 };
+    u32 m_bit_count { 0 };
+
+    const HuffmanTable* m_literal_table { nullptr };
+    const HuffmanTable* m_distance_table { nullptr };
+    HuffmanTable m_dynamic_literal_table;
+    HuffmanTable m_dynamic_distance_table;
+
+    // The output doubles as the sliding window for back references,
+    // so take_output() always keeps the last 32 KiB around.
+    ByteBuffer m_output;
+    size_t m_output_size { 0 };
+    size_t m_output_taken { 0 };
+};
+
+}
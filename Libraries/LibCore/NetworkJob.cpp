@@ -88,6 +88,16 @@ void NetworkJob::did_progress(Optional<u32> total_size, u32 downloaded)
         on_progress(total_size, downloaded);
 }
 
+void NetworkJob::did_receive_data(const ByteBuffer& data)
+{
+    // NOTE: We protect ourselves here, since the callback may otherwise
+    //       trigger destruction of this job somehow.
+    NonnullRefPtr<NetworkJob> protector(*this);
+
+    if (on_data_received)
+        on_data_received(data);
+}
+
 const char* to_string(NetworkJob::Error error)
 {
     switch (error) {
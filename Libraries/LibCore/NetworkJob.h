@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <LibCore/Object.h>
 
@@ -45,6 +46,7 @@ public:
 
     Function<void(bool success)> on_finish;
     Function<void(Optional<u32>, u32)> on_progress;
+    Function<void(const ByteBuffer&)> on_data_received;
 
     bool is_cancelled() const { return m_error == Error::Cancelled; }
     bool has_error() const { return m_error != Error::None; }
@@ -66,6 +68,7 @@ protected:
     void did_finish(NonnullRefPtr<NetworkResponse>&&);
     void did_fail(Error);
     void did_progress(Optional<u32> total_size, u32 downloaded);
+    void did_receive_data(const ByteBuffer&);
 
 private:
     RefPtr<NetworkResponse> m_response;
@@ -33,6 +33,7 @@
 #include <LibGUI/FileSystemModel.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/JPGLoader.h>
 #include <LibThread/BackgroundAction.h>
 #include <dirent.h>
 #include <grp.h>
@@ -505,7 +506,12 @@ static HashMap<String, RefPtr<Gfx::Bitmap>> s_thumbnail_cache;
 
 static RefPtr<Gfx::Bitmap> render_thumbnail(const StringView& path)
 {
-    auto png_bitmap = Gfx::Bitmap::load_from_file(path);
+    RefPtr<Gfx::Bitmap> png_bitmap;
+    // JPEGs can be decoded at a fraction of their size, which is much faster for large photos.
+    if (path.ends_with(".jpg") || path.ends_with(".jpeg"))
+        png_bitmap = Gfx::load_jpg_downscaled(path, { 32, 32 });
+    else
+        png_bitmap = Gfx::Bitmap::load_from_file(path);
     if (!png_bitmap)
         return nullptr;
 
@@ -634,7 +634,7 @@ RefPtr<Gfx::Bitmap> Window::create_shared_bitmap(Gfx::BitmapFormat format, const
 
 RefPtr<Gfx::Bitmap> Window::create_backing_bitmap(const Gfx::IntSize& size)
 {
-    auto format = m_has_alpha_channel ? Gfx::BitmapFormat::RGBA32 : Gfx::BitmapFormat::RGB32;
+    auto format = m_has_alpha_channel ? Gfx::BitmapFormat::RGBA32Premultiplied : Gfx::BitmapFormat::RGB32;
     return create_shared_bitmap(format, size);
 }
 
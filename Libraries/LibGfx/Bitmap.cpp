@@ -37,6 +37,7 @@
 #include <LibGfx/PGMLoader.h>
 #include <LibGfx/PNGLoader.h>
 #include <LibGfx/PPMLoader.h>
+#include <LibGfx/PixelKernels.h>
 #include <LibGfx/ShareableBitmap.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -222,12 +223,23 @@ void Bitmap::set_mmap_name(const StringView& name)
 void Bitmap::fill(Color color)
 {
     ASSERT(!is_indexed(m_format));
+    RGBA32 value = is_premultiplied() ? color.to_premultiplied() : color.value();
     for (int y = 0; y < height(); ++y) {
         auto* scanline = this->scanline(y);
-        fast_u32_fill(scanline, color.value(), width());
+        fast_u32_fill(scanline, value, width());
     }
 }
 
+void Bitmap::premultiply_alpha()
+{
+    if (m_format != BitmapFormat::RGBA32)
+        return;
+    auto& kernels = pixel_kernels();
+    for (int y = 0; y < height(); ++y)
+        kernels.premultiply_row(scanline(y), width());
+    m_format = BitmapFormat::RGBA32Premultiplied;
+}
+
 void Bitmap::set_volatile()
 {
     ASSERT(m_purgeable);
@@ -54,6 +54,7 @@ enum class BitmapFormat {
     Indexed8,
     RGB32,
     RGBA32,
+    RGBA32Premultiplied,
 };
 
 enum RotationDirection {
@@ -84,6 +85,10 @@ public:
     RefPtr<Gfx::Bitmap> flipped(Gfx::Orientation) const;
     RefPtr<Bitmap> to_bitmap_backed_by_shared_buffer() const;
 
+    // Converts an RGBA32 bitmap to RGBA32Premultiplied in place, so that
+    // painting it later only needs multiplies and adds.
+    void premultiply_alpha();
+
     ShareableBitmap to_shareable_bitmap(pid_t peer_pid = -1) const;
 
     ~Bitmap();
@@ -148,6 +153,7 @@ public:
             return 8;
         case BitmapFormat::RGB32:
         case BitmapFormat::RGBA32:
+        case BitmapFormat::RGBA32Premultiplied:
             return 32;
         default:
             ASSERT_NOT_REACHED();
@@ -163,7 +169,8 @@ public:
 
     void fill(Color);
 
-    bool has_alpha_channel() const { return m_format == BitmapFormat::RGBA32; }
+    bool has_alpha_channel() const { return m_format == BitmapFormat::RGBA32 || m_format == BitmapFormat::RGBA32Premultiplied; }
+    bool is_premultiplied() const { return m_format == BitmapFormat::RGBA32Premultiplied; }
     BitmapFormat format() const { return m_format; }
 
     void set_mmap_name(const StringView&);
@@ -270,6 +277,12 @@ inline Color Bitmap::get_pixel<BitmapFormat::RGBA32>(int x, int y) const
     return Color::from_rgba(scanline(y)[x]);
 }
 
+template<>
+inline Color Bitmap::get_pixel<BitmapFormat::RGBA32Premultiplied>(int x, int y) const
+{
+    return Color::from_premultiplied(scanline(y)[x]);
+}
+
 template<>
 inline Color Bitmap::get_pixel<BitmapFormat::Indexed1>(int x, int y) const
 {
@@ -301,6 +314,8 @@ inline Color Bitmap::get_pixel(int x, int y) const
         return get_pixel<BitmapFormat::RGB32>(x, y);
     case BitmapFormat::RGBA32:
         return get_pixel<BitmapFormat::RGBA32>(x, y);
+    case BitmapFormat::RGBA32Premultiplied:
+        return get_pixel<BitmapFormat::RGBA32Premultiplied>(x, y);
     case BitmapFormat::Indexed1:
         return get_pixel<BitmapFormat::Indexed1>(x, y);
     case BitmapFormat::Indexed2:
@@ -326,6 +341,12 @@ inline void Bitmap::set_pixel<BitmapFormat::RGBA32>(int x, int y, Color color)
     scanline(y)[x] = color.value();
 }
 
+template<>
+inline void Bitmap::set_pixel<BitmapFormat::RGBA32Premultiplied>(int x, int y, Color color)
+{
+    scanline(y)[x] = color.to_premultiplied();
+}
+
 inline void Bitmap::set_pixel(int x, int y, Color color)
 {
     switch (m_format) {
@@ -335,6 +356,9 @@ inline void Bitmap::set_pixel(int x, int y, Color color)
     case BitmapFormat::RGBA32:
         set_pixel<BitmapFormat::RGBA32>(x, y, color);
         break;
+    case BitmapFormat::RGBA32Premultiplied:
+        set_pixel<BitmapFormat::RGBA32Premultiplied>(x, y, color);
+        break;
     case BitmapFormat::Indexed1:
     case BitmapFormat::Indexed2:
     case BitmapFormat::Indexed4:
@@ -87,6 +87,27 @@ public:
     static constexpr Color from_rgb(unsigned rgb) { return Color(rgb | 0xff000000); }
     static constexpr Color from_rgba(unsigned rgba) { return Color(rgba); }
 
+    // Premultiplied pixels store each color channel already scaled by alpha.
+    static Color from_premultiplied(RGBA32 pixel)
+    {
+        u32 alpha = pixel >> 24;
+        if (alpha == 0xff)
+            return Color(pixel);
+        if (!alpha)
+            return Color(0);
+        auto unpremultiply = [alpha](u32 channel) -> u8 { return min(255u, (channel * 255 + alpha / 2) / alpha); };
+        return Color(unpremultiply((pixel >> 16) & 0xff), unpremultiply((pixel >> 8) & 0xff), unpremultiply(pixel & 0xff), alpha);
+    }
+
+    RGBA32 to_premultiplied() const
+    {
+        u32 a = alpha();
+        if (a == 0xff)
+            return m_value;
+        auto premultiply = [a](u32 channel) { return (channel * a + 127) / 255; };
+        return (a << 24) | (premultiply(red()) << 16) | (premultiply(green()) << 8) | premultiply(blue());
+    }
+
     u8 red() const { return (m_value >> 16) & 0xff; }
     u8 green() const { return (m_value >> 8) & 0xff; }
     u8 blue() const { return m_value & 0xff; }
@@ -40,6 +40,44 @@ void DisjointRectSet::add(const IntRect& new_rect)
         shatter();
 }
 
+void DisjointRectSet::subtract(const IntRect& hammer)
+{
+    if (hammer.is_empty())
+        return;
+    Vector<IntRect, 32> output;
+    output.ensure_capacity(m_rects.size());
+    for (auto& rect : m_rects) {
+        if (!rect.intersects(hammer)) {
+            output.append(rect);
+            continue;
+        }
+        for (auto& piece : rect.shatter(hammer))
+            output.append(piece);
+    }
+    swap(output, m_rects);
+}
+
+bool DisjointRectSet::intersects(const IntRect& rect) const
+{
+    for (auto& existing_rect : m_rects) {
+        if (existing_rect.intersects(rect))
+            return true;
+    }
+    return false;
+}
+
+DisjointRectSet DisjointRectSet::intersected(const IntRect& rect) const
+{
+    // Pieces of disjoint rects are still disjoint, so no need to shatter the result.
+    DisjointRectSet result;
+    for (auto& existing_rect : m_rects) {
+        auto piece = existing_rect.intersected(rect);
+        if (!piece.is_empty())
+            result.m_rects.append(piece);
+    }
+    return result;
+}
+
 void DisjointRectSet::shatter()
 {
     Vector<IntRect, 32> output;
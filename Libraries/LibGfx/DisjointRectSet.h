@@ -39,9 +39,20 @@ public:
         : m_rects(move(other.m_rects))
     {
     }
+    DisjointRectSet& operator=(DisjointRectSet&& other)
+    {
+        if (this != &other)
+            m_rects = move(other.m_rects);
+        return *this;
+    }
 
     void add(const IntRect&);
 
+    // Removes the area covered by the hammer rect, splitting any rects it partially covers.
+    void subtract(const IntRect& hammer);
+    bool intersects(const IntRect&) const;
+    DisjointRectSet intersected(const IntRect&) const;
+
     bool is_empty() const { return m_rects.is_empty(); }
     size_t size() const { return m_rects.size(); }
 
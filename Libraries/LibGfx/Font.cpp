@@ -149,6 +149,50 @@ Font::Font(const StringView& name, unsigned* rows, u8* widths, bool is_fixed_wid
         m_min_glyph_width = minimum;
         m_max_glyph_width = maximum;
     }
+
+    rasterize_glyph_spans();
+    update_ascii_advances();
+}
+
+void Font::update_ascii_advances()
+{
+    for (size_t ch = 0; ch < 128; ++ch)
+        m_ascii_advances[ch] = glyph_width(ch) + m_glyph_spacing;
+}
+
+void Font::rasterize_glyph_spans()
+{
+    m_glyph_spans.clear_with_capacity();
+    m_glyph_span_offsets.clear_with_capacity();
+    m_glyph_span_offsets.ensure_capacity(m_glyph_count + 1);
+    for (size_t glyph = 0; glyph < m_glyph_count; ++glyph) {
+        m_glyph_span_offsets.unchecked_append(m_glyph_spans.size());
+        const unsigned* rows = &m_rows[glyph * m_glyph_height];
+        for (u8 y = 0; y < m_glyph_height; ++y) {
+            unsigned row = rows[y];
+            u8 x = 0;
+            while (row) {
+                if (!(row & 1)) {
+                    u8 skip = __builtin_ctz(row);
+                    row >>= skip;
+                    x += skip;
+                    continue;
+                }
+                // A fully set row would make ~row zero, and both ctz(0) and shifting by 32 are undefined.
+                u8 length = ~row ? __builtin_ctz(~row) : 32;
+                m_glyph_spans.append({ y, x, length });
+                row = length < 32 ? row >> length : 0;
+                x += length;
+            }
+        }
+    }
+    m_glyph_span_offsets.unchecked_append(m_glyph_spans.size());
+}
+
+void Font::did_change_glyph(u32)
+{
+    // Glyph edits only happen in FontEditor, so just redo the whole font.
+    rasterize_glyph_spans();
 }
 
 Font::~Font()
@@ -282,6 +326,20 @@ int Font::width(const StringView& string) const
 
 int Font::width(const Utf8View& utf8) const
 {
+    // Most measured text is ASCII, which maps straight onto the width table without any decoding.
+    auto& string = utf8.as_string();
+    int ascii_width = 0;
+    bool is_ascii = true;
+    for (char ch : string) {
+        if ((u8)ch >= 0x80) {
+            is_ascii = false;
+            break;
+        }
+        ascii_width += m_ascii_advances[(u8)ch];
+    }
+    if (is_ascii)
+        return string.is_empty() ? 0 : ascii_width - glyph_spacing();
+
     bool first = true;
     int width = 0;
 
@@ -338,6 +396,8 @@ void Font::set_type(FontTypes type)
     m_glyph_count = new_glyph_count;
     m_rows = new_rows;
     m_glyph_widths = new_widths;
+
+    rasterize_glyph_spans();
 }
 
 }
@@ -29,8 +29,10 @@
 #include <AK/MappedFile.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
+#include <AK/Span.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <LibGfx/Size.h>
 
 namespace Gfx {
@@ -73,6 +75,13 @@ private:
     IntSize m_size;
 };
 
+// A horizontal run of set pixels in one row of a glyph.
+struct GlyphSpan {
+    u8 y;
+    u8 x;
+    u8 length;
+};
+
 class Font : public RefCounted<Font> {
 public:
     static Font& default_font();
@@ -91,6 +100,16 @@ public:
 
     GlyphBitmap glyph_bitmap(u32 codepoint) const;
 
+    // The glyph pre-rasterized into runs of set pixels, so that painting it is a handful of row fills.
+    // Spans are not clipped to the glyph width, since that can change independently of the bitmap.
+    Span<const GlyphSpan> glyph_spans(u32 codepoint) const
+    {
+        return { m_glyph_spans.data() + m_glyph_span_offsets[codepoint], m_glyph_span_offsets[codepoint + 1] - m_glyph_span_offsets[codepoint] };
+    }
+
+    // Call this after modifying a glyph through its GlyphBitmap.
+    void did_change_glyph(u32 codepoint);
+
     u8 glyph_width(size_t ch) const { return m_fixed_width ? m_glyph_width : m_glyph_widths[ch]; }
     int glyph_or_emoji_width(u32 codepoint) const;
     u8 glyph_height() const { return m_glyph_height; }
@@ -106,15 +125,24 @@ public:
     void set_name(const StringView& name) { m_name = name; }
 
     bool is_fixed_width() const { return m_fixed_width; }
-    void set_fixed_width(bool b) { m_fixed_width = b; }
+    void set_fixed_width(bool b)
+    {
+        m_fixed_width = b;
+        update_ascii_advances();
+    }
 
     u8 glyph_spacing() const { return m_glyph_spacing; }
-    void set_glyph_spacing(u8 spacing) { m_glyph_spacing = spacing; }
+    void set_glyph_spacing(u8 spacing)
+    {
+        m_glyph_spacing = spacing;
+        update_ascii_advances();
+    }
 
     void set_glyph_width(size_t ch, u8 width)
     {
         ASSERT(m_glyph_widths);
         m_glyph_widths[ch] = width;
+        update_ascii_advances();
     }
 
     int glyph_count() const { return m_glyph_count; }
@@ -126,6 +154,8 @@ private:
 
     static RefPtr<Font> load_from_memory(const u8*);
     static size_t glyph_count_by_type(FontTypes type);
+    void rasterize_glyph_spans();
+    void update_ascii_advances();
 
     String m_name;
     FontTypes m_type;
@@ -135,6 +165,12 @@ private:
     u8* m_glyph_widths { nullptr };
     MappedFile m_mapped_file;
 
+    Vector<GlyphSpan> m_glyph_spans;
+    Vector<u32> m_glyph_span_offsets;
+
+    // Width plus spacing of each ASCII glyph, so that measuring ASCII text takes one lookup per character.
+    u16 m_ascii_advances[128];
+
     u8 m_glyph_width { 0 };
     u8 m_glyph_height { 0 };
     u8 m_min_glyph_width { 0 };
@@ -37,6 +37,7 @@
 namespace Gfx {
 
 static bool load_gif_frame_descriptors(GIFLoadingContext&);
+static bool load_gif_frame_descriptors_from(GIFLoadingContext&, BufferStream&);
 
 struct RGB {
     u8 r;
@@ -89,6 +90,13 @@ struct GIFLoadingContext {
     u8 background_color_index { 0 };
     NonnullOwnPtrVector<ImageDescriptor> images {};
     size_t loops { 1 };
+
+    // Incremental decoding: data_size only covers what has arrived so far, and
+    // frame descriptors are parsed up to the last complete frame, from where
+    // the next call picks up.
+    bool is_data_complete { true };
+    size_t descriptors_offset { 0 };
+    size_t parsed_data_size { 0 };
 };
 
 RefPtr<Gfx::Bitmap> load_gif(const StringView& path)
@@ -342,12 +350,21 @@ bool decode_frames_up_to_index(GIFLoadingContext& context, size_t frame_index)
 
 bool load_gif_frame_descriptors(GIFLoadingContext& context)
 {
+    // Running out of data is only an error once all of it has arrived.
     if (context.data_size < 32)
-        return false;
+        return !context.is_data_complete;
+    if (!context.is_data_complete && context.data_size == context.parsed_data_size)
+        return true;
+    context.parsed_data_size = context.data_size;
 
     auto buffer = ByteBuffer::wrap(context.data, context.data_size);
     BufferStream stream(buffer);
 
+    if (context.descriptors_offset) {
+        stream.advance(context.descriptors_offset);
+        return load_gif_frame_descriptors_from(context, stream);
+    }
+
     Optional<GIFFormat> format = decode_gif_header(stream);
     if (!format.has_value()) {
         return false;
@@ -399,24 +416,32 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
     }
 
     if (stream.handle_read_failure())
-        return false;
+        return !context.is_data_complete;
 
     for (int i = 0; i < color_map_entry_count; ++i) {
         auto& rgb = context.logical_screen.color_map[i];
         printf("[%02x]: %s\n", i, Color(rgb.r, rgb.g, rgb.b).to_string().characters());
     }
 
+    context.descriptors_offset = stream.offset();
+    return load_gif_frame_descriptors_from(context, stream);
+}
+
+static bool load_gif_frame_descriptors_from(GIFLoadingContext& context, BufferStream& stream)
+{
     NonnullOwnPtr<ImageDescriptor> current_image = make<ImageDescriptor>();
     for (;;) {
         u8 sentinel = 0;
         stream >> sentinel;
+        if (stream.handle_read_failure())
+            return !context.is_data_complete;
         printf("Sentinel: %02x\n", sentinel);
 
         if (sentinel == 0x21) {
             u8 extension_type = 0;
             stream >> extension_type;
             if (stream.handle_read_failure())
-                return false;
+                return !context.is_data_complete;
 
             printf("Extension block of type %02x\n", extension_type);
 
@@ -427,7 +452,7 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
                 stream >> sub_block_length;
 
                 if (stream.handle_read_failure())
-                    return false;
+                    return !context.is_data_complete;
 
                 if (sub_block_length == 0)
                     break;
@@ -439,7 +464,7 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
                 }
 
                 if (stream.handle_read_failure())
-                    return false;
+                    return !context.is_data_complete;
             }
 
             if (extension_type == 0xF9) {
@@ -482,8 +507,7 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
         }
 
         if (sentinel == 0x2c) {
-            context.images.append(move(current_image));
-            auto& image = context.images.last();
+            auto& image = *current_image;
 
             u8 packed_fields { 0 };
             stream >> image.x;
@@ -492,7 +516,7 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
             stream >> image.height;
             stream >> packed_fields;
             if (stream.handle_read_failure())
-                return false;
+                return !context.is_data_complete;
             printf("Image descriptor: %d,%d %dx%d, %02x\n", image.x, image.y, image.width, image.height, packed_fields);
 
             stream >> image.lzw_min_code_size;
@@ -505,7 +529,7 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
                 stream >> lzw_encoded_bytes_expected;
 
                 if (stream.handle_read_failure())
-                    return false;
+                    return !context.is_data_complete;
 
                 if (lzw_encoded_bytes_expected == 0)
                     break;
@@ -516,13 +540,15 @@ bool load_gif_frame_descriptors(GIFLoadingContext& context)
                 }
 
                 if (stream.handle_read_failure())
-                    return false;
+                    return !context.is_data_complete;
 
                 for (int i = 0; i < lzw_encoded_bytes_expected; ++i) {
                     image.lzw_encoded_bytes.append(buffer[i]);
                 }
             }
 
+            context.images.append(move(current_image));
+            context.descriptors_offset = stream.offset();
             current_image = make<ImageDescriptor>();
             continue;
         }
@@ -645,6 +671,10 @@ ImageFrameDescriptor GIFImageDecoderPlugin::frame(size_t i)
         }
     }
 
+    // Later frames of an image that is still loading simply haven't arrived yet.
+    if (i >= m_context->images.size() && !m_context->is_data_complete)
+        return {};
+
     if (!decode_frames_up_to_index(*m_context, i)) {
         m_context->state = GIFLoadingContext::State::Error;
         return {};
@@ -661,4 +691,37 @@ ImageFrameDescriptor GIFImageDecoderPlugin::frame(size_t i)
     return frame;
 }
 
+void GIFImageDecoderPlugin::did_receive_data(const u8* data, size_t size, bool is_complete)
+{
+    m_context->data = data;
+    m_context->data_size = size;
+    m_context->is_data_complete = is_complete;
+}
+
+IncrementalDecodeResult GIFImageDecoderPlugin::decode_available_data()
+{
+    IncrementalDecodeResult result;
+    if (m_context->state < GIFLoadingContext::State::FrameDescriptorsLoaded && !load_gif_frame_descriptors(*m_context))
+        m_context->state = GIFLoadingContext::State::Error;
+    if (m_context->state == GIFLoadingContext::State::Error) {
+        result.has_failed = true;
+        return result;
+    }
+
+    // Frames are only decoded once all of their data has arrived.
+    result.is_complete = m_context->state == GIFLoadingContext::State::FrameDescriptorsLoaded;
+    if (m_context->images.is_empty())
+        return result;
+    result.image = frame(0).image;
+    if (!result.image) {
+        result.has_failed = true;
+        return result;
+    }
+    if (!m_has_reported_first_frame) {
+        m_has_reported_first_frame = true;
+        result.changed_rect = result.image->rect();
+    }
+    return result;
+}
+
 }
@@ -51,8 +51,13 @@ public:
     virtual size_t frame_count() override;
     virtual ImageFrameDescriptor frame(size_t i) override;
 
+    virtual bool supports_incremental_decoding() const override { return true; }
+    virtual void did_receive_data(const u8*, size_t, bool is_complete) override;
+    virtual IncrementalDecodeResult decode_available_data() override;
+
 private:
     OwnPtr<GIFLoadingContext> m_context;
+    bool m_has_reported_first_frame { false };
 };
 
 }
@@ -36,7 +36,20 @@
 
 namespace Gfx {
 
-ImageDecoder::ImageDecoder(const u8* data, size_t size)
+// Enough for every plugin to recognize its format.
+static constexpr size_t minimum_size_for_sniffing = 32;
+
+ImageDecoder::ImageDecoder(const u8* data, size_t size, bool is_complete)
+    : m_is_complete(is_complete)
+{
+    if (is_complete) {
+        create_plugin(data, size);
+        return;
+    }
+    did_receive_data(data, size, false);
+}
+
+void ImageDecoder::create_plugin(const u8* data, size_t size)
 {
     m_plugin = make<PNGImageDecoderPlugin>(data, size);
     if (m_plugin->sniff())
@@ -77,6 +90,45 @@ ImageDecoder::~ImageDecoder()
 {
 }
 
+void ImageDecoder::did_receive_data(const u8* data, size_t size, bool is_complete)
+{
+    m_is_complete = is_complete;
+    if (m_plugin && m_plugin->supports_incremental_decoding()) {
+        m_plugin->did_receive_data(data, size, is_complete);
+        return;
+    }
+
+    if (!is_complete && size < minimum_size_for_sniffing)
+        return;
+    create_plugin(data, size);
+    if (!m_plugin || is_complete)
+        return;
+    // Other plugins would hold on to data that may move, so they only get it once it has all arrived.
+    if (!m_plugin->supports_incremental_decoding()) {
+        m_plugin = nullptr;
+        return;
+    }
+    m_plugin->did_receive_data(data, size, false);
+}
+
+IncrementalDecodeResult ImageDecoder::decode_available_data()
+{
+    IncrementalDecodeResult result;
+    if (m_plugin && m_plugin->supports_incremental_decoding())
+        return m_plugin->decode_available_data();
+    if (!m_is_complete)
+        return result;
+
+    result.is_complete = true;
+    result.image = bitmap();
+    if (!result.image) {
+        result.has_failed = true;
+        return result;
+    }
+    result.changed_rect = result.image->rect();
+    return result;
+}
+
 RefPtr<Gfx::Bitmap> ImageDecoder::bitmap() const
 {
     if (!m_plugin)
@@ -30,6 +30,7 @@
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
+#include <LibGfx/Rect.h>
 #include <LibGfx/Size.h>
 
 namespace Gfx {
@@ -41,6 +42,15 @@ struct ImageFrameDescriptor {
     int duration { 0 };
 };
 
+struct IncrementalDecodeResult {
+    // The image decoded so far, or null if there isn't enough data to tell its size yet.
+    RefPtr<Bitmap> image;
+    // The part of image that changed since the previous call.
+    IntRect changed_rect;
+    bool is_complete { false };
+    bool has_failed { false };
+};
+
 class ImageDecoderPlugin {
 public:
     virtual ~ImageDecoderPlugin() { }
@@ -58,6 +68,17 @@ public:
     virtual size_t frame_count() = 0;
     virtual ImageFrameDescriptor frame(size_t i) = 0;
 
+    // Plugins that can make sense of a prefix of the data are told about more of it
+    // as it arrives, and when that was the last of it. The data may have moved since
+    // the previous call.
+    virtual bool supports_incremental_decoding() const { return false; }
+    virtual void did_receive_data(const u8*, size_t, bool) { }
+    virtual IncrementalDecodeResult decode_available_data() { return {}; }
+
+    // Plugins that can decode the image at a fraction of its size for less work do so
+    // when that still covers minimum_size. This has to be set before decoding starts.
+    virtual void set_minimum_size(const IntSize&) { }
+
 protected:
     ImageDecoderPlugin() { }
 };
@@ -66,6 +87,10 @@ class ImageDecoder : public RefCounted<ImageDecoder> {
 public:
     static NonnullRefPtr<ImageDecoder> create(const u8* data, size_t size) { return adopt(*new ImageDecoder(data, size)); }
     static NonnullRefPtr<ImageDecoder> create(const ByteBuffer& data) { return adopt(*new ImageDecoder(data.data(), data.size())); }
+
+    // For images that are still loading: data holds what has arrived so far, and
+    // did_receive_data() is called with all of it whenever more comes in.
+    static NonnullRefPtr<ImageDecoder> create_incremental(const u8* data, size_t size) { return adopt(*new ImageDecoder(data, size, false)); }
     ~ImageDecoder();
 
     bool is_valid() const { return m_plugin; }
@@ -86,10 +111,27 @@ public:
     size_t frame_count() const { return m_plugin ? m_plugin->frame_count() : 0; }
     ImageFrameDescriptor frame(size_t i) const { return m_plugin ? m_plugin->frame(i) : ImageFrameDescriptor(); }
 
+    bool is_complete() const { return m_is_complete; }
+    void did_receive_data(const u8*, size_t, bool is_complete);
+
+    // Decodes as much as the data received so far allows. Formats that can't be
+    // shown partially are decoded in one go once all of the data has arrived.
+    IncrementalDecodeResult decode_available_data();
+
+    // A hint that the image won't be shown larger than this, so the decoded bitmap may be
+    // smaller than size() (but still at least this large) if that saves work.
+    void set_minimum_size(const IntSize& minimum_size)
+    {
+        if (m_plugin)
+            m_plugin->set_minimum_size(minimum_size);
+    }
+
 private:
-    ImageDecoder(const u8*, size_t);
+    ImageDecoder(const u8*, size_t, bool is_complete = true);
+    void create_plugin(const u8*, size_t);
 
     mutable OwnPtr<ImageDecoderPlugin> m_plugin;
+    bool m_is_complete { true };
 };
 
 }
@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
 #include <AK/Bitmap.h>
 #include <AK/BufferStream.h>
 #include <AK/ByteBuffer.h>
@@ -33,7 +34,10 @@
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/JPGLoader.h>
+#include <LibGfx/PixelKernels.h>
+#include <LibThread/WorkerPool.h>
 #include <Libraries/LibM/math.h>
+#include <string.h>
 
 #define JPG_DBG 0
 #define jpg_dbg(x) \
@@ -90,6 +94,7 @@
 #define JPG_EOI 0xFFD9
 #define JPG_RST 0XFFDD
 #define JPG_SOF0 0XFFC0
+#define JPG_SOF1 0xFFC1
 #define JPG_SOF2 0xFFC2
 #define JPG_SOI 0XFFD8
 #define JPG_SOS 0XFFDA
@@ -110,40 +115,25 @@ constexpr static u8 zigzag_map[64] {
 
 using Marker = u16;
 
+// Huffman codes of up to this many bits are decoded with a single table lookup.
+constexpr static int huffman_lookup_bits = 9;
+
+// Images with fewer pixels than this are always decoded on the calling thread.
+constexpr static u32 minimum_pixels_for_threading = 256 * 256;
+
+static Atomic<size_t> s_decoder_thread_count { 1 };
+
 /**
  * MCU means group of data units that are coded together. A data unit is an 8x8
  * block of component data. In interleaved scans, number of non-interleaved data
  * units of a component C is Ch * Cv, where Ch and Cv represent the horizontal &
- * vertical subsampling factors of the component, respectively. A MacroBlock is
- * an 8x8 block of RGB values before encoding, and 8x8 block of YCbCr values when
- * we're done decoding the huffman stream.
+ * vertical subsampling factors of the component, respectively.
+ *
+ * Each component's blocks form a grid of blocks_per_line x block_rows, padded
+ * to whole MCUs. Coefficients are kept in natural (not zigzag) order, and are
+ * only stored for the whole image when a single pass over the data can't
+ * produce the final values (progressive or non-interleaved scans).
  */
-struct Macroblock {
-    union {
-        i32 y[64] = { 0 };
-        i32 r[64];
-    };
-
-    union {
-        i32 cb[64] = { 0 };
-        i32 g[64];
-    };
-
-    union {
-        i32 cr[64] = { 0 };
-        i32 b[64];
-    };
-};
-
-struct MacroblockMeta {
-    u32 total { 0 };
-    u32 padded_total { 0 };
-    u32 hcount { 0 };
-    u32 vcount { 0 };
-    u32 hpadded_count { 0 };
-    u32 vpadded_count { 0 };
-};
-
 struct ComponentSpec {
     i8 id { -1 };
     u8 hsample_factor { 1 }; // Horizontal sampling factor.
@@ -151,6 +141,12 @@ struct ComponentSpec {
     u8 ac_destination_id { 0 };
     u8 dc_destination_id { 0 };
     u8 qtable_id { 0 }; // Quantization table id.
+    u32 blocks_per_line { 0 };
+    u32 block_rows { 0 };
+    // The blocks that actually cover image data, which is what non-interleaved scans code.
+    u32 width_in_blocks { 0 };
+    u32 height_in_blocks { 0 };
+    Vector<i16> coefficients;
 };
 
 struct StartOfFrame {
@@ -184,12 +180,55 @@ struct HuffmanTableSpec {
     u8 code_counts[16] = { 0 };
     Vector<u8> symbols;
     Vector<u16> codes;
+
+    // Filled in by generate_huffman_codes(). lookup is indexed by the next
+    // huffman_lookup_bits bits of the stream and holds (code length << 8) | symbol,
+    // or 0 for longer codes. Those are found with max_code, the largest code of
+    // each length (-1 if there are none), and value_offset, which maps a code
+    // of that length to its index in symbols.
+    u16 lookup[1 << huffman_lookup_bits] = { 0 };
+    i32 max_code[17] = { 0 };
+    i32 value_offset[17] = { 0 };
+    bool is_defined { false };
 };
 
+// Reads the entropy-coded data straight from the file, removing the stuffed
+// zero bytes on the fly. Past the end of the segment (at a marker or at the end
+// of the data) it keeps producing zero bits, which lets the decoder peek ahead
+// freely; corrupt data just decodes to garbage instead of reading out of bounds.
 struct HuffmanStreamState {
-    Vector<u8> stream;
-    u8 bit_offset { 0 };
+    const u8* data { nullptr };
+    size_t size { 0 };
     size_t byte_offset { 0 };
+    u32 bit_buffer { 0 }; // The next bits of the stream, MSB first.
+    u8 bit_count { 0 };
+    bool hit_marker { false };
+    // Zero bytes that stand in for data that hasn't arrived (yet). They're always
+    // the last ones in bit_buffer.
+    u32 missing_bytes { 0 };
+};
+
+// The state of one run through (part of) a scan. Threads decoding different
+// restart intervals of the same scan each have their own.
+struct ScanState {
+    HuffmanStreamState stream;
+    i32 previous_dc_values[3] = { 0 };
+    u32 end_of_band_run { 0 };
+};
+
+// The output of one row of MCUs on its way to the bitmap: the samples of
+// each component at their own resolution, then upsampled one line at a time.
+struct MCURowBuffers {
+    Vector<i16> coefficients[3];
+    Vector<u8> planes[3];
+    Vector<u8> upsampled_lines[3];
+};
+
+enum class IncrementalPhase {
+    ReadingMarkers,
+    SequentialScan,
+    StoredScan,
+    Done,
 };
 
 struct JPGLoadingContext {
@@ -213,216 +252,806 @@ struct JPGLoadingContext {
     ComponentSpec components[3];
     RefPtr<Gfx::Bitmap> bitmap;
     u16 dc_reset_interval { 0 };
-    Vector<HuffmanTableSpec> dc_tables;
-    Vector<HuffmanTableSpec> ac_tables;
-    HuffmanStreamState huffman_stream;
-    i32 previous_dc_values[3] = { 0 };
-    MacroblockMeta mblock_meta;
+    HuffmanTableSpec dc_tables[4];
+    HuffmanTableSpec ac_tables[4];
+    u32 mcus_per_row { 0 };
+    u32 mcu_rows { 0 };
+
+    // The scan currently being decoded, as indices into components.
+    u8 scan_component_count { 0 };
+    u8 scan_components[3] = { 0 };
+    u8 spectral_selection_start { 0 };
+    u8 spectral_selection_end { 0 };
+    u8 successive_approximation_high { 0 };
+    u8 successive_approximation_low { 0 };
+    bool has_stored_coefficients { false };
+
+    // The image is decoded at 1/scale_denominator of its size (1, 2, 4 or 8),
+    // by running a smaller inverse DCT on the low frequencies of each block.
+    IntSize minimum_size;
+    u8 scale_denominator { 1 };
+    size_t thread_count { 1 };
+
+    // Quantization tables pre-multiplied with the scale factors of the AAN
+    // inverse DCT, and the basis functions of the reduced ones.
+    i32 idct_tables[2][64] = { { 0 } };
+    i32 reduced_idct_basis[4 * 4] = { 0 };
+
+    // Incremental decoding: data_size only covers what has arrived so far, and
+    // each call picks up at resume_offset (or next_mcu_row of a sequential scan).
+    bool is_data_complete { true };
+    IncrementalPhase incremental_phase { IncrementalPhase::ReadingMarkers };
+    size_t resume_offset { 0 };
+    size_t scan_search_offset { 0 };
+    ScanState sequential_state;
+    u32 next_mcu_row { 0 };
+    OwnPtr<MCURowBuffers> row_buffers;
+    IntRect changed_rect;
 };
 
-void generate_huffman_codes(HuffmanTableSpec& table)
+static bool generate_huffman_codes(HuffmanTableSpec& table)
 {
+    table.codes.clear();
+    __builtin_memset(table.lookup, 0, sizeof(table.lookup));
     unsigned code = 0;
-    for (auto number_of_codes : table.code_counts) {
-        for (int i = 0; i < number_of_codes; i++)
-            table.codes.append(code++);
+    size_t index = 0;
+    for (int length = 1; length <= 16; ++length) {
+        u8 count = table.code_counts[length - 1];
+        table.value_offset[length] = (i32)index - (i32)code;
+        for (int i = 0; i < count; ++i) {
+            if (code >= (1u << length) || index >= table.symbols.size())
+                return false;
+            table.codes.append(code);
+            if (length <= huffman_lookup_bits) {
+                int shift = huffman_lookup_bits - length;
+                u16 entry = (length << 8) | table.symbols[index];
+                for (unsigned fill = 0; fill < (1u << shift); ++fill)
+                    table.lookup[(code << shift) | fill] = entry;
+            }
+            ++code;
+            ++index;
+        }
+        table.max_code[length] = count ? (i32)code - 1 : -1;
         code <<= 1;
     }
+    table.is_defined = true;
+    return true;
 }
 
-Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t count = 1)
+ALWAYS_INLINE static void fill_bit_buffer(HuffmanStreamState& hstream)
 {
-    if (count > (8 * sizeof(size_t))) {
-        dbg() << String::format("Can't read %i bits at once!", count);
-        return {};
-    }
-    size_t value = 0;
-    while (count--) {
-        if (hstream.byte_offset >= hstream.stream.size()) {
-            dbg() << String::format("Huffman stream exhausted. This could be an error!");
-            return {};
-        }
-        u8 current_byte = hstream.stream[hstream.byte_offset];
-        u8 current_bit = 1u & (u32)(current_byte >> (7 - hstream.bit_offset)); // MSB first.
-        hstream.bit_offset++;
-        value = (value << 1) | (size_t)current_bit;
-        if (hstream.bit_offset == 8) {
-            hstream.byte_offset++;
-            hstream.bit_offset = 0;
+    while (hstream.bit_count <= 24) {
+        u32 byte = 0;
+        if (!hstream.hit_marker && hstream.byte_offset < hstream.size) {
+            byte = hstream.data[hstream.byte_offset];
+            if (byte != 0xFF) {
+                ++hstream.byte_offset;
+            } else if (hstream.byte_offset + 1 == hstream.size) {
+                // Whether this is a stuffed byte or a marker depends on data that hasn't arrived.
+                ++hstream.missing_bytes;
+                byte = 0;
+            } else if (hstream.data[hstream.byte_offset + 1] == 0x00) {
+                hstream.byte_offset += 2;
+            } else {
+                hstream.hit_marker = true;
+                byte = 0;
+            }
+        } else if (!hstream.hit_marker) {
+            ++hstream.missing_bytes;
         }
+        hstream.bit_buffer |= byte << (24 - hstream.bit_count);
+        hstream.bit_count += 8;
     }
+}
+
+ALWAYS_INLINE static void consume_bits(HuffmanStreamState& hstream, u8 count)
+{
+    hstream.bit_buffer <<= count;
+    hstream.bit_count -= count;
+}
+
+ALWAYS_INLINE static u32 read_huffman_bits(HuffmanStreamState& hstream, u8 count)
+{
+    if (!count)
+        return 0;
+    fill_bit_buffer(hstream);
+    u32 value = hstream.bit_buffer >> (32 - count);
+    consume_bits(hstream, count);
     return value;
 }
 
-Optional<u8> get_next_symbol(HuffmanStreamState& hstream, const HuffmanTableSpec& table)
+// Reads a coefficient (or DC difference) of the given magnitude category.
+ALWAYS_INLINE static i32 receive_and_extend(HuffmanStreamState& hstream, u8 length)
 {
-    unsigned code = 0;
-    size_t code_cursor = 0;
-    for (int i = 0; i < 16; i++) { // Codes can't be longer than 16 bits.
-        auto result = read_huffman_bits(hstream);
-        if (!result.has_value())
-            return {};
-        code = (code << 1) | (i32)result.release_value();
-        for (int j = 0; j < table.code_counts[i]; j++) {
-            if (code == table.codes[code_cursor])
-                return table.symbols[code_cursor];
-            code_cursor++;
+    if (!length)
+        return 0;
+    i32 value = read_huffman_bits(hstream, length);
+    if (value < (1 << (length - 1)))
+        value -= (1 << length) - 1;
+    return value;
+}
+
+ALWAYS_INLINE static Optional<u8> get_next_symbol(HuffmanStreamState& hstream, const HuffmanTableSpec& table)
+{
+    fill_bit_buffer(hstream);
+    u16 entry = table.lookup[hstream.bit_buffer >> (32 - huffman_lookup_bits)];
+    if (entry) {
+        consume_bits(hstream, entry >> 8);
+        return entry & 0xFF;
+    }
+
+    u32 bits = hstream.bit_buffer >> 16;
+    for (int length = huffman_lookup_bits + 1; length <= 16; ++length) {
+        i32 code = bits >> (16 - length);
+        if (code <= table.max_code[length]) {
+            consume_bits(hstream, length);
+            return table.symbols[code + table.value_offset[length]];
         }
     }
 
-    dbg() << "If you're seeing this...the jpeg decoder needs to support more kinds of JPEGs!";
+    jpg_dbg("If you're seeing this...the jpeg decoder needs to support more kinds of JPEGs!");
     return {};
 }
 
-/**
- * Build the macroblocks possible by reading single (MCU) subsampled pair of CbCr.
- * Depending on the sampling factors, we may not see triples of y, cb, cr in that
- * order. If sample factors differ from one, we'll read more than one block of y-
- * coefficients before we get to read a cb-cr block.
-
- * In the function below, `hcursor` and `vcursor` denote the location of the block
- * we're building in the macroblock matrix. `vfactor_i` and `hfactor_i` are cursors
- * that iterate over the vertical and horizontal subsampling factors, respectively.
- * When we finish one iteration of the innermost loop, we'll have the coefficients
- * of one of the components of block at position `mb_index`. When the outermost loop
- * finishes first iteration, we'll have all the luminance coefficients for all the
- * macroblocks that share the chrominance data. Next two iterations (assuming that
- * we are dealing with three components) will fill up the blocks with chroma data.
- */
-bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u8 hcursor, u8 vcursor)
+// Moves the stream past the next RSTn marker and resets the predictions, as
+// is done at the start of every restart interval.
+static void handle_restart(ScanState& state)
+{
+    auto& hstream = state.stream;
+    hstream.bit_buffer = 0;
+    hstream.bit_count = 0;
+    hstream.hit_marker = false;
+    while (hstream.byte_offset + 1 < hstream.size) {
+        if (hstream.data[hstream.byte_offset] != 0xFF) {
+            ++hstream.byte_offset;
+            continue;
+        }
+        u8 next = hstream.data[hstream.byte_offset + 1];
+        if (next >= 0xD0 && next <= 0xD7) {
+            hstream.byte_offset += 2;
+            break;
+        }
+        if (next != 0x00 && next != 0xFF) {
+            // Some other marker, so this interval is missing. Decode zeros.
+            hstream.hit_marker = true;
+            break;
+        }
+        ++hstream.byte_offset;
+    }
+    for (auto& value : state.previous_dc_values)
+        value = 0;
+    state.end_of_band_run = 0;
+}
+
+static bool decode_sequential_block(ScanState& state, const JPGLoadingContext& context, u8 component_index, i16* block)
 {
-    for (u32 cindex = 0; cindex < context.component_count; cindex++) {
-        auto& component = context.components[cindex];
-        for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-            for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                Macroblock& block = macroblocks[mb_index];
+    auto& hstream = state.stream;
+    auto& component = context.components[component_index];
+    __builtin_memset(block, 0, 64 * sizeof(i16));
 
-                auto& dc_table = context.dc_tables[component.dc_destination_id];
-                auto& ac_table = context.ac_tables[component.ac_destination_id];
+    auto symbol = get_next_symbol(hstream, context.dc_tables[component.dc_destination_id]);
+    if (!symbol.has_value())
+        return false;
+    // For DC coefficients, symbol encodes the length of the coefficient.
+    u8 dc_length = symbol.value();
+    if (dc_length > 11) {
+        dbg() << String::format("DC coefficient too long: %i!", dc_length);
+        return false;
+    }
+    // DC coefficients are encoded as the difference between previous and current DC values.
+    i32& previous_dc = state.previous_dc_values[component_index];
+    previous_dc += receive_and_extend(hstream, dc_length);
+    block[0] = previous_dc;
+
+    auto& ac_table = context.ac_tables[component.ac_destination_id];
+    for (int j = 1; j < 64;) {
+        symbol = get_next_symbol(hstream, ac_table);
+        if (!symbol.has_value())
+            return false;
 
-                auto symbol_or_error = get_next_symbol(context.huffman_stream, dc_table);
-                if (!symbol_or_error.has_value())
-                    return false;
+        // AC symbols encode 2 pieces of information, the high 4 bits represent
+        // number of zeroes to be stuffed before reading the coefficient. Low 4
+        // bits represent the magnitude of the coefficient.
+        u8 ac_symbol = symbol.value();
+        if (ac_symbol == 0)
+            break;
 
-                // For DC coefficients, symbol encodes the length of the coefficient.
-                auto dc_length = symbol_or_error.release_value();
-                if (dc_length > 11) {
-                    dbg() << String::format("DC coefficient too long: %i!", dc_length);
-                    return false;
+        // ac_symbol = 0xF0 means we need to skip 16 zeroes.
+        u8 run_length = ac_symbol == 0xF0 ? 16 : ac_symbol >> 4;
+        j += run_length;
+        u8 coeff_length = ac_symbol & 0x0F;
+        if (!coeff_length)
+            continue;
+        if (j >= 64) {
+            dbg() << String::format("Run-length exceeded boundaries. Cursor: %i, Skipping: %i!", j, run_length);
+            return false;
+        }
+        if (coeff_length > 10) {
+            dbg() << String::format("AC coefficient too long: %i!", coeff_length);
+            return false;
+        }
+        block[zigzag_map[j++]] = receive_and_extend(hstream, coeff_length);
+    }
+    return true;
+}
+
+// Progressive scans code either the DC coefficients of all components or a
+// band of AC coefficients of a single one. The first scan of a band codes the
+// high bits of each coefficient, later ones refine them one bit at a time.
+static bool decode_progressive_block(ScanState& state, const JPGLoadingContext& context, u8 component_index, i16* block)
+{
+    auto& hstream = state.stream;
+    auto& component = context.components[component_index];
+    u8 spectral_selection_start = context.spectral_selection_start;
+    u8 spectral_selection_end = context.spectral_selection_end;
+    u8 shift = context.successive_approximation_low;
+
+    if (spectral_selection_start == 0) {
+        if (context.successive_approximation_high) {
+            if (read_huffman_bits(hstream, 1))
+                block[0] |= 1 << shift;
+            return true;
+        }
+        auto symbol = get_next_symbol(hstream, context.dc_tables[component.dc_destination_id]);
+        if (!symbol.has_value() || symbol.value() > 11)
+            return false;
+        i32& previous_dc = state.previous_dc_values[component_index];
+        previous_dc += receive_and_extend(hstream, symbol.value());
+        block[0] = previous_dc * (1 << shift);
+        return true;
+    }
+
+    auto& ac_table = context.ac_tables[component.ac_destination_id];
+    if (!context.successive_approximation_high) {
+        if (state.end_of_band_run) {
+            --state.end_of_band_run;
+            return true;
+        }
+        for (int k = spectral_selection_start; k <= spectral_selection_end;) {
+            auto symbol = get_next_symbol(hstream, ac_table);
+            if (!symbol.has_value())
+                return false;
+            u8 run_length = symbol.value() >> 4;
+            u8 coeff_length = symbol.value() & 0x0F;
+            if (!coeff_length) {
+                if (run_length < 15) {
+                    // The end of this block's band, and of the next (1 << r) - 1 + (r more bits) ones.
+                    state.end_of_band_run = (1 << run_length) - 1 + read_huffman_bits(hstream, run_length);
+                    break;
                 }
+                k += 16;
+                continue;
+            }
+            k += run_length;
+            if (k > spectral_selection_end || coeff_length > 10)
+                return false;
+            block[zigzag_map[k++]] = receive_and_extend(hstream, coeff_length) * (1 << shift);
+        }
+        return true;
+    }
 
-                auto coeff_or_error = read_huffman_bits(context.huffman_stream, dc_length);
-                if (!coeff_or_error.has_value())
+    // Refinement: each coefficient that is already nonzero gets one correction bit,
+    // and the symbols place coefficients that become nonzero (+-1) in between them.
+    i16 bit = 1 << shift;
+    auto refine = [&](i16& coefficient) {
+        if (read_huffman_bits(hstream, 1) && !(coefficient & bit))
+            coefficient += coefficient > 0 ? bit : -bit;
+    };
+
+    int k = spectral_selection_start;
+    if (!state.end_of_band_run) {
+        for (; k <= spectral_selection_end;) {
+            auto symbol = get_next_symbol(hstream, ac_table);
+            if (!symbol.has_value())
+                return false;
+            int zeros_to_skip = symbol.value() >> 4;
+            u8 coeff_length = symbol.value() & 0x0F;
+            i16 value = 0;
+            if (!coeff_length) {
+                if (zeros_to_skip < 15) {
+                    state.end_of_band_run = (1 << zeros_to_skip) + read_huffman_bits(hstream, zeros_to_skip);
+                    break;
+                }
+            } else {
+                if (coeff_length != 1)
                     return false;
+                value = read_huffman_bits(hstream, 1) ? bit : -bit;
+            }
 
-                // DC coefficients are encoded as the difference between previous and current DC values.
-                i32 dc_diff = coeff_or_error.release_value();
+            while (k <= spectral_selection_end) {
+                i16& coefficient = block[zigzag_map[k++]];
+                if (coefficient) {
+                    refine(coefficient);
+                } else {
+                    if (!zeros_to_skip) {
+                        coefficient = value;
+                        break;
+                    }
+                    --zeros_to_skip;
+                }
+            }
+        }
+    }
 
-                // If MSB in diff is 0, the difference is -ve. Otherwise +ve.
-                if (dc_length != 0 && dc_diff < (1 << (dc_length - 1)))
-                    dc_diff -= (1 << dc_length) - 1;
+    if (state.end_of_band_run) {
+        // Only the coefficients that are already nonzero are refined for the rest of the band.
+        for (; k <= spectral_selection_end; ++k) {
+            i16& coefficient = block[zigzag_map[k]];
+            if (coefficient)
+                refine(coefficient);
+        }
+        --state.end_of_band_run;
+    }
+    return true;
+}
 
-                i32* select_component = component.id == 1 ? block.y : (component.id == 2 ? block.cb : block.cr);
-                auto& previous_dc = context.previous_dc_values[cindex];
-                select_component[0] = previous_dc += dc_diff;
+// The AAN (Arai, Agui & Nakajima) inverse DCT in 8-bit fixed point, after the
+// IJG's jidctfst.c. Most of its multiplications are folded into the
+// quantization table (see prepare_idct_tables()), leaving 5 per 8 samples.
+// The tables are more precise than the IJG's, which keeps high quality images
+// (with small quantizers) within a level or two of an exact inverse DCT.
+constexpr static int aan_fixed_point_bits = 8;
+constexpr static int aan_table_bits = 12;
+constexpr static int aan_pass1_bits = 3;
 
-                // Compute the AC coefficients.
-                for (int j = 1; j < 64;) {
-                    symbol_or_error = get_next_symbol(context.huffman_stream, ac_table);
-                    if (!symbol_or_error.has_value())
-                        return false;
+constexpr static i32 aan_fix(double value)
+{
+    return (i32)(value * (1 << aan_fixed_point_bits) + 0.5);
+}
 
-                    // AC symbols encode 2 pieces of information, the high 4 bits represent
-                    // number of zeroes to be stuffed before reading the coefficient. Low 4
-                    // bits represent the magnitude of the coefficient.
-                    auto ac_symbol = symbol_or_error.release_value();
-                    if (ac_symbol == 0)
-                        break;
+constexpr static i32 fix_1_082392200 = aan_fix(1.082392200);
+constexpr static i32 fix_1_414213562 = aan_fix(1.414213562);
+constexpr static i32 fix_1_847759065 = aan_fix(1.847759065);
+constexpr static i32 fix_2_613125930 = aan_fix(2.613125930);
 
-                    // ac_symbol = 0xF0 means we need to skip 16 zeroes.
-                    u8 run_length = ac_symbol == 0xF0 ? 16 : ac_symbol >> 4;
-                    j += run_length;
+ALWAYS_INLINE static i32 dequantize(i16 coefficient, i32 scaled_quantizer)
+{
+    constexpr int shift = aan_table_bits - aan_pass1_bits;
+    return (coefficient * scaled_quantizer + (1 << (shift - 1))) >> shift;
+}
 
-                    if (j >= 64) {
-                        dbg() << String::format("Run-length exceeded boundaries. Cursor: %i, Skipping: %i!", j, run_length);
-                        return false;
-                    }
+ALWAYS_INLINE static i32 aan_multiply(i32 value, i32 constant)
+{
+    return (value * constant) >> aan_fixed_point_bits;
+}
 
-                    u8 coeff_length = ac_symbol & 0x0F;
-                    if (coeff_length > 10) {
-                        dbg() << String::format("AC coefficient too long: %i!", coeff_length);
-                        return false;
-                    }
+ALWAYS_INLINE static u8 descale_and_clamp(i32 value)
+{
+    value = (value + (1 << (aan_pass1_bits + 2))) >> (aan_pass1_bits + 3);
+    value += 128;
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
 
-                    if (coeff_length != 0) {
-                        coeff_or_error = read_huffman_bits(context.huffman_stream, coeff_length);
-                        if (!coeff_or_error.has_value())
-                            return false;
-                        i32 ac_coefficient = coeff_or_error.release_value();
-                        if (ac_coefficient < (1 << (coeff_length - 1)))
-                            ac_coefficient -= (1 << coeff_length) - 1;
+static void inverse_dct_8x8(const i16* coefficients, const i32* table, u8* output, size_t stride)
+{
+    i32 workspace[64];
+
+    for (int column = 0; column < 8; ++column) {
+        const i16* in = coefficients + column;
+        const i32* quantization = table + column;
+        i32* out = workspace + column;
+
+        // Most columns of a typical block are zero, except for the DC coefficient.
+        if (!(in[8] | in[16] | in[24] | in[32] | in[40] | in[48] | in[56])) {
+            i32 dc = dequantize(in[0], quantization[0]);
+            for (int row = 0; row < 8; ++row)
+                out[row * 8] = dc;
+            continue;
+        }
 
-                        select_component[zigzag_map[j++]] = ac_coefficient;
-                    }
-                }
+        i32 tmp0 = dequantize(in[0], quantization[0]);
+        i32 tmp1 = dequantize(in[16], quantization[16]);
+        i32 tmp2 = dequantize(in[32], quantization[32]);
+        i32 tmp3 = dequantize(in[48], quantization[48]);
+
+        i32 tmp10 = tmp0 + tmp2;
+        i32 tmp11 = tmp0 - tmp2;
+        i32 tmp13 = tmp1 + tmp3;
+        i32 tmp12 = aan_multiply(tmp1 - tmp3, fix_1_414213562) - tmp13;
+
+        tmp0 = tmp10 + tmp13;
+        tmp3 = tmp10 - tmp13;
+        tmp1 = tmp11 + tmp12;
+        tmp2 = tmp11 - tmp12;
+
+        i32 tmp4 = dequantize(in[8], quantization[8]);
+        i32 tmp5 = dequantize(in[24], quantization[24]);
+        i32 tmp6 = dequantize(in[40], quantization[40]);
+        i32 tmp7 = dequantize(in[56], quantization[56]);
+
+        i32 z13 = tmp6 + tmp5;
+        i32 z10 = tmp6 - tmp5;
+        i32 z11 = tmp4 + tmp7;
+        i32 z12 = tmp4 - tmp7;
+
+        tmp7 = z11 + z13;
+        tmp11 = aan_multiply(z11 - z13, fix_1_414213562);
+        i32 z5 = aan_multiply(z10 + z12, fix_1_847759065);
+        tmp10 = aan_multiply(z12, fix_1_082392200) - z5;
+        tmp12 = aan_multiply(z10, -fix_2_613125930) + z5;
+
+        tmp6 = tmp12 - tmp7;
+        tmp5 = tmp11 - tmp6;
+        tmp4 = tmp10 + tmp5;
+
+        out[0] = tmp0 + tmp7;
+        out[56] = tmp0 - tmp7;
+        out[8] = tmp1 + tmp6;
+        out[48] = tmp1 - tmp6;
+        out[16] = tmp2 + tmp5;
+        out[40] = tmp2 - tmp5;
+        out[32] = tmp3 + tmp4;
+        out[24] = tmp3 - tmp4;
+    }
+
+    for (int row = 0; row < 8; ++row) {
+        const i32* in = workspace + row * 8;
+        u8* out = output + row * stride;
+
+        if (!(in[1] | in[2] | in[3] | in[4] | in[5] | in[6] | in[7])) {
+            __builtin_memset(out, descale_and_clamp(in[0]), 8);
+            continue;
+        }
+
+        i32 tmp10 = in[0] + in[4];
+        i32 tmp11 = in[0] - in[4];
+        i32 tmp13 = in[2] + in[6];
+        i32 tmp12 = aan_multiply(in[2] - in[6], fix_1_414213562) - tmp13;
+
+        i32 tmp0 = tmp10 + tmp13;
+        i32 tmp3 = tmp10 - tmp13;
+        i32 tmp1 = tmp11 + tmp12;
+        i32 tmp2 = tmp11 - tmp12;
+
+        i32 z13 = in[5] + in[3];
+        i32 z10 = in[5] - in[3];
+        i32 z11 = in[1] + in[7];
+        i32 z12 = in[1] - in[7];
+
+        i32 tmp7 = z11 + z13;
+        tmp11 = aan_multiply(z11 - z13, fix_1_414213562);
+        i32 z5 = aan_multiply(z10 + z12, fix_1_847759065);
+        tmp10 = aan_multiply(z12, fix_1_082392200) - z5;
+        tmp12 = aan_multiply(z10, -fix_2_613125930) + z5;
+
+        i32 tmp6 = tmp12 - tmp7;
+        i32 tmp5 = tmp11 - tmp6;
+        i32 tmp4 = tmp10 + tmp5;
+
+        out[0] = descale_and_clamp(tmp0 + tmp7);
+        out[7] = descale_and_clamp(tmp0 - tmp7);
+        out[1] = descale_and_clamp(tmp1 + tmp6);
+        out[6] = descale_and_clamp(tmp1 - tmp6);
+        out[2] = descale_and_clamp(tmp2 + tmp5);
+        out[5] = descale_and_clamp(tmp2 - tmp5);
+        out[4] = descale_and_clamp(tmp3 + tmp4);
+        out[3] = descale_and_clamp(tmp3 - tmp4);
+    }
+}
+
+// The reduced inverse DCTs run on 12-bit fixed point basis functions, and keep
+// 2 fractional bits between their passes.
+constexpr static int reduced_idct_bits = 12;
+constexpr static int reduced_idct_pass1_bits = 2;
+
+ALWAYS_INLINE static u8 clamp_sample(i32 value)
+{
+    value += 128;
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// Produces a size x size block (4, 2 or 1) from the lowest frequencies of a
+// block, which is the block scaled down with a good low-pass filter.
+static void inverse_dct_reduced(const i16* coefficients, const u32* table, const i32* basis, int size, u8* output, size_t stride)
+{
+    if (size == 1) {
+        *output = clamp_sample((coefficients[0] * (i32)table[0] + 4) >> 3);
+        return;
+    }
+
+    i32 workspace[4 * 4];
+    for (int u = 0; u < size; ++u) {
+        i32 dequantized[4];
+        bool is_zero = true;
+        for (int v = 0; v < size; ++v) {
+            dequantized[v] = coefficients[v * 8 + u] * (i32)table[v * 8 + u];
+            is_zero &= !dequantized[v];
+        }
+        for (int y = 0; y < size; ++y) {
+            i32 sum = 0;
+            if (!is_zero) {
+                for (int v = 0; v < size; ++v)
+                    sum += basis[y * size + v] * dequantized[v];
             }
+            workspace[y * size + u] = (sum + (1 << (reduced_idct_bits - reduced_idct_pass1_bits - 1))) >> (reduced_idct_bits - reduced_idct_pass1_bits);
         }
     }
 
-    return true;
+    constexpr int shift = reduced_idct_bits + reduced_idct_pass1_bits;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            i32 sum = 1 << (shift - 1);
+            for (int u = 0; u < size; ++u)
+                sum += basis[x * size + u] * workspace[y * size + u];
+            output[y * stride + x] = clamp_sample(sum >> shift);
+        }
+    }
 }
 
-Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& context)
+static void prepare_idct_tables(JPGLoadingContext& context)
 {
-    Vector<Macroblock> macroblocks;
-    macroblocks.resize(context.mblock_meta.padded_total);
+    // The AAN scale factors are 1 for k = 0 and cos(k * pi / 16) * sqrt(2) otherwise.
+    float scale_factors[8];
+    for (int k = 0; k < 8; ++k)
+        scale_factors[k] = k ? cosf(k * M_PI / 16) * sqrtf(2) : 1;
+    for (int i = 0; i < 64; ++i) {
+        float scale = scale_factors[i / 8] * scale_factors[i % 8] * (1 << aan_table_bits);
+        context.idct_tables[0][i] = (i32)roundf(context.luma_table[i] * scale);
+        context.idct_tables[1][i] = (i32)roundf(context.chroma_table[i] * scale);
+    }
 
-    jpg_dbg("Image width: " << context.frame.width);
-    jpg_dbg("Image height: " << context.frame.height);
-    jpg_dbg("Macroblocks in a row: " << context.mblock_meta.hpadded_count);
-    jpg_dbg("Macroblocks in a column: " << context.mblock_meta.vpadded_count);
+    // basis[x][u] = C(u) / 2 * cos((2x + 1) * u * pi / 2N), with C(0) = 1 / sqrt(2) and C(u) = 1 otherwise.
+    // This keeps the DC scaling of the full 8x8 transform, so the average of each block is preserved.
+    int size = 8 / context.scale_denominator;
+    if (size == 8)
+        return;
+    for (int x = 0; x < size; ++x) {
+        for (int u = 0; u < size; ++u) {
+            float c = u ? 1 : 1 / sqrtf(2);
+            context.reduced_idct_basis[x * size + u] = (i32)roundf(c / 2 * cosf((2 * x + 1) * u * M_PI / (2 * size)) * (1 << reduced_idct_bits));
+        }
+    }
+}
 
-    // Compute huffman codes for DC and AC tables.
-    for (auto& dc_table : context.dc_tables)
-        generate_huffman_codes(dc_table);
+static void allocate_output_buffers(JPGLoadingContext& context, MCURowBuffers& buffers)
+{
+    u32 block_size = 8 / context.scale_denominator;
+    for (int i = 0; i < context.component_count; ++i) {
+        auto& component = context.components[i];
+        buffers.planes[i].resize(component.blocks_per_line * block_size * component.vsample_factor * block_size);
+        if (component.hsample_factor != context.hsample_factor)
+            buffers.upsampled_lines[i].resize(context.bitmap->width());
+    }
+}
 
-    for (auto& ac_table : context.ac_tables)
-        generate_huffman_codes(ac_table);
+// Runs the inverse DCT on one row of MCUs and writes the resulting pixels.
+// component_blocks points to the first block of the row for each component.
+static void output_mcu_row(JPGLoadingContext& context, u32 mcu_row, const i16* const* component_blocks, MCURowBuffers& buffers)
+{
+    u32 block_size = 8 / context.scale_denominator;
+    for (int i = 0; i < context.component_count; ++i) {
+        auto& component = context.components[i];
+        size_t stride = component.blocks_per_line * block_size;
+        u8 table_index = component.qtable_id;
+        for (u32 v = 0; v < component.vsample_factor; ++v) {
+            for (u32 block_x = 0; block_x < component.blocks_per_line; ++block_x) {
+                const i16* block = component_blocks[i] + (v * component.blocks_per_line + block_x) * 64;
+                u8* output = buffers.planes[i].data() + v * block_size * stride + block_x * block_size;
+                if (block_size == 8)
+                    inverse_dct_8x8(block, context.idct_tables[table_index], output, stride);
+                else
+                    inverse_dct_reduced(block, table_index ? context.chroma_table : context.luma_table, context.reduced_idct_basis, block_size, output, stride);
+            }
+        }
+    }
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            if (context.dc_reset_interval > 0) {
-                if (i % context.dc_reset_interval == 0) {
-                    context.previous_dc_values[0] = 0;
-                    context.previous_dc_values[1] = 0;
-                    context.previous_dc_values[2] = 0;
+    auto& bitmap = *context.bitmap;
+    int width = bitmap.width();
+    u32 lines_per_mcu = context.vsample_factor * block_size;
+    u32 first_line = mcu_row * lines_per_mcu;
+    auto& kernels = pixel_kernels();
+    for (u32 line = 0; line < lines_per_mcu && first_line + line < (u32)bitmap.height(); ++line) {
+        const u8* samples[3];
+        for (int i = 0; i < context.component_count; ++i) {
+            auto& component = context.components[i];
+            size_t stride = component.blocks_per_line * block_size;
+            // Chroma subsampling is undone by repeating samples.
+            const u8* source = buffers.planes[i].data() + (line * component.vsample_factor / context.vsample_factor) * stride;
+            if (component.hsample_factor == context.hsample_factor) {
+                samples[i] = source;
+                continue;
+            }
+            int repeat = context.hsample_factor / component.hsample_factor;
+            u8* upsampled = buffers.upsampled_lines[i].data();
+            for (int x = 0; x < width; ++source) {
+                for (int j = 0; j < repeat && x < width; ++j)
+                    upsampled[x++] = *source;
+            }
+            samples[i] = upsampled;
+        }
 
-                    // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
-                    //  the 0th bit of the next byte.
-                    if (context.huffman_stream.byte_offset < context.huffman_stream.stream.size()) {
-                        if (context.huffman_stream.bit_offset > 0) {
-                            context.huffman_stream.bit_offset = 0;
-                            context.huffman_stream.byte_offset++;
-                        }
+        RGBA32* pixels = bitmap.scanline(first_line + line);
+        if (context.component_count == 1) {
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(samples[0][x], samples[0][x], samples[0][x]).value();
+        } else {
+            kernels.ycbcr_to_rgb_row(pixels, samples[0], samples[1], samples[2], width);
+        }
+    }
+}
 
-                        // Skip the restart marker (RSTn).
-                        context.huffman_stream.byte_offset++;
+static bool run_jobs(JPGLoadingContext& context, size_t job_count, Function<bool(size_t)> job)
+{
+    Vector<u8> results;
+    results.resize(job_count);
+    if (context.thread_count > 1 && job_count > 1) {
+        LibThread::WorkerPool pool(min(context.thread_count, job_count), "JPGDecoder");
+        pool.run(job_count, [&](size_t index) { results[index] = job(index); });
+    } else {
+        for (size_t i = 0; i < job_count; ++i)
+            results[i] = job(i);
+    }
+    for (auto result : results) {
+        if (!result)
+            return false;
+    }
+    return true;
+}
+
+// Decodes the coefficients of one row of MCUs into buffers.coefficients.
+static bool decode_sequential_mcu_row(JPGLoadingContext& context, ScanState& state, u32 mcu_row, MCURowBuffers& buffers, bool stream_is_at_interval_start)
+{
+    for (u32 mcu_column = 0; mcu_column < context.mcus_per_row; ++mcu_column) {
+        u32 mcu_index = mcu_row * context.mcus_per_row + mcu_column;
+        if (context.dc_reset_interval && mcu_index % context.dc_reset_interval == 0 && !(mcu_column == 0 && stream_is_at_interval_start))
+            handle_restart(state);
+
+        for (int i = 0; i < context.scan_component_count; ++i) {
+            u8 component_index = context.scan_components[i];
+            auto& component = context.components[component_index];
+            i16* blocks = buffers.coefficients[component_index].data();
+            for (u32 v = 0; v < component.vsample_factor; ++v) {
+                for (u32 h = 0; h < component.hsample_factor; ++h) {
+                    u32 block_x = mcu_column * component.hsample_factor + h;
+                    if (!decode_sequential_block(state, context, component_index, blocks + (v * component.blocks_per_line + block_x) * 64)) {
+                        dbg() << "Failed to decode MCU " << mcu_index << "!";
+                        return false;
                     }
                 }
             }
+        }
+    }
+    return true;
+}
 
-            if (!build_macroblocks(context, macroblocks, hcursor, vcursor)) {
-                dbg() << "Failed to build Macroblock " << i;
-                dbg() << "Huffman stream byte offset " << context.huffman_stream.byte_offset;
-                dbg() << "Huffman stream bit offset " << context.huffman_stream.bit_offset;
-                return {};
+static void allocate_row_buffers(JPGLoadingContext& context, MCURowBuffers& buffers, const i16** component_blocks)
+{
+    allocate_output_buffers(context, buffers);
+    for (int i = 0; i < context.component_count; ++i) {
+        auto& component = context.components[i];
+        buffers.coefficients[i].resize(component.blocks_per_line * component.vsample_factor * 64);
+        component_blocks[i] = buffers.coefficients[i].data();
+    }
+}
+
+static bool decode_sequential_mcu_rows(JPGLoadingContext& context, ScanState& state, u32 first_row, u32 end_row)
+{
+    MCURowBuffers buffers;
+    const i16* component_blocks[3];
+    allocate_row_buffers(context, buffers, component_blocks);
+
+    for (u32 mcu_row = first_row; mcu_row < end_row; ++mcu_row) {
+        // The stream starts at the beginning of an interval, so the first MCU needs no restart.
+        if (!decode_sequential_mcu_row(context, state, mcu_row, buffers, mcu_row == first_row))
+            return false;
+        output_mcu_row(context, mcu_row, component_blocks, buffers);
+    }
+    return true;
+}
+
+// A sequential scan that codes all components is decoded and turned into
+// pixels one row of MCUs at a time, so the coefficients never leave the cache.
+// Each restart interval starts with fresh predictions at a known offset, so
+// with enough of them, bands of MCU rows are decoded in parallel.
+static bool decode_sequential_scan(JPGLoadingContext& context, const Vector<size_t>& interval_offsets, size_t scan_end)
+{
+    Vector<u32> first_rows;
+    first_rows.append(0);
+    if (context.thread_count > 1 && context.dc_reset_interval) {
+        u32 rows_per_job = max(1u, context.mcu_rows / (u32)(context.thread_count * 2));
+        for (u32 mcu_row = 1; mcu_row < context.mcu_rows; ++mcu_row) {
+            if ((mcu_row * context.mcus_per_row) % context.dc_reset_interval == 0 && mcu_row - first_rows.last() >= rows_per_job)
+                first_rows.append(mcu_row);
+        }
+    }
+
+    return run_jobs(context, first_rows.size(), [&](size_t job) {
+        u32 first_row = first_rows[job];
+        u32 end_row = job + 1 < first_rows.size() ? first_rows[job + 1] : context.mcu_rows;
+        size_t interval = context.dc_reset_interval ? first_row * context.mcus_per_row / context.dc_reset_interval : 0;
+        ScanState state;
+        state.stream.data = context.data;
+        state.stream.size = scan_end;
+        state.stream.byte_offset = interval < interval_offsets.size() ? interval_offsets[interval] : scan_end;
+        return decode_sequential_mcu_rows(context, state, first_row, end_row);
+    });
+}
+
+// Progressive and non-interleaved scans each only provide part of the
+// coefficients, so they are accumulated for the whole image first.
+static bool decode_scan_coefficients(JPGLoadingContext& context, size_t scan_start, size_t scan_end)
+{
+    if (!context.has_stored_coefficients) {
+        for (int i = 0; i < context.component_count; ++i) {
+            auto& component = context.components[i];
+            component.coefficients.resize(component.blocks_per_line * component.block_rows * 64);
+            __builtin_memset(component.coefficients.data(), 0, component.coefficients.size() * sizeof(i16));
+        }
+        context.has_stored_coefficients = true;
+    }
+
+    ScanState state;
+    state.stream.data = context.data;
+    state.stream.size = scan_end;
+    state.stream.byte_offset = scan_start;
+    bool is_progressive = context.frame.type == StartOfFrame::FrameType::Progressive_DCT;
+    u32 mcus_until_restart = context.dc_reset_interval;
+    auto decode_block = [&](u8 component_index, u32 block_x, u32 block_y) {
+        auto& component = context.components[component_index];
+        i16* block = component.coefficients.data() + (block_y * component.blocks_per_line + block_x) * 64;
+        if (is_progressive)
+            return decode_progressive_block(state, context, component_index, block);
+        return decode_sequential_block(state, context, component_index, block);
+    };
+    auto start_mcu = [&] {
+        if (!context.dc_reset_interval)
+            return;
+        if (!mcus_until_restart) {
+            handle_restart(state);
+            mcus_until_restart = context.dc_reset_interval;
+        }
+        --mcus_until_restart;
+    };
+
+    // A non-interleaved scan codes the blocks of one component left to right, top to bottom,
+    // and each block is an MCU of its own.
+    if (context.scan_component_count == 1) {
+        u8 component_index = context.scan_components[0];
+        auto& component = context.components[component_index];
+        for (u32 block_y = 0; block_y < component.height_in_blocks; ++block_y) {
+            for (u32 block_x = 0; block_x < component.width_in_blocks; ++block_x) {
+                start_mcu();
+                if (!decode_block(component_index, block_x, block_y))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    for (u32 mcu_row = 0; mcu_row < context.mcu_rows; ++mcu_row) {
+        for (u32 mcu_column = 0; mcu_column < context.mcus_per_row; ++mcu_column) {
+            start_mcu();
+            for (int i = 0; i < context.scan_component_count; ++i) {
+                u8 component_index = context.scan_components[i];
+                auto& component = context.components[component_index];
+                for (u32 v = 0; v < component.vsample_factor; ++v) {
+                    for (u32 h = 0; h < component.hsample_factor; ++h) {
+                        if (!decode_block(component_index, mcu_column * component.hsample_factor + h, mcu_row * component.vsample_factor + v))
+                            return false;
+                    }
+                }
             }
         }
     }
+    return true;
+}
 
-    return macroblocks;
+static bool output_stored_coefficients(JPGLoadingContext& context)
+{
+    u32 job_count = context.thread_count > 1 ? min(context.mcu_rows, (u32)context.thread_count * 2) : 1;
+    return run_jobs(context, job_count, [&](size_t job) {
+        MCURowBuffers buffers;
+        allocate_output_buffers(context, buffers);
+        for (u32 mcu_row = job * context.mcu_rows / job_count; mcu_row < (job + 1) * context.mcu_rows / job_count; ++mcu_row) {
+            const i16* component_blocks[3];
+            for (int i = 0; i < context.component_count; ++i) {
+                auto& component = context.components[i];
+                component_blocks[i] = component.coefficients.data() + mcu_row * component.vsample_factor * component.blocks_per_line * 64;
+            }
+            output_mcu_row(context, mcu_row, component_blocks, buffers);
+        }
+        return true;
+    });
 }
 
 static inline bool bounds_okay(const size_t cursor, const size_t delta, const size_t bound)
@@ -449,8 +1078,11 @@ static inline bool is_valid_marker(const Marker marker)
     case JPG_DQT:
     case JPG_RST:
     case JPG_SOF0:
+    case JPG_SOF1:
+    case JPG_SOF2:
     case JPG_SOI:
     case JPG_SOS:
+    case JPG_EOI:
         return true;
     }
 
@@ -507,37 +1139,40 @@ static bool read_start_of_scan(BufferStream& stream, JPGLoadingContext& context)
     stream >> component_count;
     if (stream.handle_read_failure())
         return false;
-    if (component_count != context.component_count) {
+    if (component_count < 1 || component_count > context.component_count) {
         dbg() << stream.offset()
               << String::format(": Unsupported number of components: %i!", component_count);
         return false;
     }
+    context.scan_component_count = component_count;
 
     for (int i = 0; i < component_count; i++) {
-        ComponentSpec* component = nullptr;
         u8 component_id;
         stream >> component_id;
         if (stream.handle_read_failure())
             return false;
         component_id += context.has_zero_based_ids ? 1 : 0;
 
-        if (component_id == context.components[0].id)
-            component = &context.components[0];
-        else if (component_id == context.components[1].id)
-            component = &context.components[1];
-        else if (component_id == context.components[2].id)
-            component = &context.components[2];
-        else {
+        int component_index = 0;
+        while (component_index < context.component_count && component_id != (u8)context.components[component_index].id)
+            ++component_index;
+        if (component_index == context.component_count) {
             dbg() << stream.offset() << String::format(": Unsupported component id: %i!", component_id);
             return false;
         }
+        ComponentSpec& component = context.components[component_index];
+        context.scan_components[i] = component_index;
 
         u8 table_ids;
         stream >> table_ids;
         if (stream.handle_read_failure())
             return false;
-        component->dc_destination_id = table_ids >> 4;
-        component->ac_destination_id = table_ids & 0x0F;
+        component.dc_destination_id = table_ids >> 4;
+        component.ac_destination_id = table_ids & 0x0F;
+        if (component.dc_destination_id > 3 || component.ac_destination_id > 3) {
+            dbg() << stream.offset() << String::format(": Invalid huffman table ids: %i!", table_ids);
+            return false;
+        }
     }
 
     u8 spectral_selection_start;
@@ -552,13 +1187,38 @@ static bool read_start_of_scan(BufferStream& stream, JPGLoadingContext& context)
     stream >> successive_approximation;
     if (stream.handle_read_failure())
         return false;
-    // The three values should be fixed for baseline JPEGs utilizing sequential DCT.
-    if (spectral_selection_start != 0 || spectral_selection_end != 63 || successive_approximation != 0) {
+    context.spectral_selection_start = spectral_selection_start;
+    context.spectral_selection_end = spectral_selection_end;
+    context.successive_approximation_high = successive_approximation >> 4;
+    context.successive_approximation_low = successive_approximation & 0x0F;
+
+    bool is_valid;
+    if (context.frame.type == StartOfFrame::FrameType::Progressive_DCT) {
+        // A scan codes either the DC coefficients of any components, or a band of AC coefficients of one of them.
+        is_valid = spectral_selection_start <= spectral_selection_end && spectral_selection_end <= 63
+            && (spectral_selection_start == 0 ? spectral_selection_end == 0 : component_count == 1)
+            && context.successive_approximation_low <= 13;
+    } else {
+        // The three values should be fixed for JPEGs utilizing sequential DCT.
+        is_valid = spectral_selection_start == 0 && spectral_selection_end == 63 && successive_approximation == 0;
+    }
+    if (!is_valid) {
         dbg() << stream.offset() << ": ERROR! Start of Selection: " << spectral_selection_start
               << ", End of Selection: " << spectral_selection_end
               << ", Successive Approximation: " << successive_approximation << "!";
         return false;
     }
+
+    for (int i = 0; i < component_count; ++i) {
+        auto& component = context.components[context.scan_components[i]];
+        bool needs_dc_table = spectral_selection_start == 0 && context.successive_approximation_high == 0;
+        bool needs_ac_table = spectral_selection_end > 0;
+        if ((needs_dc_table && !context.dc_tables[component.dc_destination_id].is_defined)
+            || (needs_ac_table && !context.ac_tables[component.ac_destination_id].is_defined)) {
+            dbg() << stream.offset() << ": Scan uses an undefined huffman table!";
+            return false;
+        }
+    }
     return true;
 }
 
@@ -625,10 +1285,16 @@ static bool read_huffman_table(BufferStream& stream, JPGLoadingContext& context)
         if (stream.handle_read_failure())
             return false;
 
+        if (!generate_huffman_codes(table)) {
+            dbg() << stream.offset() << ": Malformed huffman table!";
+            return false;
+        }
+
+        // A table replaces any earlier one with the same destination id.
         if (table_type == 0)
-            context.dc_tables.append(move(table));
+            context.dc_tables[table_destination_id] = move(table);
         else
-            context.ac_tables.append(move(table));
+            context.ac_tables[table_destination_id] = move(table);
 
         bytes_to_read -= 1 + 16 + total_codes;
     }
@@ -639,29 +1305,41 @@ static bool read_huffman_table(BufferStream& stream, JPGLoadingContext& context)
     return true;
 }
 
-static inline bool validate_luma_and_modify_context(const ComponentSpec& luma, JPGLoadingContext& context)
+static inline bool validate_sampling_factors_and_modify_context(JPGLoadingContext& context)
 {
-    if ((luma.hsample_factor == 1 || luma.hsample_factor == 2) && (luma.vsample_factor == 1 || luma.vsample_factor == 2)) {
-        context.mblock_meta.hpadded_count += luma.hsample_factor == 1 ? 0 : context.mblock_meta.hcount % 2;
-        context.mblock_meta.vpadded_count += luma.vsample_factor == 1 ? 0 : context.mblock_meta.vcount % 2;
-        context.mblock_meta.padded_total = context.mblock_meta.hpadded_count * context.mblock_meta.vpadded_count;
-        // For easy reference to relevant sample factors.
-        context.hsample_factor = luma.hsample_factor;
-        context.vsample_factor = luma.vsample_factor;
-        jpg_dbg(String::format("Horizontal Subsampling Factor: %i", luma.hsample_factor));
-        jpg_dbg(String::format("Vertical Subsampling Factor: %i", luma.vsample_factor));
-        return true;
+    // A single component is always coded one block at a time, whatever its sampling factors say.
+    if (context.component_count == 1) {
+        context.components[0].hsample_factor = 1;
+        context.components[0].vsample_factor = 1;
     }
-    return false;
-}
 
-static inline void set_macroblock_metadata(JPGLoadingContext& context)
-{
-    context.mblock_meta.hcount = (context.frame.width + 7) / 8;
-    context.mblock_meta.vcount = (context.frame.height + 7) / 8;
-    context.mblock_meta.hpadded_count = context.mblock_meta.hcount;
-    context.mblock_meta.vpadded_count = context.mblock_meta.vcount;
-    context.mblock_meta.total = context.mblock_meta.hcount * context.mblock_meta.vcount;
+    context.hsample_factor = 1;
+    context.vsample_factor = 1;
+    for (int i = 0; i < context.component_count; ++i) {
+        auto& component = context.components[i];
+        if (component.hsample_factor < 1 || component.hsample_factor > 4 || component.vsample_factor < 1 || component.vsample_factor > 4)
+            return false;
+        context.hsample_factor = max(context.hsample_factor, component.hsample_factor);
+        context.vsample_factor = max(context.vsample_factor, component.vsample_factor);
+    }
+    jpg_dbg(String::format("Horizontal Subsampling Factor: %i", context.hsample_factor));
+    jpg_dbg(String::format("Vertical Subsampling Factor: %i", context.vsample_factor));
+
+    context.mcus_per_row = (context.frame.width + 8 * context.hsample_factor - 1) / (8 * context.hsample_factor);
+    context.mcu_rows = (context.frame.height + 8 * context.vsample_factor - 1) / (8 * context.vsample_factor);
+    for (int i = 0; i < context.component_count; ++i) {
+        auto& component = context.components[i];
+        // Chroma is upsampled by repeating samples, which needs whole ratios.
+        if (context.hsample_factor % component.hsample_factor || context.vsample_factor % component.vsample_factor)
+            return false;
+        component.blocks_per_line = context.mcus_per_row * component.hsample_factor;
+        component.block_rows = context.mcu_rows * component.vsample_factor;
+        u32 component_width = (context.frame.width * component.hsample_factor + context.hsample_factor - 1) / context.hsample_factor;
+        u32 component_height = (context.frame.height * component.vsample_factor + context.vsample_factor - 1) / context.vsample_factor;
+        component.width_in_blocks = (component_width + 7) / 8;
+        component.height_in_blocks = (component_height + 7) / 8;
+    }
+    return true;
 }
 
 static bool read_start_of_frame(BufferStream& stream, JPGLoadingContext& context)
@@ -692,7 +1370,6 @@ static bool read_start_of_frame(BufferStream& stream, JPGLoadingContext& context
               << context.frame.width << "!";
         return false;
     }
-    set_macroblock_metadata(context);
 
     stream >> context.component_count;
     if (context.component_count != 1 && context.component_count != 3) {
@@ -716,22 +1393,6 @@ static bool read_start_of_frame(BufferStream& stream, JPGLoadingContext& context
         component.hsample_factor = subsample_factors >> 4;
         component.vsample_factor = subsample_factors & 0x0F;
 
-        if (component.id == 1) {
-            // By convention, downsampling is applied only on chroma components. So we should
-            //  hope to see the maximum sampling factor in the luma component.
-            if (!validate_luma_and_modify_context(component, context)) {
-                dbg() << stream.offset() << ": Unsupported luma subsampling factors: "
-                      << "horizontal: " << component.hsample_factor << ", vertical: " << component.vsample_factor;
-                return false;
-            }
-        } else {
-            if (component.hsample_factor != 1 || component.vsample_factor != 1) {
-                dbg() << stream.offset() << ": Unsupported chroma subsampling factors: "
-                      << "horizontal: " << component.hsample_factor << ", vertical: " << component.vsample_factor;
-                return false;
-            }
-        }
-
         stream >> component.qtable_id;
         if (component.qtable_id > 1) {
             dbg() << stream.offset() << ": Unsupported quantization table id: "
@@ -739,6 +1400,11 @@ static bool read_start_of_frame(BufferStream& stream, JPGLoadingContext& context
             return false;
         }
     }
+
+    if (!validate_sampling_factors_and_modify_context(context)) {
+        dbg() << stream.offset() << ": Unsupported subsampling factors!";
+        return false;
+    }
     return true;
 }
 
@@ -798,256 +1464,43 @@ static bool skip_marker_with_length(BufferStream& stream)
     return !stream.handle_read_failure();
 }
 
-void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
-{
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u8 cindex = 0; cindex < context.component_count; cindex++) {
-                auto& component = context.components[cindex];
-                const u32* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
-                for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        int* block_component = cindex == 0 ? block.y : (cindex == 1 ? block.cb : block.cr);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
-                }
-            }
-        }
-    }
-}
-
-void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
-{
-    static const float m0 = 2.0 * cos(1.0 / 16.0 * 2.0 * M_PI);
-    static const float m1 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
-    static const float m3 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
-    static const float m5 = 2.0 * cos(3.0 / 16.0 * 2.0 * M_PI);
-    static const float m2 = m0 - m5;
-    static const float m4 = m0 + m5;
-    static const float s0 = cos(0.0 / 16.0 * M_PI) / sqrt(8);
-    static const float s1 = cos(1.0 / 16.0 * M_PI) / 2.0;
-    static const float s2 = cos(2.0 / 16.0 * M_PI) / 2.0;
-    static const float s3 = cos(3.0 / 16.0 * M_PI) / 2.0;
-    static const float s4 = cos(4.0 / 16.0 * M_PI) / 2.0;
-    static const float s5 = cos(5.0 / 16.0 * M_PI) / 2.0;
-    static const float s6 = cos(6.0 / 16.0 * M_PI) / 2.0;
-    static const float s7 = cos(7.0 / 16.0 * M_PI) / 2.0;
-
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u8 cindex = 0; cindex < context.component_count; cindex++) {
-                auto& component = context.components[cindex];
-                for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        i32* block_component = cindex == 0 ? block.y : (cindex == 1 ? block.cb : block.cr);
-                        for (u32 k = 0; k < 8; ++k) {
-                            const float g0 = block_component[0 * 8 + k] * s0;
-                            const float g1 = block_component[4 * 8 + k] * s4;
-                            const float g2 = block_component[2 * 8 + k] * s2;
-                            const float g3 = block_component[6 * 8 + k] * s6;
-                            const float g4 = block_component[5 * 8 + k] * s5;
-                            const float g5 = block_component[1 * 8 + k] * s1;
-                            const float g6 = block_component[7 * 8 + k] * s7;
-                            const float g7 = block_component[3 * 8 + k] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            const float g0 = block_component[l * 8 + 0] * s0;
-                            const float g1 = block_component[l * 8 + 4] * s4;
-                            const float g2 = block_component[l * 8 + 2] * s2;
-                            const float g3 = block_component[l * 8 + 6] * s6;
-                            const float g4 = block_component[l * 8 + 5] * s5;
-                            const float g5 = block_component[l * 8 + 1] * s1;
-                            const float g6 = block_component[l * 8 + 7] * s7;
-                            const float g7 = block_component[l * 8 + 3] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
-void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
-{
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            const Macroblock& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    i32* y = macroblocks[mb_index].y;
-                    i32* cb = macroblocks[mb_index].cb;
-                    i32* cr = macroblocks[mb_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
-                            y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
-                            cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
-                            cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
-static void compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks)
+// Whether the marker segment at offset has arrived completely, along with the
+// marker after it, so that parsing it can't run into the end of incomplete data.
+static bool marker_segment_has_arrived(const JPGLoadingContext& context, size_t offset)
 {
-    context.bitmap = Bitmap::create_purgeable(BitmapFormat::RGB32, { context.frame.width, context.frame.height });
-
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
-        }
-    }
+    if (offset >= context.data_size)
+        return false;
+    if (context.data[offset] != 0xFF)
+        return true;
+    while (offset < context.data_size && context.data[offset] == 0xFF)
+        ++offset;
+    if (offset >= context.data_size)
+        return false;
+    u8 marker = context.data[offset];
+    if (marker == 0xD8 || marker == 0xD9 || (marker >= 0xD0 && marker <= 0xD7))
+        return true;
+    if (offset + 2 >= context.data_size)
+        return false;
+    size_t length = ((size_t)context.data[offset + 1] << 8) | context.data[offset + 2];
+    return offset + 1 + length + 2 < context.data_size;
 }
 
-static bool parse_header(BufferStream& stream, JPGLoadingContext& context)
+enum class MarkerParseResult {
+    Error,
+    StartOfScan,
+    EndOfImage,
+    NeedMoreData,
+};
+
+// Reads markers up to and including the next SOS. If the data is still
+// arriving, stops in front of the first segment that isn't all there yet.
+static MarkerParseResult parse_markers(BufferStream& stream, JPGLoadingContext& context)
 {
-    auto marker = read_marker_at_cursor(stream);
-    if (stream.handle_read_failure())
-        return false;
-    if (marker != JPG_SOI) {
-        dbg() << stream.offset() << String::format(": SOI not found: %x!", marker);
-        return false;
-    }
     for (;;) {
-        marker = read_marker_at_cursor(stream);
+        if (!context.is_data_complete && !marker_segment_has_arrived(context, stream.offset()))
+            return MarkerParseResult::NeedMoreData;
+
+        auto marker = read_marker_at_cursor(stream);
 
         // Set frame type if the marker marks a new frame.
         if (marker >= 0xFFC0 && marker <= 0xFFCF) {
@@ -1058,6 +1511,8 @@ static bool parse_header(BufferStream& stream, JPGLoadingContext& context)
         }
 
         switch (marker) {
+        case JPG_EOI:
+            return MarkerParseResult::EndOfImage;
         case JPG_INVALID:
         case JPG_RST0:
         case JPG_RST1:
@@ -1068,32 +1523,33 @@ static bool parse_header(BufferStream& stream, JPGLoadingContext& context)
         case JPG_RST6:
         case JPG_RST7:
         case JPG_SOI:
-        case JPG_EOI:
             dbg() << stream.offset() << String::format(": Unexpected marker %x!", marker);
-            return false;
+            return MarkerParseResult::Error;
         case JPG_SOF0:
+        case JPG_SOF1:
+        case JPG_SOF2:
             if (!read_start_of_frame(stream, context))
-                return false;
+                return MarkerParseResult::Error;
             context.state = JPGLoadingContext::FrameDecoded;
             break;
         case JPG_DQT:
             if (!read_quantization_table(stream, context))
-                return false;
+                return MarkerParseResult::Error;
             break;
         case JPG_RST:
             if (!read_reset_marker(stream, context))
-                return false;
+                return MarkerParseResult::Error;
             break;
         case JPG_DHT:
             if (!read_huffman_table(stream, context))
-                return false;
+                return MarkerParseResult::Error;
             break;
         case JPG_SOS:
-            return read_start_of_scan(stream, context);
+            return read_start_of_scan(stream, context) ? MarkerParseResult::StartOfScan : MarkerParseResult::Error;
         default:
             if (!skip_marker_with_length(stream)) {
                 dbg() << stream.offset() << String::format(": Error skipping marker: %x!", marker);
-                return false;
+                return MarkerParseResult::Error;
             }
             break;
         }
@@ -1102,46 +1558,68 @@ static bool parse_header(BufferStream& stream, JPGLoadingContext& context)
     ASSERT_NOT_REACHED();
 }
 
-static bool scan_huffman_stream(BufferStream& stream, JPGLoadingContext& context)
+static bool parse_header(BufferStream& stream, JPGLoadingContext& context)
 {
-    u8 last_byte;
-    u8 current_byte;
-    stream >> current_byte;
+    auto marker = read_marker_at_cursor(stream);
     if (stream.handle_read_failure())
         return false;
+    if (marker != JPG_SOI) {
+        dbg() << stream.offset() << String::format(": SOI not found: %x!", marker);
+        return false;
+    }
+    auto result = parse_markers(stream, context);
+    if (result == MarkerParseResult::EndOfImage) {
+        dbg() << stream.offset() << ": EOI found before any scan!";
+        return false;
+    }
+    return result == MarkerParseResult::StartOfScan;
+}
 
-    for (;;) {
-        last_byte = current_byte;
-        stream >> current_byte;
-        if (stream.handle_read_failure()) {
-            dbg() << stream.offset() << ": EOI not found!";
-            return false;
+// Finds where the entropy-coded data of the scan starting at scan_start ends,
+// and where each of its restart intervals begins.
+static size_t scan_huffman_stream(const JPGLoadingContext& context, size_t scan_start, Vector<size_t>& interval_offsets)
+{
+    interval_offsets.append(scan_start);
+    size_t offset = scan_start;
+    while (offset + 1 < context.data_size) {
+        auto* next_ff = (const u8*)memchr(context.data + offset, 0xFF, context.data_size - offset - 1);
+        if (!next_ff)
+            return context.data_size;
+        offset = next_ff - context.data;
+        u8 next = context.data[offset + 1];
+        if (next == 0x00) {
+            offset += 2;
+        } else if (next == 0xFF) {
+            ++offset;
+        } else if (next >= 0xD0 && next <= 0xD7) {
+            offset += 2;
+            interval_offsets.append(offset);
+        } else {
+            return offset;
         }
+    }
+    return context.data_size;
+}
 
-        if (last_byte == 0xFF) {
-            if (current_byte == 0xFF)
-                continue;
-            if (current_byte == 0x00) {
-                stream >> current_byte;
-                context.huffman_stream.stream.append(last_byte);
-                continue;
-            }
-            Marker marker = 0xFF00 | current_byte;
-            if (marker == JPG_EOI)
-                return true;
-            if (marker >= JPG_RST0 && marker <= JPG_RST7) {
-                context.huffman_stream.stream.append(marker);
-                stream >> current_byte;
-                continue;
+static bool create_bitmap(JPGLoadingContext& context)
+{
+    if (!context.minimum_size.is_empty()) {
+        for (u8 denominator = 8; denominator > 1; denominator /= 2) {
+            if ((context.frame.width + denominator - 1) / denominator >= context.minimum_size.width()
+                && (context.frame.height + denominator - 1) / denominator >= context.minimum_size.height()) {
+                context.scale_denominator = denominator;
+                break;
             }
-            dbg() << stream.offset() << String::format(": Invalid marker: %x!", marker);
-            return false;
-        } else {
-            context.huffman_stream.stream.append(last_byte);
         }
     }
-
-    ASSERT_NOT_REACHED();
+    u8 denominator = context.scale_denominator;
+    IntSize size { (context.frame.width + denominator - 1) / denominator, (context.frame.height + denominator - 1) / denominator };
+    context.bitmap = Bitmap::create_purgeable(BitmapFormat::RGB32, size);
+    if (!context.bitmap)
+        return false;
+    if (size.width() * size.height() < (int)minimum_pixels_for_threading)
+        context.thread_count = 1;
+    return true;
 }
 
 static bool decode_jpg(JPGLoadingContext& context)
@@ -1150,29 +1628,186 @@ static bool decode_jpg(JPGLoadingContext& context)
     BufferStream stream(buffer);
     if (!parse_header(stream, context))
         return false;
-    if (!scan_huffman_stream(stream, context))
+    if (!create_bitmap(context))
         return false;
 
-    auto result = decode_huffman_stream(context);
-    if (!result.has_value()) {
-        dbg() << stream.offset() << ": Failed to decode Macroblocks!";
-        return false;
+    for (;;) {
+        prepare_idct_tables(context);
+        Vector<size_t> interval_offsets;
+        size_t scan_start = stream.offset();
+        size_t scan_end = scan_huffman_stream(context, scan_start, interval_offsets);
+
+        bool is_progressive = context.frame.type == StartOfFrame::FrameType::Progressive_DCT;
+        if (!is_progressive && !context.has_stored_coefficients && context.scan_component_count == context.component_count) {
+            // All the data is in this scan, so there is nothing left to do after it.
+            return decode_sequential_scan(context, interval_offsets, scan_end);
+        }
+
+        if (!decode_scan_coefficients(context, scan_start, scan_end)) {
+            dbg() << scan_start << ": Failed to decode scan!";
+            return false;
+        }
+
+        // Show what we have if the data ends early or is cut off, which is nice for progressive images.
+        stream.advance(scan_end - scan_start);
+        if (scan_end >= context.data_size)
+            break;
+        auto result = parse_markers(stream, context);
+        if (result == MarkerParseResult::Error) {
+            dbg() << stream.offset() << ": Error after a scan, showing what was decoded so far.";
+            break;
+        }
+        if (result == MarkerParseResult::EndOfImage)
+            break;
     }
 
-    auto macroblocks = result.release_value();
-    dbg() << String::format("%i macroblocks decoded successfully :^)", macroblocks.size());
-    dequantize(context, macroblocks);
-    inverse_dct(context, macroblocks);
-    ycbcr_to_rgb(context, macroblocks);
-    compose_bitmap(context, macroblocks);
+    prepare_idct_tables(context);
+    return output_stored_coefficients(context);
+}
+
+static void add_changed_mcu_rows(JPGLoadingContext& context, u32 first_row, u32 end_row)
+{
+    int lines_per_mcu = context.vsample_factor * 8 / context.scale_denominator;
+    IntRect rect { 0, (int)first_row * lines_per_mcu, context.bitmap->width(), (int)(end_row - first_row) * lines_per_mcu };
+    rect.intersect(context.bitmap->rect());
+    if (!rect.is_empty())
+        context.changed_rect = context.changed_rect.united(rect);
+}
+
+static bool decode_available_sequential_rows(JPGLoadingContext& context)
+{
+    auto& state = context.sequential_state;
+    auto& hstream = state.stream;
+    hstream.data = context.data;
+    hstream.size = context.data_size;
+    // The zeros that stood in for missing data are read again, for real this time.
+    hstream.bit_count -= hstream.missing_bytes * 8;
+    hstream.missing_bytes = 0;
+
+    const i16* component_blocks[3];
+    for (int i = 0; i < context.component_count; ++i)
+        component_blocks[i] = context.row_buffers->coefficients[i].data();
+
+    u32 first_row = context.next_mcu_row;
+    while (context.next_mcu_row < context.mcu_rows) {
+        ScanState checkpoint = state;
+        bool decoded = decode_sequential_mcu_row(context, state, context.next_mcu_row, *context.row_buffers, context.next_mcu_row == 0);
+        if (!context.is_data_complete && hstream.missing_bytes && (!decoded || hstream.missing_bytes * 8 > hstream.bit_count)) {
+            // This row needs data that hasn't arrived yet.
+            state = checkpoint;
+            break;
+        }
+        if (!decoded)
+            return false;
+        output_mcu_row(context, context.next_mcu_row, component_blocks, *context.row_buffers);
+        ++context.next_mcu_row;
+    }
+    add_changed_mcu_rows(context, first_row, context.next_mcu_row);
+    if (context.next_mcu_row == context.mcu_rows)
+        context.incremental_phase = IncrementalPhase::Done;
     return true;
 }
 
-static RefPtr<Gfx::Bitmap> load_jpg_impl(const u8* data, size_t data_size)
+// Decodes as much as the data that has arrived allows, picking up where the
+// previous call stopped. Marker segments are only parsed once all of them is
+// there. Sequential scans are shown a row of MCUs at a time; other scans once
+// they have arrived completely, as a new pass over the whole image.
+static bool decode_available_jpg_data(JPGLoadingContext& context)
+{
+    ByteBuffer buffer = ByteBuffer::wrap(context.data, context.data_size);
+    BufferStream stream(buffer);
+    stream.advance(context.resume_offset);
+
+    for (;;) {
+        switch (context.incremental_phase) {
+        case IncrementalPhase::ReadingMarkers: {
+            if (context.resume_offset == 0) {
+                if (context.data_size < 2)
+                    return !context.is_data_complete;
+                if (read_marker_at_cursor(stream) != JPG_SOI) {
+                    dbg() << "SOI not found!";
+                    return false;
+                }
+                context.resume_offset = stream.offset();
+            }
+
+            auto result = parse_markers(stream, context);
+            if (result == MarkerParseResult::NeedMoreData) {
+                context.resume_offset = stream.offset();
+                return true;
+            }
+            if (result != MarkerParseResult::StartOfScan) {
+                if (!context.has_stored_coefficients) {
+                    dbg() << stream.offset() << ": No scan could be decoded!";
+                    return false;
+                }
+                // The passes shown so far are all we get.
+                context.incremental_phase = IncrementalPhase::Done;
+                break;
+            }
+
+            if (!context.bitmap && !create_bitmap(context))
+                return false;
+            prepare_idct_tables(context);
+            context.resume_offset = stream.offset();
+            context.scan_search_offset = stream.offset();
+
+            bool is_progressive = context.frame.type == StartOfFrame::FrameType::Progressive_DCT;
+            if (is_progressive || context.has_stored_coefficients || context.scan_component_count != context.component_count) {
+                context.incremental_phase = IncrementalPhase::StoredScan;
+                break;
+            }
+            context.sequential_state = {};
+            context.sequential_state.stream.byte_offset = stream.offset();
+            context.next_mcu_row = 0;
+            context.row_buffers = make<MCURowBuffers>();
+            const i16* component_blocks[3];
+            allocate_row_buffers(context, *context.row_buffers, component_blocks);
+            context.incremental_phase = IncrementalPhase::SequentialScan;
+            break;
+        }
+        case IncrementalPhase::SequentialScan:
+            if (!decode_available_sequential_rows(context))
+                return false;
+            if (context.incremental_phase != IncrementalPhase::Done)
+                return true;
+            // All the data is in this scan, so there is nothing left to do after it.
+            context.row_buffers = nullptr;
+            break;
+        case IncrementalPhase::StoredScan: {
+            Vector<size_t> interval_offsets;
+            size_t scan_end = scan_huffman_stream(context, context.scan_search_offset, interval_offsets);
+            if (scan_end >= context.data_size && !context.is_data_complete) {
+                // Look at a trailing 0xFF again, it may turn out to start a marker.
+                context.scan_search_offset = max(context.resume_offset, context.data_size - 1);
+                return true;
+            }
+            if (!decode_scan_coefficients(context, context.resume_offset, scan_end)) {
+                dbg() << context.resume_offset << ": Failed to decode scan!";
+                return false;
+            }
+            if (!output_stored_coefficients(context))
+                return false;
+            context.changed_rect = context.bitmap->rect();
+
+            stream.advance(scan_end - stream.offset());
+            context.resume_offset = scan_end;
+            context.incremental_phase = scan_end >= context.data_size ? IncrementalPhase::Done : IncrementalPhase::ReadingMarkers;
+            break;
+        }
+        case IncrementalPhase::Done:
+            return true;
+        }
+    }
+}
+
+static RefPtr<Gfx::Bitmap> load_jpg_impl(const u8* data, size_t data_size, const IntSize& minimum_size = {})
 {
     JPGLoadingContext context;
     context.data = data;
     context.data_size = data_size;
+    context.minimum_size = minimum_size;
+    context.thread_count = s_decoder_thread_count.load();
 
     if (!decode_jpg(context))
         return nullptr;
@@ -1201,18 +1836,61 @@ RefPtr<Gfx::Bitmap> load_jpg_from_memory(const u8* data, size_t length)
     return bitmap;
 }
 
+RefPtr<Gfx::Bitmap> load_jpg_downscaled(const StringView& path, const IntSize& minimum_size)
+{
+    MappedFile mapped_file(path);
+    if (!mapped_file.is_valid()) {
+        return nullptr;
+    }
+
+    auto bitmap = load_jpg_impl((const u8*)mapped_file.data(), mapped_file.size(), minimum_size);
+    if (bitmap)
+        bitmap->set_mmap_name(String::format("Gfx::Bitmap [%dx%d] - Decoded JPG (downscaled): %s", bitmap->width(), bitmap->height(), LexicalPath::canonicalized_path(path).characters()));
+    return bitmap;
+}
+
+void set_jpg_decoder_thread_count(size_t thread_count)
+{
+    s_decoder_thread_count.store(max(thread_count, (size_t)1));
+}
+
 JPGImageDecoderPlugin::JPGImageDecoderPlugin(const u8* data, size_t size)
 {
     m_context = make<JPGLoadingContext>();
     m_context->data = data;
     m_context->data_size = size;
-    m_context->huffman_stream.stream.ensure_capacity(50 * KB);
+    m_context->thread_count = s_decoder_thread_count.load();
 }
 
 JPGImageDecoderPlugin::~JPGImageDecoderPlugin()
 {
 }
 
+bool JPGImageDecoderPlugin::decode_available_data_if_needed()
+{
+    if (m_context->state == JPGLoadingContext::State::Error)
+        return false;
+    if (m_context->state == JPGLoadingContext::State::BitmapDecoded)
+        return true;
+    if (m_context->is_data_complete && m_context->resume_offset == 0) {
+        // Nothing to pick up from, so use the regular decoder, which can use several threads.
+        if (!decode_jpg(*m_context)) {
+            m_context->state = JPGLoadingContext::State::Error;
+            return false;
+        }
+        m_context->state = JPGLoadingContext::State::BitmapDecoded;
+        m_context->changed_rect = m_context->bitmap->rect();
+        return true;
+    }
+    if (!decode_available_jpg_data(*m_context)) {
+        m_context->state = JPGLoadingContext::State::Error;
+        return false;
+    }
+    if (m_context->incremental_phase == IncrementalPhase::Done)
+        m_context->state = JPGLoadingContext::State::BitmapDecoded;
+    return true;
+}
+
 IntSize JPGImageDecoderPlugin::size()
 {
     if (m_context->state == JPGLoadingContext::State::Error)
@@ -1227,6 +1905,11 @@ RefPtr<Gfx::Bitmap> JPGImageDecoderPlugin::bitmap()
 {
     if (m_context->state == JPGLoadingContext::State::Error)
         return nullptr;
+    if (m_is_incremental) {
+        if (!decode_available_data_if_needed())
+            return nullptr;
+        return m_context->bitmap;
+    }
     if (m_context->state < JPGLoadingContext::State::BitmapDecoded) {
         if (!decode_jpg(*m_context)) {
             m_context->state = JPGLoadingContext::State::Error;
@@ -1276,9 +1959,38 @@ size_t JPGImageDecoderPlugin::frame_count()
 
 ImageFrameDescriptor JPGImageDecoderPlugin::frame(size_t i)
 {
-    if (i > 0) {
-        return { bitmap(), 0 };
+    if (i > 0)
+        return {};
+    return { bitmap(), 0 };
+}
+
+void JPGImageDecoderPlugin::did_receive_data(const u8* data, size_t size, bool is_complete)
+{
+    m_is_incremental = true;
+    m_context->data = data;
+    m_context->data_size = size;
+    m_context->is_data_complete = is_complete;
+}
+
+void JPGImageDecoderPlugin::set_minimum_size(const IntSize& minimum_size)
+{
+    // The scale is picked when the bitmap is created, and can't change after that.
+    if (!m_context->bitmap)
+        m_context->minimum_size = minimum_size;
+}
+
+IncrementalDecodeResult JPGImageDecoderPlugin::decode_available_data()
+{
+    m_is_incremental = true;
+    IncrementalDecodeResult result;
+    if (!decode_available_data_if_needed()) {
+        result.has_failed = true;
+        return result;
     }
-    return {};
+    result.image = m_context->bitmap;
+    result.changed_rect = m_context->changed_rect;
+    result.is_complete = m_context->state == JPGLoadingContext::State::BitmapDecoded;
+    m_context->changed_rect = {};
+    return result;
 }
 }
@@ -36,6 +36,14 @@ namespace Gfx {
 RefPtr<Gfx::Bitmap> load_jpg(const StringView& path);
 RefPtr<Gfx::Bitmap> load_jpg_from_memory(const u8* data, size_t length);
 
+// Decodes the image at 1/2, 1/4 or 1/8 of its size if that still covers minimum_size,
+// which skips most of the work. Meant for thumbnails.
+RefPtr<Gfx::Bitmap> load_jpg_downscaled(const StringView& path, const IntSize& minimum_size);
+
+// Large images can be decoded on several threads, but only processes that
+// pledge "thread" may use them, so this is 1 (no extra threads) by default.
+void set_jpg_decoder_thread_count(size_t);
+
 struct JPGLoadingContext;
 
 class JPGImageDecoderPlugin : public ImageDecoderPlugin {
@@ -51,8 +59,15 @@ public:
     virtual size_t loop_count() override;
     virtual size_t frame_count() override;
     virtual ImageFrameDescriptor frame(size_t i) override;
+    virtual bool supports_incremental_decoding() const override { return true; }
+    virtual void did_receive_data(const u8*, size_t, bool is_complete) override;
+    virtual IncrementalDecodeResult decode_available_data() override;
+    virtual void set_minimum_size(const IntSize&) override;
 
 private:
+    bool decode_available_data_if_needed();
+
     OwnPtr<JPGLoadingContext> m_context;
+    bool m_is_incremental { false };
 };
 }
@@ -28,20 +28,15 @@
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
 #include <AK/NetworkOrdered.h>
-#include <LibCore/puff.h>
+#include <LibCore/Inflate.h>
 #include <LibGfx/PNGLoader.h>
 #include <LibM/math.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
-#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-#ifdef __serenity__
-#    include <serenity.h>
-#endif
-
 //#define PNG_DEBUG
 
 namespace Gfx {
@@ -126,6 +121,7 @@ struct PNGLoadingContext {
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
     Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
+    ByteBuffer decompressed_data;
     u8* decompression_buffer { nullptr };
     size_t decompression_buffer_size { 0 };
     Vector<u8> compressed_data;
@@ -743,25 +739,19 @@ static bool decode_png_bitmap(PNGLoadingContext& context)
     if (context.state >= PNGLoadingContext::State::BitmapDecoded)
         return true;
 
-    unsigned long srclen = context.compressed_data.size() - 6;
-    unsigned long destlen = 0;
-    int ret = puff(NULL, &destlen, context.compressed_data.data() + 2, &srclen);
-    if (ret != 0) {
+    // The IDAT stream is zlib wrapped: skip the 2-byte header and the Adler-32 trailer.
+    if (context.compressed_data.size() < 6) {
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
-    context.decompression_buffer_size = destlen;
-#ifdef __serenity__
-    context.decompression_buffer = (u8*)mmap_with_name(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, "PNG decompression buffer");
-#else
-    context.decompression_buffer = (u8*)mmap(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
-#endif
-
-    ret = puff(context.decompression_buffer, &destlen, context.compressed_data.data() + 2, &srclen);
-    if (ret != 0) {
+    auto decompressed_data = Core::Inflate::decompress_all({ context.compressed_data.data() + 2, context.compressed_data.size() - 6 });
+    if (!decompressed_data.has_value()) {
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
+    context.decompressed_data = decompressed_data.release_value();
+    context.decompression_buffer = context.decompressed_data.data();
+    context.decompression_buffer_size = context.decompressed_data.size();
     context.compressed_data.clear();
 
     context.scanlines.ensure_capacity(context.height);
@@ -778,7 +768,7 @@ static bool decode_png_bitmap(PNGLoadingContext& context)
         ASSERT_NOT_REACHED();
     }
 
-    munmap(context.decompression_buffer, context.decompression_buffer_size);
+    context.decompressed_data.clear();
     context.decompression_buffer = nullptr;
     context.decompression_buffer_size = 0;
 
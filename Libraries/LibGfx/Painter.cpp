@@ -38,6 +38,7 @@
 #include <AK/Utf8View.h>
 #include <LibGfx/CharacterBitmap.h>
 #include <LibGfx/Path.h>
+#include <LibGfx/PixelKernels.h>
 #include <math.h>
 #include <stdio.h>
 
@@ -62,9 +63,40 @@ ALWAYS_INLINE Color get_pixel(const Gfx::Bitmap& bitmap, int x, int y)
         return Color::from_rgb(bitmap.scanline(y)[x]);
     if constexpr (format == BitmapFormat::RGBA32)
         return Color::from_rgba(bitmap.scanline(y)[x]);
+    if constexpr (format == BitmapFormat::RGBA32Premultiplied)
+        return Color::from_premultiplied(bitmap.scanline(y)[x]);
     return bitmap.get_pixel(x, y);
 }
 
+ALWAYS_INLINE static Color color_from_pixel(const Gfx::Bitmap& bitmap, RGBA32 pixel)
+{
+    if (bitmap.is_premultiplied())
+        return Color::from_premultiplied(pixel);
+    return Color::from_rgba(pixel);
+}
+
+// Blends a color over a pixel of the target, whichever way it stores alpha.
+ALWAYS_INLINE static RGBA32 blend_into(const Gfx::Bitmap& target, RGBA32 pixel, Color color)
+{
+    if (target.is_premultiplied())
+        return blend_premultiplied_pixel(pixel, color.to_premultiplied());
+    return Color::from_rgba(pixel).blend(color).value();
+}
+
+// Copied pixels have to be converted when the source and the target store alpha differently.
+ALWAYS_INLINE static bool needs_alpha_conversion(const Gfx::Bitmap& source, const Gfx::Bitmap& target)
+{
+    return source.has_alpha_channel() && target.has_alpha_channel() && source.is_premultiplied() != target.is_premultiplied();
+}
+
+ALWAYS_INLINE static void convert_copied_row(const Gfx::Bitmap& target, RGBA32* pixels, int count)
+{
+    if (target.is_premultiplied())
+        pixel_kernels().premultiply_row(pixels, count);
+    else
+        pixel_kernels().unpremultiply_row(pixels, count);
+}
+
 Painter::Painter(Gfx::Bitmap& bitmap)
     : m_target(bitmap)
 {
@@ -78,6 +110,12 @@ Painter::~Painter()
 {
 }
 
+// The value to store for a color, which depends on how the target stores alpha.
+ALWAYS_INLINE RGBA32 Painter::pixel_value(Color color) const
+{
+    return m_target->is_premultiplied() ? color.to_premultiplied() : color.value();
+}
+
 void Painter::fill_rect_with_draw_op(const IntRect& a_rect, Color color)
 {
     auto rect = a_rect.translated(translation()).intersected(clip_rect());
@@ -105,8 +143,10 @@ void Painter::clear_rect(const IntRect& a_rect, Color color)
     RGBA32* dst = m_target->scanline(rect.top()) + rect.left();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    auto& kernels = pixel_kernels();
+    RGBA32 value = pixel_value(color);
     for (int i = rect.height() - 1; i >= 0; --i) {
-        fast_u32_fill(dst, color.value(), rect.width());
+        kernels.fill_row(dst, value, rect.width());
         dst += dst_skip;
     }
 }
@@ -135,9 +175,18 @@ void Painter::fill_rect(const IntRect& a_rect, Color color)
     RGBA32* dst = m_target->scanline(rect.top()) + rect.left();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    if (!m_target->has_alpha_channel()) {
+        auto& kernels = pixel_kernels();
+        for (int i = rect.height() - 1; i >= 0; --i) {
+            kernels.blend_color_row(dst, color.value(), rect.width());
+            dst += dst_skip;
+        }
+        return;
+    }
+
     for (int i = rect.height() - 1; i >= 0; --i) {
         for (int j = 0; j < rect.width(); ++j)
-            dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+            dst[j] = blend_into(*m_target, dst[j], color);
         dst += dst_skip;
     }
 }
@@ -154,7 +203,7 @@ void Painter::fill_rect_with_dither_pattern(const IntRect& a_rect, Color color_a
     for (int i = 0; i < rect.height(); ++i) {
         for (int j = 0; j < rect.width(); ++j) {
             bool checkboard_use_a = (i & 1) ^ (j & 1);
-            dst[j] = checkboard_use_a ? color_a.value() : color_b.value();
+            dst[j] = checkboard_use_a ? pixel_value(color_a) : pixel_value(color_b);
         }
         dst += dst_skip;
     }
@@ -173,7 +222,7 @@ void Painter::fill_rect_with_checkerboard(const IntRect& a_rect, const IntSize&
         for (int j = 0; j < rect.width(); ++j) {
             int cell_row = i / cell_size.height();
             int cell_col = j / cell_size.width();
-            dst[j] = ((cell_row % 2) ^ (cell_col % 2)) ? color_light.value() : color_dark.value();
+            dst[j] = ((cell_row % 2) ^ (cell_col % 2)) ? pixel_value(color_light) : pixel_value(color_dark);
         }
         dst += dst_skip;
     }
@@ -251,7 +300,7 @@ void Painter::fill_ellipse(const IntRect& a_rect, Color color)
     for (int i = 0; i < rect.height(); i++) {
         double y = rect.height() * 0.5 - i;
         double x = rect.width() * sqrt(0.25 - y * y / rect.height() / rect.height());
-        fast_u32_fill(dst - (int)x, color.value(), 2 * (int)x);
+        fast_u32_fill(dst - (int)x, pixel_value(color), 2 * (int)x);
         dst += dst_skip;
     }
 }
@@ -287,13 +336,13 @@ void Painter::draw_rect(const IntRect& a_rect, Color color, bool rough)
     if (rect.top() >= clipped_rect.top() && rect.top() <= clipped_rect.bottom()) {
         int start_x = rough ? max(rect.x() + 1, clipped_rect.x()) : clipped_rect.x();
         int width = rough ? min(rect.width() - 2, clipped_rect.width()) : clipped_rect.width();
-        fast_u32_fill(m_target->scanline(rect.top()) + start_x, color.value(), width);
+        fast_u32_fill(m_target->scanline(rect.top()) + start_x, pixel_value(color), width);
         ++min_y;
     }
     if (rect.bottom() >= clipped_rect.top() && rect.bottom() <= clipped_rect.bottom()) {
         int start_x = rough ? max(rect.x() + 1, clipped_rect.x()) : clipped_rect.x();
         int width = rough ? min(rect.width() - 2, clipped_rect.width()) : clipped_rect.width();
-        fast_u32_fill(m_target->scanline(rect.bottom()) + start_x, color.value(), width);
+        fast_u32_fill(m_target->scanline(rect.bottom()) + start_x, pixel_value(color), width);
         --max_y;
     }
 
@@ -304,16 +353,16 @@ void Painter::draw_rect(const IntRect& a_rect, Color color, bool rough)
         // Specialized loop when drawing both sides.
         for (int y = min_y; y <= max_y; ++y) {
             auto* bits = m_target->scanline(y);
-            bits[rect.left()] = color.value();
-            bits[rect.right()] = color.value();
+            bits[rect.left()] = pixel_value(color);
+            bits[rect.right()] = pixel_value(color);
         }
     } else {
         for (int y = min_y; y <= max_y; ++y) {
             auto* bits = m_target->scanline(y);
             if (draw_left_side)
-                bits[rect.left()] = color.value();
+                bits[rect.left()] = pixel_value(color);
             if (draw_right_side)
-                bits[rect.right()] = color.value();
+                bits[rect.right()] = pixel_value(color);
         }
     }
 }
@@ -332,12 +381,13 @@ void Painter::draw_bitmap(const IntPoint& p, const CharacterBitmap& bitmap, Colo
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
     const char* bitmap_row = &bitmap.bits()[first_row * bitmap.width() + first_column];
     const size_t bitmap_skip = bitmap.width();
+    RGBA32 value = pixel_value(color);
 
     for (int row = first_row; row <= last_row; ++row) {
         for (int j = 0; j <= (last_column - first_column); ++j) {
             char fc = bitmap_row[j];
             if (fc == '#')
-                dst[j] = color.value();
+                dst[j] = value;
         }
         bitmap_row += bitmap_skip;
         dst += dst_skip;
@@ -357,10 +407,11 @@ void Painter::draw_bitmap(const IntPoint& p, const GlyphBitmap& bitmap, Color co
     RGBA32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    RGBA32 value = pixel_value(color);
     for (int row = first_row; row <= last_row; ++row) {
         for (int j = 0; j <= (last_column - first_column); ++j) {
             if (bitmap.bit_at(j + first_column, row))
-                dst[j] = color.value();
+                dst[j] = value;
         }
         dst += dst_skip;
     }
@@ -368,7 +419,7 @@ void Painter::draw_bitmap(const IntPoint& p, const GlyphBitmap& bitmap, Color co
 
 void Painter::draw_triangle(const IntPoint& a, const IntPoint& b, const IntPoint& c, Color color)
 {
-    RGBA32 rgba = color.value();
+    RGBA32 rgba = pixel_value(color);
 
     IntPoint p0(a);
     IntPoint p1(b);
@@ -490,13 +541,10 @@ void Painter::blit_with_opacity(const IntPoint& position, const Gfx::Bitmap& sou
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
     const unsigned src_skip = source.pitch() / sizeof(RGBA32);
 
+    auto& kernels = pixel_kernels();
+    auto blend_row = source.is_premultiplied() ? kernels.blend_premultiplied_row : kernels.blend_row_with_opacity;
     for (int row = first_row; row <= last_row; ++row) {
-        for (int x = 0; x <= (last_column - first_column); ++x) {
-            Color src_color_with_alpha = Color::from_rgb(src[x]);
-            src_color_with_alpha.set_alpha(alpha);
-            Color dst_color = Color::from_rgb(dst[x]);
-            dst[x] = dst_color.blend(src_color_with_alpha).value();
-        }
+        blend_row(dst, src, last_column - first_column + 1, alpha);
         dst += dst_skip;
         src += src_skip;
     }
@@ -522,11 +570,11 @@ void Painter::blit_filtered(const IntPoint& position, const Gfx::Bitmap& source,
         for (int x = 0; x <= (last_column - first_column); ++x) {
             u8 alpha = Color::from_rgba(src[x]).alpha();
             if (alpha == 0xff)
-                dst[x] = filter(Color::from_rgba(src[x])).value();
+                dst[x] = pixel_value(filter(Color::from_rgba(src[x])));
             else if (!alpha)
                 continue;
             else
-                dst[x] = Color::from_rgba(dst[x]).blend(filter(Color::from_rgba(src[x]))).value();
+                dst[x] = blend_into(*m_target, dst[x], filter(color_from_pixel(source, src[x])));
         }
         dst += dst_skip;
         src += src_skip;
@@ -559,14 +607,17 @@ void Painter::draw_tiled_bitmap(const IntRect& a_dst_rect, const Gfx::Bitmap& so
     RGBA32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
-    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32) {
+    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32 || source.format() == BitmapFormat::RGBA32Premultiplied) {
         int x_start = first_column + a_dst_rect.left();
+        bool convert = needs_alpha_conversion(source, *m_target);
         for (int row = first_row; row <= last_row; ++row) {
             const RGBA32* sl = source.scanline((row + a_dst_rect.top())
                 % source.size().height());
             for (int x = x_start; x < clipped_rect.width() + x_start; ++x) {
                 dst[x - x_start] = sl[x % source.size().width()];
             }
+            if (convert)
+                convert_copied_row(*m_target, dst, clipped_rect.width());
             dst += dst_skip;
         }
         return;
@@ -590,8 +641,12 @@ void Painter::blit_offset(const IntPoint& position,
     RGBA32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
-    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32) {
+    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32 || source.format() == BitmapFormat::RGBA32Premultiplied) {
         int x_start = first_column + src_rect.left();
+        bool convert = needs_alpha_conversion(source, *m_target);
+        // Only the columns that have a source pixel are written.
+        int first_written = max(x_start, offset.x());
+        int last_written = min(clipped_rect.width() + x_start, offset.x() + source.size().width());
         for (int row = first_row; row <= last_row; ++row) {
             int sr = row - offset.y() + src_rect.top();
             if (sr >= source.size().height() || sr < 0) {
@@ -604,6 +659,8 @@ void Painter::blit_offset(const IntPoint& position,
                 if (sx < source.size().width() && sx >= 0)
                     dst[x - x_start] = sl[sx];
             }
+            if (convert && first_written < last_written)
+                convert_copied_row(*m_target, dst + first_written - x_start, last_written - first_written);
             dst += dst_skip;
         }
         return;
@@ -629,6 +686,25 @@ void Painter::blit_with_alpha(const IntPoint& position, const Gfx::Bitmap& sourc
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
     const size_t src_skip = source.pitch() / sizeof(RGBA32);
 
+    auto& kernels = pixel_kernels();
+    if (source.is_premultiplied() && (!m_target->has_alpha_channel() || m_target->is_premultiplied())) {
+        for (int row = first_row; row <= last_row; ++row) {
+            kernels.blend_premultiplied_row(dst, src, last_column - first_column + 1, 0xff);
+            dst += dst_skip;
+            src += src_skip;
+        }
+        return;
+    }
+
+    if (!source.is_premultiplied() && !m_target->has_alpha_channel()) {
+        for (int row = first_row; row <= last_row; ++row) {
+            kernels.blend_row(dst, src, last_column - first_column + 1);
+            dst += dst_skip;
+            src += src_skip;
+        }
+        return;
+    }
+
     for (int row = first_row; row <= last_row; ++row) {
         for (int x = 0; x <= (last_column - first_column); ++x) {
             u8 alpha = Color::from_rgba(src[x]).alpha();
@@ -637,7 +713,7 @@ void Painter::blit_with_alpha(const IntPoint& position, const Gfx::Bitmap& sourc
             else if (!alpha)
                 continue;
             else
-                dst[x] = Color::from_rgba(dst[x]).blend(Color::from_rgba(src[x])).value();
+                dst[x] = blend_into(*m_target, dst[x], color_from_pixel(source, src[x]));
         }
         dst += dst_skip;
         src += src_skip;
@@ -662,11 +738,12 @@ void Painter::blit(const IntPoint& position, const Gfx::Bitmap& source, const In
     RGBA32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
-    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32) {
+    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32 || source.format() == BitmapFormat::RGBA32Premultiplied) {
         const RGBA32* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
         const size_t src_skip = source.pitch() / sizeof(RGBA32);
+        auto& kernels = pixel_kernels();
         for (int row = first_row; row <= last_row; ++row) {
-            fast_u32_copy(dst, src, clipped_rect.width());
+            kernels.copy_row(dst, src, clipped_rect.width());
             dst += dst_skip;
             src += src_skip;
         }
@@ -702,7 +779,7 @@ ALWAYS_INLINE static void do_draw_integer_scaled_bitmap(Gfx::Bitmap& target, con
                 int dst_x = dst_rect.x() + x * hfactor;
                 for (int xo = 0; xo < hfactor; ++xo) {
                     if constexpr (has_alpha_channel)
-                        scanline[dst_x + xo] = scanline[dst_x + xo].blend(src_pixel);
+                        scanline[dst_x + xo] = Color::from_rgba(blend_into(target, scanline[dst_x + xo].value(), src_pixel));
                     else
                         scanline[dst_x + xo] = src_pixel;
                 }
@@ -728,6 +805,22 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
 
     u8 src_alpha = opacity * 255;
 
+    if (has_alpha_channel && !target.has_alpha_channel()) {
+        // Gather each scaled row first so that it can be blended in one go.
+        auto& kernels = pixel_kernels();
+        Vector<RGBA32, 1024> row;
+        row.resize(clipped_rect.width());
+        for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
+            auto scaled_y = ((y - dst_rect.y()) * vscale) >> 16;
+            for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
+                auto scaled_x = ((x - dst_rect.x()) * hscale) >> 16;
+                row[x - clipped_rect.left()] = get_pixel(source, scaled_x, scaled_y).value();
+            }
+            kernels.blend_row_with_opacity(target.scanline(y) + clipped_rect.left(), row.data(), row.size(), src_alpha);
+        }
+        return;
+    }
+
     for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
         auto* scanline = (Color*)target.scanline(y);
         for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
@@ -737,7 +830,7 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
             src_pixel.set_alpha(src_alpha);
 
             if constexpr (has_alpha_channel) {
-                scanline[x] = scanline[x].blend(src_pixel);
+                scanline[x] = Color::from_rgba(blend_into(target, scanline[x].value(), src_pixel));
             } else
                 scanline[x] = src_pixel;
         }
@@ -768,6 +861,9 @@ void Painter::draw_scaled_bitmap(const IntRect& a_dst_rect, const Gfx::Bitmap& s
         case BitmapFormat::RGBA32:
             do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::RGBA32>, opacity);
             break;
+        case BitmapFormat::RGBA32Premultiplied:
+            do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::RGBA32Premultiplied>, opacity);
+            break;
         case BitmapFormat::Indexed8:
             do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::Indexed8>, opacity);
             break;
@@ -809,7 +905,28 @@ FLATTEN void Painter::draw_glyph(const IntPoint& point, u32 codepoint, Color col
 
 FLATTEN void Painter::draw_glyph(const IntPoint& point, u32 codepoint, const Font& font, Color color)
 {
-    draw_bitmap(point, font.glyph_bitmap(codepoint), color);
+    auto dst_rect = IntRect(point, { font.glyph_width(codepoint), font.glyph_height() }).translated(translation());
+    auto clipped_rect = dst_rect.intersected(clip_rect());
+    if (clipped_rect.is_empty())
+        return;
+    const int first_row = clipped_rect.top() - dst_rect.top();
+    const int last_row = clipped_rect.bottom() - dst_rect.top();
+    const int first_column = clipped_rect.left() - dst_rect.left();
+    const int end_column = clipped_rect.right() - dst_rect.left() + 1;
+
+    RGBA32 value = pixel_value(color);
+    // Spans are ordered by row, so we can stop at the first one below the clip.
+    for (auto& span : font.glyph_spans(codepoint)) {
+        if (span.y < first_row)
+            continue;
+        if (span.y > last_row)
+            break;
+        int start = max((int)span.x, first_column);
+        int end = min(span.x + span.length, end_column);
+        RGBA32* dst = m_target->scanline(dst_rect.y() + span.y) + dst_rect.x();
+        for (int x = start; x < end; ++x)
+            dst[x] = value;
+    }
 }
 
 void Painter::draw_emoji(const IntPoint& point, const Gfx::Bitmap& emoji, const Font& font)
@@ -853,9 +970,15 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf8View& text, const
     auto rect = a_rect;
     Utf8View final_text(text);
     String elided_text;
+
+    // Measure the line once; both elision and alignment need its width.
+    int text_width = 0;
+    bool is_left_aligned = alignment == TextAlignment::TopLeft || alignment == TextAlignment::CenterLeft;
+    if (elision == TextElision::Right || !is_left_aligned)
+        text_width = font.width(final_text);
+
     if (elision == TextElision::Right) {
-        int text_width = font.width(final_text);
-        if (font.width(final_text) > rect.width()) {
+        if (text_width > rect.width()) {
             int glyph_spacing = font.glyph_spacing();
             int byte_offset = 0;
             int new_width = font.width("...");
@@ -877,6 +1000,7 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf8View& text, const
                 builder.append("...");
                 elided_text = builder.to_string();
                 final_text = Utf8View { elided_text };
+                text_width = font.width(final_text);
             }
         }
     }
@@ -887,11 +1011,11 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf8View& text, const
         break;
     case TextAlignment::TopRight:
     case TextAlignment::CenterRight:
-        rect.set_x(rect.right() - font.width(final_text));
+        rect.set_x(rect.right() - text_width);
         break;
     case TextAlignment::Center: {
         auto shrunken_rect = rect;
-        shrunken_rect.set_width(font.width(final_text));
+        shrunken_rect.set_width(text_width);
         shrunken_rect.center_within(rect);
         rect = shrunken_rect;
         break;
@@ -918,9 +1042,15 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf32View& text, const
     auto rect = a_rect;
     Utf32View final_text(text);
     Vector<u32> elided_text;
+
+    // Measure the line once; both elision and alignment need its width.
+    int text_width = 0;
+    bool is_left_aligned = alignment == TextAlignment::TopLeft || alignment == TextAlignment::CenterLeft;
+    if (elision == TextElision::Right || !is_left_aligned)
+        text_width = font.width(final_text);
+
     if (elision == TextElision::Right) {
-        int text_width = font.width(final_text);
-        if (font.width(final_text) > rect.width()) {
+        if (text_width > rect.width()) {
             int glyph_spacing = font.glyph_spacing();
             int new_width = font.width("...");
             if (new_width < text_width) {
@@ -942,6 +1072,7 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf32View& text, const
                 elided_text.append('.');
                 elided_text.append('.');
                 final_text = Utf32View { elided_text.data(), elided_text.size() };
+                text_width = font.width(final_text);
             }
         }
     }
@@ -952,11 +1083,11 @@ void Painter::draw_text_line(const IntRect& a_rect, const Utf32View& text, const
         break;
     case TextAlignment::TopRight:
     case TextAlignment::CenterRight:
-        rect.set_x(rect.right() - font.width(final_text));
+        rect.set_x(rect.right() - text_width);
         break;
     case TextAlignment::Center: {
         auto shrunken_rect = rect;
-        shrunken_rect.set_width(font.width(final_text));
+        shrunken_rect.set_width(text_width);
         shrunken_rect.center_within(rect);
         rect = shrunken_rect;
         break;
@@ -1111,13 +1242,13 @@ void Painter::set_pixel(const IntPoint& p, Color color)
     point.move_by(state().translation);
     if (!clip_rect().contains(point))
         return;
-    m_target->scanline(point.y())[point.x()] = color.value();
+    m_target->scanline(point.y())[point.x()] = pixel_value(color);
 }
 
 ALWAYS_INLINE void Painter::set_pixel_with_draw_op(u32& pixel, const Color& color)
 {
     if (draw_op() == DrawOp::Copy)
-        pixel = color.value();
+        pixel = pixel_value(color);
     else if (draw_op() == DrawOp::Xor)
         pixel ^= color.value();
 }
@@ -1267,7 +1398,8 @@ static void split_quadratic_bezier_curve(const FloatPoint& original_control, con
 
 static bool can_approximate_bezier_curve(const FloatPoint& p1, const FloatPoint& p2, const FloatPoint& control)
 {
-    constexpr static int tolerance = 15;
+    // Keeps the curve within about a quarter pixel of the line, as antialiased fills would show anything coarser.
+    constexpr static int tolerance = 1;
 
     auto p1x = 3 * control.x() - 2 * p1.x() - p2.x();
     auto p1y = 3 * control.y() - 2 * p1.y() - p2.y();
@@ -1317,7 +1449,12 @@ static void split_elliptical_arc(const FloatPoint& p1, const FloatPoint& p2, con
 
 static bool can_approximate_elliptical_arc(const FloatPoint& p1, const FloatPoint& p2, const FloatPoint& center, const FloatPoint radii, float x_axis_rotation, float theta_1, float theta_delta)
 {
-    constexpr static float tolerance = 1;
+    constexpr static float tolerance = 0.25f;
+
+    // Don't keep splitting arcs shorter than the tolerance, which could otherwise
+    // happen forever if the end points are slightly off the ellipse.
+    if (fabsf(theta_delta) * max(fabsf(radii.x()), fabsf(radii.y())) < tolerance)
+        return true;
 
     auto half_theta_delta = theta_delta / 2.0f;
 
@@ -1385,187 +1522,367 @@ PainterStateSaver::~PainterStateSaver()
     m_painter.restore();
 }
 
-void Painter::stroke_path(const Path& path, Color color, int thickness)
-{
-    FloatPoint cursor;
+// Each pixel row is sampled at this many evenly spaced scanlines. Coverage along
+// a scanline is exact, so this only limits the precision of near-horizontal edges.
+static constexpr int path_samples_per_row = 8;
 
-    for (auto& segment : path.segments()) {
-        switch (segment.type()) {
-        case Segment::Type::Invalid:
-            ASSERT_NOT_REACHED();
-            break;
-        case Segment::Type::MoveTo:
-            cursor = segment.point();
-            break;
-        case Segment::Type::LineTo:
-            draw_line(cursor.to_type<int>(), segment.point().to_type<int>(), color, thickness);
-            cursor = segment.point();
-            break;
-        case Segment::Type::QuadraticBezierCurveTo: {
-            auto& through = static_cast<const QuadraticBezierCurveSegment&>(segment).through();
-            draw_quadratic_bezier_curve(through.to_type<int>(), cursor.to_type<int>(), segment.point().to_type<int>(), color, thickness);
-            cursor = segment.point();
-            break;
-        }
-        case Segment::Type::EllipticalArcTo:
-            auto& arc = static_cast<const EllipticalArcSegment&>(segment);
-            draw_elliptical_arc(cursor.to_type<int>(), segment.point().to_type<int>(), arc.center().to_type<int>(), arc.radii(), arc.x_axis_rotation(), arc.theta_1(), arc.theta_delta(), color, thickness);
-            cursor = segment.point();
-            break;
-        }
-    }
+static void append_edge(Vector<Path::SplitLineSegment>& edges, const FloatPoint& from, const FloatPoint& to)
+{
+    if (from.y() == to.y())
+        return;
+    auto& top = from.y() < to.y() ? from : to;
+    auto& bottom = from.y() < to.y() ? to : from;
+    edges.append({ from, to, (bottom.x() - top.x()) / (bottom.y() - top.y()), top.x(), bottom.y(), top.y(), from.y() < to.y() ? 1 : -1 });
 }
 
-//#define FILL_PATH_DEBUG
-
-void Painter::fill_path(Path& path, Color color, WindingRule winding_rule)
+// Scanline rasterizer with an active edge table. For every sample scanline, the
+// spans inside the shape are accumulated into a row of coverage deltas (split
+// between the two pixels around each span end, so partial pixels come out right),
+// and once per pixel row a running sum over the touched columns gives each
+// pixel's coverage. The edges must be sorted by minimum_y.
+static void rasterize_edges(Bitmap& target, const IntRect& clip_rect, const FloatPoint& translation, const Vector<Path::SplitLineSegment>& edges, Color color, Painter::WindingRule winding_rule)
 {
-    const auto& segments = path.split_lines();
-
-    if (segments.size() == 0)
+    if (edges.is_empty() || color.alpha() == 0 || clip_rect.is_empty())
         return;
 
-    Vector<Path::SplitLineSegment> active_list;
-    active_list.ensure_capacity(segments.size());
-
-    // first, grab the segments for the very first scanline
-    auto first_y = segments.first().maximum_y;
-    auto last_y = segments.last().minimum_y;
-    auto scanline = first_y;
-
-    size_t last_active_segment { 0 };
-
-    for (auto& segment : segments) {
-        if (segment.maximum_y != scanline)
-            break;
-        active_list.append(segment);
-        ++last_active_segment;
-    }
+    float minimum_y = edges.first().minimum_y + translation.y();
+    float maximum_y = minimum_y;
+    for (auto& edge : edges)
+        maximum_y = max(maximum_y, edge.maximum_y + translation.y());
 
-    auto is_inside_shape = [winding_rule](int winding_number) {
-        if (winding_rule == WindingRule::Nonzero)
-            return winding_number != 0;
+    int first_row = max(clip_rect.top(), (int)floorf(minimum_y));
+    int last_row = min(clip_rect.bottom(), (int)ceilf(maximum_y) - 1);
+    if (first_row > last_row)
+        return;
 
-        if (winding_rule == WindingRule::EvenOdd)
-            return winding_number % 2 == 0;
+    struct ActiveEdge {
+        const Path::SplitLineSegment* edge;
+        float x { 0 };
+        float top_x { 0 };
+        float bottom_x { 0 };
+    };
 
-        ASSERT_NOT_REACHED();
+    int width = clip_rect.width();
+    float left = clip_rect.left();
+    float right = clip_rect.right() + 1;
+    constexpr float sample_weight = 1.0f / path_samples_per_row;
+
+    Vector<float> coverage_buffer;
+    coverage_buffer.resize(width + 2);
+    for (auto& value : coverage_buffer)
+        value = 0;
+    float* coverage = coverage_buffer.data();
+
+    // One bit per column touched in the current row, so that thin shapes like
+    // strokes don't have to be composited across their whole width.
+    Vector<u32> touched_columns_buffer;
+    touched_columns_buffer.resize(((width + 1) >> 5) + 1);
+    for (auto& word : touched_columns_buffer)
+        word = 0;
+    u32* touched_columns = touched_columns_buffer.data();
+    int first_touched_word = touched_columns_buffer.size();
+    int last_touched_word = -1;
+
+    // Kept sorted by x from one scanline to the next, so re-sorting is usually a single pass.
+    Vector<ActiveEdge, 32> active_edges;
+    size_t next_edge = 0;
+
+    // Nonzero counts any winding as inside, even-odd only odd ones.
+    int winding_mask = winding_rule == Painter::WindingRule::Nonzero ? ~0 : 1;
+
+    RGBA32 opaque_value = target.is_premultiplied() ? color.to_premultiplied() : color.value();
+    // Like the pixel kernels, treat targets without an alpha channel as opaque.
+    bool blend_over_opaque = !target.has_alpha_channel();
+    float color_alpha = color.alpha();
+
+    auto mark_columns = [&](int first, int last) {
+        int first_word = first >> 5;
+        int last_word = last >> 5;
+        u32 first_mask = ~0u << (first & 31);
+        u32 last_mask = ~0u >> (31 - (last & 31));
+        if (first_word == last_word) {
+            touched_columns[first_word] |= first_mask & last_mask;
+        } else {
+            touched_columns[first_word] |= first_mask;
+            for (int word = first_word + 1; word < last_word; ++word)
+                touched_columns[word] = ~0u;
+            touched_columns[last_word] |= last_mask;
+        }
+        first_touched_word = min(first_touched_word, first_word);
+        last_touched_word = max(last_touched_word, last_word);
     };
 
-    auto increment_winding = [winding_rule](int& winding_number, const IntPoint& from, const IntPoint& to) {
-        if (winding_rule == WindingRule::EvenOdd) {
-            ++winding_number;
+    auto add_span = [&](float x0, float x1) {
+        x0 = max(x0, left) - left;
+        x1 = min(x1, right) - left;
+        if (x1 <= x0)
             return;
-        }
+        int i0 = x0;
+        int i1 = x1;
+        float f0 = x0 - i0;
+        float f1 = x1 - i1;
+        coverage[i0] += (1 - f0) * sample_weight;
+        coverage[i0 + 1] += f0 * sample_weight;
+        coverage[i1] -= (1 - f1) * sample_weight;
+        coverage[i1 + 1] -= f1 * sample_weight;
+        mark_columns(i0, i1 + 1);
+    };
 
-        if (winding_rule == WindingRule::Nonzero) {
-            if (from.dy_relative_to(to) < 0)
-                ++winding_number;
-            else
-                --winding_number;
+    // Adds the exact area to the right of an edge that crosses the whole row, from
+    // x0 to x1 (in either order, relative to the clip rect and inside it). Entering
+    // edges add it and leaving edges subtract it.
+    auto add_edge_area = [&](float x0, float x1, float sign) {
+        if (x0 > x1)
+            swap(x0, x1);
+        int i0 = x0;
+        int i1 = x1;
+        if (i1 < x1)
+            ++i1;
+        if (i1 <= i0 + 1) {
+            float middle = (x0 + x1) / 2 - i0;
+            coverage[i0] += sign * (1 - middle);
+            coverage[i0 + 1] += sign * middle;
             return;
         }
+        // The area left of the edge in the first and last pixel it crosses; each pixel
+        // in between gets an equal share of the rest.
+        float inverse_width = 1 / (x1 - x0);
+        float f0 = x0 - i0;
+        float f1 = x1 - i1 + 1;
+        float first_area = 0.5f * inverse_width * (1 - f0) * (1 - f0);
+        float last_area = 0.5f * inverse_width * f1 * f1;
+        coverage[i0] += sign * first_area;
+        if (i1 == i0 + 2) {
+            coverage[i0 + 1] += sign * (1 - first_area - last_area);
+        } else {
+            float second_area = inverse_width * (1.5f - f0);
+            coverage[i0 + 1] += sign * (second_area - first_area);
+            for (int i = i0 + 2; i < i1 - 1; ++i)
+                coverage[i] += sign * inverse_width;
+            float before_last_area = second_area + (i1 - i0 - 3) * inverse_width;
+            coverage[i1 - 1] += sign * (1 - before_last_area - last_area);
+        }
+        coverage[i1] += sign * last_area;
+    };
 
-        ASSERT_NOT_REACHED();
+    auto x_at = [&](const Path::SplitLineSegment& edge, float y) {
+        return edge.x_of_minimum_y + (y - edge.minimum_y) * edge.inverse_slope + translation.x();
     };
 
-    while (scanline >= last_y) {
-        if (active_list.size()) {
-            // sort the active list by 'x' from right to left
-            quick_sort(active_list, [](const auto& line0, const auto& line1) {
-                return line1.x < line0.x;
-            });
-#ifdef FILL_PATH_DEBUG
-            if ((int)scanline % 10 == 0) {
-                draw_text(IntRect(active_list.last().x - 20, scanline, 20, 10), String::format("%d", (int)scanline));
-            }
-#endif
+    auto for_each_span = [&](auto callback) {
+        int winding_number = 0;
+        const ActiveEdge* span_start = nullptr;
+        for (auto& active_edge : active_edges) {
+            bool was_inside = winding_number & winding_mask;
+            winding_number += active_edge.edge->winding;
+            bool is_inside = winding_number & winding_mask;
+            if (!was_inside && is_inside)
+                span_start = &active_edge;
+            else if (was_inside && !is_inside)
+                callback(*span_start, active_edge);
+        }
+    };
 
-            if (active_list.size() > 1) {
-                auto winding_number { 0 };
-                for (size_t i = 1; i < active_list.size(); ++i) {
-                    auto& previous = active_list[i - 1];
-                    auto& current = active_list[i];
-
-                    int int_distance = fabs(current.x - previous.x);
-                    IntPoint from(previous.x, scanline);
-                    IntPoint to(current.x, scanline);
-
-                    if (int_distance < 1) {
-                        // the two lines intersect on an int grid
-                        // so they should both be treated as a single line segment
-                        goto skip_drawing;
-                    }
-
-                    if (int_distance == 1 && is_inside_shape(winding_number)) {
-                        // The two lines form a singluar edge for the shape
-                        // while they do not intersect, they connect together
-                        goto skip_drawing;
-                    }
-
-                    if (is_inside_shape(winding_number)) {
-                        // The points between this segment and the previous are
-                        // inside the shape
-#ifdef FILL_PATH_DEBUG
-                        dbg() << "y=" << scanline << ": " << winding_number << " at " << i << ": " << from << " -- " << to;
-#endif
-                        draw_line(from, to, color, 1);
-                    }
+    for (int row = first_row; row <= last_row; ++row) {
+        // The row and its sample scanlines in path coordinates.
+        float row_top = row - translation.y();
+        float row_bottom = row_top + 1;
+
+        for (int sample = 0; sample < path_samples_per_row; ++sample) {
+            float y = row_top + (sample + 0.5f) * sample_weight;
+
+            size_t kept = 0;
+            for (auto& active_edge : active_edges) {
+                if (active_edge.edge->maximum_y > y)
+                    active_edges[kept++] = active_edge;
+            }
+            active_edges.shrink(kept, true);
+            for (; next_edge < edges.size() && edges[next_edge].minimum_y <= y; ++next_edge) {
+                if (edges[next_edge].maximum_y > y)
+                    active_edges.append({ &edges[next_edge] });
+            }
+            if (active_edges.is_empty())
+                continue;
 
-                skip_drawing:;
+            ActiveEdge* active = active_edges.data();
+            size_t active_count = active_edges.size();
+            for (size_t i = 0; i < active_count; ++i)
+                active[i].x = x_at(*active[i].edge, y);
+            // Insertion sort, as the edges are usually still in order from the previous scanline.
+            for (size_t i = 1; i < active_count; ++i) {
+                if (active[i - 1].x <= active[i].x)
+                    continue;
+                auto active_edge = active[i];
+                size_t j = i;
+                for (; j > 0 && active[j - 1].x > active_edge.x; --j)
+                    active[j] = active[j - 1];
+                active[j] = active_edge;
+            }
 
-                    auto is_passing_through_maxima = scanline == previous.maximum_y
-                        || scanline == previous.minimum_y
-                        || scanline == current.maximum_y
-                        || scanline == current.minimum_y;
+            // If every edge crosses the whole row without crossing another one, the
+            // spans are the same all the way down and their exact coverage can be
+            // added once. Straight edges in the same order at the top and bottom of
+            // the row don't cross in between. Most rows of a stroke are like this.
+            bool row_is_simple = sample == 0 && (next_edge == edges.size() || edges[next_edge].minimum_y >= row_bottom);
+            float previous_top_x = left;
+            float previous_bottom_x = left;
+            for (size_t i = 0; row_is_simple && i < active_count; ++i) {
+                auto& edge = *active[i].edge;
+                active[i].top_x = x_at(edge, row_top);
+                active[i].bottom_x = x_at(edge, row_bottom);
+                row_is_simple = edge.minimum_y <= row_top && edge.maximum_y >= row_bottom
+                    && active[i].top_x >= previous_top_x && active[i].bottom_x >= previous_bottom_x
+                    && active[i].top_x <= right && active[i].bottom_x <= right;
+                previous_top_x = active[i].top_x;
+                previous_bottom_x = active[i].bottom_x;
+            }
 
-                    auto is_passing_through_vertex = false;
+            if (!row_is_simple) {
+                for_each_span([&](auto& start, auto& end) { add_span(start.x, end.x); });
+                continue;
+            }
 
-                    if (is_passing_through_maxima) {
-                        is_passing_through_vertex = previous.x == current.x;
-                    }
+            for_each_span([&](auto& start, auto& end) {
+                add_edge_area(start.top_x - left, start.bottom_x - left, 1);
+                add_edge_area(end.top_x - left, end.bottom_x - left, -1);
+                mark_columns(min(start.top_x, start.bottom_x) - left, max(end.top_x, end.bottom_x) - left + 1);
+            });
+            break;
+        }
 
-                    if (!is_passing_through_vertex || previous.inverse_slope * current.inverse_slope < 0)
-                        increment_winding(winding_number, from, to);
+        if (last_touched_word < 0)
+            continue;
 
-                    // update the x coord
-                    active_list[i - 1].x -= active_list[i - 1].inverse_slope;
+        // Columns that weren't touched have no coverage deltas, so skipping them
+        // doesn't change the running sum.
+        RGBA32* dst = target.scanline(row) + clip_rect.left();
+        float accumulated = 0;
+        auto composite_column = [&](int i) {
+            accumulated += coverage[i];
+            coverage[i] = 0;
+            if (i >= width)
+                return;
+            int alpha = min(1.0f, max(0.0f, accumulated)) * color_alpha + 0.5f;
+            if (alpha == 0)
+                return;
+            if (alpha == 255)
+                dst[i] = opaque_value;
+            else if (blend_over_opaque)
+                dst[i] = blend_pixel(dst[i], opaque_value, alpha);
+            else
+                dst[i] = blend_into(target, dst[i], color.with_alpha(alpha));
+        };
+        for (int word = first_touched_word; word <= last_touched_word; ++word) {
+            u32 bits = touched_columns[word];
+            touched_columns[word] = 0;
+            int first = word << 5;
+            if (bits == ~0u && first + 32 <= width) {
+                // Inside a large shape most words have no deltas at all, so the
+                // whole word gets the coverage carried into it.
+                int alpha = min(1.0f, max(0.0f, accumulated)) * color_alpha + 0.5f;
+                bool uniform = alpha == 0 || alpha == 255;
+                for (int i = first; uniform && i < first + 32; ++i)
+                    uniform = coverage[i] == 0;
+                if (uniform) {
+                    if (alpha == 255)
+                        fast_u32_fill(dst + first, opaque_value, 32);
+                    continue;
                 }
-                active_list.last().x -= active_list.last().inverse_slope;
-            } else {
-                auto point = IntPoint(active_list[0].x, scanline);
-                draw_line(point, point, color);
-
-                // update the x coord
-                active_list.first().x -= active_list.first().inverse_slope;
             }
+            for (; bits; bits &= bits - 1)
+                composite_column(first + count_trailing_zeroes_32(bits));
         }
+        first_touched_word = touched_columns_buffer.size();
+        last_touched_word = -1;
+    }
+}
 
-        --scanline;
-        // remove any edge that goes out of bound from the active list
-        for (size_t i = 0, count = active_list.size(); i < count; ++i) {
-            if (scanline <= active_list[i].minimum_y) {
-                active_list.remove(i);
-                --count;
-                --i;
-            }
+void Painter::stroke_path(const Path& path, Color color, float thickness)
+{
+    if (color.alpha() == 0 || thickness <= 0)
+        return;
+
+    // Every subpath is stroked as a single outline, filled with the nonzero rule:
+    // forward along one side, back along the other, with butt caps at the ends.
+    // Where the direction turns noticeably, both sides pass through the vertex
+    // (which makes the outline equivalent to one quad per segment) and a round
+    // join is added. Everything is wound the same way, so overlaps never cancel
+    // out and translucent strokes don't double-blend.
+    float half_thickness = thickness / 2;
+    int join_sides = min(max((int)(half_thickness * 2), 6), 32);
+    Vector<Path::SplitLineSegment> edges;
+
+    auto add_join = [&](const FloatPoint& center) {
+        FloatPoint previous { center.x() + half_thickness, center.y() };
+        for (int i = 1; i <= join_sides; ++i) {
+            float angle = -2 * (float)M_PI * i / join_sides;
+            FloatPoint point { center.x() + half_thickness * cosf(angle), center.y() + half_thickness * sinf(angle) };
+            append_edge(edges, previous, point);
+            previous = point;
         }
-        for (size_t j = last_active_segment; j < segments.size(); ++j, ++last_active_segment) {
-            auto& segment = segments[j];
-            if (segment.maximum_y < scanline)
-                break;
-            if (segment.minimum_y >= scanline)
+    };
+
+    for (auto& points : path.flattened_subpaths()) {
+        if (points.size() < 2)
+            continue;
+
+        FloatPoint previous_direction;
+        FloatPoint previous_normal;
+        bool has_previous_segment = false;
+        for (size_t i = 1; i < points.size(); ++i) {
+            auto& from = points[i - 1];
+            auto& to = points[i];
+            float dx = to.x() - from.x();
+            float dy = to.y() - from.y();
+            float length = sqrtf(dx * dx + dy * dy);
+            if (length == 0)
                 continue;
+            FloatPoint direction { dx / length, dy / length };
+            FloatPoint normal { -direction.y() * half_thickness, direction.x() * half_thickness };
+
+            if (!has_previous_segment) {
+                append_edge(edges, from - normal, from + normal);
+            } else {
+                float cross = previous_direction.x() * direction.y() - previous_direction.y() * direction.x();
+                float dot = previous_direction.x() * direction.x() + previous_direction.y() * direction.y();
+                // The gap left between the two sides is about half_thickness * angle wide,
+                // so the many small turns of a flattened curve usually don't need a join.
+                if (dot < 0 || fabsf(cross) * half_thickness > 0.25f) {
+                    append_edge(edges, from + previous_normal, from);
+                    append_edge(edges, from, from + normal);
+                    append_edge(edges, from - normal, from);
+                    append_edge(edges, from, from - previous_normal);
+                    add_join(from);
+                } else {
+                    append_edge(edges, from + previous_normal, from + normal);
+                    append_edge(edges, from - normal, from - previous_normal);
+                }
+            }
+
+            append_edge(edges, from + normal, to + normal);
+            append_edge(edges, to - normal, from - normal);
 
-            active_list.append(segment);
+            previous_direction = direction;
+            previous_normal = normal;
+            has_previous_segment = true;
+        }
+
+        if (has_previous_segment) {
+            auto& end = points.last();
+            append_edge(edges, end + previous_normal, end - previous_normal);
         }
     }
 
-#ifdef FILL_PATH_DEBUG
-    size_t i { 0 };
-    for (auto& segment : segments)
-        draw_line(segment.from, segment.to, Color::from_hsv(++i / segments.size() * 255, 255, 255), 1);
-#endif
+    quick_sort(edges, [](const auto& line0, const auto& line1) {
+        return line0.minimum_y < line1.minimum_y;
+    });
+
+    rasterize_edges(*m_target, clip_rect(), FloatPoint(translation()), edges, color, WindingRule::Nonzero);
+}
+
+void Painter::fill_path(const Path& path, Color color, WindingRule winding_rule)
+{
+    rasterize_edges(*m_target, clip_rect(), FloatPoint(translation()), path.split_lines(), color, winding_rule);
 }
 
 }
@@ -89,13 +89,13 @@ public:
     static void for_each_line_segment_on_elliptical_arc(const FloatPoint& p1, const FloatPoint& p2, const FloatPoint& center, const FloatPoint radii, float x_axis_rotation, float theta_1, float theta_delta, Function<void(const FloatPoint&, const FloatPoint&)>&);
     static void for_each_line_segment_on_elliptical_arc(const FloatPoint& p1, const FloatPoint& p2, const FloatPoint& center, const FloatPoint radii, float x_axis_rotation, float theta_1, float theta_delta, Function<void(const FloatPoint&, const FloatPoint&)>&&);
 
-    void stroke_path(const Path&, Color, int thickness);
+    void stroke_path(const Path&, Color, float thickness);
 
     enum class WindingRule {
         Nonzero,
         EvenOdd,
     };
-    void fill_path(Path&, Color, WindingRule rule = WindingRule::Nonzero);
+    void fill_path(const Path&, Color, WindingRule rule = WindingRule::Nonzero);
 
     const Font& font() const { return *state().font; }
     void set_font(const Font& font) { state().font = &font; }
@@ -126,6 +126,8 @@ public:
     }
 
 protected:
+    RGBA32 pixel_value(Color) const;
+
     void set_pixel_with_draw_op(u32& pixel, const Color&);
     void fill_rect_with_draw_op(const IntRect&, Color);
     void blit_with_alpha(const IntPoint&, const Gfx::Bitmap&, const IntRect& src_rect);
@@ -38,7 +38,7 @@ void Path::close()
     if (m_segments.size() <= 1)
         return;
 
-    invalidate_split_lines();
+    invalidate_flattened_path();
 
     auto& last_point = m_segments.last().point();
 
@@ -58,7 +58,7 @@ void Path::close_all_subpaths()
     if (m_segments.size() <= 1)
         return;
 
-    invalidate_split_lines();
+    invalidate_flattened_path();
 
     Optional<FloatPoint> cursor, start_of_subpath;
     bool is_first_point_in_subpath { false };
@@ -144,60 +144,94 @@ String Path::to_string() const
     return builder.to_string();
 }
 
-void Path::segmentize_path()
+const Vector<Vector<FloatPoint>>& Path::flattened_subpaths() const
 {
-    Vector<SplitLineSegment> segments;
+    if (!m_flattened_subpaths.has_value())
+        flatten_path();
+    return m_flattened_subpaths.value();
+}
 
-    auto add_line = [&](const auto& p0, const auto& p1) {
-        float ymax = p0.y(), ymin = p1.y(), x_of_ymin = p1.x(), x_of_ymax = p0.x();
-        auto slope = p0.x() == p1.x() ? 0 : ((float)(p0.y() - p1.y())) / ((float)(p0.x() - p1.x()));
-        if (p0.y() < p1.y()) {
-            swap(ymin, ymax);
-            swap(x_of_ymin, x_of_ymax);
-        }
+const Vector<Path::SplitLineSegment>& Path::split_lines() const
+{
+    if (!m_split_lines.has_value())
+        segmentize_path();
+    return m_split_lines.value();
+}
+
+void Path::flatten_path() const
+{
+    Vector<Vector<FloatPoint>> subpaths;
 
-        segments.append({ FloatPoint(p0.x(), p0.y()),
-            FloatPoint(p1.x(), p1.y()),
-            slope == 0 ? 0 : 1 / slope,
-            x_of_ymin,
-            ymax, ymin, x_of_ymax });
+    auto add_point = [&](const FloatPoint& point) {
+        auto& subpath = subpaths.last();
+        if (subpath.last() != point)
+            subpath.append(point);
     };
 
     FloatPoint cursor { 0, 0 };
     for (auto& segment : m_segments) {
+        if (segment.type() != Segment::Type::MoveTo && subpaths.is_empty())
+            subpaths.append({ cursor });
+
         switch (segment.type()) {
         case Segment::Type::MoveTo:
-            cursor = segment.point();
+            if (!subpaths.is_empty() && subpaths.last().size() == 1)
+                subpaths.last().first() = segment.point();
+            else
+                subpaths.append({ segment.point() });
             break;
-        case Segment::Type::LineTo: {
-            add_line(cursor, segment.point());
-            cursor = segment.point();
+        case Segment::Type::LineTo:
+            add_point(segment.point());
             break;
-        }
         case Segment::Type::QuadraticBezierCurveTo: {
-            auto& control = static_cast<QuadraticBezierCurveSegment&>(segment).through();
-            Painter::for_each_line_segment_on_bezier_curve(control, cursor, segment.point(), [&](const FloatPoint& p0, const FloatPoint& p1) {
-                add_line(p0, p1);
+            auto& control = static_cast<const QuadraticBezierCurveSegment&>(segment).through();
+            Painter::for_each_line_segment_on_bezier_curve(control, cursor, segment.point(), [&](const FloatPoint&, const FloatPoint& p1) {
+                add_point(p1);
             });
-            cursor = segment.point();
             break;
         }
         case Segment::Type::EllipticalArcTo: {
-            auto& arc = static_cast<EllipticalArcSegment&>(segment);
-            Painter::for_each_line_segment_on_elliptical_arc(cursor, arc.point(), arc.center(), arc.radii(), arc.x_axis_rotation(), arc.theta_1(), arc.theta_delta(), [&](const FloatPoint& p0, const FloatPoint& p1) {
-                add_line(p0, p1);
+            auto& arc = static_cast<const EllipticalArcSegment&>(segment);
+            Painter::for_each_line_segment_on_elliptical_arc(cursor, arc.point(), arc.center(), arc.radii(), arc.x_axis_rotation(), arc.theta_1(), arc.theta_delta(), [&](const FloatPoint&, const FloatPoint& p1) {
+                add_point(p1);
             });
-            cursor = segment.point();
             break;
         }
         case Segment::Type::Invalid:
             ASSERT_NOT_REACHED();
         }
+        cursor = segment.point();
+    }
+
+    m_flattened_subpaths = move(subpaths);
+}
+
+void Path::segmentize_path() const
+{
+    Vector<SplitLineSegment> segments;
+
+    auto add_line = [&](const FloatPoint& p0, const FloatPoint& p1) {
+        if (p0.y() == p1.y())
+            return;
+        auto& top = p0.y() < p1.y() ? p0 : p1;
+        auto& bottom = p0.y() < p1.y() ? p1 : p0;
+        segments.append({ p0,
+            p1,
+            (bottom.x() - top.x()) / (bottom.y() - top.y()),
+            top.x(),
+            bottom.y(),
+            top.y(),
+            p0.y() < p1.y() ? 1 : -1 });
+    };
+
+    for (auto& subpath : flattened_subpaths()) {
+        for (size_t i = 1; i < subpath.size(); ++i)
+            add_line(subpath[i - 1], subpath[i]);
+        add_line(subpath.last(), subpath.first());
     }
 
-    // sort segments by ymax
     quick_sort(segments, [](const auto& line0, const auto& line1) {
-        return line1.maximum_y < line0.maximum_y;
+        return line0.minimum_y < line1.minimum_y;
     });
 
     m_split_lines = move(segments);
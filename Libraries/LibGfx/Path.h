@@ -139,56 +139,61 @@ public:
     void move_to(const FloatPoint& point)
     {
         append_segment<MoveSegment>(point);
+        invalidate_flattened_path();
     }
 
     void line_to(const FloatPoint& point)
     {
         append_segment<LineSegment>(point);
-        invalidate_split_lines();
+        invalidate_flattened_path();
     }
 
     void quadratic_bezier_curve_to(const FloatPoint& through, const FloatPoint& point)
     {
         append_segment<QuadraticBezierCurveSegment>(point, through);
-        invalidate_split_lines();
+        invalidate_flattened_path();
     }
 
     void elliptical_arc_to(const FloatPoint& point, const FloatPoint& center, const FloatPoint& radii, float x_axis_rotation, float theta_1, float theta_delta)
     {
         append_segment<EllipticalArcSegment>(point, center, radii, x_axis_rotation, theta_1, theta_delta);
-        invalidate_split_lines();
+        invalidate_flattened_path();
     }
 
     void close();
     void close_all_subpaths();
 
+    // A non-horizontal edge of the flattened path, oriented top to bottom.
+    // winding is +1 if the path runs downwards along it and -1 otherwise.
     struct SplitLineSegment {
         FloatPoint from, to;
         float inverse_slope;
         float x_of_minimum_y;
         float maximum_y;
         float minimum_y;
-        float x;
+        int winding;
     };
 
     const NonnullRefPtrVector<Segment>& segments() const { return m_segments; }
-    const auto& split_lines()
-    {
-        if (m_split_lines.has_value())
-            return m_split_lines.value();
-        segmentize_path();
-        ASSERT(m_split_lines.has_value());
-        return m_split_lines.value();
-    }
+
+    // The path with its curves flattened into polylines, one per subpath.
+    // Both this and split_lines() are computed once and reused until the path changes.
+    const Vector<Vector<FloatPoint>>& flattened_subpaths() const;
+
+    // The edges of the flattened path, with every subpath implicitly closed
+    // (as is required for filling), sorted by minimum_y.
+    const Vector<SplitLineSegment>& split_lines() const;
 
     String to_string() const;
 
 private:
-    void invalidate_split_lines()
+    void invalidate_flattened_path()
     {
+        m_flattened_subpaths.clear();
         m_split_lines.clear();
     }
-    void segmentize_path();
+    void flatten_path() const;
+    void segmentize_path() const;
 
     template<typename T, typename... Args>
     void append_segment(Args&&... args)
@@ -198,7 +203,8 @@ private:
 
     NonnullRefPtrVector<Segment> m_segments {};
 
-    Optional<Vector<SplitLineSegment>> m_split_lines {};
+    mutable Optional<Vector<Vector<FloatPoint>>> m_flattened_subpaths {};
+    mutable Optional<Vector<SplitLineSegment>> m_split_lines {};
 };
 
 inline const LogStream& operator<<(const LogStream& stream, const Path& path)
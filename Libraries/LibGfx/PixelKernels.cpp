@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Memory.h>
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
+#include <LibGfx/PixelKernels.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    define HAVE_SSE2_KERNELS
+#    include <cpuid.h>
+#    include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC optimize("O3")
+#endif
+
+namespace Gfx {
+
+static constexpr RGBA32 opaque_alpha = 0xff000000;
+
+// Scales all four channels, alpha included.
+ALWAYS_INLINE static RGBA32 scale_pixel(RGBA32 pixel, u32 factor)
+{
+    u32 a = divide_by_255((pixel >> 24) * factor);
+    u32 r = divide_by_255(((pixel >> 16) & 0xff) * factor);
+    u32 g = divide_by_255(((pixel >> 8) & 0xff) * factor);
+    u32 b = divide_by_255((pixel & 0xff) * factor);
+    return a << 24 | r << 16 | g << 8 | b;
+}
+
+static void copy_row_scalar(RGBA32* dst, const RGBA32* src, int count)
+{
+    fast_u32_copy(dst, src, count);
+}
+
+static void fill_row_scalar(RGBA32* dst, RGBA32 color, int count)
+{
+    fast_u32_fill(dst, color, count);
+}
+
+static void blend_color_row_scalar(RGBA32* dst, RGBA32 color, int count)
+{
+    u32 alpha = color >> 24;
+    for (int i = 0; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], color, alpha);
+}
+
+static void blend_row_scalar(RGBA32* dst, const RGBA32* src, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        u32 alpha = src[i] >> 24;
+        if (alpha == 0xff)
+            dst[i] = src[i];
+        else if (alpha)
+            dst[i] = blend_pixel(dst[i], src[i], alpha);
+    }
+}
+
+static void blend_row_with_opacity_scalar(RGBA32* dst, const RGBA32* src, int count, u8 alpha)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], src[i], alpha);
+}
+
+static void blend_premultiplied_row_scalar(RGBA32* dst, const RGBA32* src, int count, u8 opacity)
+{
+    for (int i = 0; i < count; ++i) {
+        RGBA32 pixel = src[i];
+        if (!pixel)
+            continue;
+        if (opacity != 0xff)
+            pixel = scale_pixel(pixel, opacity);
+        u32 alpha = pixel >> 24;
+        if (alpha == 0xff)
+            dst[i] = pixel;
+        else
+            dst[i] = blend_premultiplied_pixel(dst[i], pixel);
+    }
+}
+
+static void premultiply_row_scalar(RGBA32* pixels, int count)
+{
+    for (int i = 0; i < count; ++i)
+        pixels[i] = Color::from_rgba(pixels[i]).to_premultiplied();
+}
+
+static void unpremultiply_row_scalar(RGBA32* pixels, int count)
+{
+    for (int i = 0; i < count; ++i)
+        pixels[i] = Color::from_premultiplied(pixels[i]).value();
+}
+
+// The JFIF conversion coefficients in 14-bit fixed point. They all fit in an
+// i16, so the SSE2 kernel can use pmaddwd on interleaved Cb/Cr pairs.
+static constexpr int ycbcr_shift = 14;
+static constexpr int ycbcr_rounding = 1 << (ycbcr_shift - 1);
+static constexpr int cr_to_r = 22970;  // 1.402
+static constexpr int cb_to_g = -5638;  // -0.344136
+static constexpr int cr_to_g = -11700; // -0.714136
+static constexpr int cb_to_b = 29032;  // 1.772
+
+ALWAYS_INLINE static u32 clamp_to_u8(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static void ycbcr_to_rgb_row_scalar(RGBA32* dst, const u8* y, const u8* cb, const u8* cr, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        int luma = (y[i] << ycbcr_shift) + ycbcr_rounding;
+        int blue_difference = cb[i] - 128;
+        int red_difference = cr[i] - 128;
+        u32 r = clamp_to_u8((luma + cr_to_r * red_difference) >> ycbcr_shift);
+        u32 g = clamp_to_u8((luma + cb_to_g * blue_difference + cr_to_g * red_difference) >> ycbcr_shift);
+        u32 b = clamp_to_u8((luma + cb_to_b * blue_difference) >> ycbcr_shift);
+        dst[i] = opaque_alpha | (r << 16) | (g << 8) | b;
+    }
+}
+
+static const PixelKernels s_scalar_kernels {
+    "scalar",
+    copy_row_scalar,
+    fill_row_scalar,
+    blend_color_row_scalar,
+    blend_row_scalar,
+    blend_row_with_opacity_scalar,
+    blend_premultiplied_row_scalar,
+    premultiply_row_scalar,
+    unpremultiply_row_scalar,
+    ycbcr_to_rgb_row_scalar,
+};
+
+#ifdef HAVE_SSE2_KERNELS
+
+// Userland is built for plain i686, so the SSE2 kernels are compiled for
+// it explicitly and only ever called after checking CPUID.
+#    define SSE2_FUNCTION __attribute__((target("sse2")))
+
+SSE2_FUNCTION ALWAYS_INLINE static __m128i divide_by_255(__m128i values)
+{
+    values = _mm_add_epi16(values, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(values, _mm_srli_epi16(values, 8)), 8);
+}
+
+// Blends two pixels worth of 16-bit channels: (s * a + d * (255 - a)) / 255.
+SSE2_FUNCTION ALWAYS_INLINE static __m128i blend_channels(__m128i src, __m128i dst, __m128i alpha)
+{
+    const __m128i all_255 = _mm_set1_epi16(255);
+    return divide_by_255(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, _mm_sub_epi16(all_255, alpha))));
+}
+
+// Multiplies four pixels by per-channel factors given as two halves of 16-bit lanes.
+SSE2_FUNCTION ALWAYS_INLINE static __m128i scale_four_pixels(__m128i pixels, __m128i factors_low, __m128i factors_high)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low = divide_by_255(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), factors_low));
+    __m128i high = divide_by_255(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), factors_high));
+    return _mm_packus_epi16(low, high);
+}
+
+// Spreads each pixel's alpha to all four of its 16-bit channels.
+SSE2_FUNCTION ALWAYS_INLINE static __m128i broadcast_alpha(__m128i channels)
+{
+    channels = _mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_shufflehi_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+SSE2_FUNCTION ALWAYS_INLINE static __m128i blend_four_pixels(__m128i src, __m128i dst, __m128i alpha_low, __m128i alpha_high)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low = blend_channels(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), alpha_low);
+    __m128i high = blend_channels(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), alpha_high);
+    return _mm_or_si128(_mm_packus_epi16(low, high), _mm_set1_epi32(opaque_alpha));
+}
+
+SSE2_FUNCTION static void copy_row_sse2(RGBA32* dst, const RGBA32* src, int count)
+{
+    // "rep movsd" has a high startup cost but wins on long rows.
+    if (count >= 256)
+        return fast_u32_copy(dst, src, count);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 4));
+        _mm_storeu_si128((__m128i*)(dst + i), a);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), b);
+    }
+    for (; i < count; ++i)
+        dst[i] = src[i];
+}
+
+SSE2_FUNCTION static void fill_row_sse2(RGBA32* dst, RGBA32 color, int count)
+{
+    int i = 0;
+    // Align the destination so that the bulk of the row uses aligned stores.
+    for (; i < count && ((FlatPtr)(dst + i) & 15); ++i)
+        dst[i] = color;
+    __m128i colors = _mm_set1_epi32(color);
+    for (; i + 8 <= count; i += 8) {
+        _mm_store_si128((__m128i*)(dst + i), colors);
+        _mm_store_si128((__m128i*)(dst + i + 4), colors);
+    }
+    for (; i < count; ++i)
+        dst[i] = color;
+}
+
+SSE2_FUNCTION static void blend_color_row_sse2(RGBA32* dst, RGBA32 color, int count)
+{
+    u32 alpha = color >> 24;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i alphas = _mm_set1_epi16(alpha);
+    // The source half of the blend is the same for every pixel.
+    __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i low = blend_channels(src, _mm_unpacklo_epi8(pixels, zero), alphas);
+        __m128i high = blend_channels(src, _mm_unpackhi_epi8(pixels, zero), alphas);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(low, high), _mm_set1_epi32(opaque_alpha)));
+    }
+    for (; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], color, alpha);
+}
+
+SSE2_FUNCTION static void blend_row_sse2(RGBA32* dst, const RGBA32* src, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set1_epi32(opaque_alpha);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixels = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i alphas = _mm_and_si128(src_pixels, alpha_mask);
+        // Most pixels in icons and window shadows are fully opaque or fully transparent.
+        int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(alphas, alpha_mask));
+        if (opaque == 0xffff) {
+            _mm_storeu_si128((__m128i*)(dst + i), src_pixels);
+            continue;
+        }
+        int transparent = _mm_movemask_epi8(_mm_cmpeq_epi32(alphas, zero));
+        if (transparent == 0xffff)
+            continue;
+        __m128i dst_pixels = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i src_low = _mm_unpacklo_epi8(src_pixels, zero);
+        __m128i src_high = _mm_unpackhi_epi8(src_pixels, zero);
+        __m128i low = blend_channels(src_low, _mm_unpacklo_epi8(dst_pixels, zero), broadcast_alpha(src_low));
+        __m128i high = blend_channels(src_high, _mm_unpackhi_epi8(dst_pixels, zero), broadcast_alpha(src_high));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(low, high), alpha_mask));
+    }
+    blend_row_scalar(dst + i, src + i, count - i);
+}
+
+SSE2_FUNCTION static void blend_row_with_opacity_sse2(RGBA32* dst, const RGBA32* src, int count, u8 alpha)
+{
+    __m128i alphas = _mm_set1_epi16(alpha);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixels = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i dst_pixels = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), blend_four_pixels(src_pixels, dst_pixels, alphas, alphas));
+    }
+    blend_row_with_opacity_scalar(dst + i, src + i, count - i, alpha);
+}
+
+SSE2_FUNCTION static void blend_premultiplied_row_sse2(RGBA32* dst, const RGBA32* src, int count, u8 opacity)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i all_255 = _mm_set1_epi16(255);
+    const __m128i alpha_mask = _mm_set1_epi32(opaque_alpha);
+    __m128i opacities = _mm_set1_epi16(opacity);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixels = _mm_loadu_si128((const __m128i*)(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(src_pixels, zero)) == 0xffff)
+            continue;
+        if (opacity != 0xff) {
+            src_pixels = scale_four_pixels(src_pixels, opacities, opacities);
+        } else if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(src_pixels, alpha_mask), alpha_mask)) == 0xffff) {
+            _mm_storeu_si128((__m128i*)(dst + i), src_pixels);
+            continue;
+        }
+        __m128i inverse_alpha_low = _mm_sub_epi16(all_255, broadcast_alpha(_mm_unpacklo_epi8(src_pixels, zero)));
+        __m128i inverse_alpha_high = _mm_sub_epi16(all_255, broadcast_alpha(_mm_unpackhi_epi8(src_pixels, zero)));
+        __m128i dst_pixels = _mm_loadu_si128((const __m128i*)(dst + i));
+        dst_pixels = scale_four_pixels(dst_pixels, inverse_alpha_low, inverse_alpha_high);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(src_pixels, dst_pixels));
+    }
+    blend_premultiplied_row_scalar(dst + i, src + i, count - i, opacity);
+}
+
+SSE2_FUNCTION static void premultiply_row_sse2(RGBA32* pixels, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set1_epi32(opaque_alpha);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i original = _mm_loadu_si128((const __m128i*)(pixels + i));
+        __m128i alphas = _mm_and_si128(original, alpha_mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alphas, alpha_mask)) == 0xffff)
+            continue;
+        __m128i scaled = scale_four_pixels(original, broadcast_alpha(_mm_unpacklo_epi8(original, zero)), broadcast_alpha(_mm_unpackhi_epi8(original, zero)));
+        _mm_storeu_si128((__m128i*)(pixels + i), _mm_or_si128(_mm_andnot_si128(alpha_mask, scaled), alphas));
+    }
+    premultiply_row_scalar(pixels + i, count - i);
+}
+
+// Computes four 32-bit channel values from four luma values and four
+// interleaved (Cb - 128, Cr - 128) pairs, exactly like the scalar kernel.
+SSE2_FUNCTION ALWAYS_INLINE static __m128i ycbcr_channel(__m128i luma, __m128i differences, __m128i weights)
+{
+    return _mm_srai_epi32(_mm_add_epi32(luma, _mm_madd_epi16(differences, weights)), ycbcr_shift);
+}
+
+SSE2_FUNCTION static void ycbcr_to_rgb_row_sse2(RGBA32* dst, const u8* y, const u8* cb, const u8* cr, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i rounding = _mm_set1_epi32(ycbcr_rounding);
+    const __m128i red_weights = _mm_set1_epi32((u32)cr_to_r << 16);
+    const __m128i green_weights = _mm_set1_epi32(((u32)cr_to_g << 16) | (u16)cb_to_g);
+    const __m128i blue_weights = _mm_set1_epi32((u16)cb_to_b);
+    const __m128i alpha = _mm_set1_epi8((char)0xff);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lumas = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(y + i)), zero);
+        __m128i blue_differences = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(cb + i)), zero), bias);
+        __m128i red_differences = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(cr + i)), zero), bias);
+
+        __m128i luma_low = _mm_add_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(lumas, zero), ycbcr_shift), rounding);
+        __m128i luma_high = _mm_add_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(lumas, zero), ycbcr_shift), rounding);
+        __m128i differences_low = _mm_unpacklo_epi16(blue_differences, red_differences);
+        __m128i differences_high = _mm_unpackhi_epi16(blue_differences, red_differences);
+
+        __m128i r = _mm_packs_epi32(ycbcr_channel(luma_low, differences_low, red_weights), ycbcr_channel(luma_high, differences_high, red_weights));
+        __m128i g = _mm_packs_epi32(ycbcr_channel(luma_low, differences_low, green_weights), ycbcr_channel(luma_high, differences_high, green_weights));
+        __m128i b = _mm_packs_epi32(ycbcr_channel(luma_low, differences_low, blue_weights), ycbcr_channel(luma_high, differences_high, blue_weights));
+
+        // Saturate to bytes and interleave into BGRA order.
+        __m128i blue_green = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+        __m128i red_alpha = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), alpha);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi16(blue_green, red_alpha));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(blue_green, red_alpha));
+    }
+    ycbcr_to_rgb_row_scalar(dst + i, y + i, cb + i, cr + i, count - i);
+}
+
+static const PixelKernels s_sse2_kernels {
+    "sse2",
+    copy_row_sse2,
+    fill_row_sse2,
+    blend_color_row_sse2,
+    blend_row_sse2,
+    blend_row_with_opacity_sse2,
+    blend_premultiplied_row_sse2,
+    premultiply_row_sse2,
+    unpremultiply_row_scalar, // SSE2 has no integer division.
+    ycbcr_to_rgb_row_sse2,
+};
+
+static bool cpu_has_sse2()
+{
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return edx & bit_SSE2;
+}
+
+#endif
+
+const PixelKernels& scalar_pixel_kernels()
+{
+    return s_scalar_kernels;
+}
+
+const PixelKernels* sse2_pixel_kernels()
+{
+#ifdef HAVE_SSE2_KERNELS
+    static bool supported = cpu_has_sse2();
+    if (supported)
+        return &s_sse2_kernels;
+#endif
+    return nullptr;
+}
+
+const PixelKernels& pixel_kernels()
+{
+    static const PixelKernels* kernels = sse2_pixel_kernels() ?: &s_scalar_kernels;
+    return *kernels;
+}
+
+}
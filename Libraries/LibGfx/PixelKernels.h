@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <LibGfx/Color.h>
+
+namespace Gfx {
+
+// Divides by 255 with rounding, exact for every value the blending can produce.
+ALWAYS_INLINE u32 divide_by_255(u32 value)
+{
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+// Blends src over an opaque dst with the given alpha. The result is opaque.
+ALWAYS_INLINE RGBA32 blend_pixel(RGBA32 dst, RGBA32 src, u32 alpha)
+{
+    u32 inverse_alpha = 255 - alpha;
+    u32 r = divide_by_255(((src >> 16) & 0xff) * alpha + ((dst >> 16) & 0xff) * inverse_alpha);
+    u32 g = divide_by_255(((src >> 8) & 0xff) * alpha + ((dst >> 8) & 0xff) * inverse_alpha);
+    u32 b = divide_by_255((src & 0xff) * alpha + (dst & 0xff) * inverse_alpha);
+    return 0xff000000 | r << 16 | g << 8 | b;
+}
+
+// src + dst * (255 - src alpha), saturating like paddusb so that malformed
+// premultiplied input can't bleed into neighbouring channels.
+ALWAYS_INLINE RGBA32 blend_premultiplied_pixel(RGBA32 dst, RGBA32 src)
+{
+    u32 inverse_alpha = 255 - (src >> 24);
+    auto channel = [&](int shift) {
+        return min(255u, ((src >> shift) & 0xff) + divide_by_255(((dst >> shift) & 0xff) * inverse_alpha)) << shift;
+    };
+    return channel(24) | channel(16) | channel(8) | channel(0);
+}
+
+// Row primitives behind the Painter's hottest loops. Unless noted otherwise,
+// the blending kernels treat the destination as opaque (as it is for the
+// window server's back buffers) and always produce opaque pixels, computing
+// dst = (src * a + dst * (255 - a)) / 255 with exact rounding.
+struct PixelKernels {
+    const char* name;
+
+    void (*copy_row)(RGBA32* dst, const RGBA32* src, int count);
+    void (*fill_row)(RGBA32* dst, RGBA32 color, int count);
+
+    // Blends a single color with alpha over a row.
+    void (*blend_color_row)(RGBA32* dst, RGBA32 color, int count);
+
+    // Blends each source pixel using its own alpha channel.
+    void (*blend_row)(RGBA32* dst, const RGBA32* src, int count);
+
+    // Blends the (opaque) source pixels using a constant alpha.
+    void (*blend_row_with_opacity)(RGBA32* dst, const RGBA32* src, int count, u8 alpha);
+
+    // Blends premultiplied source pixels, scaled by opacity, over an opaque
+    // or premultiplied destination: dst = src * o + dst * (255 - a * o).
+    void (*blend_premultiplied_row)(RGBA32* dst, const RGBA32* src, int count, u8 opacity);
+
+    // Converts RGBA32 pixels to RGBA32Premultiplied in place.
+    void (*premultiply_row)(RGBA32* pixels, int count);
+
+    // Converts RGBA32Premultiplied pixels back to RGBA32 in place.
+    void (*unpremultiply_row)(RGBA32* pixels, int count);
+
+    // Converts a row of JFIF YCbCr samples to opaque pixels.
+    void (*ycbcr_to_rgb_row)(RGBA32* dst, const u8* y, const u8* cb, const u8* cr, int count);
+};
+
+// The fastest kernels supported by this CPU, picked once at startup.
+const PixelKernels& pixel_kernels();
+
+// Direct access for benchmarks and tests. sse2_pixel_kernels() returns
+// nullptr if the CPU doesn't support SSE2.
+const PixelKernels& scalar_pixel_kernels();
+const PixelKernels* sse2_pixel_kernels();
+
+}
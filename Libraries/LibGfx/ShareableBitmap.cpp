@@ -47,6 +47,7 @@ bool encode(Encoder& encoder, const Gfx::ShareableBitmap& shareable_bitmap)
     encoder << shareable_bitmap.shbuf_id();
     encoder << shareable_bitmap.width();
     encoder << shareable_bitmap.height();
+    encoder << (u32)(shareable_bitmap.bitmap() ? shareable_bitmap.bitmap()->format() : Gfx::BitmapFormat::Invalid);
     return true;
 }
 
@@ -54,21 +55,29 @@ bool decode(Decoder& decoder, Gfx::ShareableBitmap& shareable_bitmap)
 {
     i32 shbuf_id = 0;
     Gfx::IntSize size;
+    u32 raw_format = 0;
     if (!decoder.decode(shbuf_id))
         return false;
     if (!decoder.decode(size))
         return false;
+    if (!decoder.decode(raw_format))
+        return false;
 
     if (shbuf_id == -1)
         return true;
 
     dbg() << "Decoding a ShareableBitmap with shbuf_id=" << shbuf_id << ", size=" << size;
 
+    // Indexed bitmaps would need their palette sent along as well.
+    auto format = (Gfx::BitmapFormat)raw_format;
+    if (format != Gfx::BitmapFormat::RGB32 && format != Gfx::BitmapFormat::RGBA32 && format != Gfx::BitmapFormat::RGBA32Premultiplied)
+        return false;
+
     auto shared_buffer = SharedBuffer::create_from_shbuf_id(shbuf_id);
     if (!shared_buffer)
         return false;
 
-    auto bitmap = Gfx::Bitmap::create_with_shared_buffer(Gfx::BitmapFormat::RGBA32, shared_buffer.release_nonnull(), size);
+    auto bitmap = Gfx::Bitmap::create_with_shared_buffer(format, shared_buffer.release_nonnull(), size);
     shareable_bitmap = bitmap->to_shareable_bitmap();
     return true;
 }
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibHTTP/CachePolicy.h>
+
+namespace HTTP {
+
+void CachePolicy::parse_cache_control(const Optional<String>& cache_control, const Optional<String>& pragma)
+{
+    if (cache_control.has_value()) {
+        for (auto& part : cache_control.value().split(',')) {
+            auto directive = part.trim_whitespace().to_lowercase();
+            if (directive == "no-store") {
+                m_no_store = true;
+            } else if (directive == "no-cache") {
+                m_no_cache = true;
+            } else if (directive == "private" || directive.starts_with("private=")) {
+                m_private = true;
+            } else if (directive.starts_with("max-age=")) {
+                auto max_age = directive.substring_view(8, directive.length() - 8).to_uint();
+                if (max_age.has_value())
+                    m_max_age = max_age.value();
+            }
+        }
+    }
+
+    if (!cache_control.has_value() && pragma.has_value() && pragma.value().trim_whitespace().equals_ignoring_case("no-cache"))
+        m_no_cache = true;
+}
+
+CachePolicy CachePolicy::from_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>& headers)
+{
+    CachePolicy policy;
+    policy.parse_cache_control(headers.get("Cache-Control"), headers.get("Pragma"));
+
+    // Requests for the same URL never differ in the headers a server would vary on,
+    // so only "Vary: *" makes a response unusable for us.
+    auto vary = headers.get("Vary");
+    if (vary.has_value() && vary.value().trim_whitespace() == "*")
+        policy.m_no_store = true;
+
+    auto date = headers.get("Date");
+    if (date.has_value())
+        policy.m_date = parse_http_date(date.value());
+
+    // An Expires header we can't make sense of (like "0") means the response has already expired.
+    auto expires = headers.get("Expires");
+    if (expires.has_value())
+        policy.m_expires = parse_http_date(expires.value()).value_or(0);
+
+    policy.m_etag = headers.get("ETag").value_or({});
+    policy.m_last_modified = headers.get("Last-Modified").value_or({});
+    return policy;
+}
+
+CachePolicy CachePolicy::from_request_headers(const HashMap<String, String>& headers)
+{
+    Optional<String> cache_control;
+    Optional<String> pragma;
+    for (auto& it : headers) {
+        if (it.key.equals_ignoring_case("Cache-Control"))
+            cache_control = it.value;
+        else if (it.key.equals_ignoring_case("Pragma"))
+            pragma = it.value;
+    }
+
+    CachePolicy policy;
+    policy.parse_cache_control(cache_control, pragma);
+    return policy;
+}
+
+static bool is_leap_year(unsigned year)
+{
+    return (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+}
+
+static Optional<unsigned> parse_month(const StringView& name)
+{
+    static const char* month_names[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    for (unsigned i = 0; i < 12; ++i) {
+        if (name == month_names[i])
+            return i;
+    }
+    return {};
+}
+
+static Optional<time_t> make_utc_time(Optional<unsigned> year, Optional<unsigned> month, Optional<unsigned> day, const StringView& time_of_day)
+{
+    auto time_parts = time_of_day.split_view(':');
+    if (!year.has_value() || !month.has_value() || !day.has_value() || time_parts.size() != 3)
+        return {};
+    auto hour = time_parts[0].to_uint();
+    auto minute = time_parts[1].to_uint();
+    auto second = time_parts[2].to_uint();
+    if (!hour.has_value() || !minute.has_value() || !second.has_value())
+        return {};
+    if (year.value() < 1970 || day.value() < 1 || day.value() > 31 || hour.value() > 23 || minute.value() > 59 || second.value() > 60)
+        return {};
+
+    static const unsigned days_before_month[] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+    u64 days = days_before_month[month.value()] + day.value() - 1;
+    if (month.value() > 1 && is_leap_year(year.value()))
+        ++days;
+    for (unsigned y = 1970; y < year.value(); ++y)
+        days += is_leap_year(y) ? 366 : 365;
+    return (time_t)(days * 86400 + hour.value() * 3600 + minute.value() * 60 + second.value());
+}
+
+Optional<time_t> CachePolicy::parse_http_date(const String& date)
+{
+    auto trimmed_date = date.trim_whitespace();
+    auto parts = trimmed_date.split_view(' ');
+
+    // IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+    if (parts.size() == 6 && parts[0].ends_with(',') && parts[5] == "GMT")
+        return make_utc_time(parts[3].to_uint(), parse_month(parts[2]), parts[1].to_uint(), parts[4]);
+
+    // Obsolete RFC 850 format: "Sunday, 06-Nov-94 08:49:37 GMT"
+    if (parts.size() == 4 && parts[0].ends_with(',') && parts[3] == "GMT") {
+        auto date_parts = parts[1].split_view('-');
+        if (date_parts.size() != 3)
+            return {};
+        auto year = date_parts[2].to_uint();
+        if (year.has_value() && year.value() < 100)
+            year = year.value() + (year.value() < 70 ? 2000 : 1900);
+        return make_utc_time(year, parse_month(date_parts[1]), date_parts[0].to_uint(), parts[2]);
+    }
+
+    // ANSI C's asctime() format: "Sun Nov  6 08:49:37 1994"
+    if (parts.size() == 5)
+        return make_utc_time(parts[4].to_uint(), parse_month(parts[1]), parts[2].to_uint(), parts[3]);
+
+    return {};
+}
+
+u32 CachePolicy::freshness_lifetime(time_t response_time) const
+{
+    if (m_no_store || m_no_cache)
+        return 0;
+    if (m_max_age.has_value())
+        return m_max_age.value();
+
+    // Without a Date header, the time we received the response is the next best thing.
+    time_t date = m_date.value_or(response_time);
+    if (m_expires.has_value())
+        return m_expires.value() > date ? m_expires.value() - date : 0;
+
+    if (m_last_modified.is_null())
+        return 0;
+    auto last_modified = parse_http_date(m_last_modified);
+    if (!last_modified.has_value() || last_modified.value() >= date)
+        return 0;
+    return (date - last_modified.value()) / 10;
+}
+
+bool CachePolicy::is_fresh(time_t response_time, time_t now) const
+{
+    if (now < response_time)
+        return false;
+    return (u64)(now - response_time) < freshness_lifetime(response_time);
+}
+
+void CachePolicy::add_revalidation_headers(HashMap<String, String>& request_headers) const
+{
+    if (!m_etag.is_null())
+        request_headers.set("If-None-Match", m_etag);
+    if (!m_last_modified.is_null())
+        request_headers.set("If-Modified-Since", m_last_modified);
+}
+
+bool CachePolicy::matches_revalidation_headers(const HashMap<String, String>& request_headers) const
+{
+    if (!can_revalidate())
+        return false;
+    if (request_headers.get("If-None-Match").value_or({}) != m_etag)
+        return false;
+    return request_headers.get("If-Modified-Since").value_or({}) == m_last_modified;
+}
+
+void CachePolicy::update_headers_after_revalidation(HashMap<String, String, CaseInsensitiveStringTraits>& stored_headers, const HashMap<String, String, CaseInsensitiveStringTraits>& not_modified_headers)
+{
+    for (auto& it : not_modified_headers) {
+        if (it.key.equals_ignoring_case("Content-Length") || it.key.equals_ignoring_case("Transfer-Encoding"))
+            continue;
+        stored_headers.set(it.key, it.value);
+    }
+}
+
+}
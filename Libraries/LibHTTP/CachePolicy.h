@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <time.h>
+
+namespace HTTP {
+
+// What a response's caching headers (RFC 7234) say about storing it, how long it can be
+// reused without asking the server again, and how to revalidate it once it has gone stale.
+class CachePolicy {
+public:
+    static CachePolicy from_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>&);
+    // Requests can carry Cache-Control and Pragma too, asking caches not to store or reuse responses.
+    static CachePolicy from_request_headers(const HashMap<String, String>&);
+
+    // Parses the three date formats allowed in HTTP/1.1 (RFC 7231, section 7.1.1.1).
+    static Optional<time_t> parse_http_date(const String&);
+
+    bool is_storable() const { return !m_no_store; }
+    // Responses marked "private" are meant for a single user and mustn't go into a cache shared between users.
+    bool is_storable_in_shared_cache() const { return is_storable() && !m_private; }
+    bool can_revalidate() const { return !m_etag.is_null() || !m_last_modified.is_null(); }
+
+    // For requests: whether a stored response has to be revalidated with the server before it can be used.
+    bool requires_revalidation() const { return m_no_cache || (m_max_age.has_value() && !m_max_age.value()); }
+
+    // Without max-age or Expires, a response is considered fresh for a tenth of the time since it was last modified.
+    // Responses that don't say when they were last modified are stale right away.
+    u32 freshness_lifetime(time_t response_time) const;
+    bool is_fresh(time_t response_time, time_t now) const;
+
+    // Adds If-None-Match / If-Modified-Since so that the server can answer with 304 Not Modified.
+    void add_revalidation_headers(HashMap<String, String>&) const;
+    bool matches_revalidation_headers(const HashMap<String, String>&) const;
+
+    // A 304 Not Modified response's headers replace the stored ones, except for those describing its (empty) body.
+    static void update_headers_after_revalidation(HashMap<String, String, CaseInsensitiveStringTraits>& stored_headers, const HashMap<String, String, CaseInsensitiveStringTraits>& not_modified_headers);
+
+    const String& etag() const { return m_etag; }
+    const String& last_modified() const { return m_last_modified; }
+
+private:
+    void parse_cache_control(const Optional<String>& cache_control, const Optional<String>& pragma);
+
+    bool m_no_store { false };
+    bool m_no_cache { false };
+    bool m_private { false };
+    Optional<u32> m_max_age;
+    Optional<time_t> m_date;
+    Optional<time_t> m_expires;
+    String m_etag;
+    String m_last_modified;
+};
+
+}
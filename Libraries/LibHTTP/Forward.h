@@ -28,6 +28,7 @@
 
 namespace HTTP {
 
+class CachePolicy;
 class HttpRequest;
 class HttpResponse;
 class HttpJob;
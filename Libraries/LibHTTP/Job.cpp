@@ -25,6 +25,7 @@
  */
 
 #include <LibCore/Gzip.h>
+#include <LibCore/Inflate.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
@@ -65,6 +66,20 @@ static ByteBuffer handle_content_encoding(const ByteBuffer& buf, const String& c
         return uncompressed.value();
     }
 
+    if (content_encoding == "deflate") {
+        // "deflate" is supposed to be zlib wrapped, but plenty of servers send raw DEFLATE data.
+        auto payload = buf.span();
+        if (buf.size() > 2 && (buf[0] & 0x0f) == 8 && ((buf[0] << 8) | buf[1]) % 31 == 0)
+            payload = payload.slice(2, buf.size() - 2);
+
+        auto uncompressed = Core::Inflate::decompress_all(payload);
+        if (!uncompressed.has_value()) {
+            dbg() << "Job::handle_content_encoding: Inflate::decompress_all() failed. Returning original buffer.";
+            return buf;
+        }
+        return uncompressed.value();
+    }
+
     return buf;
 }
 
@@ -291,6 +306,10 @@ void Job::on_socket_connected()
 
             deferred_invoke([this, content_length](auto&) { did_progress(content_length, m_received_size); });
 
+            // Encoded content can only be decoded once all of it has arrived.
+            if (payload && !m_headers.contains("Content-Encoding"))
+                deferred_invoke([this, payload](auto&) { did_receive_data(payload); });
+
             if (content_length.has_value()) {
                 auto length = content_length.value();
                 if (m_received_size >= length) {
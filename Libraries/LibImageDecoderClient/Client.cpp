@@ -42,10 +42,6 @@ void Client::handshake()
     set_server_pid(response->server_pid());
 }
 
-void Client::handle(const Messages::ImageDecoderClient::Dummy&)
-{
-}
-
 RefPtr<Gfx::Bitmap> Client::decode_image(const ByteBuffer& encoded_data)
 {
     if (encoded_data.is_empty())
@@ -85,4 +81,112 @@ RefPtr<Gfx::Bitmap> Client::decode_image(const ByteBuffer& encoded_data)
     return Gfx::Bitmap::create_with_shared_buffer(bitmap_format, decoded_buffer.release_nonnull(), response->size(), response->palette());
 }
 
+i32 Client::start_streaming_decode(size_t encoded_size, const Gfx::IntSize& minimum_size, DecodeCallback callback)
+{
+    if (!encoded_size)
+        return -1;
+
+    auto encoded_buffer = SharedBuffer::create_with_size(encoded_size);
+    if (!encoded_buffer) {
+        dbg() << "Could not allocate encoded shbuf";
+        return -1;
+    }
+    encoded_buffer->share_with(server_pid());
+
+    auto decode_id = send_sync<Messages::ImageDecoderServer::StartDecode>(encoded_buffer->shbuf_id(), encoded_size, minimum_size)->decode_id();
+    if (decode_id < 0)
+        return -1;
+
+    auto decode = make<StreamingDecode>();
+    decode->encoded_buffer = move(encoded_buffer);
+    decode->encoded_size = encoded_size;
+    decode->callback = move(callback);
+    m_streaming_decodes.set(decode_id, move(decode));
+    return decode_id;
+}
+
+bool Client::append_streaming_data(i32 decode_id, const u8* data, size_t size)
+{
+    auto it = m_streaming_decodes.find(decode_id);
+    if (it == m_streaming_decodes.end())
+        return false;
+    auto& decode = *it->value;
+    if (decode.received_size + size > decode.encoded_size)
+        return false;
+
+    memcpy((u8*)decode.encoded_buffer->data() + decode.received_size, data, size);
+    decode.received_size += size;
+    if (decode.received_size == decode.encoded_size)
+        decode.encoded_buffer->seal();
+    post_message(Messages::ImageDecoderServer::DidReceiveEncodedData(decode_id, decode.received_size));
+    return true;
+}
+
+i32 Client::decode_image_async(const ByteBuffer& encoded_data, const Gfx::IntSize& minimum_size, Function<void(RefPtr<Gfx::Bitmap>)> on_decoded)
+{
+    auto decode_id = start_streaming_decode(encoded_data.size(), minimum_size, [on_decoded = move(on_decoded)](auto bitmap, auto&, bool is_complete) {
+        if (is_complete)
+            on_decoded(move(bitmap));
+    });
+    if (decode_id < 0)
+        return -1;
+    append_streaming_data(decode_id, encoded_data.data(), encoded_data.size());
+    return decode_id;
+}
+
+void Client::stop_streaming_decode(i32 decode_id)
+{
+    if (!m_streaming_decodes.contains(decode_id))
+        return;
+    m_streaming_decodes.remove(decode_id);
+    post_message(Messages::ImageDecoderServer::StopDecode(decode_id));
+}
+
+void Client::handle(const Messages::ImageDecoderClient::DecodeProgress& message)
+{
+    auto decode_id = message.decode_id();
+    auto it = m_streaming_decodes.find(decode_id);
+    if (it == m_streaming_decodes.end())
+        return;
+    auto& decode = *it->value;
+
+    if (!decode.bitmap || decode.bitmap->shbuf_id() != message.decoded_shbuf_id()) {
+        auto decoded_buffer = SharedBuffer::create_from_shbuf_id(message.decoded_shbuf_id());
+        if (decoded_buffer)
+            decode.bitmap = Gfx::Bitmap::create_with_shared_buffer((Gfx::BitmapFormat)message.bitmap_format(), decoded_buffer.release_nonnull(), message.size());
+        if (!decode.bitmap) {
+            dbg() << "Could not map decoded image shbuf_id=" << message.decoded_shbuf_id();
+            auto callback = move(decode.callback);
+            stop_streaming_decode(decode_id);
+            callback(nullptr, {}, true);
+            return;
+        }
+    }
+
+    if (!message.is_complete()) {
+        // The callback may well stop the decode, so hold on to it while it runs.
+        auto callback = move(decode.callback);
+        callback(decode.bitmap, message.changed_rect(), false);
+        if (auto it = m_streaming_decodes.find(decode_id); it != m_streaming_decodes.end())
+            it->value->callback = move(callback);
+        return;
+    }
+
+    // We have mapped the bitmap, so the decoder doesn't need to keep it around anymore.
+    auto bitmap = decode.bitmap;
+    auto callback = move(decode.callback);
+    stop_streaming_decode(decode_id);
+    callback(move(bitmap), message.changed_rect(), true);
+}
+
+void Client::handle(const Messages::ImageDecoderClient::DecodeFailed& message)
+{
+    auto it = m_streaming_decodes.find(message.decode_id());
+    if (it == m_streaming_decodes.end())
+        return;
+    auto callback = move(it->value->callback);
+    m_streaming_decodes.remove(message.decode_id());
+    callback(nullptr, {}, true);
+}
+
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
@@ -43,10 +44,33 @@ public:
 
     RefPtr<Gfx::Bitmap> decode_image(const ByteBuffer&);
 
+    // Decodes an image while its data is still arriving. The callback is invoked with the
+    // bitmap decoded so far whenever part of it changes, and a null bitmap if decoding failed.
+    // After it has been called with is_complete, the decode is over and its id is no longer valid.
+    // If minimum_size isn't empty, the bitmap may be smaller than the image, but still at least that large.
+    using DecodeCallback = Function<void(RefPtr<Gfx::Bitmap>, const Gfx::IntRect& changed_rect, bool is_complete)>;
+    i32 start_streaming_decode(size_t encoded_size, const Gfx::IntSize& minimum_size, DecodeCallback);
+    bool append_streaming_data(i32 decode_id, const u8* data, size_t size);
+    void stop_streaming_decode(i32 decode_id);
+
+    // Decodes an image without waiting for the decoder. The callback is invoked with the decoded
+    // bitmap (or null if decoding failed) once it's done, unless the decode is stopped before that.
+    i32 decode_image_async(const ByteBuffer&, const Gfx::IntSize& minimum_size, Function<void(RefPtr<Gfx::Bitmap>)>);
+
 private:
     Client();
 
-    virtual void handle(const Messages::ImageDecoderClient::Dummy&) override;
+    virtual void handle(const Messages::ImageDecoderClient::DecodeProgress&) override;
+    virtual void handle(const Messages::ImageDecoderClient::DecodeFailed&) override;
+
+    struct StreamingDecode {
+        RefPtr<SharedBuffer> encoded_buffer;
+        size_t encoded_size { 0 };
+        size_t received_size { 0 };
+        RefPtr<Gfx::Bitmap> bitmap;
+        DecodeCallback callback;
+    };
+    HashMap<i32, NonnullOwnPtr<StreamingDecode>> m_streaming_decodes;
 };
 
 }
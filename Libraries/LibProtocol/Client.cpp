@@ -73,6 +73,9 @@ void Client::handle(const Messages::ProtocolClient::DownloadFinished& message)
     RefPtr<Download> download;
     if ((download = m_downloads.get(message.download_id()).value_or(nullptr))) {
         download->did_finish({}, message.success(), message.status_code(), message.total_size(), message.shbuf_id(), message.response_headers());
+        auto received_data_shbuf_id = download->received_data_shbuf_id();
+        if (received_data_shbuf_id != -1 && received_data_shbuf_id != message.shbuf_id())
+            send_sync<Messages::ProtocolServer::DisownSharedBuffer>(received_data_shbuf_id);
     }
     send_sync<Messages::ProtocolServer::DisownSharedBuffer>(message.shbuf_id());
     m_downloads.remove(message.download_id());
@@ -85,4 +88,11 @@ void Client::handle(const Messages::ProtocolClient::DownloadProgress& message)
     }
 }
 
+void Client::handle(const Messages::ProtocolClient::DownloadDataReceived& message)
+{
+    if (auto download = const_cast<Download*>(m_downloads.get(message.download_id()).value_or(nullptr))) {
+        download->did_receive_data({}, message.shbuf_id(), message.total_size(), message.received_size());
+    }
+}
+
 }
@@ -53,6 +53,7 @@ private:
     Client();
 
     virtual void handle(const Messages::ProtocolClient::DownloadProgress&) override;
+    virtual void handle(const Messages::ProtocolClient::DownloadDataReceived&) override;
     virtual void handle(const Messages::ProtocolClient::DownloadFinished&) override;
 
     HashMap<i32, RefPtr<Download>> m_downloads;
@@ -67,4 +67,23 @@ void Download::did_progress(Badge<Client>, Optional<u32> total_size, u32 downloa
     if (on_progress)
         on_progress(total_size, downloaded_size);
 }
+
+void Download::did_receive_data(Badge<Client>, i32 shbuf_id, u32 total_size, u32 received_size)
+{
+    if (!m_received_data) {
+        m_received_data = SharedBuffer::create_from_shbuf_id(shbuf_id);
+        if (!m_received_data)
+            return;
+    }
+    if (received_size > total_size || total_size > (u32)m_received_data->size())
+        return;
+
+    if (on_data_received)
+        on_data_received(ByteBuffer::wrap(m_received_data->data(), received_size), total_size);
+}
+
+i32 Download::received_data_shbuf_id() const
+{
+    return m_received_data ? m_received_data->shbuf_id() : -1;
+}
 }
@@ -30,6 +30,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <AK/RefCounted.h>
+#include <AK/SharedBuffer.h>
 #include <AK/String.h>
 #include <AK/WeakPtr.h>
 #include <LibIPC/Forward.h>
@@ -51,13 +52,21 @@ public:
     Function<void(bool success, const ByteBuffer& payload, RefPtr<SharedBuffer> payload_storage, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> on_finish;
     Function<void(Optional<u32> total_size, u32 downloaded_size)> on_progress;
 
+    // Called with everything received so far, for downloads whose total size is known up front.
+    // The data stays where it is until on_finish.
+    Function<void(const ByteBuffer& received_data, u32 total_size)> on_data_received;
+
     void did_finish(Badge<Client>, bool success, Optional<u32> status_code, u32 total_size, i32 shbuf_id, const IPC::Dictionary& response_headers);
     void did_progress(Badge<Client>, Optional<u32> total_size, u32 downloaded_size);
+    void did_receive_data(Badge<Client>, i32 shbuf_id, u32 total_size, u32 received_size);
+
+    i32 received_data_shbuf_id() const;
 
 private:
     explicit Download(Client&, i32 download_id);
     WeakPtr<Client> m_client;
     int m_download_id { -1 };
+    RefPtr<SharedBuffer> m_received_data;
 };
 
 }
@@ -37,7 +37,7 @@ LibThread::Thread::Thread(Function<int()> action, StringView thread_name)
 
 LibThread::Thread::~Thread()
 {
-    if (m_tid) {
+    if (m_is_running) {
         dbg() << "trying to destroy a running thread!";
         ASSERT_NOT_REACHED();
     }
@@ -45,13 +45,14 @@ LibThread::Thread::~Thread()
 
 void LibThread::Thread::start()
 {
+    m_is_running = true;
     int rc = pthread_create(
         &m_tid,
         nullptr,
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
             size_t exit_code = self->m_action();
-            self->m_tid = 0;            
+            self->m_is_running = false;
             return (void*)exit_code;
         },
         static_cast<void*>(this));
@@ -68,6 +69,16 @@ void LibThread::Thread::quit(void *code)
 {
     ASSERT(m_tid == pthread_self());
 
-    m_tid = 0;
+    m_is_running = false;
     pthread_exit(code);
 }
+
+void LibThread::Thread::join()
+{
+    ASSERT(m_tid);
+    ASSERT(m_tid != pthread_self());
+
+    int rc = pthread_join(m_tid, nullptr);
+    ASSERT(rc == 0);
+    m_tid = 0;
+}
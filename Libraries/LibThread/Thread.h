@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
@@ -43,9 +44,13 @@ public:
     void start();
     void quit(void *code = 0);
 
+    // Waits for the thread to finish. Only needed when it has to be gone before something else is torn down.
+    void join();
+
 private:
     Function<int()> m_action;
-    pthread_t m_tid;
+    pthread_t m_tid { 0 };
+    Atomic<bool> m_is_running { false };
     String m_thread_name;
 };
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibThread/WorkerPool.h>
+
+LibThread::WorkerPool::WorkerPool(size_t thread_count, StringView name)
+{
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_work_available, nullptr);
+    pthread_cond_init(&m_batch_finished, nullptr);
+
+    // The thread calling run() does its share of the work, so spawn one thread less.
+    for (size_t i = 1; i < thread_count; ++i) {
+        auto thread = Thread::construct(
+            [this] {
+                worker_loop();
+                return 0;
+            },
+            name);
+        thread->start();
+        m_threads.append(move(thread));
+    }
+}
+
+LibThread::WorkerPool::~WorkerPool()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_exiting = true;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (auto& thread : m_threads)
+        thread.join();
+
+    pthread_cond_destroy(&m_batch_finished);
+    pthread_cond_destroy(&m_work_available);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void LibThread::WorkerPool::worker_loop()
+{
+    pthread_mutex_lock(&m_mutex);
+    for (;;) {
+        while (!m_exiting && !has_pending_jobs())
+            pthread_cond_wait(&m_work_available, &m_mutex);
+        if (m_exiting)
+            break;
+        run_pending_jobs();
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+// Must be called with m_mutex held; it is dropped while each job runs.
+void LibThread::WorkerPool::run_pending_jobs()
+{
+    while (has_pending_jobs()) {
+        size_t job_index = m_next_job++;
+        auto& job = *m_job;
+        pthread_mutex_unlock(&m_mutex);
+        job(job_index);
+        pthread_mutex_lock(&m_mutex);
+        if (--m_unfinished_jobs == 0)
+            pthread_cond_broadcast(&m_batch_finished);
+    }
+}
+
+void LibThread::WorkerPool::run(size_t job_count, Function<void(size_t)> job)
+{
+    if (m_threads.is_empty() || job_count <= 1) {
+        for (size_t i = 0; i < job_count; ++i)
+            job(i);
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    ASSERT(!m_job);
+    m_job = &job;
+    m_job_count = job_count;
+    m_next_job = 0;
+    m_unfinished_jobs = job_count;
+    pthread_cond_broadcast(&m_work_available);
+
+    run_pending_jobs();
+    while (m_unfinished_jobs)
+        pthread_cond_wait(&m_batch_finished, &m_mutex);
+
+    m_job = nullptr;
+    pthread_mutex_unlock(&m_mutex);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/StringView.h>
+#include <LibThread/Thread.h>
+#include <pthread.h>
+
+namespace LibThread {
+
+// A fixed set of threads for running batches of independent jobs in parallel.
+// run() hands out job indices to the workers and to the calling thread, and
+// only returns once every job in the batch has finished.
+class WorkerPool {
+    AK_MAKE_NONCOPYABLE(WorkerPool);
+    AK_MAKE_NONMOVABLE(WorkerPool);
+
+public:
+    explicit WorkerPool(size_t thread_count, StringView name = "Worker");
+    ~WorkerPool();
+
+    // The number of threads working on a batch, including the caller of run().
+    size_t concurrency() const { return m_threads.size() + 1; }
+
+    void run(size_t job_count, Function<void(size_t job_index)>);
+
+private:
+    void worker_loop();
+    bool has_pending_jobs() const { return m_job && m_next_job < m_job_count; }
+    void run_pending_jobs();
+
+    NonnullRefPtrVector<Thread> m_threads;
+
+    // LibThread::Lock spins instead of sleeping and can't be waited on, so the pool uses pthread primitives.
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_work_available;
+    pthread_cond_t m_batch_finished;
+
+    Function<void(size_t)>* m_job { nullptr };
+    size_t m_job_count { 0 };
+    size_t m_next_job { 0 };
+    size_t m_unfinished_jobs { 0 };
+    bool m_exiting { false };
+};
+
+}
@@ -66,9 +66,105 @@ void StyleResolver::for_each_stylesheet(Callback callback) const
     }
 }
 
-Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+static constexpr u32 tag_name_salt = 13;
+static constexpr u32 id_salt = 17;
+static constexpr u32 class_salt = 19;
+
+static u32 salted_hash(u32 hash, u32 salt)
 {
-    Vector<MatchingRule> matching_rules;
+    // 0 terminates the ancestor hash lists, so make sure we never produce it.
+    u32 salted = hash * salt;
+    return salted ? salted : 1;
+}
+
+template<typename Callback>
+static void for_each_ancestor_hash(const DOM::Element& element, Callback callback)
+{
+    callback(salted_hash(element.local_name().hash(), tag_name_salt));
+    auto id = element.attribute(HTML::AttributeNames::id);
+    if (!id.is_empty())
+        callback(salted_hash(id.hash(), id_salt));
+    for (auto& class_name : element.class_names())
+        callback(salted_hash(class_name.hash(), class_salt));
+}
+
+static void collect_ancestor_hashes(const Selector& selector, u32* hashes, size_t max_hashes)
+{
+    auto& complex_selectors = selector.complex_selectors();
+    size_t count = 0;
+    for (size_t i = complex_selectors.size() - 1; i > 0; --i) {
+        auto relation = complex_selectors[i].relation;
+        // Compound selectors on the other side of a sibling combinator don't have to match an ancestor.
+        if (relation != Selector::ComplexSelector::Relation::Descendant && relation != Selector::ComplexSelector::Relation::ImmediateChild)
+            return;
+        for (auto& simple_selector : complex_selectors[i - 1].compound_selector) {
+            u32 hash = 0;
+            switch (simple_selector.type) {
+            case Selector::SimpleSelector::Type::TagName:
+                hash = salted_hash(simple_selector.value.hash(), tag_name_salt);
+                break;
+            case Selector::SimpleSelector::Type::Id:
+                hash = salted_hash(simple_selector.value.hash(), id_salt);
+                break;
+            case Selector::SimpleSelector::Type::Class:
+                hash = salted_hash(simple_selector.value.hash(), class_salt);
+                break;
+            default:
+                continue;
+            }
+            hashes[count++] = hash;
+            if (count == max_hashes - 1)
+                return;
+        }
+    }
+}
+
+static bool is_sibling_dependent(const Selector::ComplexSelector& complex_selector)
+{
+    if (complex_selector.relation == Selector::ComplexSelector::Relation::AdjacentSibling || complex_selector.relation == Selector::ComplexSelector::Relation::GeneralSibling)
+        return true;
+    for (auto& simple_selector : complex_selector.compound_selector) {
+        switch (simple_selector.pseudo_class) {
+        case Selector::SimpleSelector::PseudoClass::FirstChild:
+        case Selector::SimpleSelector::PseudoClass::LastChild:
+        case Selector::SimpleSelector::PseudoClass::OnlyChild:
+        case Selector::SimpleSelector::PseudoClass::Empty:
+            return true;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+void StyleResolver::invalidate_rule_cache()
+{
+    m_rule_cache = nullptr;
+}
+
+const StyleResolver::RuleCache& StyleResolver::rule_cache() const
+{
+    if (!m_rule_cache)
+        build_rule_cache();
+    return *m_rule_cache;
+}
+
+template<typename Entry>
+static void append_to_bucket(HashMap<FlyString, Vector<Entry>>& buckets, const FlyString& key, Entry&& entry)
+{
+    auto it = buckets.find(key);
+    if (it != buckets.end()) {
+        it->value.append(move(entry));
+        return;
+    }
+    Vector<Entry> bucket;
+    bucket.append(move(entry));
+    buckets.set(key, move(bucket));
+}
+
+void StyleResolver::build_rule_cache() const
+{
+    m_rule_cache = make<RuleCache>();
 
     size_t style_sheet_index = 0;
     for_each_stylesheet([&](auto& sheet) {
@@ -76,16 +172,106 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
         for (auto& rule : sheet.rules()) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index });
-                    break;
+                RuleCacheEntry entry { { rule, style_sheet_index, rule_index, selector_index }, {} };
+                collect_ancestor_hashes(selector, entry.ancestor_hashes, max_ancestor_hashes);
+                // Only the rightmost compound selector can tell siblings with the same parent apart.
+                if (is_sibling_dependent(selector.complex_selectors().last()))
+                    m_rule_cache->has_sibling_dependent_rightmost_selectors = true;
+                for (auto& complex_selector : selector.complex_selectors()) {
+                    if (is_sibling_dependent(complex_selector))
+                        m_rule_cache->has_sibling_dependent_rules = true;
                 }
+
+                // Bucket the rule by the most specific part of its rightmost compound selector,
+                // so we only have to look at rules that have a chance of matching a given element.
+                const Selector::SimpleSelector* id_selector = nullptr;
+                const Selector::SimpleSelector* class_selector = nullptr;
+                const Selector::SimpleSelector* tag_name_selector = nullptr;
+                for (auto& simple_selector : selector.complex_selectors().last().compound_selector) {
+                    if (simple_selector.type == Selector::SimpleSelector::Type::Id && !id_selector)
+                        id_selector = &simple_selector;
+                    else if (simple_selector.type == Selector::SimpleSelector::Type::Class && !class_selector)
+                        class_selector = &simple_selector;
+                    else if (simple_selector.type == Selector::SimpleSelector::Type::TagName && !tag_name_selector)
+                        tag_name_selector = &simple_selector;
+                }
+
+                if (id_selector)
+                    append_to_bucket(m_rule_cache->rules_by_id, id_selector->value, move(entry));
+                else if (class_selector)
+                    append_to_bucket(m_rule_cache->rules_by_class, class_selector->value, move(entry));
+                else if (tag_name_selector)
+                    append_to_bucket(m_rule_cache->rules_by_tag_name, tag_name_selector->value, move(entry));
+                else
+                    m_rule_cache->other_rules.append(move(entry));
                 ++selector_index;
             }
             ++rule_index;
         }
         ++style_sheet_index;
     });
+}
+
+bool StyleResolver::may_match_ancestors(const RuleCacheEntry& entry) const
+{
+    if (!m_tree_traversal_depth)
+        return true;
+    for (size_t i = 0; i < max_ancestor_hashes && entry.ancestor_hashes[i]; ++i) {
+        if (!m_ancestor_filter.may_contain(entry.ancestor_hashes[i]))
+            return false;
+    }
+    return true;
+}
+
+void StyleResolver::collect_matching_rules(const DOM::Element& element, const Vector<RuleCacheEntry>& entries, Vector<MatchingRule>& matching_rules) const
+{
+    for (auto& entry : entries) {
+        if (!may_match_ancestors(entry))
+            continue;
+        auto& selector = entry.matching_rule.rule->selectors()[entry.matching_rule.selector_index];
+        if (SelectorEngine::matches(selector, element))
+            matching_rules.append(entry.matching_rule);
+    }
+}
+
+Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+{
+    auto& cache = rule_cache();
+    Vector<MatchingRule> matching_rules;
+
+    if (!cache.rules_by_id.is_empty()) {
+        auto id = element.attribute(HTML::AttributeNames::id);
+        if (!id.is_empty()) {
+            auto it = cache.rules_by_id.find(id);
+            if (it != cache.rules_by_id.end())
+                collect_matching_rules(element, it->value, matching_rules);
+        }
+    }
+    for (auto& class_name : element.class_names()) {
+        auto it = cache.rules_by_class.find(class_name);
+        if (it != cache.rules_by_class.end())
+            collect_matching_rules(element, it->value, matching_rules);
+    }
+    auto it = cache.rules_by_tag_name.find(element.local_name());
+    if (it != cache.rules_by_tag_name.end())
+        collect_matching_rules(element, it->value, matching_rules);
+    collect_matching_rules(element, cache.other_rules, matching_rules);
+
+    // Put the rules back in stylesheet order, and only keep the first matching selector of each rule.
+    quick_sort(matching_rules, [](auto& a, auto& b) {
+        if (a.style_sheet_index != b.style_sheet_index)
+            return a.style_sheet_index < b.style_sheet_index;
+        if (a.rule_index != b.rule_index)
+            return a.rule_index < b.rule_index;
+        return a.selector_index < b.selector_index;
+    });
+    for (size_t i = 1; i < matching_rules.size();) {
+        auto& previous = matching_rules[i - 1];
+        if (matching_rules[i].style_sheet_index == previous.style_sheet_index && matching_rules[i].rule_index == previous.rule_index)
+            matching_rules.remove(i);
+        else
+            ++i;
+    }
 
 #ifdef HTML_DEBUG
     dbgprintf("Rules matching Element{%p}\n", &element);
@@ -97,6 +283,113 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
     return matching_rules;
 }
 
+void StyleResolver::begin_tree_traversal()
+{
+    ++m_tree_traversal_depth;
+}
+
+void StyleResolver::end_tree_traversal()
+{
+    ASSERT(m_tree_traversal_depth > 0);
+    if (--m_tree_traversal_depth)
+        return;
+    m_ancestor_stack.clear();
+    m_ancestor_filter.clear();
+}
+
+void StyleResolver::push_ancestor(const DOM::Element& element) const
+{
+    for_each_ancestor_hash(element, [&](u32 hash) { m_ancestor_filter.add(hash); });
+    m_ancestor_stack.append({ &element, nullptr, nullptr, nullptr });
+}
+
+void StyleResolver::pop_ancestor() const
+{
+    auto entry = m_ancestor_stack.take_last();
+    for_each_ancestor_hash(*entry.element, [&](u32 hash) { m_ancestor_filter.remove(hash); });
+}
+
+static const DOM::Element* closest_ancestor_element(const DOM::Node& node)
+{
+    // Descendant selectors look past non-element ancestors, so we have to do the same.
+    for (auto* ancestor = node.parent(); ancestor; ancestor = ancestor->parent()) {
+        if (is<DOM::Element>(*ancestor))
+            return downcast<DOM::Element>(ancestor);
+    }
+    return nullptr;
+}
+
+void StyleResolver::update_ancestor_stack(const DOM::Element& element) const
+{
+    // We're usually resolving a child or a sibling of the previously resolved element,
+    // so only the top of the stack has to be adjusted.
+    Vector<const DOM::Element*, 16> missing_ancestors;
+    auto* ancestor = closest_ancestor_element(element);
+    for (; ancestor; ancestor = closest_ancestor_element(*ancestor)) {
+        Optional<size_t> stack_index;
+        for (size_t i = m_ancestor_stack.size(); i > 0; --i) {
+            if (m_ancestor_stack[i - 1].element == ancestor) {
+                stack_index = i - 1;
+                break;
+            }
+        }
+        if (stack_index.has_value()) {
+            while (m_ancestor_stack.size() > stack_index.value() + 1)
+                pop_ancestor();
+            break;
+        }
+        missing_ancestors.append(ancestor);
+    }
+    if (!ancestor) {
+        while (!m_ancestor_stack.is_empty())
+            pop_ancestor();
+    }
+    for (size_t i = missing_ancestors.size(); i > 0; --i)
+        push_ancestor(*missing_ancestors[i - 1]);
+}
+
+static bool have_same_attributes(const DOM::Element& a, const DOM::Element& b)
+{
+    size_t a_attribute_count = 0;
+    size_t b_attribute_count = 0;
+    bool same = true;
+    a.for_each_attribute([&](auto& name, auto& value) {
+        ++a_attribute_count;
+        if (same && b.attribute(name) != value)
+            same = false;
+    });
+    if (!same)
+        return false;
+    b.for_each_attribute([&](auto&, auto&) { ++b_attribute_count; });
+    return a_attribute_count == b_attribute_count;
+}
+
+RefPtr<StyleProperties> StyleResolver::find_shareable_style(const DOM::Element& element, const StyleProperties* parent_style) const
+{
+    if (m_ancestor_stack.is_empty())
+        return nullptr;
+    auto& parent_entry = m_ancestor_stack.last();
+    auto* candidate = parent_entry.last_child;
+    if (!candidate || candidate == &element || parent_entry.element != element.parent_element())
+        return nullptr;
+    if (parent_entry.last_child_parent_style.ptr() != parent_style)
+        return nullptr;
+    if (rule_cache().has_sibling_dependent_rightmost_selectors)
+        return nullptr;
+    if (candidate->local_name() != element.local_name() || !have_same_attributes(*candidate, element))
+        return nullptr;
+
+    // :hover depends on where the hovered node is, so siblings can match it differently.
+    if (auto* hovered_node = document().hovered_node()) {
+        if (hovered_node == candidate || candidate->is_ancestor_of(*hovered_node))
+            return nullptr;
+        if (hovered_node == &element || element.is_ancestor_of(*hovered_node))
+            return nullptr;
+    }
+
+    return parent_entry.last_child_style;
+}
+
 bool StyleResolver::is_inherited_property(CSS::PropertyID property_id)
 {
     static HashTable<CSS::PropertyID> inherited_properties;
@@ -521,6 +814,12 @@ static void set_property_expanding_shorthands(StyleProperties& style, CSS::Prope
 
 NonnullRefPtr<StyleProperties> StyleResolver::resolve_style(const DOM::Element& element, const StyleProperties* parent_style) const
 {
+    if (m_tree_traversal_depth) {
+        update_ancestor_stack(element);
+        if (auto shared_style = find_shareable_style(element, parent_style))
+            return shared_style.release_nonnull();
+    }
+
     auto style = StyleProperties::create();
 
     if (parent_style) {
@@ -562,6 +861,13 @@ NonnullRefPtr<StyleProperties> StyleResolver::resolve_style(const DOM::Element&
         }
     }
 
+    if (m_tree_traversal_depth && !m_ancestor_stack.is_empty() && m_ancestor_stack.last().element == element.parent_element()) {
+        auto& parent_entry = m_ancestor_stack.last();
+        parent_entry.last_child = &element;
+        parent_entry.last_child_parent_style = parent_style;
+        parent_entry.last_child_style = style;
+    }
+
     return style;
 }
 
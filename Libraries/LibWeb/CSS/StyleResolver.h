@@ -26,6 +26,9 @@
 
 #pragma once
 
+#include <AK/CountingBloomFilter.h>
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/StyleProperties.h>
@@ -52,13 +55,64 @@ public:
 
     Vector<MatchingRule> collect_matching_rules(const DOM::Element&) const;
 
+    void invalidate_rule_cache();
+
+    // Whether any rule can match differently depending on an element's siblings, e.g. :first-child or "a + b".
+    bool has_sibling_dependent_rules() const { return rule_cache().has_sibling_dependent_rules; }
+
+    // Style is usually resolved for many elements in tree order, e.g. while building the layout tree.
+    // Between these calls, we keep track of the ancestors of the element being resolved, which lets us
+    // reject most descendant selectors early and share style between similar siblings.
+    void begin_tree_traversal();
+    void end_tree_traversal();
+
     static bool is_inherited_property(CSS::PropertyID);
 
 private:
     template<typename Callback>
     void for_each_stylesheet(Callback) const;
 
+    static constexpr size_t max_ancestor_hashes = 4;
+
+    struct RuleCacheEntry {
+        MatchingRule matching_rule;
+        // Hashes of ids, classes and tag names that some ancestor must have for the selector to match (0-terminated).
+        u32 ancestor_hashes[max_ancestor_hashes] {};
+    };
+
+    struct RuleCache {
+        HashMap<FlyString, Vector<RuleCacheEntry>> rules_by_id;
+        HashMap<FlyString, Vector<RuleCacheEntry>> rules_by_class;
+        HashMap<FlyString, Vector<RuleCacheEntry>> rules_by_tag_name;
+        Vector<RuleCacheEntry> other_rules;
+        bool has_sibling_dependent_rules { false };
+        bool has_sibling_dependent_rightmost_selectors { false };
+    };
+
+    struct AncestorStackEntry {
+        const DOM::Element* element { nullptr };
+        RefPtr<const StyleProperties> last_child_parent_style;
+        const DOM::Element* last_child { nullptr };
+        RefPtr<StyleProperties> last_child_style;
+    };
+
+    const RuleCache& rule_cache() const;
+    void build_rule_cache() const;
+    void collect_matching_rules(const DOM::Element&, const Vector<RuleCacheEntry>&, Vector<MatchingRule>&) const;
+    bool may_match_ancestors(const RuleCacheEntry&) const;
+
+    void update_ancestor_stack(const DOM::Element&) const;
+    void push_ancestor(const DOM::Element&) const;
+    void pop_ancestor() const;
+    RefPtr<StyleProperties> find_shareable_style(const DOM::Element&, const StyleProperties* parent_style) const;
+
     DOM::Document& m_document;
+
+    mutable OwnPtr<RuleCache> m_rule_cache;
+
+    int m_tree_traversal_depth { 0 };
+    mutable Vector<AncestorStackEntry, 32> m_ancestor_stack;
+    mutable CountingBloomFilter<> m_ancestor_filter;
 };
 
 }
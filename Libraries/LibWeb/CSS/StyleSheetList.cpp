@@ -24,13 +24,17 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/CSS/StyleSheetList.h>
+#include <LibWeb/DOM/Document.h>
 
 namespace Web::CSS {
 
 void StyleSheetList::add_sheet(NonnullRefPtr<StyleSheet> sheet)
 {
     m_sheets.append(move(sheet));
+    m_document.style_resolver().invalidate_rule_cache();
+    m_document.invalidate_style();
 }
 
 StyleSheetList::StyleSheetList(DOM::Document& document)
@@ -307,4 +307,9 @@ void ImageStyleValue::resource_did_load()
         m_document->frame()->set_needs_display({});
 }
 
+void ImageStyleValue::resource_did_update_image()
+{
+    resource_did_load();
+}
+
 }
@@ -324,6 +324,11 @@ private:
     // ^ResourceClient
     virtual void resource_did_load() override;
 
+    // ^ImageResourceClient
+    virtual void resource_did_update_image() override;
+    // We don't know where the image is painted, so it has to stay decoded.
+    virtual bool is_visible_in_viewport() const override { return true; }
+
     URL m_url;
     WeakPtr<DOM::Document> m_document;
     RefPtr<Gfx::Bitmap> m_bitmap;
@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/Timer.h>
 #include <LibGUI/Application.h>
@@ -228,6 +229,8 @@ URL Document::complete_url(const String& string) const
 void Document::invalidate_layout()
 {
     m_layout_root = nullptr;
+    m_nodes_needing_layout_tree_update.clear();
+    m_nodes_kept_alive_for_layout_tree.clear();
 }
 
 void Document::force_layout()
@@ -247,27 +250,123 @@ void Document::layout()
     }
     m_layout_root->layout();
     m_layout_root->set_needs_display();
+    m_layout_root->update_images_visible_in_viewport();
 
     if (frame()->is_main_frame())
         frame()->page().client().page_did_layout();
 }
 
+static void update_style_recursively(DOM::Node& node)
+{
+    if (is<Element>(node) && node.needs_style_update())
+        downcast<Element>(node).recompute_style();
+    node.set_needs_style_update(false);
+
+    // Clear the flag before visiting the children, so that anything marked while we're at it is marked
+    // all the way up to the document again.
+    if (node.child_needs_style_update()) {
+        node.set_child_needs_style_update(false);
+        for (auto* child = node.first_child(); child; child = child->next_sibling())
+            update_style_recursively(*child);
+    }
+}
+
 void Document::update_style()
 {
-    for_each_in_subtree_of_type<Element>([&](auto& element) {
-        if (element.needs_style_update())
-            element.recompute_style();
-        return IterationDecision::Continue;
-    });
+    if (!needs_style_update() && !child_needs_style_update() && m_nodes_needing_layout_tree_update.is_empty())
+        return;
+    style_resolver().begin_tree_traversal();
+    update_style_recursively(*this);
+    style_resolver().end_tree_traversal();
     update_layout();
 }
 
+void Document::invalidate_layout_tree(Node& node)
+{
+    if (!m_layout_root)
+        return;
+    for (auto& pending_node : m_nodes_needing_layout_tree_update) {
+        if (&pending_node == &node)
+            return;
+    }
+    m_nodes_needing_layout_tree_update.append(node);
+    schedule_style_update();
+}
+
+void Document::keep_alive_until_layout_tree_update(Badge<Node>, Node& node)
+{
+    if (m_layout_root)
+        m_nodes_kept_alive_for_layout_tree.append(node);
+}
+
+static Element* find_layout_tree_rebuild_root(Node& node)
+{
+    // Block-level boxes in a block formatting context can be swapped out without touching their siblings,
+    // so the nearest one around the node is where we start rebuilding.
+    for (auto* ancestor = node.parent(); ancestor; ancestor = ancestor->parent()) {
+        if (!is<Element>(*ancestor))
+            return nullptr;
+        auto& element = downcast<Element>(*ancestor);
+        auto* layout_node = element.layout_node();
+        if (!layout_node)
+            continue;
+        if (!is<LayoutBlock>(*layout_node) || layout_node->is_inline() || !layout_node->parent())
+            continue;
+        if (layout_node->parent()->children_are_inline() || is<LayoutDocument>(*layout_node->parent()))
+            continue;
+        return &element;
+    }
+    return nullptr;
+}
+
+void Document::update_layout_tree()
+{
+    auto nodes = move(m_nodes_needing_layout_tree_update);
+    if (!m_layout_root) {
+        m_nodes_kept_alive_for_layout_tree.clear();
+        return;
+    }
+
+    for (auto& node : nodes) {
+        bool is_covered_by_other_node = false;
+        for (auto& other_node : nodes) {
+            if (&other_node != &node && other_node.is_ancestor_of(node)) {
+                is_covered_by_other_node = true;
+                break;
+            }
+        }
+        if (is_covered_by_other_node || !node.is_connected())
+            continue;
+
+        auto* rebuild_root = find_layout_tree_rebuild_root(node);
+        if (!rebuild_root) {
+            invalidate_layout();
+            return;
+        }
+        LayoutTreeBuilder tree_builder;
+        tree_builder.rebuild(*rebuild_root);
+    }
+
+    m_nodes_kept_alive_for_layout_tree.clear();
+    m_layout_root->invalidate_stacking_context_tree();
+}
+
 void Document::update_layout()
 {
+    update_layout_tree();
+
     if (!frame())
         return;
 
-    layout();
+    if (!m_layout_root || m_layout_root->needs_layout() || m_layout_root->child_needs_layout()) {
+        layout();
+        return;
+    }
+
+    // Everything that changed is contained in boxes whose size doesn't depend on their contents,
+    // so we can lay out just those boxes.
+    m_layout_root->layout_dirty_relayout_boundaries();
+    m_layout_root->update_images_visible_in_viewport();
 }
 
 RefPtr<LayoutNode> Document::create_layout_node(const CSS::StyleProperties*)
@@ -322,31 +421,201 @@ void Document::set_hovered_node(Node* node)
     RefPtr<Node> old_hovered_node = move(m_hovered_node);
     m_hovered_node = node;
 
-    invalidate_style();
+    // Only elements between the common ancestor of the old and new hovered nodes changed their :hover state,
+    // so they (and their descendants) are all that needs new style.
+    Node* common_ancestor = nullptr;
+    if (old_hovered_node && node) {
+        for (auto* ancestor = old_hovered_node.ptr(); ancestor; ancestor = ancestor->parent()) {
+            if (ancestor == node || ancestor->is_ancestor_of(*node)) {
+                common_ancestor = ancestor;
+                break;
+            }
+        }
+    }
+    if (!common_ancestor) {
+        invalidate_style();
+        return;
+    }
+    auto invalidate_below_common_ancestor = [&](Node& hovered_node) {
+        if (&hovered_node == common_ancestor)
+            return;
+        auto* topmost_changed_node = &hovered_node;
+        while (topmost_changed_node->parent() != common_ancestor)
+            topmost_changed_node = topmost_changed_node->parent();
+        topmost_changed_node->invalidate_style();
+    };
+    invalidate_below_common_ancestor(*old_hovered_node);
+    invalidate_below_common_ancestor(*node);
+}
+
+// Returns true if a comes before b in tree order. Both nodes must be in the same tree.
+static bool is_before_in_tree_order(const Node& a, const Node& b)
+{
+    if (&a == &b)
+        return false;
+    if (a.is_ancestor_of(b))
+        return true;
+    if (b.is_ancestor_of(a))
+        return false;
+
+    Vector<const Node*, 32> a_ancestors;
+    for (auto* node = &a; node; node = node->parent())
+        a_ancestors.append(node);
+    Vector<const Node*, 32> b_ancestors;
+    for (auto* node = &b; node; node = node->parent())
+        b_ancestors.append(node);
+
+    // Walk down from the root until the paths diverge, then see which branch comes first.
+    size_t a_index = a_ancestors.size() - 1;
+    size_t b_index = b_ancestors.size() - 1;
+    while (a_ancestors[a_index - 1] == b_ancestors[b_index - 1]) {
+        --a_index;
+        --b_index;
+    }
+    for (auto* sibling = a_ancestors[a_index - 1]->next_sibling(); sibling; sibling = sibling->next_sibling()) {
+        if (sibling == b_ancestors[b_index - 1])
+            return true;
+    }
+    return false;
 }
 
-Vector<const Element*> Document::get_elements_by_name(const String& name) const
+void Document::add_to_indexes(Element& element)
 {
-    Vector<const Element*> elements;
-    for_each_in_subtree_of_type<Element>([&](auto& element) {
-        if (element.attribute(HTML::AttributeNames::name) == name)
+    auto id = element.attribute(HTML::AttributeNames::id);
+    if (!id.is_null()) {
+        auto& elements = m_elements_by_id.ensure(id);
+        if (!elements.contains_slow(&element))
+            elements.append(&element);
+    }
+
+    auto name = element.attribute(HTML::AttributeNames::name);
+    if (!name.is_null()) {
+        auto& elements = m_elements_by_name.ensure(name);
+        if (!elements.contains_slow(&element))
             elements.append(&element);
+    }
+}
+
+void Document::remove_from_indexes(Element& element)
+{
+    auto remove_from = [&](auto& map, const auto& key) {
+        auto it = map.find(key);
+        if (it == map.end())
+            return;
+        it->value.remove_first_matching([&](auto* entry) { return entry == &element; });
+        if (it->value.is_empty())
+            map.remove(it);
+    };
+
+    auto id = element.attribute(HTML::AttributeNames::id);
+    if (!id.is_null())
+        remove_from(m_elements_by_id, FlyString(id));
+
+    auto name = element.attribute(HTML::AttributeNames::name);
+    if (!name.is_null())
+        remove_from(m_elements_by_name, name);
+}
+
+void Document::did_insert_node(Badge<Node>, Node& node)
+{
+    ++m_dom_tree_version;
+    node.for_each_in_subtree_of_type<Element>([&](auto& element) {
+        add_to_indexes(element);
         return IterationDecision::Continue;
     });
-    return elements;
 }
 
-NonnullRefPtrVector<Element> Document::get_elements_by_tag_name(const FlyString& tag_name) const
+void Document::did_remove_node(Badge<Node>, Node& node)
 {
-    NonnullRefPtrVector<Element> elements;
-    for_each_in_subtree_of_type<Element>([&](auto& element) {
-        if (element.local_name() == tag_name)
-            elements.append(element);
+    ++m_dom_tree_version;
+    node.for_each_in_subtree_of_type<Element>([&](auto& element) {
+        remove_from_indexes(element);
         return IterationDecision::Continue;
     });
+}
+
+void Document::element_attributes_will_change(Badge<Element>, Element& element)
+{
+    remove_from_indexes(element);
+}
+
+void Document::element_attributes_did_change(Badge<Element>, Element& element)
+{
+    ++m_dom_tree_version;
+    add_to_indexes(element);
+}
+
+const Element* Document::get_element_by_id(const FlyString& id) const
+{
+    auto it = m_elements_by_id.find(id);
+    if (it == m_elements_by_id.end())
+        return nullptr;
+
+    // IDs are supposed to be unique, but if they aren't, the first one in tree order wins.
+    auto& elements = it->value;
+    const Element* first = elements.first();
+    for (size_t i = 1; i < elements.size(); ++i) {
+        if (is_before_in_tree_order(*elements[i], *first))
+            first = elements[i];
+    }
+    return first;
+}
+
+Element* Document::get_element_by_id(const FlyString& id)
+{
+    return const_cast<Element*>(const_cast<const Document*>(this)->get_element_by_id(id));
+}
+
+Vector<const Element*> Document::get_elements_by_name(const String& name) const
+{
+    Vector<const Element*> elements;
+    auto it = m_elements_by_name.find(name);
+    if (it == m_elements_by_name.end())
+        return elements;
+
+    for (auto* element : it->value)
+        elements.append(element);
+    quick_sort(elements, [](auto* a, auto* b) {
+        return is_before_in_tree_order(*a, *b);
+    });
+    return elements;
+}
+
+template<typename Filter>
+NonnullRefPtrVector<Element> Document::cached_element_list(HashMap<FlyString, CachedElementList>& cache, const FlyString& key, Filter filter) const
+{
+    auto& list = cache.ensure(key);
+    if (list.dom_tree_version != m_dom_tree_version) {
+        list.elements.clear();
+        const_cast<Document&>(*this).for_each_in_subtree_of_type<Element>([&](auto& element) {
+            if (filter(element))
+                list.elements.append(&element);
+            return IterationDecision::Continue;
+        });
+        list.dom_tree_version = m_dom_tree_version;
+    }
+
+    NonnullRefPtrVector<Element> elements;
+    elements.ensure_capacity(list.elements.size());
+    for (auto* element : list.elements)
+        elements.unchecked_append(*element);
     return elements;
 }
 
+NonnullRefPtrVector<Element> Document::get_elements_by_tag_name(const FlyString& tag_name) const
+{
+    return cached_element_list(m_elements_by_tag_name, tag_name, [&](auto& element) {
+        return element.local_name() == tag_name;
+    });
+}
+
+NonnullRefPtrVector<Element> Document::get_elements_by_class_name(const FlyString& class_name) const
+{
+    return cached_element_list(m_elements_by_class_name, class_name, [&](auto& element) {
+        return element.has_class(class_name);
+    });
+}
+
 RefPtr<Element> Document::query_selector(const StringView& selector_text)
 {
     auto selector = parse_selector(CSS::ParsingContext(*this), selector_text);
@@ -28,6 +28,7 @@
 
 #include <AK/FlyString.h>
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/String.h>
@@ -116,15 +117,32 @@ public:
     void update_style();
     void update_layout();
 
+    // Throws away the layout nodes generated for this node, and rebuilds them (along with those of
+    // the nearest enclosing block) at the next style or layout update.
+    void invalidate_layout_tree(Node&);
+    void keep_alive_until_layout_tree_update(Badge<Node>, Node&);
+
     virtual bool is_child_allowed(const Node&) const override;
 
+    // Bumped whenever an element is connected, disconnected or has its attributes changed.
+    u64 dom_tree_version() const { return m_dom_tree_version; }
+
+    // These keep the id and name indexes up to date.
+    void did_insert_node(Badge<Node>, Node&);
+    void did_remove_node(Badge<Node>, Node&);
+    void element_attributes_will_change(Badge<Element>, Element&);
+    void element_attributes_did_change(Badge<Element>, Element&);
+
     const LayoutDocument* layout_node() const;
     LayoutDocument* layout_node();
 
     void schedule_style_update();
 
+    Element* get_element_by_id(const FlyString&);
+    const Element* get_element_by_id(const FlyString&) const;
     Vector<const Element*> get_elements_by_name(const String&) const;
     NonnullRefPtrVector<Element> get_elements_by_tag_name(const FlyString&) const;
+    NonnullRefPtrVector<Element> get_elements_by_class_name(const FlyString&) const;
     RefPtr<Element> query_selector(const StringView&);
     NonnullRefPtrVector<Element> query_selector_all(const StringView&);
 
@@ -160,6 +178,18 @@ public:
 private:
     virtual RefPtr<LayoutNode> create_layout_node(const CSS::StyleProperties* parent_style) override;
 
+    void update_layout_tree();
+
+    void add_to_indexes(Element&);
+    void remove_from_indexes(Element&);
+
+    struct CachedElementList {
+        u64 dom_tree_version { 0 };
+        Vector<Element*> elements;
+    };
+    template<typename Filter>
+    NonnullRefPtrVector<Element> cached_element_list(HashMap<FlyString, CachedElementList>&, const FlyString& key, Filter) const;
+
     OwnPtr<CSS::StyleResolver> m_style_resolver;
     RefPtr<CSS::StyleSheetList> m_style_sheets;
     RefPtr<Node> m_hovered_node;
@@ -170,6 +200,14 @@ private:
     RefPtr<Window> m_window;
 
     RefPtr<LayoutDocument> m_layout_root;
+    NonnullRefPtrVector<Node> m_nodes_needing_layout_tree_update;
+    NonnullRefPtrVector<Node> m_nodes_kept_alive_for_layout_tree;
+
+    u64 m_dom_tree_version { 1 };
+    HashMap<FlyString, Vector<Element*>> m_elements_by_id;
+    HashMap<String, Vector<Element*>> m_elements_by_name;
+    mutable HashMap<FlyString, CachedElementList> m_elements_by_tag_name;
+    mutable HashMap<FlyString, CachedElementList> m_elements_by_class_name;
 
     Optional<Color> m_link_color;
     Optional<Color> m_active_link_color;
@@ -34,13 +34,13 @@
 #include <LibWeb/DOM/Text.h>
 #include <LibWeb/Dump.h>
 #include <LibWeb/Layout/LayoutBlock.h>
+#include <LibWeb/Layout/LayoutDocument.h>
 #include <LibWeb/Layout/LayoutInline.h>
 #include <LibWeb/Layout/LayoutListItem.h>
 #include <LibWeb/Layout/LayoutTable.h>
 #include <LibWeb/Layout/LayoutTableCell.h>
 #include <LibWeb/Layout/LayoutTableRow.h>
 #include <LibWeb/Layout/LayoutTableRowGroup.h>
-#include <LibWeb/Layout/LayoutTreeBuilder.h>
 #include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
 
 namespace Web::DOM {
@@ -80,22 +80,53 @@ String Element::attribute(const FlyString& name) const
     return {};
 }
 
+Document* Element::connected_document()
+{
+    auto* root = const_cast<Node*>(this->root());
+    if (!root->is_document())
+        return nullptr;
+    return downcast<Document>(root);
+}
+
 void Element::set_attribute(const FlyString& name, const String& value)
 {
+    auto* connected_document = this->connected_document();
+    if (connected_document)
+        connected_document->element_attributes_will_change({}, *this);
+
     if (auto* attribute = find_attribute(name))
         attribute->set_value(value);
     else
         m_attributes.empend(name, value);
 
     parse_attribute(name, value);
+
+    if (connected_document)
+        connected_document->element_attributes_did_change({}, *this);
+
+    // Attribute selectors, classes and ids can only match us and our descendants,
+    // unless there are rules that look at siblings.
+    if (!document().layout_node())
+        return;
+    if (parent() && document().style_resolver().has_sibling_dependent_rules())
+        parent()->invalidate_style();
+    else
+        invalidate_style();
 }
 
 void Element::set_attributes(Vector<Attribute>&& attributes)
 {
+    auto* connected_document = this->connected_document();
+    if (connected_document)
+        connected_document->element_attributes_will_change({}, *this);
+
     m_attributes = move(attributes);
 
     for (auto& attribute : m_attributes)
         parse_attribute(attribute.name(), attribute.value());
+
+    if (connected_document)
+        connected_document->element_attributes_did_change({}, *this);
 }
 
 bool Element::has_class(const FlyString& class_name) const
@@ -162,29 +193,52 @@ enum class StyleDifference {
     None,
     NeedsRepaint,
     NeedsRelayout,
+    NeedsNewLayoutNode,
 };
 
-static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style, const Document& document)
+static bool is_paint_only_property(CSS::PropertyID property_id)
 {
-    if (old_style == new_style)
-        return StyleDifference::None;
+    switch (property_id) {
+    case CSS::PropertyID::Color:
+    case CSS::PropertyID::BackgroundColor:
+    case CSS::PropertyID::BackgroundImage:
+    case CSS::PropertyID::BorderTopColor:
+    case CSS::PropertyID::BorderRightColor:
+    case CSS::PropertyID::BorderBottomColor:
+    case CSS::PropertyID::BorderLeftColor:
+    case CSS::PropertyID::TextDecoration:
+        return true;
+    default:
+        return false;
+    }
+}
 
-    bool needs_repaint = false;
-    bool needs_relayout = false;
+static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style)
+{
+    if (&old_style == &new_style || old_style == new_style)
+        return StyleDifference::None;
 
     if (new_style.display() != old_style.display())
-        needs_relayout = true;
+        return StyleDifference::NeedsNewLayoutNode;
 
-    if (new_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black))
-        needs_repaint = true;
-    else if (new_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black))
-        needs_repaint = true;
+    bool needs_relayout = false;
+    new_style.for_each_property([&](auto property_id, auto& value) {
+        if (needs_relayout || is_paint_only_property(property_id))
+            return;
+        auto old_value = old_style.property(property_id);
+        if (!old_value.has_value() || old_value.value()->type() != value.type() || old_value.value()->to_string() != value.to_string())
+            needs_relayout = true;
+    });
+    old_style.for_each_property([&](auto property_id, auto&) {
+        if (needs_relayout || is_paint_only_property(property_id))
+            return;
+        if (!new_style.property(property_id).has_value())
+            needs_relayout = true;
+    });
 
     if (needs_relayout)
         return StyleDifference::NeedsRelayout;
-    if (needs_repaint)
-        return StyleDifference::NeedsRepaint;
-    return StyleDifference::None;
+    return StyleDifference::NeedsRepaint;
 }
 
 void Element::recompute_style()
@@ -200,9 +254,8 @@ void Element::recompute_style()
     if (!layout_node()) {
         if (style->display() == CSS::Display::None)
             return;
-        // We need a new layout tree here!
-        LayoutTreeBuilder tree_builder;
-        tree_builder.build(*this);
+        // We need a new layout node here!
+        document().invalidate_layout_tree(*this);
         return;
     }
 
@@ -210,16 +263,39 @@ void Element::recompute_style()
     if (layout_node()->is_widget())
         return;
 
-    auto diff = compute_style_difference(layout_node()->specified_style(), *style, document());
+    auto diff = compute_style_difference(layout_node()->specified_style(), *style);
     if (diff == StyleDifference::None)
         return;
-    layout_node()->set_specified_style(*style);
+
+    if (diff == StyleDifference::NeedsNewLayoutNode || !layout_node()->has_style()) {
+        document().invalidate_layout_tree(*this);
+        return;
+    }
+
+    // Our children may inherit some of what changed.
+    for (auto* child = first_child(); child; child = child->next_sibling()) {
+        if (is<Element>(*child))
+            child->set_needs_style_update(true);
+    }
+
+    auto& layout_node = static_cast<LayoutNodeWithStyle&>(*this->layout_node());
+    auto old_z_index = layout_node.style().z_index();
+    auto new_z_index = style->z_index();
+    bool stacking_may_have_changed = layout_node.style().position() != style->position()
+        || old_z_index.has_value() != new_z_index.has_value()
+        || old_z_index.value_or(0) != new_z_index.value_or(0);
+    layout_node.set_specified_style(*style);
+    if (stacking_may_have_changed) {
+        if (auto* layout_root = document().layout_node())
+            layout_root->invalidate_stacking_context_tree();
+    }
+
     if (diff == StyleDifference::NeedsRelayout) {
-        document().force_layout();
+        layout_node.set_needs_layout();
         return;
     }
     if (diff == StyleDifference::NeedsRepaint) {
-        layout_node()->set_needs_display();
+        layout_node.set_needs_display();
     }
 }
 
@@ -258,9 +334,8 @@ void Element::set_inner_html(StringView markup)
         append_child(new_children.take_first());
     }
 
-    set_needs_style_update(true);
-    document().schedule_style_update();
-    document().invalidate_layout();
+    invalidate_style();
+    document().invalidate_layout_tree(*this);
 }
 
 String Element::inner_html() const
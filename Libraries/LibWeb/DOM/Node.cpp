@@ -35,6 +35,7 @@
 #include <LibWeb/Bindings/NodeWrapper.h>
 #include <LibWeb/Bindings/NodeWrapperFactory.h>
 #include <LibWeb/CSS/StyleResolver.h>
+#include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/DOM/Event.h>
 #include <LibWeb/DOM/EventListener.h>
@@ -115,10 +116,66 @@ RefPtr<LayoutNode> Node::create_layout_node(const CSS::StyleProperties*)
     return nullptr;
 }
 
+void Node::set_needs_style_update(bool value)
+{
+    if (!value) {
+        m_needs_style_update = false;
+        return;
+    }
+    mark_as_needing_style_update();
+    document().schedule_style_update();
+}
+
+void Node::mark_as_needing_style_update()
+{
+    m_needs_style_update = true;
+    // Let the style update find us without walking the whole tree. An ancestor that's already marked
+    // has all of its own ancestors marked, so we can stop there.
+    for (auto* ancestor = parent(); ancestor && !ancestor->m_child_needs_style_update; ancestor = ancestor->parent())
+        ancestor->m_child_needs_style_update = true;
+}
+
+static Document* document_of_tree_containing(Node& node)
+{
+    auto* root = const_cast<Node*>(node.root());
+    if (!root->is_document())
+        return nullptr;
+    return downcast<Document>(root);
+}
+
+void Node::inserted_into(Node&)
+{
+    set_needs_style_update(true);
+    if (auto* document = document_of_tree_containing(*this))
+        document->did_insert_node({}, *this);
+}
+
+void Node::removed_from(Node& old_parent)
+{
+    if (auto* document = document_of_tree_containing(old_parent))
+        document->did_remove_node({}, *this);
+
+    // Our layout nodes stay in the layout tree until our old parent's layout subtree is rebuilt,
+    // so we can't go away before that.
+    if (layout_node())
+        document().keep_alive_until_layout_tree_update({}, *this);
+}
+
+void Node::children_changed()
+{
+    // Until the document has been laid out for the first time, there's nothing to invalidate.
+    if (!document().layout_node())
+        return;
+    // Selectors like :first-child or "a + b" may match our children differently now.
+    if (document().style_resolver().has_sibling_dependent_rules())
+        invalidate_style();
+    document().invalidate_layout_tree(*this);
+}
+
 void Node::invalidate_style()
 {
     for_each_in_subtree_of_type<Element>([&](auto& element) {
-        element.set_needs_style_update(true);
+        element.mark_as_needing_style_update();
         return IterationDecision::Continue;
     });
     document().schedule_style_update();
@@ -197,6 +254,8 @@ const Element* Node::parent_element() const
 RefPtr<Node> Node::append_child(NonnullRefPtr<Node> node, bool notify)
 {
     TreeNode<Node>::append_child(node, notify);
+    if (!notify)
+        did_insert_child_without_notification(node);
     return node;
 }
 
@@ -209,9 +268,20 @@ RefPtr<Node> Node::insert_before(NonnullRefPtr<Node> node, RefPtr<Node> child, b
         return nullptr;
     }
     TreeNode<Node>::insert_before(node, child, notify);
+    if (!notify)
+        did_insert_child_without_notification(node);
     return node;
 }
 
+void Node::did_insert_child_without_notification(Node& child)
+{
+    // The child won't hear about this through inserted_into(), but the document indexes still have to.
+    if (child.parent() != this)
+        return;
+    if (auto* document = document_of_tree_containing(*this))
+        document->did_insert_node({}, child);
+}
+
 void Node::set_document(Badge<Document>, Document& document)
 {
     m_document = &document;
@@ -109,9 +109,9 @@ public:
     template<typename T>
     const T* first_ancestor_of_type() const;
 
-    virtual void inserted_into(Node&) { }
-    virtual void removed_from(Node&) { }
-    virtual void children_changed() { }
+    virtual void inserted_into(Node&);
+    virtual void removed_from(Node&);
+    virtual void children_changed();
 
     const LayoutNode* layout_node() const { return m_layout_node; }
     LayoutNode* layout_node() { return m_layout_node; }
@@ -124,7 +124,10 @@ public:
     virtual bool is_child_allowed(const Node&) const { return true; }
 
     bool needs_style_update() const { return m_needs_style_update; }
-    void set_needs_style_update(bool value) { m_needs_style_update = value; }
+    void set_needs_style_update(bool);
+
+    bool child_needs_style_update() const { return m_child_needs_style_update; }
+    void set_child_needs_style_update(bool value) { m_child_needs_style_update = value; }
 
     void invalidate_style();
 
@@ -142,6 +145,12 @@ protected:
     mutable LayoutNode* m_layout_node { nullptr };
     NodeType m_type { NodeType::INVALID };
     bool m_needs_style_update { true };
+    bool m_child_needs_style_update { false };
+
+private:
+    void mark_as_needing_style_update();
+
+    void did_insert_child_without_notification(Node&);
 };
 
 template<typename T>
@@ -62,13 +62,19 @@ class HTMLFormElement;
 class HTMLHeadElement;
 class HTMLHtmlElement;
 class HTMLImageElement;
+class HTMLPreloadScanner;
 class HTMLScriptElement;
+class HTMLTokenizerThread;
 class ImageData;
 }
 
 namespace Web {
+class DecodedImageCache;
+class DisplayList;
 class Frame;
+class ImageResource;
 class LayoutBlock;
+class LayoutBox;
 class LayoutDocument;
 class LayoutNode;
 class LayoutNodeWithStyle;
@@ -82,8 +88,10 @@ class PageClient;
 class PageView;
 class PaintContext;
 class Resource;
+class ResourceCache;
 class ResourceLoader;
 class StackingContext;
+class TileCache;
 class XMLHttpRequest;
 }
 
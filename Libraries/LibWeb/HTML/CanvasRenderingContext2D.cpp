@@ -105,7 +105,7 @@ void CanvasRenderingContext2D::draw_image(const HTMLImageElement& image_element,
         return;
 
     auto src_rect = image_element.bitmap()->rect();
-    Gfx::FloatRect dst_rect = { x, y, (float)image_element.bitmap()->width(), (float)image_element.bitmap()->height() };
+    Gfx::FloatRect dst_rect = { x, y, (float)image_element.natural_width(), (float)image_element.natural_height() };
     auto rect = m_transform.map(dst_rect);
 
     painter->draw_scaled_bitmap(enclosing_int_rect(rect), *image_element.bitmap(), src_rect);
@@ -192,9 +192,9 @@ void CanvasRenderingContext2D::fill(Gfx::Painter::WindingRule winding)
     if (!painter)
         return;
 
-    auto path = m_path;
-    path.close_all_subpaths();
-    painter->fill_path(path, m_fill_style, winding);
+    // fill_path() closes subpaths itself, and filling m_path directly lets
+    // repeated fills reuse its flattened form.
+    painter->fill_path(m_path, m_fill_style, winding);
 }
 
 void CanvasRenderingContext2D::fill(const String& fill_rule)
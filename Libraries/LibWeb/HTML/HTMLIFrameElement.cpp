@@ -56,6 +56,15 @@ RefPtr<LayoutNode> HTMLIFrameElement::create_layout_node(const CSS::StylePropert
     return adopt(*new LayoutFrame(document(), *this, move(style)));
 }
 
+void HTMLIFrameElement::inserted_into(Node& node)
+{
+    HTMLElement::inserted_into(node);
+
+    // A document that's still being parsed may already be showing in a frame.
+    if (is_connected() && document().frame() && !m_hosted_frame)
+        document_did_attach_to_frame(*document().frame());
+}
+
 void HTMLIFrameElement::document_did_attach_to_frame(Frame& frame)
 {
     ASSERT(!m_hosted_frame);
@@ -45,6 +45,7 @@ public:
     const DOM::Document* content_document() const;
 
 private:
+    virtual void inserted_into(Node&) override;
     virtual void document_did_attach_to_frame(Frame&) override;
     virtual void document_will_detach_from_frame(Frame&) override;
 
@@ -41,12 +41,16 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, const FlyString& tag
     : HTMLElement(document, tag_name)
 {
     m_image_loader.on_load = [this] {
+        if (layout_node())
+            layout_node()->set_needs_layout();
         this->document().update_layout();
         dispatch_event(DOM::Event::create("load"));
     };
 
     m_image_loader.on_fail = [this] {
         dbg() << "HTMLImageElement: Resource did fail: " << this->src();
+        if (layout_node())
+            layout_node()->set_needs_layout();
         this->document().update_layout();
         dispatch_event(DOM::Event::create("error"));
     };
@@ -55,6 +59,14 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, const FlyString& tag
         if (layout_node())
             layout_node()->set_needs_display();
     };
+
+    m_image_loader.on_decode_progress = [this](bool size_did_change) {
+        if (size_did_change && layout_node()) {
+            layout_node()->set_needs_layout();
+            this->document().update_layout();
+        } else if (layout_node())
+            layout_node()->set_needs_display();
+    };
 }
 
 HTMLImageElement::~HTMLImageElement()
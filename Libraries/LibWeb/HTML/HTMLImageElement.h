@@ -48,6 +48,10 @@ public:
 
     const Gfx::Bitmap* bitmap() const;
 
+    // The size of the image itself, which the bitmap may be smaller than.
+    unsigned natural_width() const { return m_image_loader.width(); }
+    unsigned natural_height() const { return m_image_loader.height(); }
+
 private:
     virtual void apply_presentational_hints(CSS::StyleProperties&) const override;
 
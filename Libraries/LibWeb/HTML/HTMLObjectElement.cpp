@@ -38,14 +38,25 @@ namespace Web::HTML {
 HTMLObjectElement::HTMLObjectElement(DOM::Document& document, const FlyString& tag_name)
     : HTMLElement(document, tag_name)
 {
+    // Whether we show the image or our fallback content decides what kind of layout node we get.
     m_image_loader.on_load = [this] {
         m_should_show_fallback_content = false;
-        this->document().force_layout();
+        this->document().invalidate_layout_tree(*this);
+        this->document().update_layout();
     };
 
     m_image_loader.on_fail = [this] {
         m_should_show_fallback_content = true;
-        this->document().force_layout();
+        this->document().invalidate_layout_tree(*this);
+        this->document().update_layout();
+    };
+
+    m_image_loader.on_decode_progress = [this](bool size_did_change) {
+        if (size_did_change && layout_node()) {
+            layout_node()->set_needs_layout();
+            this->document().update_layout();
+        } else if (layout_node())
+            layout_node()->set_needs_display();
     };
 }
 
@@ -25,6 +25,7 @@
  */
 
 #include <AK/StringBuilder.h>
+#include <LibCore/EventLoop.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Parser.h>
 #include <LibWeb/DOM/Document.h>
@@ -121,20 +122,19 @@ void HTMLScriptElement::prepare_script(Badge<HTMLDocumentParser>)
 
         // FIXME: Check classic vs. module script type
 
-        // FIXME: This load should be made asynchronous and the parser should spin an event loop etc.
-        ResourceLoader::the().load_sync(
-            url,
-            [this, url](auto& data, auto&) {
-                if (data.is_null()) {
-                    dbg() << "HTMLScriptElement: Failed to load " << url;
-                    return;
-                }
-                m_script_source = String::copy(data);
-                script_became_ready();
-            },
-            [this](auto&) {
-                m_failed_to_load = true;
-            });
+        // NOTE: Going through the resource cache lets us pick up scripts the parser has already started preloading.
+        LoadRequest request;
+        request.set_url(url);
+        set_resource(ResourceLoader::the().load_resource(Resource::Type::Generic, request));
+        if (!resource()) {
+            m_failed_to_load = true;
+        } else if (!resource()->is_loaded() && !resource()->is_failed()) {
+            // FIXME: This load should be made asynchronous and the parser should spin an event loop etc.
+            Core::EventLoop loop;
+            m_script_load_event_loop = &loop;
+            loop.exec();
+            m_script_load_event_loop = nullptr;
+        }
     } else {
         // FIXME: Check classic vs. module script type
         m_script_source = source_text;
@@ -168,6 +168,26 @@ void HTMLScriptElement::prepare_script(Badge<HTMLDocumentParser>)
     }
 }
 
+void HTMLScriptElement::resource_did_load()
+{
+    ASSERT(resource());
+    if (!resource()->has_encoded_data()) {
+        dbg() << "HTMLScriptElement: Failed to load " << resource()->url();
+    } else {
+        m_script_source = String::copy(resource()->encoded_data());
+        script_became_ready();
+    }
+    if (m_script_load_event_loop)
+        m_script_load_event_loop->quit(0);
+}
+
+void HTMLScriptElement::resource_did_fail()
+{
+    m_failed_to_load = true;
+    if (m_script_load_event_loop)
+        m_script_load_event_loop->quit(0);
+}
+
 void HTMLScriptElement::script_became_ready()
 {
     m_script_ready = true;
@@ -27,11 +27,15 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <LibCore/Forward.h>
 #include <LibWeb/HTML/HTMLElement.h>
+#include <LibWeb/Loader/Resource.h>
 
 namespace Web::HTML {
 
-class HTMLScriptElement : public HTMLElement {
+class HTMLScriptElement
+    : public HTMLElement
+    , public ResourceClient {
 public:
     using WrapperType = Bindings::HTMLScriptElementWrapper;
 
@@ -49,6 +53,10 @@ public:
     void execute_script();
 
 private:
+    // ^ResourceClient
+    virtual void resource_did_load() override;
+    virtual void resource_did_fail() override;
+
     void script_became_ready();
     void when_the_script_is_ready(Function<void()>);
 
@@ -65,6 +73,8 @@ private:
     Function<void()> m_script_ready_callback;
 
     String m_script_source;
+
+    Core::EventLoop* m_script_load_event_loop { nullptr };
 };
 
 }
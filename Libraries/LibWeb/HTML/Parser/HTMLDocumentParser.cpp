@@ -38,6 +38,8 @@
 #include <LibWeb/HTML/HTMLScriptElement.h>
 #include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizerThread.h>
+#include <LibWeb/Loader/ResourceLoader.h>
 
 namespace Web::HTML {
 
@@ -123,21 +125,80 @@ HTMLDocumentParser::HTMLDocumentParser(const StringView& input, const String& en
 {
 }
 
+HTMLDocumentParser::HTMLDocumentParser(const String& encoding)
+    : m_tokenizer(encoding)
+{
+    m_document = adopt(*new DOM::Document);
+}
+
 HTMLDocumentParser::~HTMLDocumentParser()
 {
 }
 
 void HTMLDocumentParser::run(const URL& url)
+{
+    begin(url);
+    finish();
+}
+
+void HTMLDocumentParser::begin(const URL& url)
 {
     m_document->set_url(url);
+
+    // Big documents are worth tokenizing on another thread while we build the tree here.
+    if (!m_parsing_fragment && m_tokenizer.is_input_closed() && m_tokenizer.source().length() >= 16 * KB)
+        m_tokenizer_thread = make<HTMLTokenizerThread>(m_tokenizer.source(), url);
+}
+
+void HTMLDocumentParser::append_input(const StringView& input)
+{
+    m_tokenizer.append_input(input);
+    parse_available_input();
+
+    // Make sure whatever text we have so far shows up in the DOM.
+    flush_character_insertions();
+}
+
+void HTMLDocumentParser::finish()
+{
+    m_tokenizer.close_input();
+    parse_available_input();
+
+    flush_character_insertions();
+
+    m_tokenizer_thread = nullptr;
+
     m_document->set_source(m_tokenizer.source());
 
-    for (;;) {
-        auto optional_token = m_tokenizer.next_token();
+    // "The end"
+
+    auto scripts_to_execute_when_parsing_has_finished = m_document->take_scripts_to_execute_when_parsing_has_finished({});
+    for (auto& script : scripts_to_execute_when_parsing_has_finished) {
+        script.execute_script();
+    }
+
+    m_document->dispatch_event(DOM::Event::create("DOMContentLoaded"));
+
+    auto scripts_to_execute_as_soon_as_possible = m_document->take_scripts_to_execute_as_soon_as_possible({});
+    for (auto& script : scripts_to_execute_as_soon_as_possible) {
+        script.execute_script();
+    }
+}
+
+void HTMLDocumentParser::parse_available_input()
+{
+    while (!m_stop_parsing) {
+        auto optional_token = next_token();
         if (!optional_token.has_value())
             break;
         auto& token = optional_token.value();
 
+        if (m_ignore_next_line_feed) {
+            m_ignore_next_line_feed = false;
+            if (token.is_character() && token.codepoint() == '\n')
+                continue;
+        }
+
 #ifdef PARSER_DEBUG
         dbg() << "[" << insertion_mode_name() << "] " << token.to_string();
 #endif
@@ -147,25 +208,48 @@ void HTMLDocumentParser::run(const URL& url)
 #ifdef PARSER_DEBUG
             dbg() << "Stop parsing" << (m_parsing_fragment ? " fragment" : "") << "! :^)";
 #endif
-            break;
         }
     }
+}
 
-    flush_character_insertions();
+Optional<HTMLToken> HTMLDocumentParser::next_token()
+{
+    if (!m_tokenizer_thread)
+        return m_tokenizer.next_token();
+    auto token = m_tokenizer_thread->next_token();
+    start_preloads(m_tokenizer_thread->take_preloads());
+    return token;
+}
 
-    // "The end"
+void HTMLDocumentParser::switch_tokenizer_to(HTMLTokenizer::State state)
+{
+    if (m_tokenizer_thread)
+        m_tokenizer_thread->switch_to(state);
+    else
+        m_tokenizer.switch_to({}, state);
+}
 
-    auto scripts_to_execute_when_parsing_has_finished = m_document->take_scripts_to_execute_when_parsing_has_finished({});
-    for (auto& script : scripts_to_execute_when_parsing_has_finished) {
-        script.execute_script();
+void HTMLDocumentParser::start_preloads(Vector<HTMLPreloadScanner::Preload>&& preloads)
+{
+    for (auto& preload : preloads) {
+        LoadRequest request;
+        request.set_url(preload.url);
+        // NOTE: Holding on to the resource keeps it in the cache until the element that wants it comes along.
+        auto resource = ResourceLoader::the().load_resource(preload.type, request);
+        if (resource)
+            m_preloaded_resources.append(resource.release_nonnull());
     }
+}
 
-    m_document->dispatch_event(DOM::Event::create("DOMContentLoaded"));
-
-    auto scripts_to_execute_as_soon_as_possible = m_document->take_scripts_to_execute_as_soon_as_possible({});
-    for (auto& script : scripts_to_execute_as_soon_as_possible) {
-        script.execute_script();
-    }
+void HTMLDocumentParser::scan_ahead_for_preloads()
+{
+    if (m_tokenizer_thread || m_has_scanned_ahead)
+        return;
+    // Until all of the input is here, there may be more to find next time.
+    m_has_scanned_ahead = m_tokenizer.is_input_closed();
+    HTMLPreloadScanner scanner(m_document->url());
+    scanner.scan_ahead(m_tokenizer.source(), m_tokenizer.checkpoint());
+    start_preloads(scanner.take_preloads());
 }
 
 void HTMLDocumentParser::process_using_the_rules_for(InsertionMode mode, HTMLToken& token)
@@ -507,7 +591,7 @@ void HTMLDocumentParser::handle_in_head(HTMLToken& token)
 
     if (token.is_start_tag() && token.tag_name() == HTML::TagNames::title) {
         insert_html_element(token);
-        m_tokenizer.switch_to({}, HTMLTokenizer::State::RCDATA);
+        switch_tokenizer_to(HTMLTokenizer::State::RCDATA);
         m_original_insertion_mode = m_insertion_mode;
         m_insertion_mode = InsertionMode::Text;
         return;
@@ -541,7 +625,7 @@ void HTMLDocumentParser::handle_in_head(HTMLToken& token)
 
         adjusted_insertion_location.parent->insert_before(element, adjusted_insertion_location.insert_before_sibling, false);
         m_stack_of_open_elements.push(element);
-        m_tokenizer.switch_to({}, HTMLTokenizer::State::ScriptData);
+        switch_tokenizer_to(HTMLTokenizer::State::ScriptData);
         m_original_insertion_mode = m_insertion_mode;
         m_insertion_mode = InsertionMode::Text;
         return;
@@ -622,7 +706,7 @@ AnythingElse:
 void HTMLDocumentParser::parse_generic_raw_text_element(HTMLToken& token)
 {
     insert_html_element(token);
-    m_tokenizer.switch_to({}, HTMLTokenizer::State::RAWTEXT);
+    switch_tokenizer_to(HTMLTokenizer::State::RAWTEXT);
     m_original_insertion_mode = m_insertion_mode;
     m_insertion_mode = InsertionMode::Text;
 }
@@ -649,22 +733,19 @@ void HTMLDocumentParser::flush_character_insertions()
     m_character_insertion_node->set_data(m_character_insertion_builder.to_string());
     m_character_insertion_node->parent()->children_changed();
     m_character_insertion_builder.clear();
+    m_character_insertion_node = nullptr;
 }
 
 void HTMLDocumentParser::insert_character(u32 data)
 {
     auto node = find_character_insertion_node();
-    if (node == m_character_insertion_node) {
-        m_character_insertion_builder.append(Utf32View { &data, 1 });
-        return;
-    }
-    if (!m_character_insertion_node) {
+    if (node != m_character_insertion_node) {
+        flush_character_insertions();
         m_character_insertion_node = node;
-        m_character_insertion_builder.append(Utf32View { &data, 1 });
-        return;
+        // We may be continuing a text node that was flushed halfway through, e.g. when we ran out of input.
+        if (node)
+            m_character_insertion_builder.append(node->data());
     }
-    flush_character_insertions();
-    m_character_insertion_node = node;
     m_character_insertion_builder.append(Utf32View { &data, 1 });
 }
 
@@ -1161,12 +1242,8 @@ void HTMLDocumentParser::handle_in_body(HTMLToken& token)
         // If the next token is a U+000A LINE FEED (LF) character token,
         // then ignore that token and move on to the next one.
         // (Newlines at the start of pre blocks are ignored as an authoring convenience.)
-        auto next_token = m_tokenizer.next_token();
-        if (next_token.has_value() && next_token.value().is_character() && next_token.value().codepoint() == '\n') {
-            // Ignore it.
-        } else {
-            process_using_the_rules_for(m_insertion_mode, next_token.value());
-        }
+        // NOTE: The next token may not have arrived yet, so we just make a note of this.
+        m_ignore_next_line_feed = true;
         return;
     }
 
@@ -1242,7 +1319,7 @@ void HTMLDocumentParser::handle_in_body(HTMLToken& token)
         if (m_stack_of_open_elements.has_in_button_scope(HTML::TagNames::p))
             close_a_p_element();
         insert_html_element(token);
-        m_tokenizer.switch_to({}, HTMLTokenizer::State::PLAINTEXT);
+        switch_tokenizer_to(HTMLTokenizer::State::PLAINTEXT);
         return;
     }
 
@@ -1492,22 +1569,16 @@ void HTMLDocumentParser::handle_in_body(HTMLToken& token)
     if (token.is_start_tag() && token.tag_name() == HTML::TagNames::textarea) {
         insert_html_element(token);
 
-        m_tokenizer.switch_to({}, HTMLTokenizer::State::RCDATA);
+        switch_tokenizer_to(HTMLTokenizer::State::RCDATA);
 
         // If the next token is a U+000A LINE FEED (LF) character token,
         // then ignore that token and move on to the next one.
         // (Newlines at the start of pre blocks are ignored as an authoring convenience.)
-        auto next_token = m_tokenizer.next_token();
+        m_ignore_next_line_feed = true;
 
         m_original_insertion_mode = m_insertion_mode;
         m_frameset_ok = false;
         m_insertion_mode = InsertionMode::Text;
-
-        if (next_token.has_value() && next_token.value().is_character() && next_token.value().codepoint() == '\n') {
-            // Ignore it.
-        } else {
-            process_using_the_rules_for(m_insertion_mode, next_token.value());
-        }
         return;
     }
 
@@ -1769,6 +1840,11 @@ void HTMLDocumentParser::handle_text(HTMLToken& token)
         NonnullRefPtr<HTMLScriptElement> script = downcast<HTMLScriptElement>(current_node());
         m_stack_of_open_elements.pop();
         m_insertion_mode = m_original_insertion_mode;
+
+        // An external script blocks parsing until it has loaded, so start fetching whatever comes after it in the meantime.
+        if (!m_parsing_fragment && script->has_attribute(HTML::AttributeNames::src))
+            scan_ahead_for_preloads();
+
         // FIXME: Handle tokenizer insertion point stuff here.
         increment_script_nesting_level();
         script->prepare_script({});
@@ -27,7 +27,9 @@
 #pragma once
 
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/OwnPtr.h>
 #include <LibWeb/DOM/Node.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
 #include <LibWeb/HTML/Parser/HTMLTokenizer.h>
 #include <LibWeb/HTML/Parser/ListOfActiveFormattingElements.h>
 #include <LibWeb/HTML/Parser/StackOfOpenElements.h>
@@ -65,10 +67,16 @@ class HTMLDocumentParser {
 public:
     HTMLDocumentParser(const StringView& input, const String& encoding);
     HTMLDocumentParser(const StringView& input, const String& encoding, DOM::Document& existing_document);
+    // Creates a parser for a document that arrives in pieces: call begin(), then append_input() with each piece, then finish().
+    explicit HTMLDocumentParser(const String& encoding);
     ~HTMLDocumentParser();
 
     void run(const URL&);
 
+    void begin(const URL&);
+    void append_input(const StringView&);
+    void finish();
+
     DOM::Document& document();
 
     static NonnullRefPtrVector<DOM::Node> parse_html_fragment(DOM::Element& context_element, const StringView&);
@@ -86,6 +94,12 @@ public:
 private:
     const char* insertion_mode_name() const;
 
+    void parse_available_input();
+    Optional<HTMLToken> next_token();
+    void switch_tokenizer_to(HTMLTokenizer::State);
+    void start_preloads(Vector<HTMLPreloadScanner::Preload>&&);
+    void scan_ahead_for_preloads();
+
     DOM::QuirksMode which_quirks_mode(const HTMLToken&) const;
 
     void handle_initial(HTMLToken&);
@@ -164,6 +178,9 @@ private:
     ListOfActiveFormattingElements m_list_of_active_formatting_elements;
 
     HTMLTokenizer m_tokenizer;
+    OwnPtr<HTMLTokenizerThread> m_tokenizer_thread;
+    NonnullRefPtrVector<Resource> m_preloaded_resources;
+    bool m_has_scanned_ahead { false };
 
     bool m_foster_parenting { false };
     bool m_frameset_ok { true };
@@ -173,6 +190,7 @@ private:
     bool m_aborted { false };
     bool m_parser_pause_flag { false };
     bool m_stop_parsing { false };
+    bool m_ignore_next_line_feed { false };
     size_t m_script_nesting_level { 0 };
 
     RefPtr<DOM::Document> m_document;
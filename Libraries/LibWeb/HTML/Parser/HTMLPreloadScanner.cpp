@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibWeb/DOM/AttributeNames.h>
+#include <LibWeb/DOM/TagNames.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+
+namespace Web::HTML {
+
+HTMLPreloadScanner::HTMLPreloadScanner(const URL& document_url)
+    : m_document_url(document_url)
+{
+}
+
+void HTMLPreloadScanner::scan(const HTMLToken& token)
+{
+    ASSERT(token.is_start_tag());
+    // NOTE: Names are compared as views so that we never intern a FlyString, which isn't safe off the main thread.
+    auto tag_name = token.m_tag.tag_name.string_view();
+
+    if (tag_name == TagNames::script.view() || tag_name == TagNames::img.view()) {
+        auto type = tag_name == TagNames::img.view() ? Resource::Type::Image : Resource::Type::Generic;
+        for (auto& attribute : token.m_tag.attributes) {
+            if (attribute.local_name_builder.string_view() == AttributeNames::src.view()) {
+                add(type, attribute.value_builder.string_view());
+                break;
+            }
+        }
+        return;
+    }
+
+    if (tag_name == TagNames::link.view()) {
+        StringView href;
+        bool is_stylesheet = false;
+        bool is_alternate = false;
+        for (auto& attribute : token.m_tag.attributes) {
+            auto name = attribute.local_name_builder.string_view();
+            if (name == AttributeNames::href.view()) {
+                href = attribute.value_builder.string_view();
+            } else if (name == AttributeNames::rel.view()) {
+                for (auto& part : attribute.value_builder.string_view().split_view(' ')) {
+                    if (part == "stylesheet")
+                        is_stylesheet = true;
+                    else if (part == "alternate")
+                        is_alternate = true;
+                }
+            }
+        }
+        if (is_stylesheet && !is_alternate)
+            add(Resource::Type::Generic, href);
+    }
+}
+
+void HTMLPreloadScanner::scan_ahead(const StringView& source, const HTMLTokenizer::Checkpoint& checkpoint)
+{
+    HTMLTokenizer tokenizer(source, "utf-8");
+    tokenizer.restore(checkpoint, HTMLTokenizer::State::Data);
+    for (;;) {
+        auto token = tokenizer.next_token();
+        if (!token.has_value())
+            break;
+        if (!token.value().is_start_tag())
+            continue;
+        scan(token.value());
+        // Without a tree builder to tell us, guess the state so that e.g. script contents aren't scanned as markup.
+        tokenizer.switch_to_predicted_state_after(token.value());
+    }
+}
+
+void HTMLPreloadScanner::add(Resource::Type type, const StringView& url_string)
+{
+    if (url_string.is_empty())
+        return;
+    auto url = m_document_url.complete_url(url_string);
+    if (!url.is_valid())
+        return;
+    if (m_seen_urls.set(url.to_string()) == AK::HashSetResult::ReplacedExistingEntry)
+        return;
+    m_preloads.append({ type, move(url) });
+}
+
+}
@@ -37,6 +37,7 @@ namespace Web::HTML {
 
 class HTMLToken {
     friend class HTMLDocumentParser;
+    friend class HTMLPreloadScanner;
     friend class HTMLTokenizer;
 
 public:
@@ -25,6 +25,7 @@
  */
 
 #include <LibTextCodec/Decoder.h>
+#include <LibWeb/DOM/TagNames.h>
 #include <LibWeb/HTML/Parser/Entities.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 #include <LibWeb/HTML/Parser/HTMLTokenizer.h>
@@ -107,9 +108,9 @@ namespace Web::HTML {
         }                                                                                          \
     } while (0)
 
-#define DONT_CONSUME_NEXT_INPUT_CHARACTER       \
-    do {                                        \
-        m_utf8_iterator = m_prev_utf8_iterator; \
+#define DONT_CONSUME_NEXT_INPUT_CHARACTER \
+    do {                                  \
+        m_cursor = m_prev_cursor;         \
     } while (0)
 
 #define ON(codepoint) \
@@ -213,34 +214,100 @@ static inline bool is_control(u32 codepoint)
     return is_c0_control(codepoint) || (codepoint >= 0x7f && codepoint <= 0x9f);
 }
 
+u32 HTMLTokenizer::codepoint_at(size_t byte_offset, size_t& length_in_bytes) const
+{
+    // Most markup is ASCII, which doesn't need to go through the UTF-8 decoder.
+    u8 byte = m_input[byte_offset];
+    if (byte < 0x80) {
+        length_in_bytes = 1;
+        return byte;
+    }
+    auto it = Utf8View(m_input.substring_view(byte_offset, m_input.length() - byte_offset)).begin();
+    length_in_bytes = it.codepoint_length_in_bytes();
+    return *it;
+}
+
 Optional<u32> HTMLTokenizer::next_codepoint()
 {
-    if (m_utf8_iterator == m_utf8_view.end())
+    if (m_cursor >= m_input.length()) {
+        if (!m_input_is_closed)
+            m_ran_out_of_input = true;
         return {};
-    m_prev_utf8_iterator = m_utf8_iterator;
-    ++m_utf8_iterator;
+    }
+    size_t length_in_bytes;
+    auto codepoint = codepoint_at(m_cursor, length_in_bytes);
+    m_prev_cursor = m_cursor;
+    m_cursor += length_in_bytes;
 #ifdef TOKENIZER_TRACE
-    dbg() << "(Tokenizer) Next codepoint: " << (char)*m_prev_utf8_iterator;
+    dbg() << "(Tokenizer) Next codepoint: " << (char)codepoint;
 #endif
-    return *m_prev_utf8_iterator;
+    return codepoint;
 }
 
-Optional<u32> HTMLTokenizer::peek_codepoint(size_t offset) const
+Optional<u32> HTMLTokenizer::peek_codepoint(size_t offset)
 {
-    auto it = m_utf8_iterator;
-    for (size_t i = 0; i < offset && it != m_utf8_view.end(); ++i)
-        ++it;
-    if (it == m_utf8_view.end())
+    size_t cursor = m_cursor;
+    for (size_t i = 0; i < offset && cursor < m_input.length(); ++i) {
+        size_t length_in_bytes;
+        codepoint_at(cursor, length_in_bytes);
+        cursor += length_in_bytes;
+    }
+    if (cursor >= m_input.length()) {
+        if (!m_input_is_closed)
+            m_ran_out_of_input = true;
         return {};
-    return *it;
+    }
+    size_t length_in_bytes;
+    return codepoint_at(cursor, length_in_bytes);
+}
+
+void HTMLTokenizer::consume_ascii_run_into(StringBuilder& builder, const StringView& stop_characters)
+{
+    size_t end = m_cursor;
+    while (end < m_input.length()) {
+        u8 byte = m_input[end];
+        if (byte >= 0x80 || byte == 0 || stop_characters.contains(byte))
+            break;
+        ++end;
+    }
+    if (end == m_cursor)
+        return;
+    builder.append(m_input.substring_view(m_cursor, end - m_cursor));
+    m_prev_cursor = end - 1;
+    m_cursor = end;
 }
 
 Optional<HTMLToken> HTMLTokenizer::next_token()
+{
+    if (m_input_is_closed || !m_queued_tokens.is_empty())
+        return consume_next_token();
+
+    // Running out of input that isn't all here yet means backing up to where this token started,
+    // so that it can be tokenized again once more of the input has arrived.
+    auto checkpoint = this->checkpoint();
+    auto token = consume_next_token();
+    if (!m_ran_out_of_input)
+        return token;
+    m_ran_out_of_input = false;
+    restore(checkpoint);
+    return {};
+}
+
+Optional<HTMLToken> HTMLTokenizer::consume_next_token()
 {
 _StartOfFunction:
     if (!m_queued_tokens.is_empty())
         return m_queued_tokens.dequeue();
 
+    // Plain ASCII text in the data state turns into character tokens one by one, so it's worth skipping the state machine for.
+    if (m_state == State::Data && m_cursor < m_input.length()) {
+        u8 byte = m_input[m_cursor];
+        if (byte < 0x80 && byte != '&' && byte != '<' && byte != 0) {
+            m_prev_cursor = m_cursor++;
+            return HTMLToken::make_character(byte);
+        }
+    }
+
     for (;;) {
         auto current_input_character = next_codepoint();
         switch (m_state) {
@@ -1173,7 +1240,9 @@ _StartOfFunction:
                 }
                 ANYTHING_ELSE
                 {
-                    m_current_token.m_tag.attributes.last().value_builder.append_codepoint(current_input_character.value());
+                    auto& value_builder = m_current_token.m_tag.attributes.last().value_builder;
+                    value_builder.append_codepoint(current_input_character.value());
+                    consume_ascii_run_into(value_builder, "\"&");
                     continue;
                 }
             }
@@ -1203,7 +1272,9 @@ _StartOfFunction:
                 }
                 ANYTHING_ELSE
                 {
-                    m_current_token.m_tag.attributes.last().value_builder.append_codepoint(current_input_character.value());
+                    auto& value_builder = m_current_token.m_tag.attributes.last().value_builder;
+                    value_builder.append_codepoint(current_input_character.value());
+                    consume_ascii_run_into(value_builder, "'&");
                     continue;
                 }
             }
@@ -1263,7 +1334,9 @@ _StartOfFunction:
                 ANYTHING_ELSE
                 {
                 AnythingElseAttributeValueUnquoted:
-                    m_current_token.m_tag.attributes.last().value_builder.append_codepoint(current_input_character.value());
+                    auto& value_builder = m_current_token.m_tag.attributes.last().value_builder;
+                    value_builder.append_codepoint(current_input_character.value());
+                    consume_ascii_run_into(value_builder, "\t\n\f &>\"'<=`");
                     continue;
                 }
             }
@@ -1531,15 +1604,18 @@ _StartOfFunction:
 
             BEGIN_STATE(NamedCharacterReference)
             {
-                size_t byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
+                size_t byte_offset = m_prev_cursor;
+
+                // The longest entity name is 32 characters, so with less than that left we can't tell what this is yet.
+                if (!m_input_is_closed && m_input.length() - byte_offset < 32)
+                    m_ran_out_of_input = true;
 
-                auto match = HTML::codepoints_from_entity(m_decoded_input.substring_view(byte_offset, m_decoded_input.length() - byte_offset - 1));
+                auto match = HTML::codepoints_from_entity(m_input.substring_view(byte_offset, m_input.length() - byte_offset - 1));
 
                 if (match.has_value()) {
-                    for (size_t i = 0; i < match.value().entity.length() - 1; ++i) {
-                        m_prev_utf8_iterator = m_utf8_iterator;
-                        ++m_utf8_iterator;
-                    }
+                    // Entity names are all ASCII, so they take up a byte per character.
+                    m_prev_cursor = m_cursor + match.value().entity.length() - 2;
+                    m_cursor += match.value().entity.length() - 1;
                     for (auto ch : match.value().entity)
                         m_temporary_buffer.append(ch);
 
@@ -2599,10 +2675,9 @@ bool HTMLTokenizer::consume_next_if_match(const StringView& string, CaseSensitiv
         if (codepoint.value() != (u32)string[i])
             return false;
     }
-    for (size_t i = 0; i < string.length(); ++i) {
-        m_prev_utf8_iterator = m_utf8_iterator;
-        ++m_utf8_iterator;
-    }
+    // The string matched ASCII characters, which take up a byte each.
+    m_prev_cursor = m_cursor + string.length() - 1;
+    m_cursor += string.length();
     return true;
 }
 
@@ -2617,8 +2692,64 @@ HTMLTokenizer::HTMLTokenizer(const StringView& input, const String& encoding)
     auto* decoder = TextCodec::decoder_for(encoding);
     ASSERT(decoder);
     m_decoded_input = decoder->to_utf8(input);
-    m_utf8_view = Utf8View(m_decoded_input);
-    m_utf8_iterator = m_utf8_view.begin();
+    m_input = m_decoded_input;
+}
+
+HTMLTokenizer::HTMLTokenizer(const String& encoding)
+    : m_decoder(TextCodec::decoder_for(encoding))
+    , m_input_is_closed(false)
+{
+    ASSERT(m_decoder);
+}
+
+// Returns how many bytes at the end of the input belong to a UTF-8 sequence that continues past it.
+static size_t length_of_incomplete_utf8_sequence_at_end(const StringView& input)
+{
+    for (size_t i = 1; i <= min(input.length(), (size_t)3); ++i) {
+        u8 byte = input[input.length() - i];
+        if ((byte & 0xc0) == 0x80)
+            continue;
+        size_t sequence_length = byte >= 0xf0 ? 4 : byte >= 0xe0 ? 3 : byte >= 0xc0 ? 2 : 1;
+        return sequence_length > i ? i : 0;
+    }
+    return 0;
+}
+
+void HTMLTokenizer::append_input(const StringView& input)
+{
+    ASSERT(!m_input_is_closed);
+
+    String combined_input;
+    StringView new_input = input;
+    if (!m_undecoded_input.is_empty()) {
+        StringBuilder builder;
+        builder.append(m_undecoded_input);
+        builder.append(input);
+        combined_input = builder.to_string();
+        new_input = combined_input;
+    }
+
+    // A piece of the input can end in the middle of a UTF-8 sequence, which we can't decode until the rest of it arrives.
+    size_t decodable_length = new_input.length();
+    if (m_decoder == TextCodec::decoder_for("utf-8"))
+        decodable_length -= length_of_incomplete_utf8_sequence_at_end(new_input);
+
+    m_undecoded_input = new_input.substring_view(decodable_length, new_input.length() - decodable_length);
+    m_input_builder.append(m_decoder->to_utf8(new_input.substring_view(0, decodable_length)));
+    m_input = m_input_builder.string_view();
+}
+
+void HTMLTokenizer::close_input()
+{
+    if (m_input_is_closed)
+        return;
+    if (!m_undecoded_input.is_empty())
+        m_input_builder.append(m_decoder->to_utf8(m_undecoded_input));
+    m_decoded_input = m_input_builder.to_string();
+    m_input_builder.clear();
+    m_undecoded_input = {};
+    m_input = m_decoded_input;
+    m_input_is_closed = true;
 }
 
 void HTMLTokenizer::will_switch_to([[maybe_unused]] State new_state)
@@ -2643,18 +2774,75 @@ void HTMLTokenizer::switch_to(Badge<HTMLDocumentParser>, State new_state)
     m_state = new_state;
 }
 
+HTMLTokenizer::Checkpoint HTMLTokenizer::checkpoint() const
+{
+    ASSERT(m_queued_tokens.is_empty());
+    return { m_cursor, m_prev_cursor, m_state, m_return_state, m_temporary_buffer, m_character_reference_code, m_last_emitted_start_tag_name };
+}
+
+void HTMLTokenizer::restore(const Checkpoint& checkpoint)
+{
+#ifdef TOKENIZER_TRACE
+    dbg() << "[" << state_name(m_state) << "] Restore to " << checkpoint.cursor << " in " << state_name(checkpoint.state);
+#endif
+    m_cursor = checkpoint.cursor;
+    m_prev_cursor = checkpoint.prev_cursor;
+    m_state = checkpoint.state;
+    m_return_state = checkpoint.return_state;
+    m_temporary_buffer = checkpoint.temporary_buffer;
+    m_character_reference_code = checkpoint.character_reference_code;
+    m_last_emitted_start_tag_name = checkpoint.last_emitted_start_tag_name;
+    m_current_token = {};
+    m_queued_tokens.clear();
+    m_has_emitted_eof = false;
+}
+
+void HTMLTokenizer::restore(const Checkpoint& checkpoint, State state)
+{
+    restore(checkpoint);
+    m_state = state;
+}
+
+HTMLTokenizer::State HTMLTokenizer::state_after_start_tag(const HTMLToken& token)
+{
+    ASSERT(token.is_start_tag());
+    auto tag_name = token.m_tag.tag_name.string_view();
+    if (tag_name == TagNames::title.view() || tag_name == TagNames::textarea.view())
+        return State::RCDATA;
+    // NOTE: This assumes scripting is enabled, which it always is for the documents we parse.
+    if (tag_name == TagNames::style.view() || tag_name == TagNames::xmp.view() || tag_name == TagNames::iframe.view()
+        || tag_name == TagNames::noembed.view() || tag_name == TagNames::noframes.view() || tag_name == TagNames::noscript.view())
+        return State::RAWTEXT;
+    if (tag_name == TagNames::script.view())
+        return State::ScriptData;
+    if (tag_name == TagNames::plaintext.view())
+        return State::PLAINTEXT;
+    return State::Data;
+}
+
+HTMLTokenizer::State HTMLTokenizer::switch_to_predicted_state_after(const HTMLToken& start_tag)
+{
+    auto new_state = state_after_start_tag(start_tag);
+#ifdef TOKENIZER_TRACE
+    dbg() << "[" << state_name(m_state) << "] Predicted tokenizer state " << state_name(new_state) << " after start tag";
+#endif
+    if (new_state != State::Data)
+        m_state = new_state;
+    return new_state;
+}
+
 void HTMLTokenizer::will_emit(HTMLToken& token)
 {
     if (token.is_start_tag())
-        m_last_emitted_start_tag = token;
+        m_last_emitted_start_tag_name = token.m_tag.tag_name.to_string();
 }
 
 bool HTMLTokenizer::current_end_tag_token_is_appropriate() const
 {
     ASSERT(m_current_token.is_end_tag());
-    if (!m_last_emitted_start_tag.is_start_tag())
+    if (m_last_emitted_start_tag_name.is_null())
         return false;
-    return m_current_token.tag_name() == m_last_emitted_start_tag.tag_name();
+    return m_current_token.m_tag.tag_name.string_view() == m_last_emitted_start_tag_name;
 }
 
 bool HTMLTokenizer::consumed_as_part_of_an_attribute() const
@@ -27,12 +27,17 @@
 #pragma once
 
 #include <AK/Queue.h>
+#include <AK/StringBuilder.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Utf8View.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 
+namespace TextCodec {
+class Decoder;
+}
+
 namespace Web::HTML {
 
 #define ENUMERATE_TOKENIZER_STATES                                        \
@@ -121,6 +126,14 @@ class HTMLTokenizer {
 public:
     explicit HTMLTokenizer(const StringView& input, const String& encoding);
 
+    // Creates a tokenizer whose input arrives in pieces through append_input().
+    // Until close_input() is called, next_token() returns nothing when it runs out of input in the middle
+    // of a token, and picks up from the start of that token once there's more.
+    explicit HTMLTokenizer(const String& encoding);
+    void append_input(const StringView&);
+    void close_input();
+    bool is_input_closed() const { return m_input_is_closed; }
+
     enum class State {
 #define __ENUMERATE_TOKENIZER_STATE(state) state,
         ENUMERATE_TOKENIZER_STATES
@@ -131,14 +144,36 @@ public:
 
     void switch_to(Badge<HTMLDocumentParser>, State new_state);
 
+    // A position in the input that tokenization can be restarted from. Only valid between tokens.
+    struct Checkpoint {
+        size_t cursor { 0 };
+        size_t prev_cursor { 0 };
+        State state { State::Data };
+        State return_state { State::Data };
+        Vector<u32> temporary_buffer;
+        u32 character_reference_code { 0 };
+        String last_emitted_start_tag_name;
+    };
+    Checkpoint checkpoint() const;
+    void restore(const Checkpoint&);
+    void restore(const Checkpoint&, State);
+
+    // When tokenizing ahead of the tree builder, guess which state it would switch us to after this start tag.
+    State switch_to_predicted_state_after(const HTMLToken& start_tag);
+
     void set_blocked(bool b) { m_blocked = b; }
     bool is_blocked() const { return m_blocked; }
 
-    String source() const { return m_decoded_input; }
+    // NOTE: Until the input is closed, this makes a copy of everything that has arrived so far.
+    String source() const { return m_input_is_closed ? m_decoded_input : String(m_input); }
 
 private:
+    Optional<HTMLToken> consume_next_token();
     Optional<u32> next_codepoint();
-    Optional<u32> peek_codepoint(size_t offset) const;
+    Optional<u32> peek_codepoint(size_t offset);
+    u32 codepoint_at(size_t byte_offset, size_t& length_in_bytes) const;
+    static State state_after_start_tag(const HTMLToken&);
+    void consume_ascii_run_into(StringBuilder&, const StringView& stop_characters);
     bool consume_next_if_match(const StringView&, CaseSensitivity = CaseSensitivity::CaseSensitive);
     void create_new_token(HTMLToken::Type);
     bool current_end_tag_token_is_appropriate() const;
@@ -168,15 +203,22 @@ private:
 
     String m_decoded_input;
 
+    // Input that arrives in pieces is collected here until it's closed.
+    TextCodec::Decoder* m_decoder { nullptr };
+    StringBuilder m_input_builder;
+    String m_undecoded_input;
+    bool m_input_is_closed { true };
+    bool m_ran_out_of_input { false };
+
+    // Everything decoded so far, which is what we're tokenizing.
     StringView m_input;
 
-    Utf8View m_utf8_view;
-    AK::Utf8CodepointIterator m_utf8_iterator;
-    AK::Utf8CodepointIterator m_prev_utf8_iterator;
+    size_t m_cursor { 0 };
+    size_t m_prev_cursor { 0 };
 
     HTMLToken m_current_token;
 
-    HTMLToken m_last_emitted_start_tag;
+    String m_last_emitted_start_tag_name;
 
     bool m_has_emitted_eof { false };
 
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibWeb/HTML/Parser/HTMLTokenizerThread.h>
+
+//#define TOKENIZER_THREAD_DEBUG
+
+namespace Web::HTML {
+
+// Handing tokens over one at a time would spend most of the time on the mutex.
+static constexpr size_t tokens_per_batch = 256;
+static constexpr size_t max_queued_tokens = 16 * 1024;
+
+HTMLTokenizerThread::HTMLTokenizerThread(const StringView& source, const URL& document_url)
+    : m_tokenizer(source, "utf-8")
+    , m_preload_scanner(document_url)
+{
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_tokens_available, nullptr);
+    pthread_cond_init(&m_work_available, nullptr);
+
+    int rc = pthread_create(&m_thread, nullptr, thread_entry, this);
+    ASSERT(rc == 0);
+    pthread_setname_np(m_thread, "HTMLTokenizer");
+}
+
+HTMLTokenizerThread::~HTMLTokenizerThread()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_exiting = true;
+    pthread_cond_signal(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_join(m_thread, nullptr);
+
+    pthread_cond_destroy(&m_work_available);
+    pthread_cond_destroy(&m_tokens_available);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void* HTMLTokenizerThread::thread_entry(void* arg)
+{
+    static_cast<HTMLTokenizerThread*>(arg)->thread_loop();
+    return nullptr;
+}
+
+void HTMLTokenizerThread::thread_loop()
+{
+    Vector<QueuedToken> batch;
+    pthread_mutex_lock(&m_mutex);
+    for (;;) {
+        while (!m_exiting && !m_restart_requested && (m_finished || m_shared_tokens.size() >= max_queued_tokens))
+            pthread_cond_wait(&m_work_available, &m_mutex);
+        if (m_exiting)
+            break;
+        if (m_restart_requested) {
+            m_tokenizer.restore(m_restart_checkpoint, m_restart_state);
+            m_restart_requested = false;
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        bool reached_end = tokenize_batch(batch);
+        auto preloads = m_preload_scanner.take_preloads();
+
+        pthread_mutex_lock(&m_mutex);
+        m_shared_preloads.append(move(preloads));
+        // Whatever we tokenized while a restart was requested went down the wrong path.
+        if (m_restart_requested) {
+            batch.clear();
+            continue;
+        }
+        m_shared_tokens.append(move(batch));
+        m_finished = reached_end;
+        pthread_cond_signal(&m_tokens_available);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool HTMLTokenizerThread::tokenize_batch(Vector<QueuedToken>& batch)
+{
+    for (size_t i = 0; i < tokens_per_batch; ++i) {
+        auto token = m_tokenizer.next_token();
+        if (!token.has_value())
+            return true;
+        QueuedToken queued_token { token.release_value() };
+        if (queued_token.token.is_start_tag()) {
+            m_preload_scanner.scan(queued_token.token);
+            queued_token.checkpoint = m_tokenizer.checkpoint();
+            queued_token.predicted_state = m_tokenizer.switch_to_predicted_state_after(queued_token.token);
+        }
+        batch.append(move(queued_token));
+    }
+    return false;
+}
+
+bool HTMLTokenizerThread::receive_tokens()
+{
+    m_tokens.clear();
+    m_next_token_index = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_shared_tokens.is_empty() && !m_finished)
+        pthread_cond_wait(&m_tokens_available, &m_mutex);
+    swap(m_tokens, m_shared_tokens);
+    m_preloads.append(move(m_shared_preloads));
+    pthread_cond_signal(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    return !m_tokens.is_empty();
+}
+
+void HTMLTokenizerThread::restart(const HTMLTokenizer::Checkpoint& checkpoint, HTMLTokenizer::State state)
+{
+#ifdef TOKENIZER_THREAD_DEBUG
+    dbg() << "HTMLTokenizerThread: Restarting at " << checkpoint.cursor << " after a wrong guess";
+#endif
+    m_tokens.clear();
+    m_next_token_index = 0;
+    m_awaiting_switch = false;
+    m_last_predicted_state = state;
+
+    pthread_mutex_lock(&m_mutex);
+    m_shared_tokens.clear();
+    m_restart_requested = true;
+    m_restart_checkpoint = checkpoint;
+    m_restart_state = state;
+    m_finished = false;
+    pthread_cond_signal(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+Optional<HTMLToken> HTMLTokenizerThread::next_token()
+{
+    // We guessed that the tree builder would switch states after the last start tag, but it didn't.
+    if (m_awaiting_switch)
+        restart(m_last_checkpoint, HTMLTokenizer::State::Data);
+
+    if (m_next_token_index == m_tokens.size() && !receive_tokens())
+        return {};
+
+    auto& queued_token = m_tokens[m_next_token_index++];
+    m_last_token_was_start_tag = queued_token.token.is_start_tag();
+    if (m_last_token_was_start_tag) {
+        m_last_checkpoint = move(queued_token.checkpoint);
+        m_last_predicted_state = queued_token.predicted_state;
+        m_awaiting_switch = m_last_predicted_state != HTMLTokenizer::State::Data;
+    }
+    return move(queued_token.token);
+}
+
+void HTMLTokenizerThread::switch_to(HTMLTokenizer::State state)
+{
+    // NOTE: The tree builder only ever switches states right after receiving a start tag.
+    ASSERT(m_last_token_was_start_tag);
+    m_awaiting_switch = false;
+    if (state != m_last_predicted_state)
+        restart(m_last_checkpoint, state);
+}
+
+}
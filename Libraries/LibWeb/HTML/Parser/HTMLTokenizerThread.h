@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+#include <pthread.h>
+
+namespace Web::HTML {
+
+// Runs an HTMLTokenizer on a background thread, which hands tokens over to the tree builder in batches
+// and runs them past a preload scanner on the way.
+// The thread can't wait for the tree builder to switch tokenizer states after a start tag, so it guesses instead.
+// When a guess turns out to be wrong, tokenization restarts from right after that start tag.
+class HTMLTokenizerThread {
+    AK_MAKE_NONCOPYABLE(HTMLTokenizerThread);
+    AK_MAKE_NONMOVABLE(HTMLTokenizerThread);
+
+public:
+    HTMLTokenizerThread(const StringView& source, const URL& document_url);
+    ~HTMLTokenizerThread();
+
+    Optional<HTMLToken> next_token();
+    void switch_to(HTMLTokenizer::State);
+
+    Vector<HTMLPreloadScanner::Preload> take_preloads() { return move(m_preloads); }
+
+private:
+    struct QueuedToken {
+        HTMLToken token;
+        HTMLTokenizer::State predicted_state { HTMLTokenizer::State::Data };
+        HTMLTokenizer::Checkpoint checkpoint;
+    };
+
+    static void* thread_entry(void*);
+    void thread_loop();
+    bool tokenize_batch(Vector<QueuedToken>&);
+
+    bool receive_tokens();
+    void restart(const HTMLTokenizer::Checkpoint&, HTMLTokenizer::State);
+
+    // Only touched by the tokenizer thread while it's running.
+    HTMLTokenizer m_tokenizer;
+    HTMLPreloadScanner m_preload_scanner;
+
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_tokens_available;
+    pthread_cond_t m_work_available;
+
+    // Protected by m_mutex.
+    Vector<QueuedToken> m_shared_tokens;
+    Vector<HTMLPreloadScanner::Preload> m_shared_preloads;
+    bool m_restart_requested { false };
+    HTMLTokenizer::Checkpoint m_restart_checkpoint;
+    HTMLTokenizer::State m_restart_state { HTMLTokenizer::State::Data };
+    bool m_finished { false };
+    bool m_exiting { false };
+
+    // Only touched by the main thread.
+    Vector<QueuedToken> m_tokens;
+    size_t m_next_token_index { 0 };
+    Vector<HTMLPreloadScanner::Preload> m_preloads;
+    bool m_last_token_was_start_tag { false };
+    bool m_awaiting_switch { false };
+    HTMLTokenizer::State m_last_predicted_state { HTMLTokenizer::State::Data };
+    HTMLTokenizer::Checkpoint m_last_checkpoint;
+};
+
+}
@@ -56,13 +56,41 @@ LayoutNode& LayoutBlock::inline_wrapper()
     return *last_child();
 }
 
+bool LayoutBlock::is_previous_layout_still_valid() const
+{
+    if (needs_layout() || child_needs_layout() || !m_last_layout_inside_was_default)
+        return false;
+    if (width() != m_width_at_last_layout)
+        return false;
+    auto* containing_block = this->containing_block();
+    if ((containing_block ? containing_block->width() : 0) != m_containing_block_width_at_last_layout)
+        return false;
+    // Percentage heights depend on the height of the containing block, which may have changed.
+    if (style().height().is_percentage() || style().min_height().is_percentage() || style().max_height().is_percentage())
+        return false;
+    return true;
+}
+
 void LayoutBlock::layout(LayoutMode layout_mode)
 {
     compute_width();
+
+    // If nothing inside us changed and we're still as wide as last time, there's nothing to do.
+    // Our parent takes care of placing us, since that may have changed.
+    if (layout_mode == LayoutMode::Default && is_previous_layout_still_valid())
+        return;
+
     layout_inside(layout_mode);
     compute_height();
 
     layout_absolutely_positioned_descendants();
+
+    if (layout_mode == LayoutMode::Default) {
+        auto* containing_block = this->containing_block();
+        m_width_at_last_layout = width();
+        m_containing_block_width_at_last_layout = containing_block ? containing_block->width() : 0;
+        did_layout();
+    }
 }
 
 void LayoutBlock::layout_absolutely_positioned_descendant(LayoutBox& box)
@@ -130,6 +158,7 @@ void LayoutBlock::layout_absolutely_positioned_descendant(LayoutBox& box)
 
 void LayoutBlock::layout_inside(LayoutMode layout_mode)
 {
+    m_last_layout_inside_was_default = layout_mode == LayoutMode::Default;
     if (children_are_inline())
         layout_inline_children(layout_mode);
     else
@@ -146,13 +175,24 @@ void LayoutBlock::layout_absolutely_positioned_descendants()
     });
 }
 
+// Calls back for every box whose containing block is the given block, not counting absolutely positioned ones.
+// Boxes inside another block have that block as their containing block, so we don't have to look inside of those.
+template<typename Callback>
+static void for_each_box_in_normal_flow(LayoutNode& node, Callback callback)
+{
+    for (auto* child = node.first_child(); child; child = child->next_sibling()) {
+        if (is<LayoutBox>(*child) && !child->is_absolutely_positioned())
+            callback(downcast<LayoutBox>(*child));
+        if (!is<LayoutBlock>(*child))
+            for_each_box_in_normal_flow(*child, callback);
+    }
+}
+
 void LayoutBlock::layout_contained_boxes(LayoutMode layout_mode)
 {
     float content_height = 0;
     float content_width = 0;
-    for_each_in_subtree_of_type<LayoutBox>([&](auto& box) {
-        if (box.is_absolutely_positioned() || box.containing_block() != this)
-            return IterationDecision::Continue;
+    for_each_box_in_normal_flow(*this, [&](auto& box) {
         box.layout(layout_mode);
         if (box.is_replaced())
             place_block_level_replaced_element_in_normal_flow(downcast<LayoutReplaced>(box));
@@ -709,7 +749,7 @@ void LayoutBlock::paint(PaintContext& context, PaintPhase phase)
             for (auto& line_box : m_line_boxes) {
                 for (auto& fragment : line_box.fragments()) {
                     if (context.should_show_line_box_borders())
-                        context.painter().draw_rect(enclosing_int_rect(fragment.absolute_rect()), Color::Green);
+                        context.display_list().draw_rect(enclosing_int_rect(fragment.absolute_rect()), Color::Green);
                     fragment.paint(context);
                 }
             }
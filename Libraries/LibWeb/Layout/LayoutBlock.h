@@ -92,7 +92,14 @@ private:
     void layout_inline_children(LayoutMode);
     void layout_contained_boxes(LayoutMode);
 
+    bool is_previous_layout_still_valid() const;
+
     Vector<LineBox> m_line_boxes;
+
+    // What the last complete layout was based on, so we can tell when it can be reused.
+    bool m_last_layout_inside_was_default { false };
+    float m_width_at_last_layout { 0 };
+    float m_containing_block_width_at_last_layout { 0 };
 };
 
 template<typename Callback>
@@ -111,12 +111,12 @@ void LayoutBox::paint_border(PaintContext& context, Edge edge, const Gfx::FloatR
             p2.move_by(int_width / 2, -int_width / 2);
             break;
         }
-        context.painter().draw_line({ (int)p1.x(), (int)p1.y() }, { (int)p2.x(), (int)p2.y() }, color, int_width, line_style);
+        context.display_list().draw_line({ (int)p1.x(), (int)p1.y() }, { (int)p2.x(), (int)p2.y() }, color, int_width, line_style);
         return;
     }
 
     auto draw_line = [&](auto& p1, auto& p2) {
-        context.painter().draw_line({ (int)p1.x(), (int)p1.y() }, { (int)p2.x(), (int)p2.y() }, color, 1, line_style);
+        context.display_list().draw_line({ (int)p1.x(), (int)p1.y() }, { (int)p2.x(), (int)p2.y() }, color, 1, line_style);
     };
 
     float p1_step = 0;
@@ -167,9 +167,11 @@ void LayoutBox::paint(PaintContext& context, PaintPhase phase)
     if (!is_visible())
         return;
 
-    Gfx::PainterStateSaver saver(context.painter());
-    if (is_fixed_position())
-        context.painter().translate(context.scroll_offset());
+    DisplayListStateSaver saver(context.display_list());
+    if (is_fixed_position()) {
+        context.display_list().translate(context.scroll_offset());
+        context.set_did_paint_fixed_position_box();
+    }
 
     Gfx::FloatRect padded_rect;
     padded_rect.set_x(absolute_x() - box_model().padding.left.to_px(*this));
@@ -181,14 +183,14 @@ void LayoutBox::paint(PaintContext& context, PaintPhase phase)
         // FIXME: We should paint the body here too, but that currently happens at the view layer.
         auto bgcolor = specified_style().property(CSS::PropertyID::BackgroundColor);
         if (bgcolor.has_value() && bgcolor.value()->is_color()) {
-            context.painter().fill_rect(enclosing_int_rect(padded_rect), bgcolor.value()->to_color(document()));
+            context.display_list().fill_rect(enclosing_int_rect(padded_rect), bgcolor.value()->to_color(document()));
         }
 
         auto bgimage = specified_style().property(CSS::PropertyID::BackgroundImage);
         if (bgimage.has_value() && bgimage.value()->is_image()) {
             auto& image_value = static_cast<const CSS::ImageStyleValue&>(*bgimage.value());
             if (image_value.bitmap()) {
-                context.painter().draw_tiled_bitmap(enclosing_int_rect(padded_rect), *image_value.bitmap());
+                context.display_list().draw_tiled_bitmap(enclosing_int_rect(padded_rect), *image_value.bitmap());
             }
         }
     }
@@ -218,9 +220,9 @@ void LayoutBox::paint(PaintContext& context, PaintPhase phase)
         margin_rect.set_y(absolute_y() - margin_box.top);
         margin_rect.set_height(height() + margin_box.top + margin_box.bottom);
 
-        context.painter().draw_rect(enclosing_int_rect(margin_rect), Color::Yellow);
-        context.painter().draw_rect(enclosing_int_rect(padded_rect), Color::Cyan);
-        context.painter().draw_rect(enclosing_int_rect(content_rect), Color::Magenta);
+        context.display_list().draw_rect(enclosing_int_rect(margin_rect), Color::Yellow);
+        context.display_list().draw_rect(enclosing_int_rect(padded_rect), Color::Cyan);
+        context.display_list().draw_rect(enclosing_int_rect(content_rect), Color::Magenta);
     }
 }
 
@@ -243,6 +245,7 @@ HitTestResult LayoutBox::hit_test(const Gfx::IntPoint& position) const
 void LayoutBox::set_needs_display()
 {
     if (!is_inline()) {
+        invalidate_enclosing_display_list();
         frame().set_needs_display(enclosing_int_rect(absolute_rect()));
         return;
     }
@@ -307,6 +310,16 @@ StackingContext* LayoutBox::enclosing_stacking_context()
     ASSERT_NOT_REACHED();
 }
 
+bool LayoutBox::is_relayout_boundary() const
+{
+    if (is_root() || !is_block() || is_inline())
+        return false;
+    if (is_table() || is_table_row_group() || is_table_cell())
+        return false;
+    // Our size doesn't depend on what's inside us, so nothing outside of us moves when that changes.
+    return style().width().is_absolute() && style().height().is_absolute();
+}
+
 bool LayoutBox::establishes_stacking_context() const
 {
     if (!has_style())
@@ -60,12 +60,16 @@ public:
 
     bool is_body() const;
 
+    // Whether this box can be laid out again on its own, without affecting the layout of anything outside of it.
+    bool is_relayout_boundary() const;
+
     void set_containing_line_box_fragment(LineBoxFragment&);
 
     bool establishes_stacking_context() const;
     StackingContext* stacking_context() { return m_stacking_context; }
     const StackingContext* stacking_context() const { return m_stacking_context; }
     void set_stacking_context(NonnullOwnPtr<StackingContext> context) { m_stacking_context = move(context); }
+    void clear_stacking_context() { m_stacking_context = nullptr; }
     StackingContext* enclosing_stacking_context();
 
     virtual void paint(PaintContext&, PaintPhase) override;
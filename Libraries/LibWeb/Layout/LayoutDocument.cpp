@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibGfx/Painter.h>
 #include <LibWeb/Dump.h>
 #include <LibWeb/Layout/LayoutDocument.h>
 #include <LibWeb/Layout/LayoutImage.h>
@@ -48,6 +49,7 @@ void LayoutDocument::build_stacking_context_tree()
         return;
 
     set_stacking_context(make<StackingContext>(*this, nullptr));
+    m_display_lists_depend_on_scroll_offset = false;
 
     for_each_in_subtree_of_type<LayoutBox>([&](LayoutBox& box) {
         if (&box == this)
@@ -63,12 +65,64 @@ void LayoutDocument::build_stacking_context_tree()
     });
 }
 
+void LayoutDocument::invalidate_stacking_context_tree()
+{
+    for_each_in_subtree_of_type<LayoutBox>([&](LayoutBox& box) {
+        box.clear_stacking_context();
+        return IterationDecision::Continue;
+    });
+}
+
+void LayoutDocument::invalidate_display_lists()
+{
+    for_each_in_subtree_of_type<LayoutBox>([&](LayoutBox& box) {
+        if (box.stacking_context())
+            box.stacking_context()->invalidate_display_lists();
+        return IterationDecision::Continue;
+    });
+    m_display_lists_depend_on_scroll_offset = false;
+}
+
+void LayoutDocument::did_set_needs_layout_inside_relayout_boundary(Badge<LayoutNode>, LayoutBox& box)
+{
+    for (auto& boundary : m_dirty_relayout_boundaries) {
+        if (&boundary == &box)
+            return;
+    }
+    m_dirty_relayout_boundaries.append(box);
+}
+
+void LayoutDocument::layout_dirty_relayout_boundaries()
+{
+    build_stacking_context_tree();
+
+    auto boundaries = move(m_dirty_relayout_boundaries);
+    if (!boundaries.is_empty())
+        invalidate_display_lists();
+    for (auto& boundary : boundaries) {
+        // The box may have been removed from the layout tree since it was marked.
+        if (!is_ancestor_of(boundary))
+            continue;
+        if (!boundary.needs_layout() && !boundary.child_needs_layout())
+            continue;
+        boundary.layout(LayoutMode::Default);
+        boundary.for_each_in_subtree_of_type<LayoutWidget>([&](auto& widget) {
+            widget.update_widget();
+            return IterationDecision::Continue;
+        });
+        boundary.set_needs_display();
+    }
+}
+
 void LayoutDocument::layout(LayoutMode layout_mode)
 {
     build_stacking_context_tree();
 
     set_width(frame().size().width());
 
+    // These aren't necessarily reached from here, since their ancestors don't know that they need layout.
+    layout_dirty_relayout_boundaries();
+
     LayoutNode::layout(layout_mode);
 
     ASSERT(!children_are_inline());
@@ -89,11 +143,22 @@ void LayoutDocument::layout(LayoutMode layout_mode)
         widget.update_widget();
         return IterationDecision::Continue;
     });
+
+    invalidate_display_lists();
+    did_layout();
+}
+
+void LayoutDocument::did_set_viewport_rect(Badge<Frame>, const Gfx::IntRect&)
+{
+    update_images_visible_in_viewport();
 }
 
-void LayoutDocument::did_set_viewport_rect(Badge<Frame>, const Gfx::IntRect& a_viewport_rect)
+void LayoutDocument::update_images_visible_in_viewport()
 {
-    Gfx::FloatRect viewport_rect(a_viewport_rect.x(), a_viewport_rect.y(), a_viewport_rect.width(), a_viewport_rect.height());
+    // Subframes are painted as a whole into their host's box (see LayoutFrame), so all of them counts as the viewport.
+    auto& frame = this->frame();
+    auto int_viewport_rect = frame.is_main_frame() ? frame.viewport_rect() : Gfx::IntRect({}, frame.size());
+    Gfx::FloatRect viewport_rect(int_viewport_rect.x(), int_viewport_rect.y(), int_viewport_rect.width(), int_viewport_rect.height());
     for_each_in_subtree_of_type<LayoutImage>([&](auto& layout_image) {
         const_cast<LayoutImage&>(layout_image).set_visible_in_viewport({}, viewport_rect.intersects(layout_image.absolute_rect()));
         return IterationDecision::Continue;
@@ -110,11 +175,50 @@ void LayoutDocument::paint_all_phases(PaintContext& context)
 
 void LayoutDocument::paint(PaintContext& context, PaintPhase phase)
 {
+    build_stacking_context_tree();
     stacking_context()->paint(context, phase);
 }
 
+void LayoutDocument::paint_with_display_lists(Gfx::Painter& painter, const Gfx::IntRect& content_rect, PaintContext& context)
+{
+    painter.fill_rect(content_rect, document().background_color(context.palette()));
+    if (auto background_bitmap = document().background_image())
+        painter.draw_tiled_bitmap(content_rect, *background_bitmap);
+
+    build_stacking_context_tree();
+
+    // Fixed position boxes are recorded at the scroll offset they were painted with.
+    if (m_display_lists_depend_on_scroll_offset && m_display_list_scroll_offset != context.scroll_offset())
+        invalidate_display_lists();
+    m_display_list_scroll_offset = context.scroll_offset();
+
+    stacking_context()->record_display_lists(context);
+    if (context.did_paint_fixed_position_box())
+        m_display_lists_depend_on_scroll_offset = true;
+
+    stacking_context()->paint_display_lists(painter, content_rect, PaintPhase::Background);
+    stacking_context()->paint_display_lists(painter, content_rect, PaintPhase::Border);
+    stacking_context()->paint_display_lists(painter, content_rect, PaintPhase::Foreground);
+    stacking_context()->paint_display_lists(painter, content_rect, PaintPhase::Overlay);
+}
+
+void LayoutDocument::set_selection(const LayoutRange& selection)
+{
+    m_selection = selection;
+    invalidate_display_lists();
+    set_needs_display();
+}
+
+void LayoutDocument::set_selection_end(const LayoutPosition& position)
+{
+    m_selection.set_end(position);
+    invalidate_display_lists();
+    set_needs_display();
+}
+
 HitTestResult LayoutDocument::hit_test(const Gfx::IntPoint& position) const
 {
+    const_cast<LayoutDocument&>(*this).build_stacking_context_tree();
     return stacking_context()->hit_test(position);
 }
 
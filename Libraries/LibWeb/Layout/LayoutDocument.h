@@ -43,19 +43,36 @@ public:
     void paint_all_phases(PaintContext&);
     virtual void paint(PaintContext&, PaintPhase) override;
 
+    // Paints the document background and the retained display lists into content_rect,
+    // re-recording whichever display lists have been invalidated since the last time.
+    void paint_with_display_lists(Gfx::Painter&, const Gfx::IntRect& content_rect, PaintContext&);
+    void invalidate_display_lists();
+    bool display_lists_depend_on_scroll_offset() const { return m_display_lists_depend_on_scroll_offset; }
+
     virtual HitTestResult hit_test(const Gfx::IntPoint&) const override;
 
     const LayoutRange& selection() const { return m_selection; }
-    LayoutRange& selection() { return m_selection; }
+    void set_selection(const LayoutRange&);
+    void set_selection_end(const LayoutPosition&);
 
     void did_set_viewport_rect(Badge<Frame>, const Gfx::IntRect&);
+    // Layout may move images into or out of the viewport, so this is done after it too.
+    void update_images_visible_in_viewport();
 
     virtual bool is_root() const override { return true; }
 
     void build_stacking_context_tree();
+    void invalidate_stacking_context_tree();
+
+    void did_set_needs_layout_inside_relayout_boundary(Badge<LayoutNode>, LayoutBox&);
+    void layout_dirty_relayout_boundaries();
 
 private:
     LayoutRange m_selection;
+    NonnullRefPtrVector<LayoutBox> m_dirty_relayout_boundaries;
+
+    Gfx::IntPoint m_display_list_scroll_offset;
+    bool m_display_lists_depend_on_scroll_offset { false };
 };
 
 }
@@ -71,17 +71,17 @@ void LayoutFrame::paint(PaintContext& context, PaintPhase phase)
         if (!hosted_layout_tree)
             return;
 
-        context.painter().save();
+        context.display_list().save();
         auto old_viewport_rect = context.viewport_rect();
 
-        context.painter().add_clip_rect(enclosing_int_rect(absolute_rect()));
-        context.painter().translate(absolute_x(), absolute_y());
+        context.display_list().add_clip_rect(enclosing_int_rect(absolute_rect()));
+        context.display_list().translate(absolute_x(), absolute_y());
 
         context.set_viewport_rect({ {}, node().hosted_frame()->size() });
         const_cast<LayoutDocument*>(hosted_layout_tree)->paint_all_phases(context);
 
         context.set_viewport_rect(old_viewport_rect);
-        context.painter().restore();
+        context.display_list().restore();
     }
 }
 
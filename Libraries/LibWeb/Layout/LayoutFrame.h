@@ -44,6 +44,8 @@ public:
 
 private:
     virtual bool is_frame() const final { return true; }
+    // Resizing the hosted frame lays out its document.
+    virtual bool prepare_for_parallel_layout() const override { return false; }
     virtual const char* class_name() const override { return "LayoutFrame"; }
     virtual void did_set_rect() override;
 };
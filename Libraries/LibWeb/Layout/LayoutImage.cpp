@@ -102,14 +102,14 @@ void LayoutImage::paint(PaintContext& context, PaintPhase phase)
     if (phase == PaintPhase::Foreground) {
         if (renders_as_alt_text()) {
             auto& image_element = downcast<HTML::HTMLImageElement>(node());
-            context.painter().set_font(Gfx::Font::default_font());
-            Gfx::StylePainter::paint_frame(context.painter(), enclosing_int_rect(absolute_rect()), context.palette(), Gfx::FrameShape::Container, Gfx::FrameShadow::Sunken, 2);
+            context.display_list().set_font(Gfx::Font::default_font());
+            context.display_list().paint_frame(enclosing_int_rect(absolute_rect()), context.palette(), Gfx::FrameShape::Container, Gfx::FrameShadow::Sunken, 2);
             auto alt = image_element.alt();
             if (alt.is_empty())
                 alt = image_element.src();
-            context.painter().draw_text(enclosing_int_rect(absolute_rect()), alt, Gfx::TextAlignment::Center, specified_style().color_or_fallback(CSS::PropertyID::Color, document(), Color::Black), Gfx::TextElision::Right);
+            context.display_list().draw_text(enclosing_int_rect(absolute_rect()), alt, Gfx::TextAlignment::Center, specified_style().color_or_fallback(CSS::PropertyID::Color, document(), Color::Black), Gfx::TextElision::Right);
         } else if (auto* bitmap = m_image_loader.bitmap()) {
-            context.painter().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *bitmap, bitmap->rect());
+            context.display_list().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *bitmap, bitmap->rect());
         }
     }
 }
@@ -123,7 +123,15 @@ bool LayoutImage::renders_as_alt_text() const
 
 void LayoutImage::set_visible_in_viewport(Badge<LayoutDocument>, bool visible_in_viewport)
 {
+    // The image is always drawn scaled to our size, so it doesn't need to be decoded any larger.
+    if (!renders_as_alt_text())
+        m_image_loader.set_displayed_size(enclosing_int_rect(absolute_rect()).size());
     m_image_loader.set_visible_in_viewport(visible_in_viewport);
+
+    // Images outside the viewport are left out of the display list, so record this one now that it's visible.
+    if (visible_in_viewport && !m_visible_in_viewport)
+        set_needs_display();
+    m_visible_in_viewport = visible_in_viewport;
 }
 
 }
@@ -48,11 +48,14 @@ public:
 private:
     virtual const char* class_name() const override { return "LayoutImage"; }
     virtual bool is_image() const override { return true; }
+    // Images with the same URL share a decoder, which gets created and fed lazily.
+    virtual bool prepare_for_parallel_layout() const override { return false; }
 
     int preferred_width() const;
     int preferred_height() const;
 
     const ImageLoader& m_image_loader;
+    bool m_visible_in_viewport { false };
 };
 
 }
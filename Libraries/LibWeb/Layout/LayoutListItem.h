@@ -42,6 +42,8 @@ public:
 
 private:
     virtual const char* class_name() const override { return "LayoutListItem"; }
+    // Layout may add the marker to the tree.
+    virtual bool prepare_for_parallel_layout() const override { return false; }
 
     RefPtr<LayoutListItemMarker> m_marker;
 };
@@ -46,7 +46,7 @@ void LayoutListItemMarker::paint(PaintContext& context, PaintPhase phase)
     bullet_rect.center_within(enclosing_int_rect(absolute_rect()));
     // FIXME: It would be nicer to not have to go via the parent here to get our inherited style.
     auto color = parent()->specified_style().color_or_fallback(CSS::PropertyID::Color, document(), context.palette().base_text());
-    context.painter().fill_rect(bullet_rect, color);
+    context.display_list().fill_rect(bullet_rect, color);
 }
 
 }
@@ -32,6 +32,7 @@
 #include <LibWeb/Layout/LayoutNode.h>
 #include <LibWeb/Layout/LayoutReplaced.h>
 #include <LibWeb/Page/Frame.h>
+#include <LibWeb/Painting/StackingContext.h>
 
 namespace Web {
 
@@ -56,6 +57,30 @@ void LayoutNode::layout(LayoutMode layout_mode)
     });
 }
 
+bool LayoutNode::prepare_for_parallel_layout() const
+{
+    specified_style().font();
+    return true;
+}
+
+void LayoutNode::set_needs_layout()
+{
+    m_needs_layout = true;
+
+    // Absolutely positioned boxes are laid out by their containing block, which may be outside a relayout boundary.
+    bool may_stop_at_relayout_boundary = !is_absolutely_positioned();
+    for (auto* ancestor = parent(); ancestor; ancestor = ancestor->parent()) {
+        ancestor->m_child_needs_layout = true;
+        if (may_stop_at_relayout_boundary && is<LayoutBox>(*ancestor) && downcast<LayoutBox>(*ancestor).is_relayout_boundary()) {
+            if (auto* layout_root = document().layout_node())
+                layout_root->did_set_needs_layout_inside_relayout_boundary({}, downcast<LayoutBox>(*ancestor));
+            return;
+        }
+        if (ancestor->is_absolutely_positioned())
+            may_stop_at_relayout_boundary = false;
+    }
+}
+
 bool LayoutNode::can_contain_boxes_with_position_absolute() const
 {
     return style().position() != CSS::Position::Static || is_root();
@@ -148,8 +173,21 @@ void LayoutNode::split_into_lines(LayoutBlock& container, LayoutMode layout_mode
     });
 }
 
+void LayoutNode::invalidate_enclosing_display_list()
+{
+    // What we paint is recorded into the display lists of the nearest stacking context.
+    for (auto* node = this; node; node = node->parent()) {
+        if (is<LayoutBox>(*node) && downcast<LayoutBox>(*node).stacking_context()) {
+            downcast<LayoutBox>(*node).stacking_context()->invalidate_display_lists();
+            return;
+        }
+    }
+}
+
 void LayoutNode::set_needs_display()
 {
+    invalidate_enclosing_display_list();
+
     if (auto* block = containing_block()) {
         block->for_each_fragment([&](auto& fragment) {
             if (&fragment.layout_node() == this || is_ancestor_of(fragment.layout_node())) {
@@ -128,6 +128,17 @@ public:
 
     virtual void layout(LayoutMode);
 
+    // Independent subtrees may be laid out on worker threads (see ParallelLayout.h). Before that happens, this is called
+    // on the main thread for every node in the subtree, to load whatever layout() would otherwise load lazily.
+    // Nodes whose layout has effects outside of their own subtree return false to keep it on the main thread.
+    virtual bool prepare_for_parallel_layout() const;
+
+    // Set when something about this node changed that affects its layout,
+    // and on all of its ancestors (up to the nearest relayout boundary) when it's one of their descendants.
+    bool needs_layout() const { return m_needs_layout; }
+    bool child_needs_layout() const { return m_child_needs_layout; }
+    void set_needs_layout();
+
     enum class PaintPhase {
         Background,
         Border,
@@ -197,6 +208,14 @@ public:
 protected:
     LayoutNode(DOM::Document&, DOM::Node*);
 
+    void did_layout()
+    {
+        m_needs_layout = false;
+        m_child_needs_layout = false;
+    }
+
+    void invalidate_enclosing_display_list();
+
 private:
     friend class LayoutNodeWithStyle;
 
@@ -207,6 +226,8 @@ private:
     bool m_has_style { false };
     bool m_visible { true };
     bool m_children_are_inline { false };
+    bool m_needs_layout { true };
+    bool m_child_needs_layout { false };
 };
 
 class LayoutNodeWithStyle : public LayoutNode {
@@ -214,7 +235,11 @@ public:
     virtual ~LayoutNodeWithStyle() override { }
 
     const CSS::StyleProperties& specified_style() const { return m_specified_style; }
-    void set_specified_style(const CSS::StyleProperties& style) { m_specified_style = style; }
+    void set_specified_style(const CSS::StyleProperties& style)
+    {
+        m_specified_style = style;
+        apply_style(style);
+    }
 
     const ImmutableLayoutStyle& style() const { return static_cast<const ImmutableLayoutStyle&>(m_style); }
 
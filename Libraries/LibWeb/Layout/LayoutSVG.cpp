@@ -53,14 +53,11 @@ void LayoutSVG::paint(PaintContext& context, PaintPhase phase)
     LayoutReplaced::paint(context, phase);
 
     if (phase == PaintPhase::Foreground) {
-        if (!context.viewport_rect().intersects(enclosing_int_rect(absolute_rect())))
-            return;
-
         if (!node().bitmap())
             node().create_bitmap_as_top_level_svg_element();
 
         ASSERT(node().bitmap());
-        context.painter().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *node().bitmap(), node().bitmap()->rect());
+        context.display_list().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *node().bitmap(), node().bitmap()->rect());
     }
 }
 
@@ -44,17 +44,17 @@ void LayoutTableRow::layout(LayoutMode)
 {
 }
 
-void LayoutTableRow::calculate_column_widths(Vector<float>& column_widths)
+LayoutNode::LayoutMode LayoutTableRow::layout_mode_for_cells() const
 {
-    size_t column_index = 0;
     auto* table = first_ancestor_of_type<LayoutTable>();
     bool use_auto_layout = !table || table->style().width().is_undefined_or_auto();
+    return use_auto_layout ? LayoutMode::OnlyRequiredLineBreaks : LayoutMode::Default;
+}
+
+void LayoutTableRow::calculate_column_widths(Vector<float>& column_widths)
+{
+    size_t column_index = 0;
     for_each_child_of_type<LayoutTableCell>([&](auto& cell) {
-        if (use_auto_layout) {
-            cell.layout(LayoutMode::OnlyRequiredLineBreaks);
-        } else {
-            cell.layout(LayoutMode::Default);
-        }
         column_widths[column_index] = max(column_widths[column_index], cell.width());
         column_index += cell.colspan();
     });
@@ -71,13 +71,6 @@ void LayoutTableRow::layout_row(const Vector<float>& column_widths)
     for_each_child_of_type<LayoutTableCell>([&](auto& cell) {
         cell.set_offset(effective_offset().translated(content_width, 0));
 
-        // Layout the cell contents a second time, now that we know its final width.
-        if (use_auto_layout) {
-            cell.layout_inside(LayoutMode::OnlyRequiredLineBreaks);
-        } else {
-            cell.layout_inside(LayoutMode::Default);
-        }
-
         size_t cell_colspan = cell.colspan();
         for (size_t i = 0; i < cell_colspan; ++i)
             content_width += column_widths[column_index++];
@@ -37,6 +37,10 @@ public:
     LayoutTableRow(DOM::Document&, DOM::Element&, NonnullRefPtr<CSS::StyleProperties>);
     virtual ~LayoutTableRow() override;
 
+    // How the cells in this row are laid out, both before and after the column widths are known.
+    LayoutMode layout_mode_for_cells() const;
+
+    // These expect the cells to have been laid out already.
     void layout_row(const Vector<float>& column_widths);
     void calculate_column_widths(Vector<float>& column_widths);
 
@@ -28,6 +28,7 @@
 #include <LibWeb/Layout/LayoutTableCell.h>
 #include <LibWeb/Layout/LayoutTableRow.h>
 #include <LibWeb/Layout/LayoutTableRowGroup.h>
+#include <LibWeb/Layout/ParallelLayout.h>
 
 namespace Web {
 
@@ -61,10 +62,28 @@ void LayoutTableRowGroup::layout(LayoutMode)
     Vector<float> column_widths;
     column_widths.resize(column_count);
 
+    // The cells only depend on their own contents and the width of their row, so they can all be laid out at once.
+    Vector<LayoutBox*> cells;
+    for_each_child_of_type<LayoutTableRow>([&](auto& row) {
+        row.template for_each_child_of_type<LayoutTableCell>([&](auto& cell) {
+            cells.append(&cell);
+        });
+    });
+    layout_independent_boxes(cells, [](LayoutBox& cell) {
+        auto& row = downcast<LayoutTableRow>(*cell.parent());
+        downcast<LayoutTableCell>(cell).layout(row.layout_mode_for_cells());
+    });
+
     for_each_child_of_type<LayoutTableRow>([&](auto& row) {
         row.calculate_column_widths(column_widths);
     });
 
+    // Lay the cell contents out a second time, now that we know their final widths.
+    layout_independent_boxes(cells, [](LayoutBox& cell) {
+        auto& row = downcast<LayoutTableRow>(*cell.parent());
+        downcast<LayoutTableCell>(cell).layout_inside(row.layout_mode_for_cells());
+    });
+
     float content_height = 0;
 
     for_each_child_of_type<LayoutTableRow>([&](auto& row) {
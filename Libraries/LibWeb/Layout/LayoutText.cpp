@@ -67,22 +67,22 @@ const String& LayoutText::text_for_style(const CSS::StyleProperties& style) cons
 
 void LayoutText::paint_fragment(PaintContext& context, const LineBoxFragment& fragment) const
 {
-    auto& painter = context.painter();
-    painter.set_font(specified_style().font());
+    auto& display_list = context.display_list();
+    display_list.set_font(specified_style().font());
 
     auto background_color = specified_style().property(CSS::PropertyID::BackgroundColor);
     if (background_color.has_value() && background_color.value()->is_color())
-        painter.fill_rect(enclosing_int_rect(fragment.absolute_rect()), background_color.value()->to_color(document()));
+        display_list.fill_rect(enclosing_int_rect(fragment.absolute_rect()), background_color.value()->to_color(document()));
 
     auto color = specified_style().color_or_fallback(CSS::PropertyID::Color, document(), context.palette().base_text());
     auto text_decoration = specified_style().string_or_fallback(CSS::PropertyID::TextDecoration, "none");
 
     if (document().inspected_node() == &node())
-        context.painter().draw_rect(enclosing_int_rect(fragment.absolute_rect()), Color::Magenta);
+        display_list.draw_rect(enclosing_int_rect(fragment.absolute_rect()), Color::Magenta);
 
     bool is_underline = text_decoration == "underline";
     if (is_underline)
-        painter.draw_line(enclosing_int_rect(fragment.absolute_rect()).bottom_left().translated(0, 1), enclosing_int_rect(fragment.absolute_rect()).bottom_right().translated(0, 1), color);
+        display_list.draw_line(enclosing_int_rect(fragment.absolute_rect()).bottom_left().translated(0, 1), enclosing_int_rect(fragment.absolute_rect()).bottom_right().translated(0, 1), color);
 
     // FIXME: text-transform should be done already in layout, since uppercase glyphs may be wider than lowercase, etc.
     auto text = m_text_for_rendering;
@@ -92,14 +92,14 @@ void LayoutText::paint_fragment(PaintContext& context, const LineBoxFragment& fr
     if (text_transform == "lowercase")
         text = m_text_for_rendering.to_lowercase();
 
-    painter.draw_text(enclosing_int_rect(fragment.absolute_rect()), text.substring_view(fragment.start(), fragment.length()), Gfx::TextAlignment::TopLeft, color);
+    display_list.draw_text(enclosing_int_rect(fragment.absolute_rect()), text.substring_view(fragment.start(), fragment.length()), Gfx::TextAlignment::TopLeft, color);
 
     auto selection_rect = fragment.selection_rect(specified_style().font());
     if (!selection_rect.is_empty()) {
-        painter.fill_rect(enclosing_int_rect(selection_rect), context.palette().selection());
-        Gfx::PainterStateSaver saver(painter);
-        painter.add_clip_rect(enclosing_int_rect(selection_rect));
-        painter.draw_text(enclosing_int_rect(fragment.absolute_rect()), text.substring_view(fragment.start(), fragment.length()), Gfx::TextAlignment::TopLeft, context.palette().selection_text());
+        display_list.fill_rect(enclosing_int_rect(selection_rect), context.palette().selection());
+        DisplayListStateSaver saver(display_list);
+        display_list.add_clip_rect(enclosing_int_rect(selection_rect));
+        display_list.draw_text(enclosing_int_rect(fragment.absolute_rect()), text.substring_view(fragment.start(), fragment.length()), Gfx::TextAlignment::TopLeft, context.palette().selection_text());
     }
 }
 
@@ -156,64 +156,91 @@ void LayoutText::for_each_chunk(Callback callback, LayoutMode layout_mode, bool
         commit_chunk(view.end(), false, true);
 }
 
-void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode layout_mode, bool do_collapse, bool do_wrap_lines, bool do_wrap_breaks)
+void LayoutText::update_text_for_rendering(bool do_collapse, bool skip_leading_whitespace)
 {
-    auto& font = specified_style().font();
-    float space_width = font.glyph_width(' ') + font.glyph_spacing();
+    if (!do_collapse)
+        skip_leading_whitespace = false;
 
-    auto& line_boxes = container.line_boxes();
-    if (line_boxes.is_empty())
-        line_boxes.append(LineBox());
-    float available_width = container.width() - line_boxes.last().width();
+    if (m_text_for_rendering_source.impl() == node().data().impl()
+        && m_text_for_rendering_is_collapsed == do_collapse
+        && m_text_for_rendering_skipped_leading_whitespace == skip_leading_whitespace
+        && !m_text_for_rendering_source.is_null())
+        return;
+
+    m_text_for_rendering_source = node().data();
+    m_text_for_rendering_is_collapsed = do_collapse;
+    m_text_for_rendering_skipped_leading_whitespace = skip_leading_whitespace;
+
+    if (!do_collapse) {
+        m_text_for_rendering = node().data();
+        return;
+    }
 
     // Collapse whitespace into single spaces
-    if (do_collapse) {
-        auto utf8_view = Utf8View(node().data());
-        StringBuilder builder(node().data().length());
-        auto it = utf8_view.begin();
-        auto skip_over_whitespace = [&] {
-            auto prev = it;
-            while (it != utf8_view.end() && isspace(*it)) {
-                prev = it;
-                ++it;
-            }
-            it = prev;
-        };
-        if (line_boxes.last().ends_in_whitespace())
+    auto utf8_view = Utf8View(node().data());
+    StringBuilder builder(node().data().length());
+    auto it = utf8_view.begin();
+    auto skip_over_whitespace = [&] {
+        auto prev = it;
+        while (it != utf8_view.end() && isspace(*it)) {
+            prev = it;
+            ++it;
+        }
+        it = prev;
+    };
+    if (skip_leading_whitespace)
+        skip_over_whitespace();
+    for (; it != utf8_view.end(); ++it) {
+        if (!isspace(*it)) {
+            builder.append(utf8_view.as_string().characters_without_null_termination() + utf8_view.byte_offset_of(it), it.codepoint_length_in_bytes());
+        } else {
+            builder.append(' ');
             skip_over_whitespace();
-        for (; it != utf8_view.end(); ++it) {
-            if (!isspace(*it)) {
-                builder.append(utf8_view.as_string().characters_without_null_termination() + utf8_view.byte_offset_of(it), it.codepoint_length_in_bytes());
-            } else {
-                builder.append(' ');
-                skip_over_whitespace();
-            }
         }
-        m_text_for_rendering = builder.to_string();
-    } else {
-        m_text_for_rendering = node().data();
     }
+    m_text_for_rendering = builder.to_string();
+}
+
+const Vector<LayoutText::MeasuredChunk>& LayoutText::measured_chunks(const Gfx::Font& font, LayoutMode layout_mode, bool do_wrap_lines, bool do_wrap_breaks)
+{
+    auto& cache = m_chunk_caches[(int)layout_mode];
+    if (cache.font == &font
+        && cache.text.impl() == m_text_for_rendering.impl()
+        && cache.do_wrap_lines == do_wrap_lines
+        && cache.do_wrap_breaks == do_wrap_breaks)
+        return cache.chunks;
+
+    cache.text = m_text_for_rendering;
+    cache.font = font;
+    cache.do_wrap_lines = do_wrap_lines;
+    cache.do_wrap_breaks = do_wrap_breaks;
+    cache.chunks.clear();
 
     // do_wrap_lines  => chunks_are_words
     // !do_wrap_lines => chunks_are_lines
-    struct Chunk {
-        Utf8View view;
-        int start { 0 };
-        int length { 0 };
-        bool is_break { false };
-        bool is_all_whitespace { false };
-    };
-    Vector<Chunk> chunks;
-
     for_each_chunk(
         [&](const Utf8View& view, int start, int length, bool is_break, bool is_all_whitespace) {
-            chunks.append({ Utf8View(view), start, length, is_break, is_all_whitespace });
+            bool starts_with_whitespace = length > 0 && isspace(*view.begin());
+            cache.chunks.append({ start, length, (float)font.width(view), is_break, is_all_whitespace, starts_with_whitespace });
         },
         layout_mode, do_wrap_lines, do_wrap_breaks);
 
-    for (size_t i = 0; i < chunks.size(); ++i) {
-        auto& chunk = chunks[i];
+    return cache.chunks;
+}
+
+void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode layout_mode, bool do_collapse, bool do_wrap_lines, bool do_wrap_breaks)
+{
+    auto& font = specified_style().font();
+    float space_width = font.glyph_width(' ') + font.glyph_spacing();
+
+    auto& line_boxes = container.line_boxes();
+    if (line_boxes.is_empty())
+        line_boxes.append(LineBox());
+    float available_width = container.width() - line_boxes.last().width();
+
+    update_text_for_rendering(do_collapse, line_boxes.last().ends_in_whitespace());
 
+    for (auto& chunk : measured_chunks(font, layout_mode, do_wrap_lines, do_wrap_breaks)) {
         // Collapse entire fragment into non-existence if previous fragment on line ended in whitespace.
         if (do_collapse && line_boxes.last().ends_in_whitespace() && chunk.is_all_whitespace)
             continue;
@@ -221,12 +248,12 @@ void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode la
         float chunk_width;
         bool need_collapse = false;
         if (do_wrap_lines) {
-            need_collapse = do_collapse && isspace(*chunk.view.begin()) && line_boxes.last().ends_in_whitespace();
+            need_collapse = do_collapse && chunk.starts_with_whitespace && line_boxes.last().ends_in_whitespace();
 
             if (need_collapse)
                 chunk_width = space_width;
             else
-                chunk_width = font.width(chunk.view) + font.glyph_spacing();
+                chunk_width = chunk.width + font.glyph_spacing();
 
             if (line_boxes.last().width() > 0 && chunk_width > available_width) {
                 line_boxes.append(LineBox());
@@ -235,7 +262,7 @@ void LayoutText::split_into_lines_by_rules(LayoutBlock& container, LayoutMode la
             if (need_collapse & line_boxes.last().fragments().is_empty())
                 continue;
         } else {
-            chunk_width = font.width(chunk.view);
+            chunk_width = chunk.width;
         }
 
         line_boxes.last().add_fragment(*this, chunk.start, need_collapse ? 1 : chunk.length, chunk_width, font.glyph_height());
@@ -53,12 +53,39 @@ public:
     const CSS::StyleProperties& specified_style() const { return parent()->specified_style(); }
 
 private:
+    struct MeasuredChunk {
+        int start { 0 };
+        int length { 0 };
+        float width { 0 };
+        bool is_break { false };
+        bool is_all_whitespace { false };
+        bool starts_with_whitespace { false };
+    };
+
     void split_into_lines_by_rules(LayoutBlock& container, LayoutMode, bool do_collapse, bool do_wrap_lines, bool do_wrap_breaks);
+    void update_text_for_rendering(bool do_collapse, bool skip_leading_whitespace);
+    const Vector<MeasuredChunk>& measured_chunks(const Gfx::Font&, LayoutMode, bool do_wrap_lines, bool do_wrap_breaks);
 
     template<typename Callback>
     void for_each_chunk(Callback, LayoutMode, bool do_wrap_lines, bool do_wrap_breaks) const;
 
     String m_text_for_rendering;
+
+    // What m_text_for_rendering was made from, so it's only rebuilt when the text changes.
+    String m_text_for_rendering_source;
+    bool m_text_for_rendering_is_collapsed { false };
+    bool m_text_for_rendering_skipped_leading_whitespace { false };
+
+    // The text split into chunks and measured, for each layout mode. These only depend on the text, the font and the
+    // wrapping rules, so relayouts that just change the available width can go straight to breaking lines.
+    struct ChunkCache {
+        String text;
+        RefPtr<const Gfx::Font> font;
+        bool do_wrap_lines { false };
+        bool do_wrap_breaks { false };
+        Vector<MeasuredChunk> chunks;
+    };
+    ChunkCache m_chunk_caches[3];
 };
 
 }
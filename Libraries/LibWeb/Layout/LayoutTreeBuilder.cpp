@@ -24,7 +24,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/DOM/Document.h>
+#include <LibWeb/DOM/Element.h>
 #include <LibWeb/DOM/ParentNode.h>
 #include <LibWeb/Layout/LayoutNode.h>
 #include <LibWeb/Layout/LayoutTable.h>
@@ -39,6 +41,9 @@ LayoutTreeBuilder::LayoutTreeBuilder()
 
 static RefPtr<LayoutNode> create_layout_tree(DOM::Node& node, const CSS::StyleProperties* parent_style)
 {
+    // Creating the layout node resolves style for the node, so it's up to date now.
+    node.set_needs_style_update(false);
+
     auto layout_node = node.create_layout_node(parent_style);
     if (!layout_node)
         return nullptr;
@@ -46,12 +51,17 @@ static RefPtr<LayoutNode> create_layout_tree(DOM::Node& node, const CSS::StylePr
     if (!node.has_children())
         return layout_node;
 
+    node.set_child_needs_style_update(false);
+
     NonnullRefPtrVector<LayoutNode> layout_children;
     bool have_inline_children = false;
     bool have_noninline_children = false;
 
     downcast<DOM::ParentNode>(node).for_each_child([&](DOM::Node& child) {
         auto layout_child = create_layout_tree(child, &layout_node->specified_style());
+        // Children without a layout node keep their flags, so we have to stay marked for the style update to find them.
+        if (child.child_needs_style_update())
+            node.set_child_needs_style_update(true);
         if (!layout_child)
             return;
         if (layout_child->is_inline())
@@ -83,7 +93,32 @@ RefPtr<LayoutNode> LayoutTreeBuilder::build(DOM::Node& node)
         dbg() << "FIXME: Support building partial layout trees.";
         return nullptr;
     }
-    return create_layout_tree(node, nullptr);
+    auto& style_resolver = node.document().style_resolver();
+    style_resolver.begin_tree_traversal();
+    auto layout_root = create_layout_tree(node, nullptr);
+    style_resolver.end_tree_traversal();
+    return layout_root;
+}
+
+void LayoutTreeBuilder::rebuild(DOM::Element& element)
+{
+    auto* old_layout_node = element.layout_node();
+    ASSERT(old_layout_node);
+    auto* layout_parent = old_layout_node->parent();
+    ASSERT(layout_parent);
+
+    auto& style_resolver = element.document().style_resolver();
+    style_resolver.begin_tree_traversal();
+    auto new_layout_node = create_layout_tree(element, &layout_parent->specified_style());
+    style_resolver.end_tree_traversal();
+
+    if (new_layout_node) {
+        layout_parent->insert_before(*new_layout_node, *old_layout_node);
+        new_layout_node->set_needs_layout();
+    } else {
+        layout_parent->set_needs_layout();
+    }
+    layout_parent->remove_child(*old_layout_node);
 }
 
 }
@@ -36,6 +36,9 @@ public:
     LayoutTreeBuilder();
 
     RefPtr<LayoutNode> build(DOM::Node&);
+
+    // Replaces the layout subtree of an element whose layout node is a block-level box in a block formatting context.
+    void rebuild(DOM::Element&);
 };
 
 }
@@ -44,6 +44,8 @@ public:
 
 private:
     virtual const char* class_name() const override { return "LayoutWidget"; }
+    // Moving the widget around has to happen on the GUI thread.
+    virtual bool prepare_for_parallel_layout() const override { return false; }
 
     virtual void did_set_rect() override;
 
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/OwnPtr.h>
+#include <AK/TemporaryChange.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibThread/WorkerPool.h>
+#include <LibWeb/Layout/LayoutBlock.h>
+#include <LibWeb/Layout/ParallelLayout.h>
+
+//#define PARALLEL_LAYOUT_DEBUG
+
+namespace Web {
+
+static size_t s_layout_thread_count = 1;
+static OwnPtr<LibThread::WorkerPool> s_worker_pool;
+static bool s_is_laying_out_in_parallel = false;
+
+void set_layout_thread_count(size_t thread_count)
+{
+    thread_count = max(thread_count, (size_t)1);
+    if (thread_count == s_layout_thread_count)
+        return;
+    s_layout_thread_count = thread_count;
+    s_worker_pool = nullptr;
+}
+
+size_t layout_thread_count()
+{
+    return s_layout_thread_count;
+}
+
+static bool prepare_subtree_for_parallel_layout(const LayoutNode& root)
+{
+    bool can_be_laid_out_in_parallel = true;
+    root.for_each_in_subtree([&](auto& node) {
+        if (node.prepare_for_parallel_layout())
+            return IterationDecision::Continue;
+        can_be_laid_out_in_parallel = false;
+        return IterationDecision::Break;
+    });
+    return can_be_laid_out_in_parallel;
+}
+
+#ifdef PARALLEL_LAYOUT_DEBUG
+// How many boxes have been checked against a sequential layout, and how many of them came out differently.
+static size_t s_checked_box_count = 0;
+static size_t s_mismatched_box_count = 0;
+
+// Everything layout decided about a subtree: where its boxes and line box fragments ended up.
+static Vector<Gfx::FloatRect> layout_snapshot(const LayoutBox& root)
+{
+    Vector<Gfx::FloatRect> rects;
+    root.for_each_in_subtree([&](auto& node) {
+        if (is<LayoutBox>(node))
+            rects.append({ downcast<LayoutBox>(node).effective_offset(), downcast<LayoutBox>(node).size() });
+        if (is<LayoutBlock>(node)) {
+            downcast<LayoutBlock>(node).for_each_fragment([&](auto& fragment) {
+                rects.append({ fragment.offset(), fragment.size() });
+                return IterationDecision::Continue;
+            });
+        }
+        return IterationDecision::Continue;
+    });
+    return rects;
+}
+#endif
+
+void layout_independent_boxes(const Vector<LayoutBox*>& boxes, Function<void(LayoutBox&)> layout_box)
+{
+    // Boxes laid out on the layout threads may contain more independent boxes. Those are laid out right where they are.
+    if (s_layout_thread_count <= 1 || s_is_laying_out_in_parallel || boxes.size() <= 1) {
+        for (auto* box : boxes)
+            layout_box(*box);
+        return;
+    }
+
+    Vector<LayoutBox*> parallel_boxes;
+    parallel_boxes.ensure_capacity(boxes.size());
+    for (auto* box : boxes) {
+        if (prepare_subtree_for_parallel_layout(*box))
+            parallel_boxes.append(box);
+        else
+            layout_box(*box);
+    }
+
+    if (!s_worker_pool)
+        s_worker_pool = make<LibThread::WorkerPool>(s_layout_thread_count, "Layout");
+
+#ifdef PARALLEL_LAYOUT_DEBUG
+    Core::ElapsedTimer timer;
+    timer.start();
+#endif
+
+    {
+        TemporaryChange change(s_is_laying_out_in_parallel, true);
+        s_worker_pool->run(parallel_boxes.size(), [&](size_t index) {
+            layout_box(*parallel_boxes[index]);
+        });
+    }
+
+#ifdef PARALLEL_LAYOUT_DEBUG
+    // Lay everything out again on this thread, and make sure it ends up exactly where it was.
+    auto parallel_ms = timer.elapsed();
+    Vector<Vector<Gfx::FloatRect>> parallel_snapshots;
+    for (auto* box : parallel_boxes)
+        parallel_snapshots.append(layout_snapshot(*box));
+
+    timer.start();
+    for (auto* box : parallel_boxes)
+        layout_box(*box);
+    auto sequential_ms = timer.elapsed();
+
+    for (size_t i = 0; i < parallel_boxes.size(); ++i) {
+        ++s_checked_box_count;
+        if (layout_snapshot(*parallel_boxes[i]) != parallel_snapshots[i]) {
+            ++s_mismatched_box_count;
+            dbg() << "ParallelLayout: " << parallel_boxes[i]->class_name() << " " << parallel_boxes[i] << " was laid out differently on the layout threads!";
+        }
+    }
+    dbg() << "ParallelLayout: " << parallel_boxes.size() << "/" << boxes.size() << " boxes took " << parallel_ms << "ms on " << s_layout_thread_count << " threads, " << sequential_ms << "ms on one";
+    dbg() << "ParallelLayout: " << s_mismatched_box_count << " of " << s_checked_box_count << " boxes checked so far were laid out differently";
+#endif
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibWeb/Loader/DecodedImageCache.h>
+#include <LibWeb/Loader/ImageResource.h>
+
+//#define DECODED_IMAGE_CACHE_DEBUG
+
+namespace Web {
+
+DecodedImageCache::DecodedImageCache(size_t capacity_in_bytes)
+    : m_capacity_in_bytes(capacity_in_bytes)
+{
+}
+
+void DecodedImageCache::did_decode(ImageResource& resource, size_t size_in_bytes, bool is_visible_in_viewport)
+{
+    did_discard(resource);
+    m_entries.set(&resource, { size_in_bytes, is_visible_in_viewport, ++m_visibility_counter });
+    m_size_in_bytes += size_in_bytes;
+    evict_until_size_is_at_most(m_capacity_in_bytes);
+}
+
+void DecodedImageCache::did_update_visibility(ImageResource& resource, bool is_visible_in_viewport)
+{
+    auto it = m_entries.find(&resource);
+    if (it == m_entries.end() || it->value.is_visible_in_viewport == is_visible_in_viewport)
+        return;
+    it->value.is_visible_in_viewport = is_visible_in_viewport;
+    it->value.last_visible = ++m_visibility_counter;
+    if (!is_visible_in_viewport)
+        evict_until_size_is_at_most(m_capacity_in_bytes);
+}
+
+void DecodedImageCache::did_discard(ImageResource& resource)
+{
+    auto it = m_entries.find(&resource);
+    if (it == m_entries.end())
+        return;
+    m_size_in_bytes -= it->value.size_in_bytes;
+    m_entries.remove(it);
+}
+
+void DecodedImageCache::evict_until_size_is_at_most(size_t size_in_bytes)
+{
+    while (m_size_in_bytes > size_in_bytes) {
+        ImageResource* least_recently_visible = nullptr;
+        u64 least_recent_visibility = 0;
+        for (auto& it : m_entries) {
+            if (it.value.is_visible_in_viewport)
+                continue;
+            if (!least_recently_visible || it.value.last_visible < least_recent_visibility) {
+                least_recently_visible = it.key;
+                least_recent_visibility = it.value.last_visible;
+            }
+        }
+        if (!least_recently_visible)
+            return;
+#ifdef DECODED_IMAGE_CACHE_DEBUG
+        dbg() << "DecodedImageCache: Discarding decoded image for " << least_recently_visible->url();
+#endif
+        did_discard(*least_recently_visible);
+        least_recently_visible->discard_decoded_image();
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <LibWeb/Forward.h>
+
+namespace Web {
+
+// Keeps track of the decoded pixels that images hold on to, and has the images that have been
+// out of view the longest drop theirs once they add up to more than the capacity.
+// Images in the viewport keep their pixels regardless, and are decoded again when they come back into view.
+class DecodedImageCache {
+public:
+    explicit DecodedImageCache(size_t capacity_in_bytes);
+
+    void did_decode(ImageResource&, size_t size_in_bytes, bool is_visible_in_viewport);
+    void did_update_visibility(ImageResource&, bool is_visible_in_viewport);
+    void did_discard(ImageResource&);
+
+    size_t entry_count() const { return m_entries.size(); }
+    size_t size_in_bytes() const { return m_size_in_bytes; }
+    size_t capacity_in_bytes() const { return m_capacity_in_bytes; }
+
+private:
+    struct Entry {
+        size_t size_in_bytes { 0 };
+        bool is_visible_in_viewport { false };
+        u64 last_visible { 0 };
+    };
+
+    void evict_until_size_is_at_most(size_t);
+
+    HashMap<ImageResource*, Entry> m_entries;
+    size_t m_size_in_bytes { 0 };
+    size_t m_capacity_in_bytes { 0 };
+    u64 m_visibility_counter { 0 };
+};
+
+}
@@ -25,6 +25,8 @@
  */
 
 #include <AK/LexicalPath.h>
+#include <AK/TemporaryChange.h>
+#include <LibCore/Timer.h>
 #include <LibGemini/Document.h>
 #include <LibGfx/ImageDecoder.h>
 #include <LibMarkdown/Document.h>
@@ -37,6 +39,8 @@
 #include <LibWeb/Page/Frame.h>
 #include <LibWeb/Page/Page.h>
 
+//#define FRAMELOADER_DEBUG
+
 namespace Web {
 
 FrameLoader::FrameLoader(Frame& frame)
@@ -48,6 +52,9 @@ FrameLoader::~FrameLoader()
 {
 }
 
+// How long we let a streaming document build up before showing it for the first time.
+static constexpr int first_paint_delay_ms = 250;
+
 static RefPtr<DOM::Document> create_markdown_document(const ByteBuffer& data, const URL& url)
 {
     auto markdown_document = Markdown::Document::parse(data);
@@ -141,6 +148,9 @@ bool FrameLoader::load(const URL& url, Type type)
 {
     dbg() << "FrameLoader::load: " << url;
 
+    discard_streaming_parser();
+    m_load_timer.start();
+
     if (!url.is_valid()) {
         load_error_page(url, "Invalid URL");
         return false;
@@ -202,9 +212,16 @@ void FrameLoader::load_error_page(const URL& failed_url, const String& error)
 
 void FrameLoader::resource_did_load()
 {
+    // The streaming parser may be waiting for a script, in which case we finish up once it's done.
+    if (m_is_feeding_streaming_parser) {
+        m_resource_did_load_while_feeding_streaming_parser = true;
+        return;
+    }
+
     auto url = resource()->url();
 
     if (!resource()->has_encoded_data()) {
+        discard_streaming_parser();
         load_error_page(url, "No data");
         return;
     }
@@ -212,18 +229,37 @@ void FrameLoader::resource_did_load()
     // FIXME: Also check HTTP status code before redirecting
     auto location = resource()->response_headers().get("Location");
     if (location.has_value()) {
+        discard_streaming_parser();
         load(url.complete_url(location.value()), FrameLoader::Type::Navigation);
         return;
     }
 
     dbg() << "I believe this content has MIME type '" << resource()->mime_type() << "', encoding '" << resource()->encoding() << "'";
-    auto document = create_document_from_mime_type(resource()->encoded_data(), url, resource()->mime_type(), resource()->encoding());
+
+    RefPtr<DOM::Document> document;
+    if (m_streaming_parser && resource()->mime_type() == "text/html" && resource()->encoding().equals_ignoring_case("utf-8")) {
+        feed_streaming_parser(resource()->encoded_data(), true);
+        // Someone started a new load while we were parsing.
+        if (!m_streaming_parser)
+            return;
+        document = &m_streaming_parser->document();
+        discard_streaming_parser();
+    } else {
+        // We guessed wrong about the content while it was streaming in, so start over.
+        discard_streaming_parser();
+        document = create_document_from_mime_type(resource()->encoded_data(), url, resource()->mime_type(), resource()->encoding());
+    }
 
     if (!document) {
         load_error_page(url, "Failed to parse content.");
         return;
     }
 
+#ifdef FRAMELOADER_DEBUG
+    if (frame().document() != document.ptr())
+        dbg() << "FrameLoader: First layout of " << url << " after " << m_load_timer.elapsed() << "ms";
+#endif
+
     frame().set_document(document);
     frame().page().client().page_did_change_title(document->title());
 
@@ -233,7 +269,125 @@ void FrameLoader::resource_did_load()
 
 void FrameLoader::resource_did_fail()
 {
+    discard_streaming_parser();
     load_error_page(resource()->url(), resource()->error());
 }
 
+// The response headers only show up once the whole response is in, so we have to go by the content itself to decide
+// whether it's HTML that we can start parsing early. This follows the HTML patterns of https://mimesniff.spec.whatwg.org/#rules-for-identifying-an-unknown-mime-type
+// Returns an empty Optional if there isn't enough data to tell yet.
+static Optional<bool> content_looks_like_html(const ByteBuffer& data)
+{
+    size_t offset = 0;
+    if (data.size() >= 3 && data[0] == 0xef && data[1] == 0xbb && data[2] == 0xbf)
+        offset = 3;
+    while (offset < data.size() && (data[offset] == ' ' || data[offset] == '\t' || data[offset] == '\n' || data[offset] == '\f' || data[offset] == '\r'))
+        ++offset;
+
+    static const char* patterns[] = {
+        "<!DOCTYPE HTML", "<HTML", "<HEAD", "<SCRIPT", "<IFRAME", "<H1", "<DIV", "<FONT",
+        "<TABLE", "<A", "<STYLE", "<TITLE", "<B", "<BODY", "<BR", "<P", "<!--"
+    };
+
+    StringView content { (const char*)data.data() + offset, data.size() - offset };
+    if (content.length() <= StringView(patterns[0]).length())
+        return {};
+
+    for (auto* pattern_characters : patterns) {
+        StringView pattern { pattern_characters };
+        if (!content.substring_view(0, pattern.length()).equals_ignoring_case(pattern))
+            continue;
+        char terminator = content[pattern.length()];
+        if (terminator == ' ' || terminator == '>')
+            return true;
+    }
+    return false;
+}
+
+void FrameLoader::resource_did_receive_data(const ByteBuffer& received_data, u32)
+{
+    // We always get everything received so far, so whatever comes in while the parser is busy gets picked up next time.
+    if (m_is_feeding_streaming_parser || m_content_is_not_streamable)
+        return;
+
+    if (!m_streaming_parser) {
+        auto is_html = content_looks_like_html(received_data);
+        if (!is_html.has_value())
+            return;
+        if (!is_html.value()) {
+            m_content_is_not_streamable = true;
+            return;
+        }
+
+        // FIXME: Look for a <meta charset> in the first chunk instead of assuming UTF-8.
+        m_streaming_parser = make<HTML::HTMLDocumentParser>("utf-8");
+        m_streaming_parser->begin(resource()->url());
+        m_first_paint_timer = Core::Timer::create_single_shot(first_paint_delay_ms, [this] {
+            show_partially_loaded_document();
+        });
+    }
+
+    feed_streaming_parser(received_data, false);
+}
+
+void FrameLoader::feed_streaming_parser(const ByteBuffer& received_data, bool is_complete)
+{
+    ASSERT(m_streaming_parser);
+    ASSERT(!m_is_feeding_streaming_parser);
+
+    // Scripts may spin a nested event loop while the parser runs. If more data, the end of the load or a whole new
+    // load comes in meanwhile, we deal with it once the parser returns.
+    {
+        TemporaryChange feeding_change(m_is_feeding_streaming_parser, true);
+        if (received_data.size() > m_streamed_byte_count) {
+            StringView new_data { (const char*)received_data.data() + m_streamed_byte_count, received_data.size() - m_streamed_byte_count };
+            m_streamed_byte_count = received_data.size();
+            m_streaming_parser->append_input(new_data);
+        }
+        if (is_complete && !m_streaming_parser_was_abandoned)
+            m_streaming_parser->finish();
+    }
+
+    if (m_streaming_parser_was_abandoned) {
+        m_streaming_parser_was_abandoned = false;
+        m_streaming_parser = nullptr;
+    }
+
+    if (m_resource_did_load_while_feeding_streaming_parser) {
+        m_resource_did_load_while_feeding_streaming_parser = false;
+        resource_did_load();
+    }
+}
+
+void FrameLoader::discard_streaming_parser()
+{
+    if (m_first_paint_timer) {
+        m_first_paint_timer->stop();
+        m_first_paint_timer = nullptr;
+    }
+    m_streamed_byte_count = 0;
+    m_content_is_not_streamable = false;
+    m_resource_did_load_while_feeding_streaming_parser = false;
+
+    // If the parser is busy, it goes away as soon as it returns.
+    if (m_is_feeding_streaming_parser) {
+        m_streaming_parser_was_abandoned = true;
+        return;
+    }
+    m_streaming_parser = nullptr;
+}
+
+void FrameLoader::show_partially_loaded_document()
+{
+    if (!m_streaming_parser || m_streaming_parser_was_abandoned)
+        return;
+
+    auto& document = m_streaming_parser->document();
+#ifdef FRAMELOADER_DEBUG
+    dbg() << "FrameLoader: First layout of " << document.url() << " after " << m_load_timer.elapsed() << "ms, while still loading";
+#endif
+    frame().set_document(&document);
+    frame().page().client().page_did_change_title(document.title());
+}
+
 }
@@ -27,6 +27,9 @@
 #pragma once
 
 #include <AK/Forward.h>
+#include <AK/OwnPtr.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/Forward.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/Loader/Resource.h>
 
@@ -53,11 +56,27 @@ private:
     // ^ResourceClient
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
+    virtual void resource_did_receive_data(const ByteBuffer&, u32 total_size) override;
 
     void load_error_page(const URL& failed_url, const String& error_message);
     RefPtr<DOM::Document> create_document_from_mime_type(const ByteBuffer&, const URL&, const String& mime_type, const String& encoding);
 
+    void feed_streaming_parser(const ByteBuffer& received_data, bool is_complete);
+    void discard_streaming_parser();
+    void show_partially_loaded_document();
+
     Frame& m_frame;
+
+    Core::ElapsedTimer m_load_timer;
+
+    // HTML is parsed while it's still arriving, and shown once it's had a moment to get going.
+    OwnPtr<HTML::HTMLDocumentParser> m_streaming_parser;
+    RefPtr<Core::Timer> m_first_paint_timer;
+    size_t m_streamed_byte_count { 0 };
+    bool m_content_is_not_streamable { false };
+    bool m_is_feeding_streaming_parser { false };
+    bool m_streaming_parser_was_abandoned { false };
+    bool m_resource_did_load_while_feeding_streaming_parser { false };
 };
 
 }
@@ -57,6 +57,24 @@ void ImageLoader::set_visible_in_viewport(bool visible_in_viewport) const
         const_cast<ImageResource*>(resource())->update_volatility();
 }
 
+void ImageLoader::set_displayed_size(const Gfx::IntSize& displayed_size) const
+{
+    if (m_displayed_size == displayed_size)
+        return;
+    m_displayed_size = displayed_size;
+
+    // The image may have to be decoded at a different size now, or not be needed at all anymore.
+    if (resource())
+        const_cast<ImageResource*>(resource())->update_volatility();
+}
+
+bool ImageLoader::is_visible_in_viewport() const
+{
+    // Images that aren't laid out (like the ones that are only drawn onto a canvas) may be
+    // painted at any time, so their pixels have to stay around.
+    return m_visible_in_viewport || m_displayed_size.is_empty();
+}
+
 void ImageLoader::resource_did_load()
 {
     ASSERT(resource());
@@ -76,20 +94,54 @@ void ImageLoader::resource_did_load()
 #endif
 
     if (resource()->should_decode_in_process()) {
-        auto& decoder = resource()->ensure_decoder();
-
-        if (decoder.is_animated() && decoder.frame_count() > 1) {
-            const auto& first_frame = decoder.frame(0);
-            m_timer->set_interval(first_frame.duration);
-            m_timer->on_timeout = [this] { animate(); };
-            m_timer->start();
-        }
+        start_animation_if_needed();
+    } else if (!resource()->has_finished_decoding()) {
+        // We'll hear from resource_did_update_image() once the decoder is done.
+        m_is_waiting_for_decode = true;
+        return;
     }
 
+    m_size = { (int)width(), (int)height() };
     if (on_load)
         on_load();
 }
 
+void ImageLoader::resource_did_update_image()
+{
+    ASSERT(resource());
+
+    if (resource()->should_decode_in_process())
+        start_animation_if_needed();
+
+    if (m_is_waiting_for_decode && resource()->has_finished_decoding()) {
+        m_is_waiting_for_decode = false;
+        m_size = { (int)width(), (int)height() };
+        if (on_load)
+            on_load();
+        return;
+    }
+
+    Gfx::IntSize size { (int)width(), (int)height() };
+    bool size_did_change = size != m_size;
+    m_size = size;
+    if (on_decode_progress)
+        on_decode_progress(size_did_change);
+}
+
+void ImageLoader::start_animation_if_needed()
+{
+    if (m_timer->is_active())
+        return;
+
+    auto& decoder = resource()->ensure_decoder();
+    if (decoder.is_animated() && decoder.frame_count() > 1) {
+        const auto& first_frame = decoder.frame(0);
+        m_timer->set_interval(first_frame.duration);
+        m_timer->on_timeout = [this] { animate(); };
+        m_timer->start();
+    }
+}
+
 void ImageLoader::animate()
 {
     if (!m_visible_in_viewport)
@@ -104,7 +156,8 @@ void ImageLoader::animate()
         m_timer->restart(current_frame.duration);
     }
 
-    if (m_current_frame_index == decoder.frame_count() - 1) {
+    // Frames may still be arriving, so loops only count once we have all of them.
+    if (decoder.is_complete() && m_current_frame_index == decoder.frame_count() - 1) {
         ++m_loops_completed;
         if (m_loops_completed > 0 && m_loops_completed == decoder.loop_count()) {
             m_timer->stop();
@@ -137,7 +190,7 @@ unsigned ImageLoader::width() const
         return 0;
     if (resource()->should_decode_in_process())
         return const_cast<ImageResource*>(resource())->ensure_decoder().width();
-    return bitmap() ? bitmap()->width() : 0;
+    return resource()->image_size().width();
 }
 
 unsigned ImageLoader::height() const
@@ -146,7 +199,7 @@ unsigned ImageLoader::height() const
         return 0;
     if (resource()->should_decode_in_process())
         return const_cast<ImageResource*>(resource())->ensure_decoder().height();
-    return bitmap() ? bitmap()->height() : 0;
+    return resource()->image_size().height();
 }
 
 const Gfx::Bitmap* ImageLoader::bitmap() const
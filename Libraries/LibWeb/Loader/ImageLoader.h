@@ -28,6 +28,7 @@
 
 #include <AK/Function.h>
 #include <LibCore/Timer.h>
+#include <LibGfx/Size.h>
 #include <LibWeb/Loader/ImageResource.h>
 
 namespace Web {
@@ -43,6 +44,7 @@ public:
     bool has_image() const;
 
     void set_visible_in_viewport(bool) const;
+    void set_displayed_size(const Gfx::IntSize&) const;
 
     unsigned width() const;
     unsigned height() const;
@@ -51,15 +53,24 @@ public:
     Function<void()> on_fail;
     Function<void()> on_animate;
 
+    // Called when more of the image has been decoded before it's done loading.
+    Function<void(bool size_did_change)> on_decode_progress;
+
 private:
     // ^ImageResourceClient
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
-    virtual bool is_visible_in_viewport() const override { return m_visible_in_viewport; }
+    virtual void resource_did_update_image() override;
+    virtual bool is_visible_in_viewport() const override;
+    virtual Gfx::IntSize displayed_size() const override { return m_displayed_size; }
 
+    void start_animation_if_needed();
     void animate();
 
     mutable bool m_visible_in_viewport { false };
+    mutable Gfx::IntSize m_displayed_size;
+    bool m_is_waiting_for_decode { false };
+    Gfx::IntSize m_size;
 
     size_t m_current_frame_index { 0 };
     size_t m_loops_completed { 0 };
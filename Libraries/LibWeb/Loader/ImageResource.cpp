@@ -29,9 +29,18 @@
 #include <LibGfx/ImageDecoder.h>
 #include <LibImageDecoderClient/Client.h>
 #include <LibWeb/Loader/ImageResource.h>
+#include <LibWeb/Loader/ResourceLoader.h>
 
 namespace Web {
 
+static ImageDecoderClient::Client& image_decoder_client()
+{
+    static RefPtr<ImageDecoderClient::Client> s_client;
+    if (!s_client)
+        s_client = ImageDecoderClient::Client::construct();
+    return *s_client;
+}
+
 ImageResource::ImageResource(const LoadRequest& request)
     : Resource(Type::Image, request)
 {
@@ -39,50 +48,267 @@ ImageResource::ImageResource(const LoadRequest& request)
 
 ImageResource::~ImageResource()
 {
+    if (m_decode_id >= 0)
+        image_decoder_client().stop_streaming_decode(m_decode_id);
+    if (m_decoded_image)
+        ResourceLoader::the().decoded_image_cache().did_discard(*this);
 }
 
-bool ImageResource::should_decode_in_process() const
+void ImageResource::choose_decoder(const ByteBuffer& data)
 {
-    return mime_type() == "image/gif";
+    // GIFs are decoded in process, since we need to get at their individual frames.
+    m_should_decode_in_process = (data.size() >= 4 && !memcmp(data.data(), "GIF8", 4)) || mime_type() == "image/gif";
+    m_has_chosen_decoder = true;
 }
 
-Gfx::ImageDecoder& ImageResource::ensure_decoder()
+void ImageResource::did_receive_partial_data(const ByteBuffer& received_data, u32 total_size)
 {
+    m_partial_data = received_data;
+    if (!m_has_chosen_decoder) {
+        if (received_data.size() < 4)
+            return;
+        choose_decoder(received_data);
+    }
+
+    if (!m_should_decode_in_process) {
+        stream_to_decoder(received_data, total_size);
+        return;
+    }
+
     if (!m_decoder)
-        m_decoder = Gfx::ImageDecoder::create(encoded_data());
-    return *m_decoder;
+        m_decoder = Gfx::ImageDecoder::create_incremental(received_data.data(), received_data.size());
+    else
+        m_decoder->did_receive_data(received_data.data(), received_data.size(), false);
+    decode_available_data_in_process();
 }
 
-const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
+void ImageResource::did_load_encoded_data()
 {
-    if (!has_encoded_data())
-        return nullptr;
+    // The partial data went away with the download, and encoded_data() has all of it now.
+    m_partial_data.clear();
+    if (!m_has_chosen_decoder)
+        choose_decoder(encoded_data());
 
-    if (should_decode_in_process()) {
-        if (!m_decoder)
-            return nullptr;
-        if (m_decoder->is_animated())
-            return m_decoder->frame(frame_index).image;
-        return m_decoder->bitmap();
+    if (!m_should_decode_in_process) {
+        stream_to_decoder(encoded_data(), encoded_data().size());
+        return;
     }
-    if (!m_decoded_image && !m_has_attempted_decode) {
-        auto image_decoder_client = ImageDecoderClient::Client::construct();
-        m_decoded_image = image_decoder_client->decode_image(encoded_data());
-        m_has_attempted_decode = true;
+
+    if (m_decoder)
+        m_decoder->did_receive_data(encoded_data().data(), encoded_data().size(), true);
+}
+
+void ImageResource::decode_available_data_in_process()
+{
+    auto result = m_decoder->decode_available_data();
+    auto frame_count = m_decoder->frame_count();
+    if (result.changed_rect.is_empty() && frame_count == m_available_frame_count)
+        return;
+    m_available_frame_count = frame_count;
+    notify_clients_of_image_update();
+}
+
+void ImageResource::stream_to_decoder(const ByteBuffer& data, size_t total_size)
+{
+    if (m_has_finished_decoding)
+        return;
+
+    auto& client = image_decoder_client();
+    if (m_decode_id >= 0 && total_size != m_encoded_size) {
+        // The load turned out to have a different size than we were told up front, so start over.
+        client.stop_streaming_decode(m_decode_id);
+        m_decode_id = -1;
+    }
+
+    if (m_decode_id < 0) {
+        // The image is decoded at full size while it loads, since we don't know how large it will be shown yet.
+        m_decode_id = client.start_streaming_decode(total_size, {}, [this](auto bitmap, auto&, bool is_complete) {
+            did_decode_data(move(bitmap), is_complete);
+        });
+        if (m_decode_id < 0) {
+            did_decode_data(nullptr, true);
+            return;
+        }
+        m_encoded_size = total_size;
+        m_streamed_size = 0;
     }
-    return m_decoded_image;
+
+    auto available_size = min(data.size(), total_size);
+    if (available_size <= m_streamed_size)
+        return;
+    client.append_streaming_data(m_decode_id, data.data() + m_streamed_size, available_size - m_streamed_size);
+    m_streamed_size = available_size;
 }
 
-void ImageResource::update_volatility()
+void ImageResource::did_decode_data(RefPtr<Gfx::Bitmap> bitmap, bool is_complete)
 {
-    if (!m_decoder)
+    // If decoding fails partway through, we keep showing what we got.
+    if (bitmap) {
+        m_decoded_image = move(bitmap);
+        m_image_size = m_decoded_image->size();
+    }
+    if (is_complete) {
+        m_has_finished_decoding = true;
+        m_decode_id = -1;
+        if (m_decoded_image)
+            keep_decoded_image(*m_decoded_image);
+    }
+    notify_clients_of_image_update();
+}
+
+void ImageResource::keep_decoded_image(NonnullRefPtr<Gfx::Bitmap> bitmap)
+{
+    // Move the pixels out of the buffer we share with the decoder and into purgeable memory,
+    // so the kernel can take them back while the image is out of view.
+    if (!bitmap->is_purgeable()) {
+        if (auto purgeable_bitmap = Gfx::Bitmap::create_purgeable(bitmap->format(), bitmap->size())) {
+            for (int y = 0; y < bitmap->height(); ++y)
+                memcpy(purgeable_bitmap->scanline(y), bitmap->scanline(y), bitmap->width() * sizeof(Gfx::RGBA32));
+            bitmap = purgeable_bitmap.release_nonnull();
+        }
+    }
+    m_decoded_image = move(bitmap);
+    bool visible_in_viewport = is_visible_in_viewport();
+    if (!visible_in_viewport)
+        m_decoded_image->set_volatile();
+    // This may well discard the image right away if it's out of view and we're short on memory.
+    ResourceLoader::the().decoded_image_cache().did_decode(*this, m_decoded_image->size_in_bytes(), visible_in_viewport);
+}
+
+void ImageResource::discard_decoded_image()
+{
+    if (m_should_decode_in_process || !m_decoded_image)
         return;
+    m_decoded_image = nullptr;
+    ResourceLoader::the().decoded_image_cache().did_discard(*this);
+}
 
+bool ImageResource::is_visible_in_viewport()
+{
     bool visible_in_viewport = false;
     for_each_client([&](auto& client) {
         if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
             visible_in_viewport = true;
     });
+    return visible_in_viewport;
+}
+
+Gfx::IntSize ImageResource::minimum_decoded_size()
+{
+    Gfx::IntSize minimum_size;
+    bool needs_full_size = false;
+    for_each_client([&](auto& client) {
+        auto displayed_size = static_cast<const ImageResourceClient&>(client).displayed_size();
+        if (displayed_size.is_empty()) {
+            needs_full_size = true;
+            return;
+        }
+        minimum_size.set_width(max(minimum_size.width(), displayed_size.width()));
+        minimum_size.set_height(max(minimum_size.height(), displayed_size.height()));
+    });
+    if (needs_full_size)
+        return m_image_size;
+    return { min(minimum_size.width(), m_image_size.width()), min(minimum_size.height(), m_image_size.height()) };
+}
+
+void ImageResource::redecode_if_needed()
+{
+    if (!is_loaded() || !m_has_finished_decoding || m_has_failed_to_redecode || m_image_size.is_empty())
+        return;
+
+    auto minimum_size = minimum_decoded_size();
+    if (m_decoded_image) {
+        auto decoded_size = m_decoded_image->size();
+        bool is_large_enough = decoded_size.width() >= minimum_size.width() && decoded_size.height() >= minimum_size.height();
+        // Decoders can only skip work in steps of halving the size, so it's not worth starting over for less.
+        bool is_twice_as_large = decoded_size.width() >= minimum_size.width() * 2 && decoded_size.height() >= minimum_size.height() * 2;
+        if (is_large_enough && !is_twice_as_large)
+            return;
+    }
+
+    auto& client = image_decoder_client();
+    if (m_decode_id >= 0) {
+        if (minimum_size == m_redecode_minimum_size)
+            return;
+        client.stop_streaming_decode(m_decode_id);
+        m_decode_id = -1;
+    }
+
+    // Asking for all of the image gets it without any scaling.
+    m_redecode_minimum_size = minimum_size;
+    m_decode_id = client.decode_image_async(encoded_data(), minimum_size == m_image_size ? Gfx::IntSize() : minimum_size, [this](auto bitmap) {
+        did_redecode(move(bitmap));
+    });
+    if (m_decode_id < 0)
+        m_has_failed_to_redecode = true;
+}
+
+void ImageResource::did_redecode(RefPtr<Gfx::Bitmap> bitmap)
+{
+    m_decode_id = -1;
+    if (!bitmap) {
+        // It decoded fine the first time around, so something is wrong with the decoder. Don't keep at it.
+        m_has_failed_to_redecode = true;
+        return;
+    }
+    keep_decoded_image(bitmap.release_nonnull());
+    notify_clients_of_image_update();
+}
+
+void ImageResource::notify_clients_of_image_update()
+{
+    for_each_client([](auto& client) {
+        static_cast<ImageResourceClient&>(client).resource_did_update_image();
+    });
+}
+
+Gfx::ImageDecoder& ImageResource::ensure_decoder()
+{
+    if (!m_decoder) {
+        if (is_loaded())
+            m_decoder = Gfx::ImageDecoder::create(encoded_data());
+        else
+            m_decoder = Gfx::ImageDecoder::create_incremental(m_partial_data.data(), m_partial_data.size());
+    }
+    return *m_decoder;
+}
+
+const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
+{
+    if (!m_should_decode_in_process)
+        return m_decoded_image;
+    if (!m_decoder)
+        return nullptr;
+    if (m_decoder->is_animated())
+        return m_decoder->frame(frame_index).image;
+    return m_decoder->bitmap();
+}
+
+void ImageResource::update_volatility()
+{
+    bool visible_in_viewport = is_visible_in_viewport();
+
+    if (!m_should_decode_in_process) {
+        auto& cache = ResourceLoader::the().decoded_image_cache();
+        if (!visible_in_viewport) {
+            if (m_decoded_image) {
+                m_decoded_image->set_volatile();
+                cache.did_update_visibility(*this, false);
+            }
+            return;
+        }
+        if (m_decoded_image) {
+            if (m_decoded_image->set_nonvolatile())
+                cache.did_update_visibility(*this, true);
+            else
+                discard_decoded_image();
+        }
+        redecode_if_needed();
+        return;
+    }
+
+    if (!m_decoder)
+        return;
 
     if (!visible_in_viewport) {
         m_decoder->set_volatile();
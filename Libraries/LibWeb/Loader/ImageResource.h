@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <LibGfx/Size.h>
 #include <LibWeb/Loader/Resource.h>
 
 namespace Web {
@@ -38,15 +39,61 @@ public:
     Gfx::ImageDecoder& ensure_decoder();
     const Gfx::Bitmap* bitmap(size_t frame_index = 0) const;
 
-    bool should_decode_in_process() const;
+    bool should_decode_in_process() const { return m_should_decode_in_process; }
 
+    // Images that aren't decoded in process are decoded by the ImageDecoder service
+    // while they load, and this tells whether it is done with them.
+    bool has_finished_decoding() const { return m_has_finished_decoding; }
+
+    // The size of the image itself. The decoded bitmap can be smaller than this when
+    // none of the clients show the image that large.
+    Gfx::IntSize image_size() const { return m_image_size; }
+
+    // Lets the decoded image be purged while no client shows it, and has it decoded again
+    // (at the size the clients show it at) when it's needed.
     void update_volatility();
 
+    // Called by the DecodedImageCache to free up memory. The image is decoded again
+    // once one of the clients shows it.
+    void discard_decoded_image();
+
 private:
     explicit ImageResource(const LoadRequest&);
+
+    // ^Resource
+    virtual void did_receive_partial_data(const ByteBuffer&, u32 total_size) override;
+    virtual void did_load_encoded_data() override;
+
+    void choose_decoder(const ByteBuffer&);
+    void decode_available_data_in_process();
+    void stream_to_decoder(const ByteBuffer&, size_t total_size);
+    void did_decode_data(RefPtr<Gfx::Bitmap>, bool is_complete);
+    void notify_clients_of_image_update();
+
+    bool is_visible_in_viewport();
+    Gfx::IntSize minimum_decoded_size();
+    void keep_decoded_image(NonnullRefPtr<Gfx::Bitmap>);
+    void redecode_if_needed();
+    void did_redecode(RefPtr<Gfx::Bitmap>);
+
     RefPtr<Gfx::ImageDecoder> m_decoder;
-    mutable RefPtr<Gfx::Bitmap> m_decoded_image;
-    mutable bool m_has_attempted_decode { false };
+    // What has arrived so far while the image is still loading.
+    ByteBuffer m_partial_data;
+    bool m_has_chosen_decoder { false };
+    bool m_should_decode_in_process { false };
+    size_t m_available_frame_count { 0 };
+
+    i32 m_decode_id { -1 };
+    size_t m_encoded_size { 0 };
+    size_t m_streamed_size { 0 };
+    RefPtr<Gfx::Bitmap> m_decoded_image;
+    Gfx::IntSize m_image_size;
+    bool m_has_finished_decoding { false };
+
+    // Once the image is loaded, it's decoded again whenever the clients need a different size,
+    // or the decoded image was discarded.
+    Gfx::IntSize m_redecode_minimum_size;
+    bool m_has_failed_to_redecode { false };
 };
 
 class ImageResourceClient : public ResourceClient {
@@ -55,6 +102,13 @@ public:
 
     virtual bool is_visible_in_viewport() const { return false; }
 
+    // How large the client shows the image, if it only ever draws it scaled to that size.
+    // The image is decoded no smaller than the largest of these, and at full size if any client doesn't say.
+    virtual Gfx::IntSize displayed_size() const { return {}; }
+
+    // Called whenever more of the image has been decoded, which may be before it's done loading.
+    virtual void resource_did_update_image() { }
+
 protected:
     ImageResource* resource() { return static_cast<ImageResource*>(ResourceClient::resource()); }
     const ImageResource* resource() const { return static_cast<const ImageResource*>(ResourceClient::resource()); }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/URL.h>
 #include <LibWeb/Forward.h>
 
@@ -42,6 +43,10 @@ public:
     const URL& url() const { return m_url; }
     void set_url(const URL& url) { m_url = url; }
 
+    const HashMap<String, String>& headers() const { return m_headers; }
+    void set_header(const String& name, const String& value) { m_headers.set(name, value); }
+
+    // Requests are identified by their URL alone, so the headers don't affect caching.
     unsigned hash() const { return m_url.to_string().hash(); }
 
     bool operator==(const LoadRequest& other) const
@@ -51,6 +56,7 @@ public:
 
 private:
     URL m_url;
+    HashMap<String, String> m_headers;
 };
 
 }
@@ -89,6 +89,8 @@ void Resource::did_load(Badge<ResourceLoader>, const ByteBuffer& data, const Has
     ASSERT(!m_loaded);
     m_encoded_data = data;
     m_response_headers = headers;
+    m_cache_policy = HTTP::CachePolicy::from_response_headers(headers);
+    m_response_time = time(nullptr);
     m_loaded = true;
 
     auto content_type = headers.get("Content-Type");
@@ -112,11 +114,31 @@ void Resource::did_load(Badge<ResourceLoader>, const ByteBuffer& data, const Has
         m_mime_type = Core::guess_mime_type_based_on_filename(url());
     }
 
+    did_load_encoded_data();
+
     for_each_client([](auto& client) {
         client.resource_did_load();
     });
 }
 
+bool Resource::is_fresh() const
+{
+    if (url().protocol() != "http" && url().protocol() != "https")
+        return true;
+    return m_cache_policy.is_fresh(m_response_time, time(nullptr));
+}
+
+void Resource::did_receive_data(Badge<ResourceLoader>, const ByteBuffer& received_data, u32 total_size)
+{
+    if (m_loaded || m_failed)
+        return;
+    did_receive_partial_data(received_data, total_size);
+
+    for_each_client([&](auto& client) {
+        client.resource_did_receive_data(received_data, total_size);
+    });
+}
+
 void Resource::did_fail(Badge<ResourceLoader>, const String& error)
 {
     m_error = error;
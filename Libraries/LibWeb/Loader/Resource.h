@@ -35,6 +35,7 @@
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
 #include <LibGfx/Forward.h>
+#include <LibHTTP/CachePolicy.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/Loader/LoadRequest.h>
 
@@ -64,11 +65,18 @@ public:
 
     bool has_encoded_data() const { return !m_encoded_data.is_null(); }
 
+    const LoadRequest& request() const { return m_request; }
     const URL& url() const { return m_request.url(); }
     const ByteBuffer& encoded_data() const { return m_encoded_data; }
 
     const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers() const { return m_response_headers; }
 
+    // Whether a loaded resource can be reused without asking the server again.
+    // Only HTTP responses go stale; anything else stays good for as long as it's cached.
+    bool is_fresh() const;
+    bool is_storable() const { return m_cache_policy.is_storable(); }
+    const HTTP::CachePolicy& cache_policy() const { return m_cache_policy; }
+
     void register_client(Badge<ResourceClient>, ResourceClient&);
     void unregister_client(Badge<ResourceClient>, ResourceClient&);
 
@@ -79,10 +87,17 @@ public:
 
     void did_load(Badge<ResourceLoader>, const ByteBuffer& data, const HashMap<String, String, CaseInsensitiveStringTraits>& headers);
     void did_fail(Badge<ResourceLoader>, const String& error);
+    void did_receive_data(Badge<ResourceLoader>, const ByteBuffer& received_data, u32 total_size);
 
 protected:
     explicit Resource(Type, const LoadRequest&);
 
+    // Called with everything received so far while the load is in progress. The data
+    // stays where it is until the load finishes and encoded_data() takes over.
+    virtual void did_receive_partial_data(const ByteBuffer&, u32 /* total_size */) { }
+    // Called once encoded_data() is complete, before clients are told about it.
+    virtual void did_load_encoded_data() { }
+
 private:
     LoadRequest m_request;
     ByteBuffer m_encoded_data;
@@ -93,6 +108,8 @@ private:
     String m_encoding;
     String m_mime_type;
     HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+    HTTP::CachePolicy m_cache_policy;
+    time_t m_response_time { 0 };
     HashTable<ResourceClient*> m_clients;
 };
 
@@ -102,6 +119,8 @@ public:
 
     virtual void resource_did_load() { }
     virtual void resource_did_fail() { }
+    // Called with everything received so far while the load is in progress, see Resource::did_receive_partial_data().
+    virtual void resource_did_receive_data(const ByteBuffer& /* received_data */, u32 /* total_size */) { }
 
 protected:
     virtual Resource::Type client_type() const { return Resource::Type::Generic; }
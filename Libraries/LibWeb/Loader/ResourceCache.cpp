@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibWeb/Loader/Resource.h>
+#include <LibWeb/Loader/ResourceCache.h>
+
+//#define CACHE_DEBUG
+
+namespace Web {
+
+ResourceCache::ResourceCache(size_t capacity_in_bytes)
+    : m_capacity_in_bytes(capacity_in_bytes)
+{
+}
+
+RefPtr<Resource> ResourceCache::get(const LoadRequest& request)
+{
+    auto it = m_entries.find(request);
+    if (it == m_entries.end())
+        return nullptr;
+    it->value.last_used = ++m_use_counter;
+    return it->value.resource;
+}
+
+void ResourceCache::set(const LoadRequest& request, NonnullRefPtr<Resource> resource)
+{
+    remove(request);
+    m_entries.set(request, { move(resource), 0, ++m_use_counter });
+}
+
+ResourceCache::Entry* ResourceCache::entry_for(const Resource& resource)
+{
+    auto it = m_entries.find(resource.request());
+    if (it == m_entries.end() || it->value.resource != &resource)
+        return nullptr;
+    return &it->value;
+}
+
+void ResourceCache::did_load(Resource& resource)
+{
+    auto* entry = entry_for(resource);
+    if (!entry)
+        return;
+
+    auto size_in_bytes = resource.encoded_data().size();
+    if (!resource.is_storable() || size_in_bytes > m_capacity_in_bytes) {
+        remove(resource.request());
+        return;
+    }
+
+    entry->size_in_bytes = size_in_bytes;
+    m_size_in_bytes += size_in_bytes;
+    evict_until_size_is_at_most(m_capacity_in_bytes);
+}
+
+void ResourceCache::did_fail(Resource& resource)
+{
+    // Forget failed loads so that the next request tries again.
+    if (entry_for(resource))
+        remove(resource.request());
+}
+
+void ResourceCache::remove(const LoadRequest& request)
+{
+    auto it = m_entries.find(request);
+    if (it == m_entries.end())
+        return;
+    m_size_in_bytes -= it->value.size_in_bytes;
+    m_entries.remove(it);
+}
+
+void ResourceCache::evict_until_size_is_at_most(size_t size_in_bytes)
+{
+    while (m_size_in_bytes > size_in_bytes) {
+        Optional<LoadRequest> least_recently_used;
+        u64 least_recent_use = 0;
+        for (auto& it : m_entries) {
+            if (!it.value.resource->is_loaded())
+                continue;
+            if (!least_recently_used.has_value() || it.value.last_used < least_recent_use) {
+                least_recently_used = it.key;
+                least_recent_use = it.value.last_used;
+            }
+        }
+        if (!least_recently_used.has_value())
+            return;
+#ifdef CACHE_DEBUG
+        dbg() << "ResourceCache: Evicting " << least_recently_used.value().url();
+#endif
+        remove(least_recently_used.value());
+    }
+}
+
+}
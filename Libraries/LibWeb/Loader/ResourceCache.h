@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/RefPtr.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/Loader/LoadRequest.h>
+
+namespace Web {
+
+// Keeps loaded resources around for reuse, up to a total size of encoded data.
+// Resources that are still loading are kept regardless, so that concurrent requests share them.
+class ResourceCache {
+public:
+    explicit ResourceCache(size_t capacity_in_bytes);
+
+    RefPtr<Resource> get(const LoadRequest&);
+    void set(const LoadRequest&, NonnullRefPtr<Resource>);
+
+    void did_load(Resource&);
+    void did_fail(Resource&);
+
+    size_t entry_count() const { return m_entries.size(); }
+    size_t size_in_bytes() const { return m_size_in_bytes; }
+    size_t capacity_in_bytes() const { return m_capacity_in_bytes; }
+
+private:
+    struct Entry {
+        RefPtr<Resource> resource;
+        size_t size_in_bytes { 0 };
+        u64 last_used { 0 };
+    };
+
+    Entry* entry_for(const Resource&);
+    void remove(const LoadRequest&);
+    void evict_until_size_is_at_most(size_t);
+
+    HashMap<LoadRequest, Entry> m_entries;
+    size_t m_size_in_bytes { 0 };
+    size_t m_capacity_in_bytes { 0 };
+    u64 m_use_counter { 0 };
+};
+
+}
@@ -49,6 +49,8 @@ ResourceLoader& ResourceLoader::the()
 
 ResourceLoader::ResourceLoader()
     : m_protocol_client(Protocol::Client::construct())
+    , m_resource_cache(16 * MB)
+    , m_decoded_image_cache(64 * MB)
     , m_user_agent("Mozilla/4.0 (SerenityOS; x86) LibWeb+LibJS (Not KHTML, nor Gecko) LibWeb")
 {
 }
@@ -72,43 +74,83 @@ void ResourceLoader::load_sync(const URL& url, Function<void(const ByteBuffer&,
     loop.exec();
 }
 
-static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
-
 RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRequest& request)
 {
     if (!request.is_valid())
         return nullptr;
 
-    auto it = s_resource_cache.find(request);
-    if (it != s_resource_cache.end()) {
-        if (it->value->type() != type) {
-            dbg() << "FIXME: Not using cached resource for " << request.url() << " since there's a type mismatch.";
-        } else {
+    auto cached_resource = m_resource_cache.get(request);
+    if (cached_resource && cached_resource->type() != type) {
+        dbg() << "FIXME: Not using cached resource for " << request.url() << " since there's a type mismatch.";
+        cached_resource = nullptr;
+    }
+
+    if (cached_resource) {
+        if (!cached_resource->is_loaded() || cached_resource->is_fresh()) {
 #ifdef CACHE_DEBUG
             dbg() << "Reusing cached resource for: " << request.url();
 #endif
-            return it->value;
+            return cached_resource;
         }
+        if (!cached_resource->cache_policy().can_revalidate())
+            cached_resource = nullptr;
     }
 
     auto resource = Resource::create({}, type, request);
 
-    s_resource_cache.set(request, resource);
+    m_resource_cache.set(request, resource);
+
+    // A stale resource we can revalidate is replaced by a new one, which takes over its data if the server says it hasn't changed.
+    LoadRequest network_request = request;
+    if (cached_resource) {
+#ifdef CACHE_DEBUG
+        dbg() << "Revalidating cached resource for: " << request.url();
+#endif
+        HashMap<String, String> revalidation_headers;
+        cached_resource->cache_policy().add_revalidation_headers(revalidation_headers);
+        for (auto& it : revalidation_headers)
+            network_request.set_header(it.key, it.value);
+    }
 
     load(
-        request.url(),
-        [=](auto& data, auto& headers) {
-            const_cast<Resource&>(*resource).did_load({}, data, headers);
+        network_request,
+        [this, resource, cached_resource](auto& data, auto& headers, auto status_code) {
+            if (cached_resource && status_code.has_value() && status_code.value() == 304) {
+                auto updated_headers = cached_resource->response_headers();
+                HTTP::CachePolicy::update_headers_after_revalidation(updated_headers, headers);
+                const_cast<Resource&>(*resource).did_load({}, cached_resource->encoded_data(), updated_headers);
+            } else {
+                const_cast<Resource&>(*resource).did_load({}, data, headers);
+            }
+            m_resource_cache.did_load(const_cast<Resource&>(*resource));
         },
-        [=](auto& error) {
+        [this, resource](auto& error) {
             const_cast<Resource&>(*resource).did_fail({}, error);
+            m_resource_cache.did_fail(const_cast<Resource&>(*resource));
+        },
+        [=](auto& received_data, u32 total_size) {
+            const_cast<Resource&>(*resource).did_receive_data({}, received_data, total_size);
         });
 
     return resource;
 }
 
-void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback)
+void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback, Function<void(const ByteBuffer& received_data, u32 total_size)> partial_data_callback)
+{
+    LoadRequest request;
+    request.set_url(url);
+    load(
+        request,
+        [success_callback = move(success_callback)](auto& data, auto& response_headers, auto) {
+            success_callback(data, response_headers);
+        },
+        move(error_callback), move(partial_data_callback));
+}
+
+void ResourceLoader::load(const LoadRequest& request, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&)> error_callback, Function<void(const ByteBuffer& received_data, u32 total_size)> partial_data_callback)
 {
+    auto& url = request.url();
+
     if (is_port_blocked(url.port())) {
         dbg() << "ResourceLoader::load: Error: blocked port " << url.port() << " for URL: " << url;
         return;
@@ -117,7 +159,7 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
     if (url.protocol() == "about") {
         dbg() << "Loading about: URL " << url;
         deferred_invoke([success_callback = move(success_callback)](auto&) {
-            success_callback(ByteBuffer::wrap(String::empty().characters(), 1), {});
+            success_callback(ByteBuffer::wrap(String::empty().characters(), 1), {}, {});
         });
         return;
     }
@@ -132,7 +174,7 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
             data = url.data_payload().to_byte_buffer();
 
         deferred_invoke([data = move(data), success_callback = move(success_callback)](auto&) {
-            success_callback(data, {});
+            success_callback(data, {}, {});
         });
         return;
     }
@@ -149,13 +191,13 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
 
         auto data = f->read_all();
         deferred_invoke([data = move(data), success_callback = move(success_callback)](auto&) {
-            success_callback(data, {});
+            success_callback(data, {}, {});
         });
         return;
     }
 
     if (url.protocol() == "http" || url.protocol() == "https" || url.protocol() == "gemini") {
-        HashMap<String, String> headers;
+        auto headers = request.headers();
         headers.set("User-Agent", m_user_agent);
         auto download = protocol_client().start_download(url.to_string(), headers);
         if (!download) {
@@ -177,8 +219,10 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&, const
                     error_callback(String::format("HTTP error (%u)", status_code.value()));
                 return;
             }
-            success_callback(ByteBuffer::copy(payload.data(), payload.size()), response_headers);
+            success_callback(ByteBuffer::copy(payload.data(), payload.size()), response_headers, status_code);
         };
+        if (partial_data_callback)
+            download->on_data_received = move(partial_data_callback);
         ++m_pending_loads;
         if (on_load_counter_change)
             on_load_counter_change();
@@ -207,6 +251,10 @@ void ResourceLoader::save_to(JsonObject& object)
     Object::save_to(object);
     object.set("pending_loads", m_pending_loads);
     object.set("user_agent", m_user_agent);
+    object.set("cached_resources", m_resource_cache.entry_count());
+    object.set("resource_cache_size", m_resource_cache.size_in_bytes());
+    object.set("decoded_images", m_decoded_image_cache.entry_count());
+    object.set("decoded_image_cache_size", m_decoded_image_cache.size_in_bytes());
 }
 
 }
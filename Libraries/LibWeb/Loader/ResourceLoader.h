@@ -29,7 +29,9 @@
 #include <AK/Function.h>
 #include <AK/URL.h>
 #include <LibCore/Object.h>
+#include <LibWeb/Loader/DecodedImageCache.h>
 #include <LibWeb/Loader/Resource.h>
+#include <LibWeb/Loader/ResourceCache.h>
 
 namespace Protocol {
 class Client;
@@ -44,7 +46,11 @@ public:
 
     RefPtr<Resource> load_resource(Resource::Type, const LoadRequest&);
 
-    void load(const URL&, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback = nullptr);
+    // partial_data_callback is called with everything received so far while the load is in progress,
+    // for loads that arrive over the network with their size known up front.
+    void load(const URL&, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback = nullptr, Function<void(const ByteBuffer& received_data, u32 total_size)> partial_data_callback = nullptr);
+    // Like the above, but sends the request's headers along and tells success_callback the status code, if there was one.
+    void load(const LoadRequest&, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&)> error_callback = nullptr, Function<void(const ByteBuffer& received_data, u32 total_size)> partial_data_callback = nullptr);
     void load_sync(const URL&, Function<void(const ByteBuffer&, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)> success_callback, Function<void(const String&)> error_callback = nullptr);
 
     Function<void()> on_load_counter_change;
@@ -55,6 +61,8 @@ public:
 
     const String& user_agent() const { return m_user_agent; }
 
+    DecodedImageCache& decoded_image_cache() { return m_decoded_image_cache; }
+
 private:
     ResourceLoader();
     static bool is_port_blocked(int port);
@@ -63,6 +71,9 @@ private:
 
     int m_pending_loads { 0 };
 
+    ResourceCache m_resource_cache;
+    DecodedImageCache m_decoded_image_cache;
+
     RefPtr<Protocol::Client> m_protocol_client;
     String m_user_agent;
 };
@@ -150,7 +150,7 @@ bool EventHandler::handle_mousedown(const Gfx::IntPoint& position, unsigned butt
         }
     } else {
         if (button == GUI::MouseButton::Left) {
-            layout_root()->selection().set({ result.layout_node, result.index_in_node }, {});
+            layout_root()->set_selection({ { result.layout_node, result.index_in_node }, {} });
             dump_selection("MouseDown");
             m_in_mouse_selection = true;
         } else if (button == GUI::MouseButton::Right) {
@@ -196,7 +196,7 @@ bool EventHandler::handle_mousemove(const Gfx::IntPoint& position, unsigned butt
                 return true;
         }
         if (m_in_mouse_selection) {
-            layout_root()->selection().set_end({ result.layout_node, result.index_in_node });
+            layout_root()->set_selection_end({ result.layout_node, result.index_in_node });
             dump_selection("MouseMove");
             page_client.page_did_change_selection();
         }
@@ -91,9 +91,7 @@ void Frame::set_viewport_rect(const Gfx::IntRect& rect)
 
 void Frame::set_needs_display(const Gfx::IntRect& rect)
 {
-    if (!m_viewport_rect.intersects(rect))
-        return;
-
+    // NOTE: Changes outside the viewport still have to be reported, since they may have been painted into a cached tile.
     if (is_main_frame()) {
         page().client().page_did_invalidate(to_main_frame_rect(rect));
         return;
@@ -78,6 +78,17 @@ PageView::~PageView()
 {
 }
 
+void PageView::set_should_show_line_box_borders(bool value)
+{
+    if (m_should_show_line_box_borders == value)
+        return;
+    m_should_show_line_box_borders = value;
+    if (layout_root())
+        layout_root()->invalidate_display_lists();
+    m_tile_cache.invalidate_all();
+    update();
+}
+
 void PageView::select_all()
 {
     auto* layout_root = this->layout_root();
@@ -109,7 +120,7 @@ void PageView::select_all()
     if (is<LayoutText>(*last_layout_node))
         last_layout_node_index_in_node = downcast<LayoutText>(*last_layout_node).text_for_rendering().length() - 1;
 
-    layout_root->selection().set({ first_layout_node, 0 }, { last_layout_node, last_layout_node_index_in_node });
+    layout_root->set_selection({ { first_layout_node, 0 }, { last_layout_node, last_layout_node_index_in_node } });
     update();
 }
 
@@ -161,6 +172,7 @@ String PageView::selected_text() const
 void PageView::page_did_layout()
 {
     ASSERT(layout_root());
+    m_tile_cache.invalidate_all();
     set_content_size(layout_root()->size().to_type<int>());
 }
 
@@ -172,6 +184,7 @@ void PageView::page_did_change_title(const String& title)
 
 void PageView::page_did_set_document_in_main_frame(DOM::Document* document)
 {
+    m_tile_cache.invalidate_all();
     if (on_set_document)
         on_set_document(document);
     layout_and_sync_size();
@@ -242,9 +255,11 @@ void PageView::page_did_unhover_link()
         on_link_hover({});
 }
 
-void PageView::page_did_invalidate(const Gfx::IntRect&)
+void PageView::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
-    update();
+    m_tile_cache.invalidate(content_rect);
+    if (viewport_rect_in_content_coordinates().intersects(content_rect))
+        update();
 }
 
 void PageView::page_did_change_favicon(const Gfx::Bitmap& bitmap)
@@ -300,19 +315,18 @@ void PageView::paint_event(GUI::PaintEvent& event)
         return;
     }
 
-    painter.fill_rect(event.rect(), document()->background_color(palette()));
-
-    if (auto background_bitmap = document()->background_image()) {
-        painter.draw_tiled_bitmap(event.rect(), *background_bitmap);
-    }
-
     painter.translate(frame_thickness(), frame_thickness());
     painter.translate(-horizontal_scrollbar().value(), -vertical_scrollbar().value());
 
-    PaintContext context(painter, palette(), { horizontal_scrollbar().value(), vertical_scrollbar().value() });
-    context.set_should_show_line_box_borders(m_should_show_line_box_borders);
-    context.set_viewport_rect(viewport_rect_in_content_coordinates());
-    layout_root()->paint_all_phases(context);
+    auto content_rect = event.rect().translated(-frame_thickness(), -frame_thickness()).translated(horizontal_scrollbar().value(), vertical_scrollbar().value());
+    content_rect.intersect(viewport_rect_in_content_coordinates());
+
+    m_tile_cache.paint(painter, content_rect, [&](Gfx::Painter& tile_painter, const Gfx::IntRect& tile_rect) {
+        PaintContext context(palette(), { horizontal_scrollbar().value(), vertical_scrollbar().value() });
+        context.set_should_show_line_box_borders(m_should_show_line_box_borders);
+        context.set_viewport_rect(viewport_rect_in_content_coordinates());
+        layout_root()->paint_with_display_lists(tile_painter, tile_rect, context);
+    });
 }
 
 void PageView::mousemove_event(GUI::MouseEvent& event)
@@ -436,6 +450,10 @@ void PageView::set_document(DOM::Document* document)
 
 void PageView::did_scroll()
 {
+    // Fixed position boxes move along with the viewport, so none of the cached tiles can be reused.
+    if (layout_root() && layout_root()->display_lists_depend_on_scroll_offset())
+        m_tile_cache.invalidate_all();
+
     page().main_frame().set_viewport_rect(viewport_rect_in_content_coordinates());
     page().main_frame().did_scroll({});
 }
@@ -30,6 +30,7 @@
 #include <LibGUI/ScrollableWidget.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/Page/Page.h>
+#include <LibWeb/Painting/TileCache.h>
 #include <LibWeb/WebViewHooks.h>
 
 namespace Web {
@@ -59,7 +60,7 @@ public:
 
     URL url() const;
 
-    void set_should_show_line_box_borders(bool value) { m_should_show_line_box_borders = value; }
+    void set_should_show_line_box_borders(bool);
 
     virtual bool accepts_focus() const override { return true; }
 
@@ -110,6 +111,7 @@ private:
     bool m_should_show_line_box_borders { false };
 
     NonnullOwnPtr<Page> m_page;
+    TileCache m_tile_cache;
 
     RefPtr<GUI::Action> m_copy_action;
     RefPtr<GUI::Action> m_select_all_action;
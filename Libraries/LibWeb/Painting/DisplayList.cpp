@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibWeb/Painting/DisplayList.h>
+
+namespace Web {
+
+DisplayList::DisplayList()
+{
+    m_state_stack.append(State());
+    state().font = &Gfx::Font::default_font();
+}
+
+DisplayList::~DisplayList()
+{
+}
+
+void DisplayList::clear()
+{
+    m_commands.clear();
+    m_state_stack.clear();
+    m_state_stack.append(State());
+    state().font = &Gfx::Font::default_font();
+}
+
+DisplayList::Command* DisplayList::append_state_command(Command::Type type)
+{
+    Command command;
+    command.type = type;
+    m_commands.append(move(command));
+    return &m_commands.last();
+}
+
+DisplayList::Command* DisplayList::append_drawing_command(Command::Type type, const Gfx::IntRect& rect_in_local_coordinates)
+{
+    auto bounding_rect = rect_in_local_coordinates.translated(state().translation);
+    if (state().clip_rect.has_value())
+        bounding_rect.intersect(state().clip_rect.value());
+
+    // Nothing recorded here could ever become visible, so don't bother keeping it around.
+    if (bounding_rect.is_empty())
+        return nullptr;
+
+    Command command;
+    command.type = type;
+    command.bounding_rect = bounding_rect;
+    m_commands.append(move(command));
+    return &m_commands.last();
+}
+
+void DisplayList::save()
+{
+    m_state_stack.append(m_state_stack.last());
+    append_state_command(Command::Type::Save);
+}
+
+void DisplayList::restore()
+{
+    ASSERT(m_state_stack.size() > 1);
+    m_state_stack.take_last();
+
+    // Drop state commands that didn't end up affecting anything.
+    if (!m_commands.is_empty() && m_commands.last().type == Command::Type::Save) {
+        m_commands.take_last();
+        return;
+    }
+    append_state_command(Command::Type::Restore);
+}
+
+void DisplayList::translate(const Gfx::IntPoint& delta)
+{
+    if (delta.is_null())
+        return;
+    state().translation.move_by(delta);
+    append_state_command(Command::Type::Translate)->from = delta;
+}
+
+void DisplayList::add_clip_rect(const Gfx::IntRect& rect)
+{
+    auto clip_rect = rect.translated(state().translation);
+    if (state().clip_rect.has_value())
+        clip_rect.intersect(state().clip_rect.value());
+    state().clip_rect = clip_rect;
+    append_state_command(Command::Type::AddClipRect)->rect = rect;
+}
+
+void DisplayList::fill_rect(const Gfx::IntRect& rect, Color color)
+{
+    auto* command = append_drawing_command(Command::Type::FillRect, rect);
+    if (!command)
+        return;
+    command->rect = rect;
+    command->color = color;
+}
+
+void DisplayList::draw_rect(const Gfx::IntRect& rect, Color color)
+{
+    auto* command = append_drawing_command(Command::Type::DrawRect, rect);
+    if (!command)
+        return;
+    command->rect = rect;
+    command->color = color;
+}
+
+void DisplayList::draw_line(const Gfx::IntPoint& from, const Gfx::IntPoint& to, Color color, int thickness, Gfx::Painter::LineStyle line_style)
+{
+    auto bounding_rect = Gfx::IntRect::from_two_points(from, to).inflated(thickness * 2 + 2, thickness * 2 + 2);
+    auto* command = append_drawing_command(Command::Type::DrawLine, bounding_rect);
+    if (!command)
+        return;
+    command->from = from;
+    command->to = to;
+    command->color = color;
+    command->thickness = thickness;
+    command->line_style = line_style;
+}
+
+void DisplayList::draw_text(const Gfx::IntRect& rect, const StringView& text, Gfx::TextAlignment alignment, Color color, Gfx::TextElision elision)
+{
+    auto* command = append_drawing_command(Command::Type::DrawText, rect);
+    if (!command)
+        return;
+    command->rect = rect;
+    command->text = text;
+    command->font = const_cast<Gfx::Font*>(state().font);
+    command->alignment = alignment;
+    command->color = color;
+    command->elision = elision;
+}
+
+void DisplayList::draw_scaled_bitmap(const Gfx::IntRect& dst_rect, const Gfx::Bitmap& bitmap, const Gfx::IntRect& src_rect)
+{
+    auto* command = append_drawing_command(Command::Type::DrawScaledBitmap, dst_rect);
+    if (!command)
+        return;
+    command->rect = dst_rect;
+    command->source_rect = src_rect;
+    command->bitmap = const_cast<Gfx::Bitmap*>(&bitmap);
+}
+
+void DisplayList::draw_tiled_bitmap(const Gfx::IntRect& rect, const Gfx::Bitmap& bitmap)
+{
+    auto* command = append_drawing_command(Command::Type::DrawTiledBitmap, rect);
+    if (!command)
+        return;
+    command->rect = rect;
+    command->bitmap = const_cast<Gfx::Bitmap*>(&bitmap);
+}
+
+void DisplayList::paint_frame(const Gfx::IntRect& rect, const Palette& palette, Gfx::FrameShape shape, Gfx::FrameShadow shadow, int thickness)
+{
+    auto* command = append_drawing_command(Command::Type::PaintFrame, rect);
+    if (!command)
+        return;
+    command->rect = rect;
+    command->palette = const_cast<Gfx::PaletteImpl*>(&palette.impl());
+    command->frame_shape = shape;
+    command->frame_shadow = shadow;
+    command->thickness = thickness;
+}
+
+void DisplayList::paint(Gfx::Painter& painter, const Gfx::IntRect& rect) const
+{
+    Gfx::PainterStateSaver saver(painter);
+
+    for (auto& command : m_commands) {
+        switch (command.type) {
+        case Command::Type::Save:
+            painter.save();
+            continue;
+        case Command::Type::Restore:
+            painter.restore();
+            continue;
+        case Command::Type::Translate:
+            painter.translate(command.from);
+            continue;
+        case Command::Type::AddClipRect:
+            painter.add_clip_rect(command.rect);
+            continue;
+        default:
+            break;
+        }
+
+        if (!command.bounding_rect.intersects(rect))
+            continue;
+
+        switch (command.type) {
+        case Command::Type::FillRect:
+            painter.fill_rect(command.rect, command.color);
+            break;
+        case Command::Type::DrawRect:
+            painter.draw_rect(command.rect, command.color);
+            break;
+        case Command::Type::DrawLine:
+            painter.draw_line(command.from, command.to, command.color, command.thickness, command.line_style);
+            break;
+        case Command::Type::DrawText:
+            painter.draw_text(command.rect, command.text, *command.font, command.alignment, command.color, command.elision);
+            break;
+        case Command::Type::DrawScaledBitmap:
+            painter.draw_scaled_bitmap(command.rect, *command.bitmap, command.source_rect);
+            break;
+        case Command::Type::DrawTiledBitmap:
+            painter.draw_tiled_bitmap(command.rect, *command.bitmap);
+            break;
+        case Command::Type::PaintFrame:
+            Gfx::StylePainter::paint_frame(painter, command.rect, Palette(*command.palette), command.frame_shape, command.frame_shadow, command.thickness);
+            break;
+        default:
+            ASSERT_NOT_REACHED();
+        }
+    }
+}
+
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Font.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Palette.h>
+#include <LibGfx/Rect.h>
+#include <LibGfx/StylePainter.h>
+#include <LibGfx/TextAlignment.h>
+#include <LibGfx/TextElision.h>
+
+namespace Web {
+
+// A recording of painting operations that can be replayed into a Gfx::Painter later.
+// The recording API mirrors the subset of Gfx::Painter that layout nodes use.
+class DisplayList {
+public:
+    DisplayList();
+    ~DisplayList();
+
+    void save();
+    void restore();
+    void translate(int dx, int dy) { translate({ dx, dy }); }
+    void translate(const Gfx::IntPoint&);
+    void add_clip_rect(const Gfx::IntRect&);
+
+    const Gfx::Font& font() const { return *state().font; }
+    void set_font(const Gfx::Font& font) { state().font = &font; }
+
+    void fill_rect(const Gfx::IntRect&, Color);
+    void draw_rect(const Gfx::IntRect&, Color);
+    void draw_line(const Gfx::IntPoint&, const Gfx::IntPoint&, Color, int thickness = 1, Gfx::Painter::LineStyle = Gfx::Painter::LineStyle::Solid);
+    void draw_text(const Gfx::IntRect&, const StringView&, Gfx::TextAlignment = Gfx::TextAlignment::TopLeft, Color = Color::Black, Gfx::TextElision = Gfx::TextElision::None);
+    void draw_scaled_bitmap(const Gfx::IntRect& dst_rect, const Gfx::Bitmap&, const Gfx::IntRect& src_rect);
+    void draw_tiled_bitmap(const Gfx::IntRect&, const Gfx::Bitmap&);
+    void paint_frame(const Gfx::IntRect&, const Palette&, Gfx::FrameShape, Gfx::FrameShadow, int thickness);
+
+    bool is_empty() const { return m_commands.is_empty(); }
+    void clear();
+
+    // Replays the recorded commands, skipping the ones that can't touch the given rect.
+    // The rect is in the same coordinate space that the commands were recorded in.
+    void paint(Gfx::Painter&, const Gfx::IntRect&) const;
+
+private:
+    struct Command {
+        enum class Type {
+            Save,
+            Restore,
+            Translate,
+            AddClipRect,
+            FillRect,
+            DrawRect,
+            DrawLine,
+            DrawText,
+            DrawScaledBitmap,
+            DrawTiledBitmap,
+            PaintFrame,
+        };
+
+        Type type;
+
+        // The area this command may touch, in the coordinate space of the whole list.
+        Gfx::IntRect bounding_rect;
+
+        Gfx::IntRect rect;
+        Gfx::IntRect source_rect;
+        Gfx::IntPoint from;
+        Gfx::IntPoint to;
+        Color color;
+        int thickness { 1 };
+        Gfx::Painter::LineStyle line_style { Gfx::Painter::LineStyle::Solid };
+        String text;
+        RefPtr<Gfx::Font> font;
+        Gfx::TextAlignment alignment { Gfx::TextAlignment::TopLeft };
+        Gfx::TextElision elision { Gfx::TextElision::None };
+        RefPtr<Gfx::Bitmap> bitmap;
+        RefPtr<Gfx::PaletteImpl> palette;
+        Gfx::FrameShape frame_shape { Gfx::FrameShape::NoFrame };
+        Gfx::FrameShadow frame_shadow { Gfx::FrameShadow::Plain };
+    };
+
+    struct State {
+        const Gfx::Font* font { nullptr };
+        Gfx::IntPoint translation;
+        Optional<Gfx::IntRect> clip_rect;
+    };
+
+    State& state() { return m_state_stack.last(); }
+    const State& state() const { return m_state_stack.last(); }
+
+    Command* append_state_command(Command::Type);
+    Command* append_drawing_command(Command::Type, const Gfx::IntRect& rect_in_local_coordinates);
+
+    Vector<Command> m_commands;
+    Vector<State, 4> m_state_stack;
+};
+
+class DisplayListStateSaver {
+public:
+    explicit DisplayListStateSaver(DisplayList& display_list)
+        : m_display_list(display_list)
+    {
+        m_display_list.save();
+    }
+
+    ~DisplayListStateSaver()
+    {
+        m_display_list.restore();
+    }
+
+private:
+    DisplayList& m_display_list;
+};
+
+}
@@ -29,19 +29,25 @@
 #include <LibGfx/Palette.h>
 #include <LibGfx/Rect.h>
 #include <LibGfx/Forward.h>
+#include <LibWeb/Painting/DisplayList.h>
 
 namespace Web {
 
 class PaintContext {
 public:
-    explicit PaintContext(Gfx::Painter& painter, const Palette& palette, const Gfx::IntPoint& scroll_offset)
-        : m_painter(painter)
-        , m_palette(palette)
+    explicit PaintContext(const Palette& palette, const Gfx::IntPoint& scroll_offset)
+        : m_palette(palette)
         , m_scroll_offset(scroll_offset)
     {
     }
 
-    Gfx::Painter& painter() const { return m_painter; }
+    DisplayList& display_list() const
+    {
+        ASSERT(m_display_list);
+        return *m_display_list;
+    }
+    void set_display_list(DisplayList& display_list) { m_display_list = &display_list; }
+
     const Palette& palette() const { return m_palette; }
 
     bool should_show_line_box_borders() const { return m_should_show_line_box_borders; }
@@ -52,12 +58,16 @@ public:
 
     const Gfx::IntPoint& scroll_offset() const { return m_scroll_offset; }
 
+    bool did_paint_fixed_position_box() const { return m_did_paint_fixed_position_box; }
+    void set_did_paint_fixed_position_box() { m_did_paint_fixed_position_box = true; }
+
 private:
-    Gfx::Painter& m_painter;
+    DisplayList* m_display_list { nullptr };
     Palette m_palette;
     Gfx::IntRect m_viewport_rect;
     Gfx::IntPoint m_scroll_offset;
     bool m_should_show_line_box_borders { false };
+    bool m_did_paint_fixed_position_box { false };
 };
 
 }
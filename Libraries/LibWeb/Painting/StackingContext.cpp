@@ -47,7 +47,7 @@ StackingContext::StackingContext(LayoutBox& box, StackingContext* parent)
     }
 }
 
-void StackingContext::paint(PaintContext& context, LayoutNode::PaintPhase phase)
+void StackingContext::paint_box(PaintContext& context, LayoutNode::PaintPhase phase)
 {
     if (!m_box.is_root()) {
         m_box.paint(context, phase);
@@ -56,11 +56,39 @@ void StackingContext::paint(PaintContext& context, LayoutNode::PaintPhase phase)
         //       so we call its base class instead.
         downcast<LayoutDocument>(m_box).LayoutBlock::paint(context, phase);
     }
+}
+
+void StackingContext::paint(PaintContext& context, LayoutNode::PaintPhase phase)
+{
+    paint_box(context, phase);
     for (auto* child : m_children) {
         child->paint(context, phase);
     }
 }
 
+void StackingContext::record_display_lists(PaintContext& context)
+{
+    if (!m_has_display_lists) {
+        for (size_t i = 0; i < paint_phase_count; ++i) {
+            m_display_lists[i].clear();
+            context.set_display_list(m_display_lists[i]);
+            paint_box(context, (LayoutNode::PaintPhase)i);
+        }
+        m_has_display_lists = true;
+    }
+    for (auto* child : m_children) {
+        child->record_display_lists(context);
+    }
+}
+
+void StackingContext::paint_display_lists(Gfx::Painter& painter, const Gfx::IntRect& rect, LayoutNode::PaintPhase phase) const
+{
+    m_display_lists[(size_t)phase].paint(painter, rect);
+    for (auto* child : m_children) {
+        child->paint_display_lists(painter, rect, phase);
+    }
+}
+
 HitTestResult StackingContext::hit_test(const Gfx::IntPoint& position) const
 {
     HitTestResult result;
@@ -28,6 +28,7 @@
 
 #include <AK/Vector.h>
 #include <LibWeb/Layout/LayoutNode.h>
+#include <LibWeb/Painting/DisplayList.h>
 
 namespace Web {
 
@@ -43,12 +44,24 @@ public:
     void paint(PaintContext&, LayoutNode::PaintPhase);
     HitTestResult hit_test(const Gfx::IntPoint&) const;
 
+    // Records the display lists of this stacking context and its descendants, skipping the ones that are still valid.
+    void record_display_lists(PaintContext&);
+    void paint_display_lists(Gfx::Painter&, const Gfx::IntRect&, LayoutNode::PaintPhase) const;
+    void invalidate_display_lists() { m_has_display_lists = false; }
+
     void dump(int indent = 0) const;
 
 private:
+    void paint_box(PaintContext&, LayoutNode::PaintPhase);
+
     LayoutBox& m_box;
     StackingContext* const m_parent { nullptr };
     Vector<StackingContext*> m_children;
+
+    // One list per paint phase, each covering the box and its descendants minus the ones with their own stacking context.
+    static constexpr size_t paint_phase_count = (size_t)LayoutNode::PaintPhase::Overlay + 1;
+    DisplayList m_display_lists[paint_phase_count];
+    bool m_has_display_lists { false };
 };
 
 }
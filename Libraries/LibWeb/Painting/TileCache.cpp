@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NumericLimits.h>
+#include <AK/QuickSort.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibWeb/Painting/TileCache.h>
+
+namespace Web {
+
+TileCache::TileCache()
+{
+}
+
+TileCache::~TileCache()
+{
+}
+
+static Gfx::IntRect tile_range_for_rect(const Gfx::IntRect& rect)
+{
+    int first_column = rect.left() / TileCache::tile_size;
+    int first_row = rect.top() / TileCache::tile_size;
+    int last_column = rect.right() / TileCache::tile_size;
+    int last_row = rect.bottom() / TileCache::tile_size;
+    return { first_column, first_row, last_column - first_column + 1, last_row - first_row + 1 };
+}
+
+void TileCache::paint(Gfx::Painter& painter, const Gfx::IntRect& a_content_rect, const RasterizeCallback& rasterize)
+{
+    // Content coordinates are never negative.
+    auto content_rect = a_content_rect.intersected({ 0, 0, NumericLimits<int>::max(), NumericLimits<int>::max() });
+    if (content_rect.is_empty())
+        return;
+
+    ++m_paint_generation;
+
+    auto tile_range = tile_range_for_rect(content_rect);
+    for (int row = tile_range.top(); row <= tile_range.bottom(); ++row) {
+        for (int column = tile_range.left(); column <= tile_range.right(); ++column) {
+            Gfx::IntRect tile_rect { column * tile_size, row * tile_size, tile_size, tile_size };
+            auto key = key_for_tile(column, row);
+
+            if (!m_tiles.contains(key))
+                m_tiles.set(key, {});
+            auto& tile = m_tiles.find(key)->value;
+            tile.last_used = m_paint_generation;
+
+            if (!tile.bitmap) {
+                tile.bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { tile_size, tile_size });
+                if (!tile.bitmap)
+                    continue;
+                tile.is_valid = false;
+            }
+
+            if (!tile.is_valid) {
+                Gfx::Painter tile_painter(*tile.bitmap);
+                tile_painter.translate(-tile_rect.x(), -tile_rect.y());
+                rasterize(tile_painter, tile_rect);
+                tile.is_valid = true;
+            }
+
+            painter.blit(tile_rect.location(), *tile.bitmap, tile.bitmap->rect());
+        }
+    }
+
+    evict_tiles_if_needed();
+}
+
+void TileCache::invalidate(const Gfx::IntRect& a_content_rect)
+{
+    auto content_rect = a_content_rect.intersected({ 0, 0, NumericLimits<int>::max(), NumericLimits<int>::max() });
+    if (content_rect.is_empty())
+        return;
+
+    auto tile_range = tile_range_for_rect(content_rect);
+    for (auto& it : m_tiles) {
+        int column = (int)(it.key >> 32);
+        int row = (int)(u32)it.key;
+        if (tile_range.contains(column, row))
+            it.value.is_valid = false;
+    }
+}
+
+void TileCache::invalidate_all()
+{
+    for (auto& it : m_tiles)
+        it.value.is_valid = false;
+}
+
+void TileCache::evict_tiles_if_needed()
+{
+    if (m_tiles.size() <= max_tile_count)
+        return;
+
+    // Throw out the least recently painted tiles, but never the ones we just painted.
+    Vector<u64> candidates;
+    for (auto& it : m_tiles) {
+        if (it.value.last_used != m_paint_generation)
+            candidates.append(it.key);
+    }
+    quick_sort(candidates, [&](auto& a, auto& b) {
+        return m_tiles.get(a).value().last_used < m_tiles.get(b).value().last_used;
+    });
+
+    for (size_t i = 0; i < candidates.size() && m_tiles.size() > max_tile_count; ++i)
+        m_tiles.remove(candidates[i]);
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/RefPtr.h>
+#include <LibGfx/Forward.h>
+#include <LibGfx/Rect.h>
+
+namespace Web {
+
+// Keeps rasterized content in fixed-size tiles so that repainting an unchanged area
+// (e.g. after scrolling) is just a blit. Tiles are addressed in content coordinates.
+class TileCache {
+public:
+    static constexpr int tile_size = 256;
+    static constexpr size_t max_tile_count = 64;
+
+    using RasterizeCallback = Function<void(Gfx::Painter&, const Gfx::IntRect& tile_rect)>;
+
+    TileCache();
+    ~TileCache();
+
+    // Blits the tiles covering content_rect into the painter, which must be translated into content coordinates.
+    // Tiles that are missing or invalidated are rasterized first by calling the callback with a painter
+    // that's translated so that the tile covers tile_rect.
+    void paint(Gfx::Painter&, const Gfx::IntRect& content_rect, const RasterizeCallback&);
+
+    void invalidate(const Gfx::IntRect& content_rect);
+    void invalidate_all();
+
+private:
+    struct Tile {
+        RefPtr<Gfx::Bitmap> bitmap;
+        u64 last_used { 0 };
+        bool is_valid { false };
+    };
+
+    static u64 key_for_tile(int column, int row) { return ((u64)(u32)column << 32) | (u32)row; }
+
+    void evict_tiles_if_needed();
+
+    HashMap<u64, Tile> m_tiles;
+    u64 m_paint_generation { 0 };
+};
+
+}
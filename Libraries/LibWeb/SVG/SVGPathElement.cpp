@@ -419,12 +419,17 @@ void SVGPathElement::parse_attribute(const FlyString& name, const String& value)
 {
     SVGGeometryElement::parse_attribute(name, value);
 
-    if (name == "d")
+    if (name == "d") {
         m_instructions = PathDataParser(value).parse();
+        m_path.clear();
+    }
 }
 
-void SVGPathElement::paint(Gfx::Painter& painter, const SVGPaintingContext& context)
+Gfx::Path& SVGPathElement::get_path()
 {
+    if (m_path.has_value())
+        return m_path.value();
+
     Gfx::Path path;
 
     for (auto& instruction : m_instructions) {
@@ -588,14 +593,18 @@ void SVGPathElement::paint(Gfx::Painter& painter, const SVGPaintingContext& cont
         }
     }
 
-    // We need to fill the path before applying the stroke, however the filled
-    // path must be closed, whereas the stroke path may not necessary be closed.
-    // Copy the path and close it for filling, but use the previous path for stroke
-    auto closed_path = path;
-    closed_path.close();
+    m_path = move(path);
+    return m_path.value();
+}
+
+void SVGPathElement::paint(Gfx::Painter& painter, const SVGPaintingContext& context)
+{
+    // The path (and its flattened form) is kept around between paints, and only rebuilt when "d" changes.
+    auto& path = get_path();
 
-    // Fills are computed as though all paths are closed (https://svgwg.org/svg2-draft/painting.html#FillProperties)
-    painter.fill_path(closed_path, m_fill_color.value_or(context.fill_color), Gfx::Painter::WindingRule::EvenOdd);
+    // Fills are computed as though all paths are closed (https://svgwg.org/svg2-draft/painting.html#FillProperties),
+    // which fill_path() takes care of, so the same path can be used for both the fill and the stroke.
+    painter.fill_path(path, m_fill_color.value_or(context.fill_color), Gfx::Painter::WindingRule::EvenOdd);
     painter.stroke_path(path, m_stroke_color.value_or(context.stroke_color), m_stroke_width.value_or(context.stroke_width));
 }
 
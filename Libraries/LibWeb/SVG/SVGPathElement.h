@@ -26,7 +26,9 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/Path.h>
 #include <LibWeb/HTML/HTMLElement.h>
 #include <LibWeb/SVG/SVGGeometryElement.h>
 
@@ -109,7 +111,10 @@ public:
     virtual void paint(Gfx::Painter& painter, const SVGPaintingContext& context) override;
 
 private:
+    Gfx::Path& get_path();
+
     Vector<PathInstruction> m_instructions;
+    Optional<Gfx::Path> m_path;
 };
 
 }
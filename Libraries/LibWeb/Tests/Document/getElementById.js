@@ -0,0 +1,35 @@
+loadPage("file:///res/html/misc/blank.html");
+
+afterInitialPageLoad(() => {
+    test("Finds elements as they are inserted and renamed", () => {
+        expect(document.getElementById("foo")).toBe(null);
+
+        const div = document.createElement("div");
+        div.id = "foo";
+        expect(document.getElementById("foo")).toBe(null);
+
+        document.body.appendChild(div);
+        expect(document.getElementById("foo")).toBe(div);
+
+        div.setAttribute("id", "bar");
+        expect(document.getElementById("foo")).toBe(null);
+        expect(document.getElementById("bar")).toBe(div);
+    });
+
+    test("Returns the first element in tree order for duplicate IDs", () => {
+        const first = document.createElement("span");
+        const second = document.createElement("span");
+        second.id = "duplicate";
+        document.body.appendChild(second);
+        first.id = "duplicate";
+        document.body.insertBefore(first, second);
+        expect(document.getElementById("duplicate")).toBe(first);
+    });
+
+    test("Finds elements inserted with innerHTML", () => {
+        const container = document.createElement("div");
+        document.body.appendChild(container);
+        container.innerHTML = "<p id='inner'>Hello</p>";
+        expect(document.getElementById("inner").tagName).toBe("P");
+    });
+});
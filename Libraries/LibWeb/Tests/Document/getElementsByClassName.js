@@ -0,0 +1,28 @@
+loadPage("file:///res/html/misc/blank.html");
+
+afterInitialPageLoad(() => {
+    test("Results follow DOM changes", () => {
+        expect(document.getElementsByClassName("item")).toHaveLength(0);
+
+        const a = document.createElement("div");
+        a.className = "item";
+        document.body.appendChild(a);
+        expect(document.getElementsByClassName("item")).toHaveLength(1);
+
+        const b = document.createElement("div");
+        document.body.appendChild(b);
+        expect(document.getElementsByClassName("item")).toHaveLength(1);
+
+        b.className = "other item";
+        const items = document.getElementsByClassName("item");
+        expect(items).toHaveLength(2);
+        expect(items[0]).toBe(a);
+        expect(items[1]).toBe(b);
+    });
+
+    test("getElementsByTagName sees new elements", () => {
+        const before = document.getElementsByTagName("section").length;
+        document.body.appendChild(document.createElement("section"));
+        expect(document.getElementsByTagName("section")).toHaveLength(before + 1);
+    });
+});
@@ -6,6 +6,8 @@ wheel_gid=1
 tty_gid=2
 phys_gid=3
 audio_gid=4
+protocol_uid=11
+protocol_gid=11
 window_uid=13
 window_gid=13
 
@@ -61,6 +63,9 @@ done
 chmod 700 mnt/boot
 chmod 700 mnt/mod
 chmod 1777 mnt/tmp
+mkdir -p mnt/var/cache/ProtocolServer
+chmod 700 mnt/var/cache/ProtocolServer
+chown $protocol_uid:$protocol_gid mnt/var/cache/ProtocolServer
 echo "done"
 
 printf "setting up device nodes... "
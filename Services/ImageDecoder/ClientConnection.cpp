@@ -30,6 +30,7 @@
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
+#include <LibGfx/PixelKernels.h>
 #include <LibGfx/SystemTheme.h>
 
 namespace ImageDecoder {
@@ -91,6 +92,8 @@ OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> ClientConnection::hand
 
     // FIXME: We should fix ShareableBitmap so you can send it in responses as well as requests..
     m_shareable_bitmap = bitmap->to_bitmap_backed_by_shared_buffer();
+    // Convert once at load time so the client can composite the image with multiply-add blending.
+    m_shareable_bitmap->premultiply_alpha();
     m_shareable_bitmap->shared_buffer()->share_with(client_pid());
     Vector<u32> palette;
     if (m_shareable_bitmap->is_indexed()) {
@@ -99,4 +102,157 @@ OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> ClientConnection::hand
     return make<Messages::ImageDecoderServer::DecodeImageResponse>(m_shareable_bitmap->shbuf_id(), m_shareable_bitmap->size(), (i32)m_shareable_bitmap->format(), palette);
 }
 
+OwnPtr<Messages::ImageDecoderServer::StartDecodeResponse> ClientConnection::handle(const Messages::ImageDecoderServer::StartDecode& message)
+{
+    auto encoded_buffer = SharedBuffer::create_from_shbuf_id(message.encoded_shbuf_id());
+    if (!encoded_buffer || message.encoded_size() > (size_t)encoded_buffer->size()) {
+#ifdef IMAGE_DECODER_DEBUG
+        dbg() << "Could not map encoded data buffer for streaming decode";
+#endif
+        return make<Messages::ImageDecoderServer::StartDecodeResponse>(-1);
+    }
+
+    auto decode = make<StreamingDecode>();
+    decode->encoded_buffer = move(encoded_buffer);
+    decode->encoded_size = message.encoded_size();
+    decode->minimum_size = message.minimum_size();
+    auto decode_id = m_next_decode_id++;
+    m_streaming_decodes.set(decode_id, move(decode));
+    return make<Messages::ImageDecoderServer::StartDecodeResponse>(decode_id);
+}
+
+void ClientConnection::handle(const Messages::ImageDecoderServer::DidReceiveEncodedData& message)
+{
+    auto decode_id = message.decode_id();
+    auto it = m_streaming_decodes.find(decode_id);
+    if (it == m_streaming_decodes.end())
+        return;
+    auto& decode = *it->value;
+    if (!decode.encoded_buffer)
+        return;
+
+    auto received_size = min(message.received_size(), decode.encoded_size);
+    bool is_complete = received_size == decode.encoded_size;
+    auto* data = (const u8*)decode.encoded_buffer->data();
+    if (!decode.decoder) {
+        decode.decoder = is_complete ? Gfx::ImageDecoder::create(data, received_size) : Gfx::ImageDecoder::create_incremental(data, received_size);
+        decode.decoder->set_minimum_size(decode.minimum_size);
+    } else
+        decode.decoder->did_receive_data(data, received_size, is_complete);
+
+    auto result = decode.decoder->decode_available_data();
+    Gfx::IntRect changed_rect = result.changed_rect;
+    if (result.has_failed || (result.image && !update_decoded_bitmap(decode, *result.image, changed_rect))) {
+        post_message(Messages::ImageDecoderClient::DecodeFailed(decode_id));
+        m_streaming_decodes.remove(decode_id);
+        return;
+    }
+
+    if (result.is_complete) {
+        // The decoded bitmap is all that's needed from here on.
+        decode.decoder = nullptr;
+        decode.encoded_buffer = nullptr;
+    }
+
+    if (!decode.decoded_bitmap) {
+        if (result.is_complete) {
+            post_message(Messages::ImageDecoderClient::DecodeFailed(decode_id));
+            m_streaming_decodes.remove(decode_id);
+        }
+        return;
+    }
+
+    if (changed_rect.is_empty() && !result.is_complete)
+        return;
+    auto& bitmap = *decode.decoded_bitmap;
+    post_message(Messages::ImageDecoderClient::DecodeProgress(decode_id, bitmap.shbuf_id(), bitmap.size(), (i32)bitmap.format(), changed_rect, result.is_complete));
+}
+
+void ClientConnection::handle(const Messages::ImageDecoderServer::StopDecode& message)
+{
+    m_streaming_decodes.remove(message.decode_id());
+}
+
+// How many times smaller than the image the client's bitmap can be while still covering minimum_size.
+static int downscale_factor(const Gfx::IntSize& image_size, const Gfx::IntSize& minimum_size)
+{
+    if (minimum_size.is_empty())
+        return 1;
+    return max(1, min(image_size.width() / minimum_size.width(), image_size.height() / minimum_size.height()));
+}
+
+// Box filters the part of image within source_rect into a bitmap that is scale times smaller,
+// and returns the part of that bitmap that changed.
+static Gfx::IntRect downscale_into(Gfx::Bitmap& bitmap, const Gfx::Bitmap& image, const Gfx::IntRect& source_rect, int scale)
+{
+    int left = source_rect.left() / scale;
+    int top = source_rect.top() / scale;
+    int right = min(source_rect.right() / scale, bitmap.width() - 1);
+    int bottom = min(source_rect.bottom() / scale, bitmap.height() - 1);
+    for (int y = top; y <= bottom; ++y) {
+        auto* destination = bitmap.scanline(y) + left;
+        int source_top = y * scale;
+        int source_bottom = min(source_top + scale, image.height());
+        for (int x = left; x <= right; ++x) {
+            int source_left = x * scale;
+            int source_right = min(source_left + scale, image.width());
+            // Averaging premultiplied colors keeps transparent pixels from bleeding into their neighbors.
+            u32 alpha = 0, red = 0, green = 0, blue = 0;
+            for (int source_y = source_top; source_y < source_bottom; ++source_y) {
+                for (int source_x = source_left; source_x < source_right; ++source_x) {
+                    auto pixel = image.get_pixel(source_x, source_y).to_premultiplied();
+                    alpha += pixel >> 24;
+                    red += (pixel >> 16) & 0xff;
+                    green += (pixel >> 8) & 0xff;
+                    blue += pixel & 0xff;
+                }
+            }
+            u32 count = (source_bottom - source_top) * (source_right - source_left);
+            *destination++ = ((alpha + count / 2) / count) << 24 | ((red + count / 2) / count) << 16 | ((green + count / 2) / count) << 8 | ((blue + count / 2) / count);
+        }
+    }
+    return { left, top, right - left + 1, bottom - top + 1 };
+}
+
+bool ClientConnection::update_decoded_bitmap(StreamingDecode& decode, const Gfx::Bitmap& image, Gfx::IntRect& changed_rect)
+{
+    // Decoders that can't produce a smaller image themselves (or not small enough) are helped along here,
+    // so the client only gets as many pixels as it asked for.
+    int scale = downscale_factor(image.size(), decode.minimum_size);
+    Gfx::IntSize size { (image.width() + scale - 1) / scale, (image.height() + scale - 1) / scale };
+    if (!decode.decoded_bitmap || decode.decoded_bitmap->size() != size) {
+        // Images with an alpha channel are premultiplied so the client can composite them with multiply-add blending.
+        auto format = image.format() == Gfx::BitmapFormat::RGB32 ? Gfx::BitmapFormat::RGB32 : Gfx::BitmapFormat::RGBA32Premultiplied;
+        auto shared_buffer = SharedBuffer::create_with_size(size.width() * size.height() * sizeof(Gfx::RGBA32));
+        if (!shared_buffer)
+            return false;
+        decode.decoded_bitmap = Gfx::Bitmap::create_with_shared_buffer(format, *shared_buffer, size);
+        if (!decode.decoded_bitmap)
+            return false;
+        decode.decoded_bitmap->shared_buffer()->share_with(client_pid());
+        changed_rect = image.rect();
+    }
+
+    auto& bitmap = *decode.decoded_bitmap;
+    changed_rect.intersect(image.rect());
+    if (scale > 1) {
+        if (!changed_rect.is_empty())
+            changed_rect = downscale_into(bitmap, image, changed_rect, scale);
+        return true;
+    }
+    auto& kernels = Gfx::pixel_kernels();
+    for (int y = changed_rect.top(); y <= changed_rect.bottom(); ++y) {
+        auto* destination = bitmap.scanline(y) + changed_rect.left();
+        if (image.format() == Gfx::BitmapFormat::RGB32 || image.format() == Gfx::BitmapFormat::RGBA32) {
+            memcpy(destination, image.scanline(y) + changed_rect.left(), changed_rect.width() * sizeof(Gfx::RGBA32));
+            if (image.format() == Gfx::BitmapFormat::RGBA32)
+                kernels.premultiply_row(destination, changed_rect.width());
+            continue;
+        }
+        for (int x = changed_rect.left(); x <= changed_rect.right(); ++x)
+            *destination++ = image.get_pixel(x, y).to_premultiplied();
+    }
+    return true;
+}
+
 }
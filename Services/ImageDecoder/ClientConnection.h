@@ -48,8 +48,24 @@ public:
 private:
     virtual OwnPtr<Messages::ImageDecoderServer::GreetResponse> handle(const Messages::ImageDecoderServer::Greet&) override;
     virtual OwnPtr<Messages::ImageDecoderServer::DecodeImageResponse> handle(const Messages::ImageDecoderServer::DecodeImage&) override;
+    virtual OwnPtr<Messages::ImageDecoderServer::StartDecodeResponse> handle(const Messages::ImageDecoderServer::StartDecode&) override;
+    virtual void handle(const Messages::ImageDecoderServer::DidReceiveEncodedData&) override;
+    virtual void handle(const Messages::ImageDecoderServer::StopDecode&) override;
+
+    struct StreamingDecode {
+        RefPtr<SharedBuffer> encoded_buffer;
+        u32 encoded_size { 0 };
+        Gfx::IntSize minimum_size;
+        RefPtr<Gfx::ImageDecoder> decoder;
+        // What the client sees. It stays around until they stop the decode.
+        RefPtr<Gfx::Bitmap> decoded_bitmap;
+    };
+
+    bool update_decoded_bitmap(StreamingDecode&, const Gfx::Bitmap&, Gfx::IntRect& changed_rect);
 
     RefPtr<Gfx::Bitmap> m_shareable_bitmap;
+    HashMap<i32, NonnullOwnPtr<StreamingDecode>> m_streaming_decodes;
+    i32 m_next_decode_id { 1 };
 };
 
 }
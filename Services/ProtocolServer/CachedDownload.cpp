@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCore/Timer.h>
+#include <ProtocolServer/CachedDownload.h>
+
+namespace ProtocolServer {
+
+CachedDownload::CachedDownload(ClientConnection& client, CachedResponse&& response)
+    : Download(client)
+{
+    set_status_code(response.status_code);
+    set_response_headers(response.headers);
+    set_payload(response.payload);
+
+    // The client only learns the download's id once we return, so finish on the next event loop iteration.
+    m_finish_timer = Core::Timer::create_single_shot(0, [this] {
+        did_progress(total_size(), total_size().value());
+        did_finish(true);
+    });
+}
+
+CachedDownload::~CachedDownload()
+{
+    m_finish_timer->stop();
+}
+
+NonnullOwnPtr<CachedDownload> CachedDownload::create(Badge<ClientConnection>, ClientConnection& client, CachedResponse&& response)
+{
+    return adopt_own(*new CachedDownload(client, move(response)));
+}
+
+}
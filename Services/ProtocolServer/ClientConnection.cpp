@@ -26,7 +26,9 @@
 
 #include <AK/Badge.h>
 #include <AK/SharedBuffer.h>
+#include <ProtocolServer/CachedDownload.h>
 #include <ProtocolServer/ClientConnection.h>
+#include <ProtocolServer/DiskCache.h>
 #include <ProtocolServer/Download.h>
 #include <ProtocolServer/Protocol.h>
 #include <ProtocolServer/ProtocolClientEndpoint.h>
@@ -66,7 +68,11 @@ OwnPtr<Messages::ProtocolServer::StartDownloadResponse> ClientConnection::handle
     auto* protocol = Protocol::find_by_name(url.protocol());
     if (!protocol)
         return make<Messages::ProtocolServer::StartDownloadResponse>(-1);
-    auto download = protocol->start_download(*this, url, message.request_headers().entries());
+    OwnPtr<Download> download;
+    if (DiskCache::can_cache(url))
+        download = start_download_through_disk_cache(*protocol, url, message.request_headers().entries());
+    else
+        download = protocol->start_download(*this, url, message.request_headers().entries());
     if (!download)
         return make<Messages::ProtocolServer::StartDownloadResponse>(-1);
     auto id = download->id();
@@ -74,6 +80,46 @@ OwnPtr<Messages::ProtocolServer::StartDownloadResponse> ClientConnection::handle
     return make<Messages::ProtocolServer::StartDownloadResponse>(id);
 }
 
+static bool has_credentials(const HashMap<String, String>& request_headers)
+{
+    for (auto& it : request_headers) {
+        if (it.key.equals_ignoring_case("Authorization") || it.key.equals_ignoring_case("Cookie"))
+            return true;
+    }
+    return false;
+}
+
+OwnPtr<Download> ClientConnection::start_download_through_disk_cache(Protocol& protocol, const URL& url, HashMap<String, String> request_headers)
+{
+    // The disk cache is shared between users, and responses to requests with credentials may be personalized.
+    auto request_policy = HTTP::CachePolicy::from_request_headers(request_headers);
+    if (!request_policy.is_storable() || has_credentials(request_headers))
+        return protocol.start_download(*this, url, request_headers);
+
+    auto cached_response = DiskCache::the().lookup(url);
+    if (cached_response.has_value() && cached_response.value().is_fresh() && !request_policy.requires_revalidation())
+        return CachedDownload::create({}, *this, cached_response.release_value());
+
+    bool client_expects_not_modified = request_headers.contains("If-None-Match") || request_headers.contains("If-Modified-Since");
+    Optional<CachedResponse> revalidated_response;
+    if (cached_response.has_value()) {
+        auto policy = cached_response.value().policy();
+        if (client_expects_not_modified) {
+            // The client is revalidating its own copy, and a 304 only tells us something if that copy is ours too.
+            if (policy.matches_revalidation_headers(request_headers))
+                revalidated_response = cached_response.release_value();
+        } else if (policy.can_revalidate()) {
+            policy.add_revalidation_headers(request_headers);
+            revalidated_response = cached_response.release_value();
+        }
+    }
+
+    auto download = protocol.start_download(*this, url, request_headers);
+    if (download)
+        download->enable_disk_cache({}, url, move(revalidated_response), client_expects_not_modified);
+    return download;
+}
+
 OwnPtr<Messages::ProtocolServer::StopDownloadResponse> ClientConnection::handle(const Messages::ProtocolServer::StopDownload& message)
 {
     auto* download = const_cast<Download*>(m_downloads.get(message.download_id()).value_or(nullptr));
@@ -88,13 +134,23 @@ OwnPtr<Messages::ProtocolServer::StopDownloadResponse> ClientConnection::handle(
 
 void ClientConnection::did_finish_download(Badge<Download>, Download& download, bool success)
 {
+    // The client may not have mapped the received data yet, so it stays around until they disown it.
+    auto received_data = download.received_data();
+    if (received_data)
+        m_shared_buffers.set(received_data->shbuf_id(), received_data);
+
     RefPtr<SharedBuffer> buffer;
     if (success && download.payload().size() > 0 && !download.payload().is_null()) {
-        buffer = SharedBuffer::create_with_size(download.payload().size());
-        memcpy(buffer->data(), download.payload().data(), download.payload().size());
-        buffer->seal();
-        buffer->share_with(client_pid());
-        m_shared_buffers.set(buffer->shbuf_id(), buffer);
+        if (received_data && download.received_data_size() == download.payload().size()) {
+            buffer = received_data;
+            buffer->seal();
+        } else {
+            buffer = SharedBuffer::create_with_size(download.payload().size());
+            memcpy(buffer->data(), download.payload().data(), download.payload().size());
+            buffer->seal();
+            buffer->share_with(client_pid());
+            m_shared_buffers.set(buffer->shbuf_id(), buffer);
+        }
     }
     ASSERT(download.total_size().has_value());
 
@@ -111,6 +167,12 @@ void ClientConnection::did_progress_download(Badge<Download>, Download& download
     post_message(Messages::ProtocolClient::DownloadProgress(download.id(), download.total_size(), download.downloaded_size()));
 }
 
+void ClientConnection::did_receive_download_data(Badge<Download>, Download& download)
+{
+    ASSERT(download.received_data());
+    post_message(Messages::ProtocolClient::DownloadDataReceived(download.id(), download.received_data()->shbuf_id(), download.total_size().value(), download.received_data_size()));
+}
+
 OwnPtr<Messages::ProtocolServer::GreetResponse> ClientConnection::handle(const Messages::ProtocolServer::Greet&)
 {
     return make<Messages::ProtocolServer::GreetResponse>(client_id());
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/QuickSort.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/File.h>
+#include <ProtocolServer/DiskCache.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+//#define DISK_CACHE_DEBUG
+
+namespace ProtocolServer {
+
+void CachedResponse::did_revalidate(const HashMap<String, String, CaseInsensitiveStringTraits>& new_headers)
+{
+    HTTP::CachePolicy::update_headers_after_revalidation(headers, new_headers);
+    response_time = time(nullptr);
+}
+
+DiskCache& DiskCache::the()
+{
+    static DiskCache* s_the;
+    if (!s_the)
+        s_the = new DiskCache;
+    return *s_the;
+}
+
+const char* DiskCache::directory()
+{
+    return "/var/cache/ProtocolServer";
+}
+
+DiskCache::DiskCache()
+{
+    if (mkdir(directory(), 0700) < 0 && errno != EEXIST) {
+        perror("DiskCache: mkdir");
+        return;
+    }
+    m_enabled = true;
+}
+
+bool DiskCache::can_cache(const URL& url)
+{
+    return url.protocol() == "http" || url.protocol() == "https";
+}
+
+String DiskCache::path_for(const URL& url) const
+{
+    // Two URLs that hash the same share a file; the URL stored in it tells them apart.
+    return String::format("%s/%08x", directory(), url.to_string().hash());
+}
+
+Optional<CachedResponse> DiskCache::lookup(const URL& url)
+{
+    if (!m_enabled)
+        return {};
+
+    auto path = path_for(url);
+    auto file_or_error = Core::File::open(path, Core::IODevice::ReadOnly);
+    if (file_or_error.is_error())
+        return {};
+    auto data = file_or_error.value()->read_all();
+
+    Optional<size_t> metadata_size;
+    for (size_t i = 0; i + 1 < data.size(); ++i) {
+        if (data[i] == '\n' && data[i + 1] == '\n') {
+            metadata_size = i;
+            break;
+        }
+    }
+    if (!metadata_size.has_value())
+        return {};
+
+    auto lines = StringView((const char*)data.data(), metadata_size.value()).split_view('\n');
+    if (lines.size() < 3 || lines[0] != url.to_string())
+        return {};
+
+    auto status_code = lines[1].to_uint();
+    auto response_time = lines[2].to_uint();
+    if (!status_code.has_value() || !response_time.has_value())
+        return {};
+
+    CachedResponse response;
+    response.status_code = status_code.value();
+    response.response_time = response_time.value();
+    for (size_t i = 3; i < lines.size(); ++i) {
+        auto colon = lines[i].find_first_of(':');
+        if (!colon.has_value())
+            return {};
+        auto name = lines[i].substring_view(0, colon.value());
+        auto value = lines[i].substring_view(colon.value() + 1, lines[i].length() - colon.value() - 1);
+        response.headers.set(name, value);
+    }
+    auto payload_offset = metadata_size.value() + 2;
+    response.payload = ByteBuffer::copy(data.data() + payload_offset, data.size() - payload_offset);
+
+    // Eviction goes by modification time, so bump it to keep recently used entries around.
+    utime(path.characters(), nullptr);
+
+#ifdef DISK_CACHE_DEBUG
+    dbg() << "DiskCache: Found " << url << " (" << response.payload.size() << " bytes)";
+#endif
+    return response;
+}
+
+void DiskCache::store(const URL& url, const CachedResponse& response)
+{
+    if (!m_enabled)
+        return;
+    auto policy = response.policy();
+    if (!policy.is_storable_in_shared_cache())
+        return;
+    // A response that is stale right away and can't be revalidated would never be used.
+    if (!policy.can_revalidate() && !policy.freshness_lifetime(response.response_time))
+        return;
+    if (response.payload.size() > m_capacity_in_bytes / 8)
+        return;
+
+    StringBuilder builder;
+    builder.append(url.to_string());
+    builder.appendf("\n%u\n%u\n", response.status_code, (u32)response.response_time);
+    for (auto& it : response.headers) {
+        builder.append(it.key);
+        builder.append(':');
+        builder.append(it.value);
+        builder.append('\n');
+    }
+    builder.append('\n');
+
+    // Other instances may be reading this entry, so write it aside and then move it into place.
+    auto path = path_for(url);
+    auto temporary_path = String::format("%s.%d", path.characters(), getpid());
+    {
+        auto file_or_error = Core::File::open(temporary_path, Core::IODevice::WriteOnly, 0600);
+        if (file_or_error.is_error())
+            return;
+        auto& file = *file_or_error.value();
+        if (!file.write(builder.to_string()) || !file.write(response.payload.data(), response.payload.size())) {
+            unlink(temporary_path.characters());
+            return;
+        }
+    }
+    if (rename(temporary_path.characters(), path.characters()) < 0) {
+        perror("DiskCache: rename");
+        unlink(temporary_path.characters());
+        return;
+    }
+
+#ifdef DISK_CACHE_DEBUG
+    dbg() << "DiskCache: Stored " << url << " (" << response.payload.size() << " bytes)";
+#endif
+    evict_if_needed();
+}
+
+void DiskCache::remove(const URL& url)
+{
+    if (!m_enabled)
+        return;
+    unlink(path_for(url).characters());
+}
+
+void DiskCache::evict_if_needed()
+{
+    struct Entry {
+        String path;
+        size_t size { 0 };
+        time_t last_modified { 0 };
+    };
+    Vector<Entry> entries;
+    size_t total_size = 0;
+
+    Core::DirIterator iterator(directory(), Core::DirIterator::SkipDots);
+    while (iterator.has_next()) {
+        auto path = iterator.next_full_path();
+        struct stat st;
+        if (stat(path.characters(), &st) < 0)
+            continue;
+        entries.append({ path, (size_t)st.st_size, st.st_mtime });
+        total_size += st.st_size;
+    }
+    if (total_size <= m_capacity_in_bytes)
+        return;
+
+    quick_sort(entries, [](auto& a, auto& b) { return a.last_modified < b.last_modified; });
+    for (auto& entry : entries) {
+        if (total_size <= m_capacity_in_bytes)
+            break;
+#ifdef DISK_CACHE_DEBUG
+        dbg() << "DiskCache: Evicting " << entry.path << " (" << entry.size << " bytes)";
+#endif
+        if (unlink(entry.path.characters()) == 0)
+            total_size -= entry.size;
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/URL.h>
+#include <LibHTTP/CachePolicy.h>
+#include <time.h>
+
+namespace ProtocolServer {
+
+struct CachedResponse {
+    u32 status_code { 0 };
+    time_t response_time { 0 };
+    HashMap<String, String, CaseInsensitiveStringTraits> headers;
+    ByteBuffer payload;
+
+    HTTP::CachePolicy policy() const { return HTTP::CachePolicy::from_response_headers(headers); }
+    bool is_fresh() const { return policy().is_fresh(response_time, time(nullptr)); }
+
+    // Takes the headers of a 304 Not Modified response for this one.
+    void did_revalidate(const HashMap<String, String, CaseInsensitiveStringTraits>& new_headers);
+};
+
+// Responses are stored one file per URL in a directory shared by every ProtocolServer instance,
+// so a WebContent process or a `pro` download can reuse what another one has already fetched.
+class DiskCache {
+public:
+    static DiskCache& the();
+    static const char* directory();
+
+    static bool can_cache(const URL&);
+
+    Optional<CachedResponse> lookup(const URL&);
+    void store(const URL&, const CachedResponse&);
+    void remove(const URL&);
+
+private:
+    DiskCache();
+
+    String path_for(const URL&) const;
+    void evict_if_needed();
+
+    size_t m_capacity_in_bytes { 64 * MB };
+    bool m_enabled { false };
+};
+
+}
@@ -59,8 +59,47 @@ void Download::set_response_headers(const HashMap<String, String, CaseInsensitiv
     m_response_headers = response_headers;
 }
 
+void Download::enable_disk_cache(Badge<ClientConnection>, const URL& url, Optional<CachedResponse>&& revalidated_response, bool client_expects_not_modified)
+{
+    m_url = url;
+    m_uses_disk_cache = true;
+    m_revalidated_response = move(revalidated_response);
+    m_client_expects_not_modified = client_expects_not_modified;
+}
+
+void Download::update_disk_cache()
+{
+    if (!m_status_code.has_value())
+        return;
+    auto status_code = m_status_code.value();
+
+    if (status_code == 304) {
+        if (!m_revalidated_response.has_value())
+            return;
+        auto& response = m_revalidated_response.value();
+        response.did_revalidate(m_response_headers);
+        DiskCache::the().store(m_url, response);
+        if (!m_client_expects_not_modified) {
+            m_status_code = response.status_code;
+            m_response_headers = response.headers;
+            set_payload(response.payload);
+        }
+        return;
+    }
+
+    if (status_code == 200) {
+        DiskCache::the().store(m_url, { status_code, time(nullptr), m_response_headers, m_payload });
+        return;
+    }
+
+    if (status_code == 404 || status_code == 410)
+        DiskCache::the().remove(m_url);
+}
+
 void Download::did_finish(bool success)
 {
+    if (success && m_uses_disk_cache)
+        update_disk_cache();
     m_client.did_finish_download({}, *this, success);
 }
 
@@ -71,4 +110,21 @@ void Download::did_progress(Optional<u32> total_size, u32 downloaded_size)
     m_client.did_progress_download({}, *this);
 }
 
+void Download::did_receive_data(const ByteBuffer& data)
+{
+    if (!m_total_size.has_value() || m_total_size.value() == 0)
+        return;
+    auto total_size = m_total_size.value();
+    if (!m_received_data) {
+        m_received_data = SharedBuffer::create_with_size(total_size);
+        if (!m_received_data)
+            return;
+        m_received_data->share_with(m_client.client_pid());
+    }
+    auto size = min((size_t)data.size(), total_size - m_received_data_size);
+    memcpy((u8*)m_received_data->data() + m_received_data_size, data.data(), size);
+    m_received_data_size += size;
+    m_client.did_receive_download_data({}, *this);
+}
+
 }
@@ -30,7 +30,9 @@
 #include <AK/HashMap.h>
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
+#include <AK/SharedBuffer.h>
 #include <AK/URL.h>
+#include <ProtocolServer/DiskCache.h>
 #include <ProtocolServer/Forward.h>
 
 namespace ProtocolServer {
@@ -46,20 +48,30 @@ public:
     Optional<u32> total_size() const { return m_total_size; }
     size_t downloaded_size() const { return m_downloaded_size; }
     const ByteBuffer& payload() const { return m_payload; }
+    RefPtr<SharedBuffer> received_data() const { return m_received_data; }
+    size_t received_data_size() const { return m_received_data_size; }
     const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers() const { return m_response_headers; }
 
     void stop();
 
+    // Stores the response in the disk cache once it arrives. When the download is asking the server whether
+    // a stored response is still good, a 304 Not Modified is answered with that response instead, unless the
+    // client sent the validators itself and expects to see the 304.
+    void enable_disk_cache(Badge<ClientConnection>, const URL&, Optional<CachedResponse>&& revalidated_response, bool client_expects_not_modified);
+
 protected:
     explicit Download(ClientConnection&);
 
     void did_finish(bool success);
     void did_progress(Optional<u32> total_size, u32 downloaded_size);
+    void did_receive_data(const ByteBuffer&);
     void set_status_code(u32 status_code) { m_status_code = status_code; }
     void set_payload(const ByteBuffer&);
     void set_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>&);
 
 private:
+    void update_disk_cache();
+
     ClientConnection& m_client;
     i32 m_id { 0 };
     URL m_url;
@@ -67,7 +79,13 @@ private:
     Optional<u32> m_total_size {};
     size_t m_downloaded_size { 0 };
     ByteBuffer m_payload;
+    // The data received so far, when we know how much there will be in total.
+    RefPtr<SharedBuffer> m_received_data;
+    size_t m_received_data_size { 0 };
     HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+    bool m_uses_disk_cache { false };
+    Optional<CachedResponse> m_revalidated_response;
+    bool m_client_expects_not_modified { false };
 };
 
 }
@@ -28,7 +28,9 @@
 
 namespace ProtocolServer {
 
+class CachedDownload;
 class ClientConnection;
+class DiskCache;
 class Download;
 class GeminiProtocol;
 class HttpProtocol;
@@ -51,12 +51,16 @@ HttpDownload::HttpDownload(ClientConnection& client, NonnullRefPtr<HTTP::HttpJob
     m_job->on_progress = [this](Optional<u32> total, u32 current) {
         did_progress(total, current);
     };
+    m_job->on_data_received = [this](auto& data) {
+        did_receive_data(data);
+    };
 }
 
 HttpDownload::~HttpDownload()
 {
     m_job->on_finish = nullptr;
     m_job->on_progress = nullptr;
+    m_job->on_data_received = nullptr;
     m_job->shutdown();
 }
 
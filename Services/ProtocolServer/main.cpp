@@ -27,6 +27,7 @@
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
 #include <LibIPC/ClientConnection.h>
+#include <ProtocolServer/DiskCache.h>
 #include <ProtocolServer/GeminiProtocol.h>
 #include <ProtocolServer/HttpProtocol.h>
 #include <ProtocolServer/HttpsProtocol.h>
@@ -34,13 +35,13 @@
 
 int main(int, char**)
 {
-    if (pledge("stdio inet shared_buffer accept unix rpath cpath fattr", nullptr) < 0) {
+    if (pledge("stdio inet shared_buffer accept unix rpath wpath cpath fattr", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
     Core::EventLoop event_loop;
     // FIXME: Establish a connection to LookupServer and then drop "unix"?
-    if (pledge("stdio inet shared_buffer accept unix", nullptr) < 0) {
+    if (pledge("stdio inet shared_buffer accept unix rpath wpath cpath fattr", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -48,6 +49,12 @@ int main(int, char**)
         perror("unveil");
         return 1;
     }
+    // Creates the cache directory if needed, which has to happen before we can unveil it.
+    (void)ProtocolServer::DiskCache::the();
+    if (unveil(ProtocolServer::DiskCache::directory(), "rwc") < 0) {
+        perror("unveil");
+        return 1;
+    }
     if (unveil(nullptr, nullptr) < 0) {
         perror("unveil");
         return 1;
@@ -64,6 +64,9 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(const Gfx::PaletteImpl& impl)
 {
     m_palette_impl = impl;
+    if (auto* layout_root = this->layout_root())
+        layout_root->invalidate_display_lists();
+    m_tile_cache.invalidate_all();
 }
 
 Web::LayoutDocument* PageHost::layout_root()
@@ -81,33 +84,37 @@ void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
 
     auto* layout_root = this->layout_root();
     if (!layout_root) {
+        m_tile_cache.invalidate_all();
         painter.fill_rect(bitmap_rect, Color::White);
         return;
     }
 
-    painter.fill_rect(bitmap_rect, layout_root->document().background_color(palette()));
-
-    if (auto background_bitmap = layout_root->document().background_image()) {
-        painter.draw_tiled_bitmap(bitmap_rect, *background_bitmap);
-    }
-
     painter.translate(-content_rect.x(), -content_rect.y());
 
-    Web::PaintContext context(painter, palette(), Gfx::IntPoint());
-    context.set_viewport_rect(content_rect);
-    layout_root->paint_all_phases(context);
+    m_tile_cache.paint(painter, content_rect, [&](Gfx::Painter& tile_painter, const Gfx::IntRect& tile_rect) {
+        Web::PaintContext context(palette(), Gfx::IntPoint());
+        context.set_viewport_rect(page().main_frame().viewport_rect());
+        layout_root->paint_with_display_lists(tile_painter, tile_rect, context);
+    });
 }
 
 void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
 {
+    // NOTE: Frame::set_size() lays out again if the size changed. Scrolling only moves the viewport,
+    //       so there's no need to lay out (and throw away all the cached tiles) for that.
     page().main_frame().set_size(rect.size());
-    if (page().main_frame().document())
-        page().main_frame().document()->layout();
+    auto* document = page().main_frame().document();
+    if (document && !document->layout_node())
+        document->layout();
     page().main_frame().set_viewport_rect(rect);
 }
 
 void PageHost::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
+    m_tile_cache.invalidate(content_rect);
+    auto viewport_rect = page().main_frame().viewport_rect();
+    if (!viewport_rect.is_empty() && !viewport_rect.intersects(content_rect))
+        return;
     m_client.post_message(Messages::WebContentClient::DidInvalidateContentRect(content_rect));
 }
 
@@ -120,6 +127,7 @@ void PageHost::page_did_layout()
 {
     auto* layout_root = this->layout_root();
     ASSERT(layout_root);
+    m_tile_cache.invalidate_all();
     auto content_size = enclosing_int_rect(layout_root->absolute_rect()).size();
     m_client.post_message(Messages::WebContentClient::DidLayout(content_size));
 }
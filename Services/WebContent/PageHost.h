@@ -27,6 +27,7 @@
 #pragma once
 
 #include <LibWeb/Page/Page.h>
+#include <LibWeb/Painting/TileCache.h>
 
 namespace WebContent {
 
@@ -72,6 +73,7 @@ private:
     ClientConnection& m_client;
     NonnullOwnPtr<Web::Page> m_page;
     RefPtr<Gfx::PaletteImpl> m_palette_impl;
+    Web::TileCache m_tile_cache;
 };
 
 }
@@ -33,9 +33,11 @@
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
+#include <LibCore/Gzip.h>
 #include <LibCore/MimeData.h>
 #include <LibHTTP/HttpRequest.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -125,10 +127,10 @@ void Client::handle_request(ByteBuffer raw_request)
         return;
     }
 
-    send_response(file->read_all(), request, Core::guess_mime_type_based_on_filename(request.url()));
+    send_file_response(*file, request, Core::guess_mime_type_based_on_filename(request.url()));
 }
 
-void Client::send_response(StringView response, const HTTP::HttpRequest& request, const String& content_type)
+void Client::send_response_headers(const String& content_type, const char* content_encoding)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n");
@@ -136,14 +138,80 @@ void Client::send_response(StringView response, const HTTP::HttpRequest& request
     builder.append("Content-Type: ");
     builder.append(content_type);
     builder.append("\r\n");
+    if (content_encoding) {
+        builder.append("Content-Encoding: ");
+        builder.append(content_encoding);
+        builder.append("\r\n");
+    }
     builder.append("\r\n");
 
     m_socket->write(builder.to_string());
+}
+
+void Client::send_response(StringView response, const HTTP::HttpRequest& request, const String& content_type)
+{
+    send_response_headers(content_type);
     m_socket->write(response);
 
     log_response(200, request);
 }
 
+static bool accepts_gzip(const HTTP::HttpRequest& request)
+{
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case("Accept-Encoding"))
+            return header.value.contains("gzip");
+    }
+    return false;
+}
+
+static bool is_compressible(const String& content_type)
+{
+    return content_type.starts_with("text/")
+        || content_type == "application/javascript"
+        || content_type == "application/json"
+        || content_type == "image/svg+xml";
+}
+
+bool Client::send_compressed_file_response(Core::File& file, const HTTP::HttpRequest& request, const String& content_type)
+{
+    // Images and archives are compressed already; only text is worth the CPU time.
+    if (!is_compressible(content_type) || !accepts_gzip(request))
+        return false;
+
+    auto contents = file.read_all();
+    auto compressed = Core::Gzip::compress(contents.span());
+    if (compressed.size() >= contents.size())
+        return false;
+
+    send_response_headers(content_type, "gzip");
+    m_socket->write(compressed.data(), compressed.size());
+    log_response(200, request);
+    return true;
+}
+
+void Client::send_file_response(Core::File& file, const HTTP::HttpRequest& request, const String& content_type)
+{
+    if (send_compressed_file_response(file, request, content_type))
+        return;
+
+    send_response_headers(content_type);
+
+    // Let the kernel move the file contents straight to the socket.
+    off_t offset = 0;
+    for (;;) {
+        ssize_t nsent = sendfile(m_socket->fd(), file.fd(), &offset, 64 * KB);
+        if (nsent < 0) {
+            perror("sendfile");
+            break;
+        }
+        if (nsent == 0)
+            break;
+    }
+
+    log_response(200, request);
+}
+
 void Client::send_redirect(StringView redirect_path, const HTTP::HttpRequest& request)
 {
     StringBuilder builder;
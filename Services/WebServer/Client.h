@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/Forward.h>
@@ -42,7 +43,10 @@ private:
     Client(NonnullRefPtr<Core::TCPSocket>, const String&, Core::Object* parent);
 
     void handle_request(ByteBuffer);
+    void send_response_headers(const String& content_type, const char* content_encoding = nullptr);
     void send_response(StringView, const HTTP::HttpRequest&, const String& content_type);
+    void send_file_response(Core::File&, const HTTP::HttpRequest&, const String& content_type);
+    bool send_compressed_file_response(Core::File&, const HTTP::HttpRequest&, const String& content_type);
     void send_redirect(StringView redirect, const HTTP::HttpRequest& request);
     void send_error_response(unsigned code, const StringView& message, const HTTP::HttpRequest&);
     void die();
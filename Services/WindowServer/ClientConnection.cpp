@@ -343,6 +343,20 @@ OwnPtr<Messages::WindowServer::SetResolutionResponse> ClientConnection::handle(c
     return make<Messages::WindowServer::SetResolutionResponse>(WindowManager::the().set_resolution(message.resolution().width(), message.resolution().height()), WindowManager::the().resolution());
 }
 
+OwnPtr<Messages::WindowServer::GetCompositorStatisticsResponse> ClientConnection::handle(const Messages::WindowServer::GetCompositorStatistics&)
+{
+    auto& compositor = Compositor::the();
+    return make<Messages::WindowServer::GetCompositorStatisticsResponse>(compositor.frame_count(), compositor.last_frame_time_us(), compositor.total_frame_time_us(), compositor.total_pixels_dirtied(), compositor.total_pixels_painted());
+}
+
+OwnPtr<Messages::WindowServer::SetCompositorThreadCountResponse> ClientConnection::handle(const Messages::WindowServer::SetCompositorThreadCount& message)
+{
+    // A thread count of 0 just queries the current one.
+    if (message.thread_count())
+        Compositor::the().set_thread_count(message.thread_count());
+    return make<Messages::WindowServer::SetCompositorThreadCountResponse>(Compositor::the().thread_count());
+}
+
 OwnPtr<Messages::WindowServer::SetWindowTitleResponse> ClientConnection::handle(const Messages::WindowServer::SetWindowTitle& message)
 {
     auto it = m_windows.find(message.window_id());
@@ -568,7 +582,7 @@ OwnPtr<Messages::WindowServer::SetWindowBackingStoreResponse> ClientConnection::
         if (!shared_buffer)
             return make<Messages::WindowServer::SetWindowBackingStoreResponse>();
         auto backing_store = Gfx::Bitmap::create_with_shared_buffer(
-            message.has_alpha_channel() ? Gfx::BitmapFormat::RGBA32 : Gfx::BitmapFormat::RGB32,
+            message.has_alpha_channel() ? Gfx::BitmapFormat::RGBA32Premultiplied : Gfx::BitmapFormat::RGB32,
             *shared_buffer,
             message.size());
         window.set_backing_store(move(backing_store));
@@ -36,9 +36,13 @@
 #include <LibGfx/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibThread/BackgroundAction.h>
+#include <LibThread/WorkerPool.h>
+#include <unistd.h>
 
 namespace WindowServer {
 
+static const size_t max_thread_count = 8;
+
 Compositor& Compositor::the()
 {
     static Compositor s_the;
@@ -80,10 +84,30 @@ Compositor::Compositor()
         },
         this);
 
+    long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    set_thread_count(processor_count > 0 ? min(processor_count, (long)max_thread_count) : 1);
+
     m_screen_can_set_buffer = Screen::the().can_set_buffer();
     init_bitmaps();
 }
 
+Compositor::~Compositor()
+{
+}
+
+size_t Compositor::thread_count() const
+{
+    return m_worker_pool->concurrency();
+}
+
+void Compositor::set_thread_count(size_t thread_count)
+{
+    thread_count = clamp(thread_count, (size_t)1, max_thread_count);
+    if (m_worker_pool && m_worker_pool->concurrency() == thread_count)
+        return;
+    m_worker_pool = make<LibThread::WorkerPool>(thread_count, "Compositor");
+}
+
 void Compositor::init_bitmaps()
 {
     auto& screen = Screen::the();
@@ -101,15 +125,25 @@ void Compositor::init_bitmaps()
 
     m_buffers_are_flipped = false;
 
+    invalidate_occlusions();
     invalidate();
 }
 
+static u64 monotonic_time_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 void Compositor::compose()
 {
     auto& wm = WindowManager::the();
     if (m_wallpaper_mode == WallpaperMode::Unchecked)
         m_wallpaper_mode = mode_to_enum(wm.config()->read_entry("Background", "Mode", "simple"));
-    auto& ws = Screen::the();
+
+    if (m_occlusions_dirty)
+        recompute_occlusions();
 
     auto dirty_rects = move(m_dirty_rects);
 
@@ -118,15 +152,16 @@ void Compositor::compose()
         return;
     }
 
+    auto frame_start_time = monotonic_time_us();
+
     dirty_rects.add(Gfx::IntRect::intersection(m_last_geometry_label_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::IntRect::intersection(m_last_cursor_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::IntRect::intersection(m_last_dnd_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::IntRect::intersection(current_cursor_rect(), Screen::the().rect()));
 
-    auto any_dirty_rect_intersects_window = [&dirty_rects](const Window& window) {
-        auto window_frame_rect = window.frame().rect();
+    auto any_dirty_rect_intersects = [&dirty_rects](const Gfx::DisjointRectSet& visible_rects) {
         for (auto& dirty_rect : dirty_rects.rects()) {
-            if (dirty_rect.intersects(window_frame_rect))
+            if (visible_rects.intersects(dirty_rect))
                 return true;
         }
         return false;
@@ -138,48 +173,126 @@ void Compositor::compose()
         background_color = Color::from_string(background_color_entry).value_or(background_color);
     }
 
-    // Paint the wallpaper.
+    Vector<Window*, 32> windows_to_compose;
+    if (auto* fullscreen_window = wm.active_fullscreen_window()) {
+        windows_to_compose.append(fullscreen_window);
+    } else {
+        wm.for_each_visible_window_from_back_to_front([&](Window& window) {
+            if (any_dirty_rect_intersects(window.visible_rects()))
+                windows_to_compose.append(&window);
+            return IterationDecision::Continue;
+        });
+    }
+
+    // Split the dirty region into tiles along a fixed grid, and compose the tiles in parallel.
+    // Each tile only touches its own pixels, so workers just need their own painter.
+    Vector<Gfx::IntRect> tiles;
     for (auto& dirty_rect : dirty_rects.rects()) {
-        if (any_opaque_window_contains_rect(dirty_rect))
-            continue;
-        // FIXME: If the wallpaper is opaque, no need to fill with color!
-        m_back_painter->fill_rect(dirty_rect, background_color);
-        if (m_wallpaper) {
-            if (m_wallpaper_mode == WallpaperMode::Simple) {
-                m_back_painter->blit(dirty_rect.location(), *m_wallpaper, dirty_rect);
-            } else if (m_wallpaper_mode == WallpaperMode::Center) {
-                Gfx::IntPoint offset { ws.size().width() / 2 - m_wallpaper->size().width() / 2,
-                    ws.size().height() / 2 - m_wallpaper->size().height() / 2 };
-                m_back_painter->blit_offset(dirty_rect.location(), *m_wallpaper,
-                    dirty_rect, offset);
-            } else if (m_wallpaper_mode == WallpaperMode::Tile) {
-                m_back_painter->draw_tiled_bitmap(dirty_rect, *m_wallpaper);
-            } else if (m_wallpaper_mode == WallpaperMode::Scaled) {
-                float hscale = (float)m_wallpaper->size().width() / (float)ws.size().width();
-                float vscale = (float)m_wallpaper->size().height() / (float)ws.size().height();
-
-                m_back_painter->blit_scaled(dirty_rect, *m_wallpaper, dirty_rect, hscale, vscale);
-            } else {
-                ASSERT_NOT_REACHED();
-            }
+        int first_column = dirty_rect.left() / tile_size;
+        int last_column = dirty_rect.right() / tile_size;
+        int first_row = dirty_rect.top() / tile_size;
+        int last_row = dirty_rect.bottom() / tile_size;
+        for (int row = first_row; row <= last_row; ++row) {
+            for (int column = first_column; column <= last_column; ++column)
+                tiles.append(dirty_rect.intersected({ column * tile_size, row * tile_size, tile_size, tile_size }));
         }
     }
 
-    auto compose_window = [&](Window& window) -> IterationDecision {
-        if (!any_dirty_rect_intersects_window(window))
-            return IterationDecision::Continue;
-        Gfx::PainterStateSaver saver(*m_back_painter);
-        m_back_painter->add_clip_rect(window.frame().rect());
+    Vector<u64> pixels_painted_per_tile;
+    pixels_painted_per_tile.resize(tiles.size());
+    m_worker_pool->run(tiles.size(), [&](size_t tile_index) {
+        Gfx::Painter painter(*m_back_bitmap);
+        pixels_painted_per_tile[tile_index] = compose_tile(painter, tiles[tile_index], windows_to_compose, background_color);
+    });
+    // run() returns once all tiles are done, so the back buffer is complete from here on.
+
+    u64 pixels_painted = 0;
+    for (auto pixels : pixels_painted_per_tile)
+        pixels_painted += pixels;
+
+    if (!wm.active_fullscreen_window())
+        draw_geometry_label();
+
+    run_animations();
+
+    draw_cursor();
+
+    if (m_flash_flush) {
+        for (auto& rect : dirty_rects.rects())
+            m_front_painter->fill_rect(rect, Color::Yellow);
+    }
+
+    if (m_screen_can_set_buffer)
+        flip_buffers();
+
+    u64 pixels_dirtied = 0;
+    for (auto& r : dirty_rects.rects()) {
+        pixels_dirtied += r.size().area();
+        flush(r);
+    }
+
+    auto frame_time_us = monotonic_time_us() - frame_start_time;
+    ++m_frame_count;
+    m_last_frame_time_us = frame_time_us;
+    m_total_frame_time_us += frame_time_us;
+    m_total_pixels_dirtied += pixels_dirtied;
+    m_total_pixels_painted += pixels_painted;
+}
+
+void Compositor::paint_wallpaper(Gfx::Painter& painter, const Gfx::IntRect& dirty_rect, Color background_color)
+{
+    auto& ws = Screen::the();
+    // FIXME: If the wallpaper is opaque, no need to fill with color!
+    painter.fill_rect(dirty_rect, background_color);
+    if (m_wallpaper) {
+        if (m_wallpaper_mode == WallpaperMode::Simple) {
+            painter.blit(dirty_rect.location(), *m_wallpaper, dirty_rect);
+        } else if (m_wallpaper_mode == WallpaperMode::Center) {
+            Gfx::IntPoint offset { ws.size().width() / 2 - m_wallpaper->size().width() / 2,
+                ws.size().height() / 2 - m_wallpaper->size().height() / 2 };
+            painter.blit_offset(dirty_rect.location(), *m_wallpaper,
+                dirty_rect, offset);
+        } else if (m_wallpaper_mode == WallpaperMode::Tile) {
+            painter.draw_tiled_bitmap(dirty_rect, *m_wallpaper);
+        } else if (m_wallpaper_mode == WallpaperMode::Scaled) {
+            float hscale = (float)m_wallpaper->size().width() / (float)ws.size().width();
+            float vscale = (float)m_wallpaper->size().height() / (float)ws.size().height();
+
+            painter.blit_scaled(dirty_rect, *m_wallpaper, dirty_rect, hscale, vscale);
+        } else {
+            ASSERT_NOT_REACHED();
+        }
+    }
+}
+
+u64 Compositor::compose_tile(Gfx::Painter& painter, const Gfx::IntRect& tile, const Vector<Window*, 32>& windows, Color background_color)
+{
+    u64 pixels_painted = 0;
+    auto& wm = WindowManager::the();
+    painter.add_clip_rect(tile);
+
+    for (auto& wallpaper_rect : m_wallpaper_rects.rects()) {
+        auto dirty_rect = tile.intersected(wallpaper_rect);
+        if (dirty_rect.is_empty())
+            continue;
+        pixels_painted += dirty_rect.size().area();
+        paint_wallpaper(painter, dirty_rect, background_color);
+    }
+
+    for (auto* window_ptr : windows) {
+        auto& window = *window_ptr;
         RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        for (auto& dirty_rect : dirty_rects.rects()) {
-            if (!window.is_fullscreen() && any_opaque_window_above_this_one_contains_rect(window, dirty_rect))
+        for (auto& visible_rect : window.visible_rects().rects()) {
+            auto dirty_rect = tile.intersected(visible_rect);
+            if (dirty_rect.is_empty())
                 continue;
-            Gfx::PainterStateSaver saver(*m_back_painter);
-            m_back_painter->add_clip_rect(dirty_rect);
+            pixels_painted += dirty_rect.size().area();
+            Gfx::PainterStateSaver saver(painter);
+            painter.add_clip_rect(dirty_rect);
             if (!backing_store)
-                m_back_painter->fill_rect(dirty_rect, wm.palette().window());
-            if (!window.is_fullscreen())
-                window.frame().paint(*m_back_painter);
+                painter.fill_rect(dirty_rect, wm.palette().window());
+            if (!window.is_fullscreen() && !window.rect().contains(dirty_rect))
+                window.frame().paint(painter);
             if (!backing_store)
                 continue;
 
@@ -226,44 +339,18 @@ void Compositor::compose()
             auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
 
             if (window.client() && window.client()->is_unresponsive()) {
-                m_back_painter->blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
+                painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
                     return src.to_grayscale().darkened(0.75f);
                 });
             } else {
-                m_back_painter->blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
+                painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
             }
 
             for (auto background_rect : window.rect().shatter(backing_rect))
-                m_back_painter->fill_rect(background_rect, wm.palette().window());
+                painter.fill_rect(background_rect, wm.palette().window());
         }
-        return IterationDecision::Continue;
-    };
-
-    // Paint the window stack.
-    if (auto* fullscreen_window = wm.active_fullscreen_window()) {
-        compose_window(*fullscreen_window);
-    } else {
-        wm.for_each_visible_window_from_back_to_front([&](Window& window) {
-            return compose_window(window);
-        });
-
-        draw_geometry_label();
-    }
-
-    run_animations();
-
-    draw_cursor();
-
-    if (m_flash_flush) {
-        for (auto& rect : dirty_rects.rects())
-            m_front_painter->fill_rect(rect, Color::Yellow);
     }
-
-    if (m_screen_can_set_buffer)
-        flip_buffers();
-
-    for (auto& r : dirty_rects.rects())
-        flush(r);
+    return pixels_painted;
 }
 
 void Compositor::flush(const Gfx::IntRect& a_rect)
@@ -314,7 +401,32 @@ void Compositor::invalidate(const Gfx::IntRect& a_rect)
         return;
 
     m_dirty_rects.add(rect);
+    schedule_compose();
+}
+
+void Compositor::invalidate_window(const Window& window, const Gfx::IntRect& rect)
+{
+    // Only the visible parts of a window can change what's on screen,
+    // unless the window stack is changing and we don't know yet what's visible.
+    if (m_occlusions_dirty) {
+        invalidate(rect);
+        return;
+    }
+    for (auto& visible_rect : window.visible_rects().rects()) {
+        auto piece = rect.intersected(visible_rect);
+        if (!piece.is_empty())
+            invalidate(piece);
+    }
+}
 
+void Compositor::invalidate_occlusions()
+{
+    m_occlusions_dirty = true;
+    schedule_compose();
+}
+
+void Compositor::schedule_compose()
+{
     // We delay composition by a timer interval, but to not affect latency too
     // much, if a pending compose is not already scheduled, we also schedule an
     // immediate compose the next spin of the event loop.
@@ -514,70 +626,59 @@ void Compositor::decrement_display_link_count(Badge<ClientConnection>)
         m_display_link_notify_timer->stop();
 }
 
-bool Compositor::any_opaque_window_contains_rect(const Gfx::IntRect& rect)
+static bool is_opaque(const Window& window)
 {
-    bool found_containing_window = false;
-    WindowManager::the().for_each_visible_window_from_back_to_front([&](Window& window) {
-        if (window.is_minimized())
-            return IterationDecision::Continue;
-        if (window.opacity() < 1.0f)
-            return IterationDecision::Continue;
-        if (window.has_alpha_channel()) {
-            // FIXME: Just because the window has an alpha channel doesn't mean it's not opaque.
-            //        Maybe there's some way we could know this?
-            return IterationDecision::Continue;
-        }
-        if (window.frame().rect().contains(rect)) {
-            found_containing_window = true;
-            return IterationDecision::Break;
-        }
-        return IterationDecision::Continue;
-    });
-    return found_containing_window;
-};
+    if (window.opacity() < 1.0f)
+        return false;
+    // FIXME: Just because the window has an alpha channel doesn't mean it's not opaque.
+    //        Maybe there's some way we could know this?
+    return !window.has_alpha_channel();
+}
 
-bool Compositor::any_opaque_window_above_this_one_contains_rect(const Window& a_window, const Gfx::IntRect& rect)
+void Compositor::recompute_occlusions()
 {
-    bool found_containing_window = false;
-    bool checking = false;
-    WindowManager::the().for_each_visible_window_from_back_to_front([&](Window& window) {
-        if (&window == &a_window) {
-            checking = true;
-            return IterationDecision::Continue;
-        }
-        if (!checking)
-            return IterationDecision::Continue;
-        if (!window.is_visible())
-            return IterationDecision::Continue;
-        if (window.is_minimized())
-            return IterationDecision::Continue;
-        if (window.opacity() < 1.0f)
-            return IterationDecision::Continue;
-        if (window.has_alpha_channel())
-            return IterationDecision::Continue;
-        if (window.frame().rect().contains(rect)) {
-            found_containing_window = true;
-            return IterationDecision::Break;
-        }
+    auto& wm = WindowManager::the();
+    auto screen_rect = Screen::the().rect();
+    m_occlusions_dirty = false;
+
+    wm.for_each_window([](Window& window) {
+        window.set_visible_rects({});
         return IterationDecision::Continue;
     });
-    return found_containing_window;
-};
 
-void Compositor::recompute_occlusions()
-{
-    auto& wm = WindowManager::the();
-    wm.for_each_visible_window_from_back_to_front([&](Window& window) {
-        if (wm.m_switcher.is_visible()) {
+    // Walk the stack from the top, carving each opaque window out of the
+    // region that the windows below it (and ultimately the wallpaper) can show through.
+    Gfx::DisjointRectSet uncovered_rects;
+    uncovered_rects.add(screen_rect);
+    wm.for_each_visible_window_from_front_to_back([&](Window& window) {
+        auto frame_rect = window.frame().rect();
+        auto visible_rects = uncovered_rects.intersected(frame_rect);
+        if (wm.m_switcher.is_visible())
             window.set_occluded(false);
-        } else {
-            if (any_opaque_window_above_this_one_contains_rect(window, window.frame().rect()))
-                window.set_occluded(true);
-            else
-                window.set_occluded(false);
-        }
+        else
+            window.set_occluded(visible_rects.is_empty() && frame_rect.intersects(screen_rect));
+        window.set_visible_rects(move(visible_rects));
+        if (is_opaque(window))
+            uncovered_rects.subtract(frame_rect);
         return IterationDecision::Continue;
     });
+
+    // A fullscreen window is the only thing we paint, so everything else is hidden behind it.
+    if (auto* fullscreen_window = wm.active_fullscreen_window()) {
+        wm.for_each_window([](Window& window) {
+            window.set_visible_rects({});
+            return IterationDecision::Continue;
+        });
+        Gfx::DisjointRectSet fullscreen_rects;
+        fullscreen_rects.add(fullscreen_window->frame().rect().intersected(screen_rect));
+        fullscreen_window->set_visible_rects(move(fullscreen_rects));
+        uncovered_rects.clear();
+        uncovered_rects.add(screen_rect);
+        if (is_opaque(*fullscreen_window))
+            uncovered_rects.subtract(fullscreen_window->frame().rect());
+    }
+
+    m_wallpaper_rects = move(uncovered_rects);
 }
 
 }
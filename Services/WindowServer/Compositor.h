@@ -32,6 +32,10 @@
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Forward.h>
 
+namespace LibThread {
+class WorkerPool;
+}
+
 namespace WindowServer {
 
 class ClientConnection;
@@ -54,6 +58,7 @@ public:
     void compose();
     void invalidate();
     void invalidate(const Gfx::IntRect&);
+    void invalidate_window(const Window&, const Gfx::IntRect&);
 
     bool set_resolution(int desired_width, int desired_height);
 
@@ -70,10 +75,24 @@ public:
     void increment_display_link_count(Badge<ClientConnection>);
     void decrement_display_link_count(Badge<ClientConnection>);
 
-    void recompute_occlusions();
+    // Call this whenever the window stack or any window's geometry, visibility
+    // or opacity changes. The occlusion state is recomputed lazily before the next compose.
+    void invalidate_occlusions();
+
+    size_t thread_count() const;
+    void set_thread_count(size_t);
+
+    u64 frame_count() const { return m_frame_count; }
+    u32 last_frame_time_us() const { return m_last_frame_time_us; }
+    u64 total_frame_time_us() const { return m_total_frame_time_us; }
+    u64 total_pixels_dirtied() const { return m_total_pixels_dirtied; }
+    u64 total_pixels_painted() const { return m_total_pixels_painted; }
 
 private:
+    static constexpr int tile_size = 128;
+
     Compositor();
+    ~Compositor();
     void init_bitmaps();
     void flip_buffers();
     void flush(const Gfx::IntRect&);
@@ -82,8 +101,10 @@ private:
     void draw_menubar();
     void run_animations();
     void notify_display_links();
-    bool any_opaque_window_contains_rect(const Gfx::IntRect&);
-    bool any_opaque_window_above_this_one_contains_rect(const Window&, const Gfx::IntRect&);
+    void recompute_occlusions();
+    void schedule_compose();
+    void paint_wallpaper(Gfx::Painter&, const Gfx::IntRect&, Color background_color);
+    u64 compose_tile(Gfx::Painter&, const Gfx::IntRect& tile, const Vector<Window*, 32>& windows, Color background_color);
 
     RefPtr<Core::Timer> m_compose_timer;
     RefPtr<Core::Timer> m_immediate_compose_timer;
@@ -97,6 +118,17 @@ private:
     OwnPtr<Gfx::Painter> m_front_painter;
 
     Gfx::DisjointRectSet m_dirty_rects;
+    OwnPtr<LibThread::WorkerPool> m_worker_pool;
+
+    // The parts of the screen not covered by any opaque window.
+    Gfx::DisjointRectSet m_wallpaper_rects;
+    bool m_occlusions_dirty { true };
+
+    u64 m_frame_count { 0 };
+    u32 m_last_frame_time_us { 0 };
+    u64 m_total_frame_time_us { 0 };
+    u64 m_total_pixels_dirtied { 0 };
+    u64 m_total_pixels_painted { 0 };
 
     Gfx::IntRect m_last_cursor_rect;
     Gfx::IntRect m_last_dnd_rect;
@@ -247,6 +247,14 @@ void Window::set_opacity(float opacity)
     WindowManager::the().notify_opacity_changed(*this);
 }
 
+void Window::set_has_alpha_channel(bool value)
+{
+    if (m_has_alpha_channel == value)
+        return;
+    m_has_alpha_channel = value;
+    Compositor::the().invalidate_occlusions();
+}
+
 void Window::set_occluded(bool occluded)
 {
     if (m_occluded == occluded)
@@ -358,6 +366,7 @@ void Window::set_visible(bool b)
     if (m_visible == b)
         return;
     m_visible = b;
+    Compositor::the().invalidate_occlusions();
     invalidate();
 }
 
@@ -382,7 +391,7 @@ void Window::invalidate(const Gfx::IntRect& rect)
     inner_rect.move_by(position());
     // FIXME: This seems slightly wrong; the inner rect shouldn't intersect the border part of the outer rect.
     inner_rect.intersect(outer_rect);
-    Compositor::the().invalidate(inner_rect);
+    Compositor::the().invalidate_window(*this, inner_rect);
 }
 
 bool Window::is_active() const
@@ -108,6 +108,11 @@ public:
     bool is_occluded() const { return m_occluded; }
     void set_occluded(bool);
 
+    // The parts of the frame rect that the compositor actually needs to paint,
+    // i.e. not covered by any opaque window above this one.
+    const Gfx::DisjointRectSet& visible_rects() const { return m_visible_rects; }
+    void set_visible_rects(Gfx::DisjointRectSet&& rects) { m_visible_rects = move(rects); }
+
     bool is_movable() const
     {
         return m_type == WindowType::Normal;
@@ -197,7 +202,7 @@ public:
     bool global_cursor_tracking() const { return m_global_cursor_tracking_enabled || m_automatic_cursor_tracking_enabled; }
 
     bool has_alpha_channel() const { return m_has_alpha_channel; }
-    void set_has_alpha_channel(bool value) { m_has_alpha_channel = value; }
+    void set_has_alpha_channel(bool);
 
     Gfx::IntSize size_increment() const { return m_size_increment; }
     void set_size_increment(const Gfx::IntSize& increment) { m_size_increment = increment; }
@@ -296,6 +301,7 @@ private:
     WindowTileType m_tiled { WindowTileType::None };
     Gfx::IntRect m_untiled_rect;
     bool m_occluded { false };
+    Gfx::DisjointRectSet m_visible_rects;
     RefPtr<Gfx::Bitmap> m_backing_store;
     RefPtr<Gfx::Bitmap> m_last_backing_store;
     int m_window_id { -1 };
@@ -188,7 +188,7 @@ void WindowManager::add_window(Window& window)
     if (m_switcher.is_visible() && window.type() != WindowType::WindowSwitcher)
         m_switcher.refresh();
 
-    Compositor::the().recompute_occlusions();
+    Compositor::the().invalidate_occlusions();
 
     if (window.listens_to_wm_events()) {
         for_each_window([&](Window& other_window) {
@@ -237,7 +237,7 @@ void WindowManager::do_move_to_front(Window& window, bool make_active, bool make
     m_windows_in_order.remove(&window);
     m_windows_in_order.append(&window);
 
-    Compositor::the().recompute_occlusions();
+    Compositor::the().invalidate_occlusions();
 
     if (make_active)
         set_active_window(&window, make_input);
@@ -267,7 +267,7 @@ void WindowManager::remove_window(Window& window)
     if (m_switcher.is_visible() && window.type() != WindowType::WindowSwitcher)
         m_switcher.refresh();
 
-    Compositor::the().recompute_occlusions();
+    Compositor::the().invalidate_occlusions();
 
     for_each_window_listening_to_wm_events([&window](Window& listener) {
         if (!(listener.wm_event_mask() & WMEventMask::WindowRemovals))
@@ -375,7 +375,7 @@ void WindowManager::notify_rect_changed(Window& window, const Gfx::IntRect& old_
     if (m_switcher.is_visible() && window.type() != WindowType::WindowSwitcher)
         m_switcher.refresh();
 
-    Compositor::the().recompute_occlusions();
+    Compositor::the().invalidate_occlusions();
 
     tell_wm_listeners_window_rect_changed(window);
 
@@ -387,11 +387,12 @@ void WindowManager::notify_rect_changed(Window& window, const Gfx::IntRect& old_
 
 void WindowManager::notify_opacity_changed(Window&)
 {
-    Compositor::the().recompute_occlusions();
+    Compositor::the().invalidate_occlusions();
 }
 
 void WindowManager::notify_minimization_state_changed(Window& window)
 {
+    Compositor::the().invalidate_occlusions();
     tell_wm_listeners_window_state_changed(window);
 
     if (window.client())
@@ -1114,6 +1115,7 @@ void WindowManager::set_highlight_window(Window* window)
     if (auto* previous_highlight_window = m_highlight_window.ptr())
         previous_highlight_window->invalidate();
     m_highlight_window = window ? window->make_weak_ptr() : nullptr;
+    Compositor::the().invalidate_occlusions();
     if (m_highlight_window)
         m_highlight_window->invalidate();
 }
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/Timer.h>
+#include <LibGUI/Application.h>
+#include <LibGUI/Desktop.h>
+#include <LibGUI/Widget.h>
+#include <LibGUI/Window.h>
+#include <LibGUI/WindowServerConnection.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Drags a screen-sized window back and forth and asks WindowServer how long
+// each composed frame took, once for every compositor thread count.
+
+struct Sample {
+    u64 frame_count { 0 };
+    u64 total_frame_time_us { 0 };
+};
+
+static Sample take_sample()
+{
+    auto response = GUI::WindowServerConnection::the().send_sync<Messages::WindowServer::GetCompositorStatistics>();
+    return { response->frame_count(), response->total_frame_time_us() };
+}
+
+static u32 set_compositor_thread_count(u32 thread_count)
+{
+    return GUI::WindowServerConnection::the().send_sync<Messages::WindowServer::SetCompositorThreadCount>(thread_count)->thread_count();
+}
+
+int main(int argc, char** argv)
+{
+    int frames_per_run = 120;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(frames_per_run, "Number of frames to compose per thread count", "frames", 'f', "count");
+    args_parser.parse(argc, argv);
+
+    auto app = GUI::Application::construct(argc, argv);
+
+    // A thread count of 0 leaves the compositor alone and just tells us the current one.
+    u32 original_thread_count = set_compositor_thread_count(0);
+
+    Vector<u32> thread_counts;
+    long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    for (u32 count = 1; count < (u32)max(processor_count, 1l); count *= 2)
+        thread_counts.append(count);
+    thread_counts.append(max(processor_count, 1l));
+
+    auto screen_rect = GUI::Desktop::the().rect();
+    auto window = GUI::Window::construct();
+    window->set_title("Compositor benchmark");
+    window->set_rect(screen_rect.shrunken(64, 64));
+    auto& widget = window->set_main_widget<GUI::Widget>();
+    widget.set_fill_with_background_color(true);
+    window->show();
+
+    printf("Threads   Frames   Avg frame time   Speedup\n");
+
+    size_t run_index = 0;
+    Sample run_start;
+    u64 single_thread_frame_time_us = 0;
+    int step = 0;
+
+    auto start_run = [&] {
+        u32 thread_count = set_compositor_thread_count(thread_counts[run_index]);
+        if (thread_count != thread_counts[run_index])
+            fprintf(stderr, "compositor_benchmark: WindowServer is using %u threads instead of %u\n", thread_count, thread_counts[run_index]);
+        run_start = take_sample();
+    };
+    start_run();
+
+    auto timer = Core::Timer::construct(1000 / 60, [&] {
+        // Move back and forth so the whole window (and what it uncovers) gets recomposed every frame.
+        ++step;
+        window->move_to(screen_rect.x() + 32 + (step % 2 ? 16 : -16), screen_rect.y() + 32);
+
+        auto now = take_sample();
+        u64 frames = now.frame_count - run_start.frame_count;
+        if (frames < (u64)frames_per_run)
+            return;
+
+        u64 average_us = (now.total_frame_time_us - run_start.total_frame_time_us) / frames;
+        if (run_index == 0)
+            single_thread_frame_time_us = average_us;
+        printf("%7u %8llu %13llu us %8.2fx\n", thread_counts[run_index], frames, average_us, (double)single_thread_frame_time_us / max(average_us, (u64)1));
+
+        if (++run_index == thread_counts.size()) {
+            set_compositor_thread_count(original_thread_count);
+            app->quit(0);
+            return;
+        }
+        start_run();
+    });
+
+    return app->exec();
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/Deflate.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/File.h>
+#include <LibCore/Inflate.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: deflate_benchmark [-h] [-l level] [path...]\n");
+    exit(rc);
+}
+
+static void collect_files(const String& path, Vector<ByteBuffer>& corpus)
+{
+    if (!Core::File::is_directory(path)) {
+        auto file_or_error = Core::File::open(path, Core::IODevice::ReadOnly);
+        if (file_or_error.is_error())
+            return;
+        auto data = file_or_error.value()->read_all();
+        if (!data.is_empty())
+            corpus.append(move(data));
+        return;
+    }
+
+    Core::DirIterator iterator(path, Core::DirIterator::SkipDots);
+    while (iterator.has_next())
+        collect_files(iterator.next_full_path(), corpus);
+}
+
+int main(int argc, char** argv)
+{
+    int only_level = -1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hl:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'l':
+            only_level = atoi(optarg);
+            if (only_level < 0 || only_level > Core::Deflate::max_level)
+                exit_with_usage(1);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    Vector<ByteBuffer> corpus;
+    if (optind < argc) {
+        for (int i = optind; i < argc; ++i)
+            collect_files(argv[i], corpus);
+    } else {
+        collect_files("/res/html", corpus);
+        collect_files("/usr/share/man", corpus);
+        collect_files("/res/fonts", corpus);
+    }
+
+    u64 total_size = 0;
+    for (auto& data : corpus)
+        total_size += data.size();
+    if (!total_size) {
+        fprintf(stderr, "deflate_benchmark: Nothing to compress\n");
+        return 1;
+    }
+    printf("Compressing %zu files, %llu bytes in total\n", corpus.size(), total_size);
+
+    for (int level = 0; level <= Core::Deflate::max_level; ++level) {
+        if (only_level >= 0 && level != only_level)
+            continue;
+
+        u64 compressed_size = 0;
+        u64 compress_ms = 0;
+        u64 decompress_ms = 0;
+        for (auto& data : corpus) {
+            Core::ElapsedTimer timer;
+            timer.start();
+            auto compressed = Core::Deflate::compress_all(data.span(), level);
+            compress_ms += timer.elapsed();
+            compressed_size += compressed.size();
+
+            timer.start();
+            auto decompressed = Core::Inflate::decompress_all(compressed.span());
+            decompress_ms += timer.elapsed();
+            if (!decompressed.has_value() || decompressed.value() != data) {
+                fprintf(stderr, "deflate_benchmark: Round trip failed at level %d!\n", level);
+                return 1;
+            }
+        }
+
+        printf("level %d: %10llu bytes (%5.1f%%), compress %6llu ms (%llu KiB/s), inflate %6llu ms\n",
+            level, compressed_size, 100.0 * compressed_size / total_size,
+            compress_ms, compress_ms ? total_size * 1000 / compress_ms / KB : 0, decompress_ms);
+    }
+    return 0;
+}
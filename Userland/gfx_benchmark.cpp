@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Function.h>
+#include <AK/Types.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Font.h>
+#include <LibGfx/JPGLoader.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
+#include <LibGfx/PixelKernels.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: gfx_benchmark [-h] [-r runs] [-s WIDTHxHEIGHT] [JPEG files to decode...]\n");
+    exit(rc);
+}
+
+static int s_runs = 50;
+
+static void report(const char* name, u64 pixels_per_run, Function<void()> callback)
+{
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < s_runs; ++i)
+        callback();
+    u64 ms = max(timer.elapsed(), 1);
+    printf("%-32s %8llu Mpx/s\n", name, pixels_per_run * s_runs / ms / 1000);
+}
+
+static void fill_with_noise(Gfx::Bitmap& bitmap, bool with_alpha)
+{
+    u32 state = 1;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        auto* scanline = bitmap.scanline(y);
+        for (int x = 0; x < bitmap.width(); ++x) {
+            state = state * 1103515245 + 12345;
+            u32 pixel = state >> 8;
+            if (with_alpha) {
+                // A mix of transparent, opaque and translucent pixels, like icons and shadows.
+                switch (x / 16 % 3) {
+                case 0:
+                    pixel |= 0xff000000;
+                    break;
+                case 1:
+                    pixel &= 0x00ffffff;
+                    break;
+                default:
+                    pixel |= (state & 0xff) << 24;
+                    break;
+                }
+            } else {
+                pixel |= 0xff000000;
+            }
+            scanline[x] = pixel;
+        }
+    }
+}
+
+static void benchmark_kernels(const Gfx::PixelKernels& kernels, Gfx::Bitmap& target, const Gfx::Bitmap& source, const Gfx::Bitmap& source_with_alpha)
+{
+    printf("%s kernels:\n", kernels.name);
+    u64 pixels = (u64)target.width() * target.height();
+    auto for_each_row = [&](auto callback) {
+        for (int y = 0; y < target.height(); ++y)
+            callback(target.scanline(y), source.scanline(y), source_with_alpha.scanline(y), target.width());
+    };
+    report("  copy_row", pixels, [&] { for_each_row([&](auto* dst, auto* src, auto*, int count) { kernels.copy_row(dst, src, count); }); });
+    report("  fill_row", pixels, [&] { for_each_row([&](auto* dst, auto*, auto*, int count) { kernels.fill_row(dst, 0xff336699, count); }); });
+    report("  blend_color_row", pixels, [&] { for_each_row([&](auto* dst, auto*, auto*, int count) { kernels.blend_color_row(dst, 0x80336699, count); }); });
+    report("  blend_row", pixels, [&] { for_each_row([&](auto* dst, auto*, auto* src, int count) { kernels.blend_row(dst, src, count); }); });
+    report("  blend_row_with_opacity", pixels, [&] { for_each_row([&](auto* dst, auto* src, auto*, int count) { kernels.blend_row_with_opacity(dst, src, count, 0xc0); }); });
+    report("  ycbcr_to_rgb_row", pixels, [&] { for_each_row([&](auto* dst, auto* src, auto*, int count) {
+        auto* samples = (const u8*)src;
+        kernels.ycbcr_to_rgb_row(dst, samples, samples + count, samples + 2 * count, count);
+    }); });
+}
+
+int main(int argc, char** argv)
+{
+    int width = 1024;
+    int height = 768;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hr:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'r':
+            s_runs = atoi(optarg);
+            break;
+        case 's':
+            if (sscanf(optarg, "%dx%d", &width, &height) != 2)
+                exit_with_usage(1);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+    if (s_runs <= 0 || width <= 0 || height <= 0)
+        exit_with_usage(1);
+
+    Gfx::IntSize size { width, height };
+    auto target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, size);
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, size);
+    auto source_with_alpha = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, size);
+    auto small_source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, { width / 3, height / 3 });
+    if (!target || !source || !source_with_alpha || !small_source) {
+        fprintf(stderr, "gfx_benchmark: Failed to allocate bitmaps\n");
+        return 1;
+    }
+    fill_with_noise(*target, false);
+    fill_with_noise(*source, false);
+    fill_with_noise(*source_with_alpha, true);
+    fill_with_noise(*small_source, true);
+
+    u64 pixels = (u64)width * height;
+    printf("%dx%d, %d runs, using %s kernels\n", width, height, s_runs, Gfx::pixel_kernels().name);
+
+    Gfx::Painter painter(*target);
+    report("fill_rect (opaque)", pixels, [&] { painter.fill_rect(target->rect(), Color(0x33, 0x66, 0x99)); });
+    report("fill_rect (alpha)", pixels, [&] { painter.fill_rect(target->rect(), Color(0x33, 0x66, 0x99, 0x80)); });
+    report("blit (opaque)", pixels, [&] { painter.blit({}, *source, source->rect()); });
+    report("blit (alpha)", pixels, [&] { painter.blit({}, *source_with_alpha, source_with_alpha->rect()); });
+    report("blit (opacity)", pixels, [&] { painter.blit({}, *source, source->rect(), 0.75f); });
+    report("draw_scaled_bitmap (alpha)", pixels, [&] { painter.draw_scaled_bitmap(target->rect(), *small_source, small_source->rect(), 0.75f); });
+
+    // Fill the target with lines of text, both through the glyph span atlas and bit by bit.
+    auto& font = Gfx::Font::default_font();
+    const char* text = "The quick brown fox jumps over the lazy dog. 0123456789 (){}[]";
+    int text_width = font.width(text);
+    auto for_each_text_line = [&](auto callback) {
+        for (int y = 0; y < height; y += font.glyph_height()) {
+            for (int x = 0; x < width; x += text_width)
+                callback(Gfx::IntPoint { x, y });
+        }
+    };
+    report("draw_text", pixels, [&] {
+        for_each_text_line([&](auto point) { painter.draw_text({ point, { text_width, font.glyph_height() } }, text, font, Gfx::TextAlignment::TopLeft, Color::Black); });
+    });
+    report("draw_bitmap (glyph bits)", pixels, [&] {
+        for_each_text_line([&](auto point) {
+            for (const char* ch = text; *ch; ++ch) {
+                painter.draw_bitmap(point, font.glyph_bitmap(*ch), Color::Black);
+                point.move_by(font.glyph_width(*ch) + font.glyph_spacing(), 0);
+            }
+        });
+    });
+
+    // A star and a circle inscribed in the target. The path is built once, as a canvas or SVG element would keep it around.
+    Gfx::Path path;
+    Gfx::FloatPoint center { width / 2.0f, height / 2.0f };
+    float radius = min(width, height) / 2.0f;
+    for (int i = 0; i < 9; ++i) {
+        float angle = i * 4 * M_PI / 9;
+        Gfx::FloatPoint point { center.x() + radius * cosf(angle), center.y() + radius * sinf(angle) };
+        if (i == 0)
+            path.move_to(point);
+        else
+            path.line_to(point);
+    }
+    path.close();
+    path.move_to({ center.x() + radius / 2, center.y() });
+    path.elliptical_arc_to({ center.x() - radius / 2, center.y() }, center, { radius / 2, radius / 2 }, 0, 0, M_PI);
+    path.elliptical_arc_to({ center.x() + radius / 2, center.y() }, center, { radius / 2, radius / 2 }, 0, M_PI, M_PI);
+    u64 path_pixels = (u64)(2 * radius) * (u64)(2 * radius);
+    report("fill_path (nonzero)", path_pixels, [&] { painter.fill_path(path, Color(0x33, 0x66, 0x99), Gfx::Painter::WindingRule::Nonzero); });
+    report("fill_path (evenodd)", path_pixels, [&] { painter.fill_path(path, Color(0x33, 0x66, 0x99), Gfx::Painter::WindingRule::EvenOdd); });
+    report("stroke_path", path_pixels, [&] { painter.stroke_path(path, Color::Black, 3); });
+
+    benchmark_kernels(Gfx::scalar_pixel_kernels(), *target, *source, *source_with_alpha);
+    if (auto* sse2_kernels = Gfx::sse2_pixel_kernels())
+        benchmark_kernels(*sse2_kernels, *target, *source, *source_with_alpha);
+
+    long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = optind; i < argc; ++i) {
+        auto bitmap = Gfx::load_jpg(argv[i]);
+        if (!bitmap) {
+            fprintf(stderr, "gfx_benchmark: Failed to decode %s\n", argv[i]);
+            return 1;
+        }
+        u64 image_pixels = (u64)bitmap->width() * bitmap->height();
+        printf("%s (%dx%d):\n", argv[i], bitmap->width(), bitmap->height());
+        report("  load_jpg", image_pixels, [&] { Gfx::load_jpg(argv[i]); });
+        report("  load_jpg_downscaled (1/8)", image_pixels, [&] { Gfx::load_jpg_downscaled(argv[i], { 1, 1 }); });
+        if (processor_count > 1) {
+            Gfx::set_jpg_decoder_thread_count(processor_count);
+            report("  load_jpg (threaded)", image_pixels, [&] { Gfx::load_jpg(argv[i]); });
+            Gfx::set_jpg_decoder_thread_count(1);
+        }
+    }
+    return 0;
+}
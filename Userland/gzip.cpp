@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/String.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
+#include <LibCore/Gzip.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static bool write_all(int fd, const ByteBuffer& data)
+{
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t nwritten = write(fd, data.data() + offset, data.size() - offset);
+        if (nwritten < 0) {
+            perror("write");
+            return false;
+        }
+        offset += nwritten;
+    }
+    return true;
+}
+
+static bool process_file(const char* path, bool decompress, bool keep_input, bool to_stdout, int level)
+{
+    auto input_or_error = Core::File::open(path, Core::IODevice::ReadOnly);
+    if (input_or_error.is_error()) {
+        fprintf(stderr, "gzip: %s: %s\n", path, input_or_error.error().characters());
+        return false;
+    }
+    auto input = input_or_error.value()->read_all();
+
+    String output_path;
+    ByteBuffer output;
+    if (decompress) {
+        String input_path = path;
+        if (!to_stdout && !input_path.ends_with(".gz")) {
+            fprintf(stderr, "gzip: %s: Unknown suffix\n", path);
+            return false;
+        }
+        auto decompressed = Core::Gzip::decompress(input);
+        if (!decompressed.has_value()) {
+            fprintf(stderr, "gzip: %s: Not in gzip format or corrupt\n", path);
+            return false;
+        }
+        output = decompressed.release_value();
+        output_path = input_path.substring(0, input_path.length() - 3);
+    } else {
+        output = Core::Gzip::compress(input.span(), level);
+        output_path = String::format("%s.gz", path);
+    }
+
+    if (to_stdout)
+        return write_all(STDOUT_FILENO, output);
+
+    auto output_or_error = Core::File::open(output_path, Core::IODevice::WriteOnly);
+    if (output_or_error.is_error()) {
+        fprintf(stderr, "gzip: %s: %s\n", output_path.characters(), output_or_error.error().characters());
+        return false;
+    }
+    if (!write_all(output_or_error.value()->fd(), output))
+        return false;
+
+    if (!keep_input && unlink(path) < 0) {
+        perror("unlink");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (pledge("stdio rpath wpath cpath", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
+    bool decompress = false;
+    bool keep_input = false;
+    bool to_stdout = false;
+    int level = 6;
+    Vector<const char*> paths;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(keep_input, "Keep (don't delete) input files", "keep", 'k');
+    args_parser.add_option(to_stdout, "Write to stdout, keep original files", "stdout", 'c');
+    args_parser.add_option(level, "Compression level (0-9)", "level", 'l', "level");
+    args_parser.add_positional_argument(paths, "Files", "files");
+    args_parser.parse(argc, argv);
+
+    if (level < 0 || level > 9) {
+        fprintf(stderr, "gzip: Compression level must be between 0 and 9\n");
+        return 1;
+    }
+
+    bool success = true;
+    for (auto* path : paths) {
+        if (!process_file(path, decompress, keep_input || to_stdout, to_stdout, level))
+            success = false;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/File.h>
+#include <LibCore/Gzip.h>
+#include <LibCore/Inflate.h>
+#include <LibCore/puff.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: inflate_benchmark [-h] [-r runs] [-c chunk_size] file.gz\n");
+    exit(rc);
+}
+
+static Optional<ByteBuffer> run_puff(const ByteBuffer& payload, size_t output_size)
+{
+    auto output = ByteBuffer::create_uninitialized(output_size);
+    unsigned long destination_length = output.size();
+    unsigned long source_length = payload.size();
+    if (puff(output.data(), &destination_length, payload.data(), &source_length) != 0)
+        return {};
+    output.trim(destination_length);
+    return output;
+}
+
+static Optional<ByteBuffer> run_inflate_streaming(const ByteBuffer& payload, size_t chunk_size)
+{
+    Core::Inflate inflate;
+    ByteBuffer output;
+    for (size_t offset = 0; offset < payload.size() && !inflate.is_finished(); offset += chunk_size) {
+        auto status = inflate.write({ payload.data() + offset, min(chunk_size, payload.size() - offset) });
+        if (status == Core::Inflate::Status::Error)
+            return {};
+        auto chunk = inflate.take_output();
+        output.append(chunk.data(), chunk.size());
+    }
+    if (!inflate.is_finished())
+        return {};
+    return output;
+}
+
+template<typename Callback>
+static u64 time_runs(int runs, const ByteBuffer& expected, Callback callback)
+{
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < runs; ++i) {
+        auto output = callback();
+        if (!output.has_value() || output.value() != expected) {
+            fprintf(stderr, "inflate_benchmark: Output mismatch!\n");
+            exit(1);
+        }
+    }
+    return timer.elapsed();
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 10;
+    size_t chunk_size = 4096;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hr:c:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        case 'c':
+            chunk_size = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (optind >= argc || runs <= 0 || chunk_size == 0)
+        exit_with_usage(1);
+
+    auto file_or_error = Core::File::open(argv[optind], Core::IODevice::ReadOnly);
+    if (file_or_error.is_error()) {
+        fprintf(stderr, "inflate_benchmark: %s\n", file_or_error.error().characters());
+        return 1;
+    }
+    auto data = file_or_error.value()->read_all();
+    auto payload = Core::Gzip::deflate_payload(data);
+    if (!payload.has_value()) {
+        fprintf(stderr, "inflate_benchmark: %s is not a gzip file\n", argv[optind]);
+        return 1;
+    }
+
+    auto reference = Core::Inflate::decompress_all(payload.value().span());
+    if (!reference.has_value()) {
+        fprintf(stderr, "inflate_benchmark: Failed to decompress %s\n", argv[optind]);
+        return 1;
+    }
+    auto& expected = reference.value();
+
+    printf("Decompressing %zu bytes into %zu bytes, %d runs\n", payload.value().size(), expected.size(), runs);
+
+    // puff needs to know the output size up front; give it that for free.
+    u64 puff_ms = time_runs(runs, expected, [&] { return run_puff(payload.value(), expected.size()); });
+    u64 inflate_ms = time_runs(runs, expected, [&] { return Core::Inflate::decompress_all(payload.value().span()); });
+    u64 streaming_ms = time_runs(runs, expected, [&] { return run_inflate_streaming(payload.value(), chunk_size); });
+
+    auto report = [&](const char* name, u64 ms) {
+        printf("%-24s %6llu ms (%llu KiB/s)\n", name, ms, ms ? (u64)expected.size() * runs / ms * 1000 / KB : 0);
+    };
+    report("puff", puff_ms);
+    report("Inflate", inflate_ms);
+    report("Inflate (streaming)", streaming_ms);
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
+#include <LibGUI/Application.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
+#include <LibWeb/Layout/LayoutDocument.h>
+#include <LibWeb/Layout/ParallelLayout.h>
+#include <LibWeb/Page/Frame.h>
+#include <LibWeb/Page/Page.h>
+#include <LibWeb/Painting/PaintContext.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+// Loads pages without showing them and times how long parsing (including
+// running their scripts, which is where canvas drawing happens), laying out
+// and painting them takes. Layout is timed on one thread, and then on 2, 4, ...
+// threads up to the number of CPUs, along with the speedup over one thread.
+// By default, the SVG, canvas and table test pages are used.
+
+class BenchmarkPageClient final : public Web::PageClient {
+public:
+    BenchmarkPageClient()
+        : m_page(make<Web::Page>(*this))
+    {
+    }
+
+    Web::Page& page() { return *m_page; }
+
+    virtual Gfx::Palette palette() const override { return GUI::Application::the()->palette(); }
+
+private:
+    NonnullOwnPtr<Web::Page> m_page;
+};
+
+static u64 microseconds_since(const struct timespec& start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000000ull + now.tv_nsec / 1000 - start.tv_nsec / 1000;
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 20;
+    int width = 800;
+    int height = 600;
+    int max_thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    Vector<const char*> paths;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(runs, "Number of times to load and paint each page", "runs", 'r', "count");
+    args_parser.add_option(width, "Viewport width", "width", 'w', "pixels");
+    args_parser.add_option(height, "Viewport height", "height", 'h', "pixels");
+    args_parser.add_option(max_thread_count, "Most threads to time layout on (default: number of CPUs)", "threads", 'j', "count");
+    args_parser.add_positional_argument(paths, "HTML files to render", "files", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
+
+    if (paths.is_empty()) {
+        paths.append("/res/html/misc/svg.html");
+        paths.append("/res/html/misc/canvas.html");
+        paths.append("/res/html/misc/canvas-path.html");
+        paths.append("/res/html/misc/canvas-path-quadratic-curve.html");
+        paths.append("/res/html/misc/trigonometry.html");
+        paths.append("/res/html/misc/large-table.html");
+    }
+    if (max_thread_count < 1)
+        max_thread_count = 1;
+    if (runs <= 0 || width <= 0 || height <= 0) {
+        args_parser.print_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    auto app = GUI::Application::construct(argc, argv);
+
+    auto target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { width, height });
+    if (!target) {
+        fprintf(stderr, "paint_benchmark: Failed to allocate a %dx%d bitmap\n", width, height);
+        return 1;
+    }
+
+    Vector<int> thread_counts;
+    for (int thread_count = 2; thread_count < max_thread_count; thread_count *= 2)
+        thread_counts.append(thread_count);
+    if (max_thread_count > 1)
+        thread_counts.append(max_thread_count);
+
+    printf("%-48s %10s %10s", "Page", "Load", "Layout");
+    for (auto thread_count : thread_counts)
+        printf(" %10s", String::format("Layout x%d", thread_count).characters());
+    printf(" %10s\n", "Paint");
+
+    for (auto* path : paths) {
+        auto file = Core::File::construct(path);
+        if (!file->open(Core::IODevice::ReadOnly)) {
+            fprintf(stderr, "paint_benchmark: %s: %s\n", path, file->error_string());
+            continue;
+        }
+        auto html = file->read_all();
+        auto url = URL::create_with_file_protocol(path);
+
+        BenchmarkPageClient client;
+        auto& frame = client.page().main_frame();
+        frame.set_size({ width, height });
+
+        u64 load_us = 0;
+        u64 layout_us = 0;
+        Vector<u64> parallel_layout_us;
+        for (size_t j = 0; j < thread_counts.size(); ++j)
+            parallel_layout_us.append(0);
+        u64 paint_us = 0;
+        for (int i = 0; i < runs; ++i) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            Web::HTML::HTMLDocumentParser parser(html, "utf-8");
+            parser.run(url);
+            frame.set_document(&parser.document());
+            parser.document().layout();
+            load_us += microseconds_since(start);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            parser.document().force_layout();
+            layout_us += microseconds_since(start);
+
+            for (size_t j = 0; j < thread_counts.size(); ++j) {
+                Web::set_layout_thread_count(thread_counts[j]);
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                parser.document().force_layout();
+                parallel_layout_us[j] += microseconds_since(start);
+            }
+            Web::set_layout_thread_count(1);
+
+            auto* layout_root = parser.document().layout_node();
+            if (!layout_root)
+                continue;
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            Gfx::Painter painter(*target);
+            Web::PaintContext context(client.palette(), {});
+            context.set_viewport_rect(target->rect());
+            layout_root->paint_with_display_lists(painter, target->rect(), context);
+            paint_us += microseconds_since(start);
+        }
+
+        printf("%-48s %7llu us %7llu us", path, load_us / runs, layout_us / runs);
+        for (auto us : parallel_layout_us)
+            printf(" %7llu us", us / runs);
+        printf(" %7llu us\n", paint_us / runs);
+
+        // How much faster layout got on each thread count, compared to one thread.
+        if (!thread_counts.is_empty() && layout_us) {
+            printf("%-48s %10s %10s", "", "", "");
+            for (auto us : parallel_layout_us)
+                printf(" %10s", String::format("%.2fx", us ? (double)layout_us / us : 0.0).characters());
+            printf("\n");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: sendfile_benchmark [-h] [-f file] [-s file_size] [-b block_size] [-r runs] [-p port]\n");
+    exit(rc);
+}
+
+static void drain_from(u16 port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    char buffer[65536];
+    for (;;) {
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            exit(1);
+        }
+        if (nread == 0)
+            break;
+    }
+    close(fd);
+    exit(0);
+}
+
+enum class Method {
+    ReadWrite,
+    SendFile,
+};
+
+// Serves the whole file to a client on the loopback interface and returns the throughput in bytes per second.
+static u64 serve_once(int listen_fd, u16 port, int file_fd, off_t file_size, int block_size, Method method)
+{
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (child == 0)
+        drain_from(port);
+
+    int client_fd = accept(listen_fd, nullptr, nullptr);
+    if (client_fd < 0) {
+        perror("accept");
+        exit(1);
+    }
+
+    Core::ElapsedTimer timer;
+    timer.start();
+
+    if (method == Method::ReadWrite) {
+        auto buffer = ByteBuffer::create_uninitialized(block_size);
+        if (lseek(file_fd, 0, SEEK_SET) < 0) {
+            perror("lseek");
+            exit(1);
+        }
+        for (;;) {
+            ssize_t nread = read(file_fd, buffer.data(), block_size);
+            if (nread < 0) {
+                perror("read");
+                exit(1);
+            }
+            if (nread == 0)
+                break;
+            if (write(client_fd, buffer.data(), nread) != nread) {
+                perror("write");
+                exit(1);
+            }
+        }
+    } else {
+        off_t offset = 0;
+        while (offset < file_size) {
+            ssize_t nsent = sendfile(client_fd, file_fd, &offset, block_size);
+            if (nsent < 0) {
+                perror("sendfile");
+                exit(1);
+            }
+            if (nsent == 0)
+                break;
+        }
+    }
+
+    close(client_fd);
+    waitpid(child, nullptr, 0);
+
+    auto elapsed = timer.elapsed();
+    return (u64)(elapsed ? (file_size / elapsed) : file_size) * 1000;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    int file_size = 8 * MB;
+    int block_size = 64 * KB;
+    int runs = 5;
+    u16 port = 8123;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hf:s:b:r:p:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'f':
+            path = optarg;
+            break;
+        case 's':
+            file_size = atoi(optarg);
+            break;
+        case 'b':
+            block_size = atoi(optarg);
+            break;
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (file_size <= 0 || block_size <= 0 || runs <= 0)
+        exit_with_usage(1);
+
+    String temporary_path;
+    int file_fd;
+    if (path) {
+        file_fd = open(path, O_RDONLY);
+        if (file_fd < 0) {
+            perror("open");
+            return 1;
+        }
+        file_size = lseek(file_fd, 0, SEEK_END);
+    } else {
+        temporary_path = "/tmp/sendfile_benchmark.tmp";
+        file_fd = open(temporary_path.characters(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+        if (file_fd < 0) {
+            perror("open");
+            return 1;
+        }
+        auto buffer = ByteBuffer::create_zeroed(block_size);
+        for (int nwritten = 0; nwritten < file_size; nwritten += block_size) {
+            if (write(file_fd, buffer.data(), min(block_size, file_size - nwritten)) < 0) {
+                perror("write");
+                return 1;
+            }
+        }
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    if (listen(listen_fd, 1) < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    printf("Serving %d bytes over loopback in %d byte blocks, %d runs\n", file_size, block_size, runs);
+
+    Method methods[] = { Method::ReadWrite, Method::SendFile };
+    for (auto method : methods) {
+        u64 total_bps = 0;
+        for (int i = 0; i < runs; ++i)
+            total_bps += serve_once(listen_fd, port, file_fd, file_size, block_size, method);
+        printf("%-10s %llu bytes/s\n", method == Method::ReadWrite ? "read/write" : "sendfile", total_bps / runs);
+    }
+
+    close(listen_fd);
+    close(file_fd);
+    if (!temporary_path.is_null())
+        unlink(temporary_path.characters());
+    return 0;
+}
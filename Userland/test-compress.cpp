@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Types.h>
+#include <LibCore/Deflate.h>
+#include <LibCore/Gzip.h>
+#include <LibCore/Inflate.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+static const char* s_test_name = "";
+
+#define EXPECT(condition)                                                           \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            fprintf(stderr, __FILE__ ":%d: FAIL: %s (%s)\n", __LINE__, #condition, \
+                s_test_name);                                                       \
+            ++s_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+static ByteBuffer compress_in_chunks(ReadonlyBytes data, int level, Core::Deflate::Format format, size_t chunk_size)
+{
+    Core::Deflate deflate(level, format);
+    ByteBuffer output;
+    auto append_output = [&] {
+        auto chunk = deflate.take_output();
+        if (!chunk.is_empty())
+            output.append(chunk.data(), chunk.size());
+    };
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+        deflate.write({ data.data() + offset, min(chunk_size, data.size() - offset) });
+        append_output();
+    }
+    deflate.finish();
+    append_output();
+    return output;
+}
+
+static bool round_trips(const ByteBuffer& data, int level, Core::Deflate::Format format, size_t chunk_size)
+{
+    auto compressed = compress_in_chunks(data.span(), level, format, chunk_size);
+    Optional<ByteBuffer> decompressed;
+    switch (format) {
+    case Core::Deflate::Format::Raw:
+        decompressed = Core::Inflate::decompress_all(compressed.span());
+        break;
+    case Core::Deflate::Format::Zlib: {
+        // CMF and FLG, then the DEFLATE stream, then the Adler-32 checksum.
+        if (compressed.size() < 6 || compressed[0] != 0x78 || ((compressed[0] << 8) | compressed[1]) % 31)
+            return false;
+        decompressed = Core::Inflate::decompress_all({ compressed.data() + 2, compressed.size() - 6 });
+        break;
+    }
+    case Core::Deflate::Format::Gzip:
+        if (!Core::Gzip::is_compressed(compressed))
+            return false;
+        decompressed = Core::Gzip::decompress(compressed);
+        break;
+    }
+    if (!decompressed.has_value() || decompressed.value().size() != data.size())
+        return false;
+    return data.is_empty() || !memcmp(decompressed.value().data(), data.data(), data.size());
+}
+
+static void test_all_levels_and_formats(const char* name, const ByteBuffer& data)
+{
+    s_test_name = name;
+    for (int level = 0; level <= Core::Deflate::max_level; ++level) {
+        EXPECT(round_trips(data, level, Core::Deflate::Format::Raw, data.size() + 1));
+        EXPECT(round_trips(data, level, Core::Deflate::Format::Zlib, data.size() + 1));
+        EXPECT(round_trips(data, level, Core::Deflate::Format::Gzip, data.size() + 1));
+        // Odd-sized pieces make matches and blocks straddle write() calls.
+        EXPECT(round_trips(data, level, Core::Deflate::Format::Raw, 1000));
+    }
+}
+
+static ByteBuffer make_text(size_t size)
+{
+    static const char* words[] = { "the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ", "\n", "Serenity ", "kernel ", "window " };
+    auto buffer = ByteBuffer::create_uninitialized(size);
+    u32 state = 1;
+    size_t offset = 0;
+    while (offset < size) {
+        state = state * 1103515245 + 12345;
+        const char* word = words[(state >> 16) % (sizeof(words) / sizeof(words[0]))];
+        for (size_t i = 0; word[i] && offset < size; ++i)
+            buffer[offset++] = word[i];
+    }
+    return buffer;
+}
+
+static ByteBuffer make_random(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size);
+    u32 state = 12345;
+    for (size_t i = 0; i < size; ++i) {
+        state = state * 1103515245 + 12345;
+        buffer[i] = state >> 16;
+    }
+    return buffer;
+}
+
+static void test_compression_ratio()
+{
+    s_test_name = "ratio";
+    auto text = make_text(256 * KB);
+    auto fast = Core::Deflate::compress_all(text.span(), 1);
+    auto best = Core::Deflate::compress_all(text.span(), Core::Deflate::max_level);
+    auto stored = Core::Deflate::compress_all(text.span(), 0);
+    EXPECT(fast.size() < text.size() / 2);
+    EXPECT(best.size() <= fast.size());
+    EXPECT(stored.size() > text.size());
+
+    // Incompressible data must not grow much beyond the stored block overhead.
+    auto random = make_random(256 * KB);
+    auto compressed = Core::Deflate::compress_all(random.span());
+    EXPECT(compressed.size() < random.size() + random.size() / 1000 + 64);
+}
+
+static void test_streaming_output()
+{
+    s_test_name = "streaming";
+    auto text = make_text(1 * MB);
+    Core::Deflate deflate(Core::Deflate::default_level, Core::Deflate::Format::Gzip);
+    deflate.write(text.span());
+    // Full blocks should be handed out before the stream is finished.
+    EXPECT(!deflate.take_output().is_empty());
+    deflate.finish();
+    EXPECT(deflate.is_finished());
+    EXPECT(!deflate.take_output().is_empty());
+}
+
+int main(int, char**)
+{
+    test_all_levels_and_formats("empty", {});
+    test_all_levels_and_formats("single byte", ByteBuffer::copy("x", 1));
+
+    auto repeated = ByteBuffer::create_uninitialized(100 * KB);
+    memset(repeated.data(), 'a', repeated.size());
+    test_all_levels_and_formats("repeated", repeated);
+
+    test_all_levels_and_formats("text", make_text(300 * KB));
+    test_all_levels_and_formats("random", make_random(100 * KB));
+
+    test_compression_ratio();
+    test_streaming_output();
+
+    if (s_failures) {
+        printf("%d test(s) FAILED\n", s_failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
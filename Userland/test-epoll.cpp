@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Assertions.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int s_failures = 0;
+
+// Registers fd, checks that it's not ready yet, runs make_ready and checks that epoll_wait() wakes up for it.
+template<typename Callback>
+static void expect_readable_after(const char* name, int fd, Callback make_ready)
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    ASSERT(epoll_fd >= 0);
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    int rc = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    ASSERT(rc == 0);
+
+    epoll_event ready;
+    rc = epoll_wait(epoll_fd, &ready, 1, 0);
+    if (rc != 0) {
+        fprintf(stderr, "FAIL %s: ready before EOF (rc=%d)\n", name, rc);
+        ++s_failures;
+        close(epoll_fd);
+        return;
+    }
+
+    make_ready();
+
+    rc = epoll_wait(epoll_fd, &ready, 1, 1000);
+    if (rc != 1 || ready.data.fd != fd || !(ready.events & EPOLLIN)) {
+        fprintf(stderr, "FAIL %s: no EPOLLIN after EOF (rc=%d)\n", name, rc);
+        ++s_failures;
+        close(epoll_fd);
+        return;
+    }
+
+    char buffer[16];
+    ssize_t nread = read(fd, buffer, sizeof(buffer));
+    if (nread != 0) {
+        fprintf(stderr, "FAIL %s: expected EOF, read returned %zd\n", name, nread);
+        ++s_failures;
+        close(epoll_fd);
+        return;
+    }
+
+    printf("PASS %s\n", name);
+    close(epoll_fd);
+}
+
+static void test_pipe_eof()
+{
+    int fds[2];
+    int rc = pipe(fds);
+    ASSERT(rc == 0);
+    expect_readable_after("pipe eof", fds[0], [&] { close(fds[1]); });
+    close(fds[0]);
+}
+
+static int open_slave(int master_fd)
+{
+    int rc = grantpt(master_fd);
+    ASSERT(rc == 0);
+    rc = unlockpt(master_fd);
+    ASSERT(rc == 0);
+    int slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+    ASSERT(slave_fd >= 0);
+    return slave_fd;
+}
+
+static void test_pty_master_eof()
+{
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT(master_fd >= 0);
+    int slave_fd = open_slave(master_fd);
+    expect_readable_after("pty master eof", master_fd, [&] { close(slave_fd); });
+    close(master_fd);
+}
+
+static void test_pty_slave_eof()
+{
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT(master_fd >= 0);
+    int slave_fd = open_slave(master_fd);
+    expect_readable_after("pty slave eof", slave_fd, [&] { close(master_fd); });
+    close(slave_fd);
+}
+
+static void test_local_socket_eof()
+{
+    const char* path = "/tmp/test-epoll-socket";
+    unlink(path);
+
+    int listen_fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+    ASSERT(listen_fd >= 0);
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_LOCAL;
+    strcpy(address.sun_path, path);
+    int rc = bind(listen_fd, (const sockaddr*)&address, sizeof(address));
+    ASSERT(rc == 0);
+    rc = listen(listen_fd, 1);
+    ASSERT(rc == 0);
+
+    pid_t pid = fork();
+    ASSERT(pid >= 0);
+    if (pid == 0) {
+        int fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (const sockaddr*)&address, sizeof(address)) < 0)
+            _exit(1);
+        // Stay connected until the parent has armed its watch.
+        char byte;
+        read(fd, &byte, 1);
+        _exit(0);
+    }
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    ASSERT(fd >= 0);
+    expect_readable_after("local socket eof", fd, [&] {
+        write(fd, "x", 1);
+        waitpid(pid, nullptr, 0);
+    });
+    close(fd);
+    close(listen_fd);
+    unlink(path);
+}
+
+static void test_udp_socket_shutdown()
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT(fd >= 0);
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    int rc = bind(fd, (const sockaddr*)&address, sizeof(address));
+    ASSERT(rc == 0);
+
+    expect_readable_after("udp socket shutdown", fd, [&] { shutdown(fd, SHUT_RD); });
+    close(fd);
+}
+
+int main(int, char**)
+{
+    test_pipe_eof();
+    test_pty_master_eof();
+    test_pty_slave_eof();
+    test_local_socket_eof();
+    test_udp_socket_shutdown();
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Assertions.h>
+#include <AK/Types.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/io_ring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int s_failures = 0;
+
+#define EXPECT_EQ(a, b)                                                                                               \
+    do {                                                                                                              \
+        auto lhs = (a);                                                                                               \
+        auto rhs = (b);                                                                                               \
+        if (lhs != rhs) {                                                                                             \
+            fprintf(stderr, __FILE__ ":%d: Expected " #a " == " #b ", got %d != %d\n", __LINE__, (int)lhs, (int)rhs); \
+            ++s_failures;                                                                                             \
+        }                                                                                                             \
+    } while (0)
+
+class Ring {
+public:
+    Ring(unsigned entries, unsigned completion_entries = 0)
+    {
+        memset(&m_params, 0, sizeof(m_params));
+        m_params.sq_entries = entries;
+        m_params.cq_entries = completion_entries;
+        m_params.buffer_size = 4096;
+        m_fd = io_ring_setup(&m_params);
+        ASSERT(m_fd >= 0);
+        m_ring = (u8*)mmap(nullptr, m_params.ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        ASSERT(m_ring != MAP_FAILED);
+        m_header = (io_ring_header*)m_ring;
+    }
+
+    ~Ring()
+    {
+        munmap(m_ring, m_params.ring_size);
+        close(m_fd);
+    }
+
+    int fd() const { return m_fd; }
+    u8* buffer() { return m_ring + m_params.buffer_offset; }
+
+    void queue(u8 opcode, int fd, u64 offset, u32 buffer, u32 length, u64 user_data)
+    {
+        auto* entries = (io_ring_sqe*)(m_ring + m_params.sq_offset);
+        auto& sqe = entries[m_header->sq_tail & m_header->sq_mask];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.offset = offset;
+        sqe.buffer = buffer;
+        sqe.length = length;
+        sqe.user_data = user_data;
+        __atomic_store_n(&m_header->sq_tail, m_header->sq_tail + 1, __ATOMIC_RELEASE);
+        ++m_queued;
+    }
+
+    int enter(unsigned min_complete)
+    {
+        int rc = io_ring_enter(m_fd, m_queued, min_complete);
+        if (rc >= 0)
+            m_queued -= rc;
+        return rc;
+    }
+
+    unsigned available() const { return __atomic_load_n(&m_header->cq_tail, __ATOMIC_ACQUIRE) - m_header->cq_head; }
+
+    io_ring_cqe pop()
+    {
+        ASSERT(available());
+        auto* entries = (io_ring_cqe*)(m_ring + m_params.cq_offset);
+        auto cqe = entries[m_header->cq_head & m_header->cq_mask];
+        __atomic_store_n(&m_header->cq_head, m_header->cq_head + 1, __ATOMIC_RELEASE);
+        return cqe;
+    }
+
+private:
+    io_ring_params m_params;
+    int m_fd { -1 };
+    u8* m_ring { nullptr };
+    io_ring_header* m_header { nullptr };
+    unsigned m_queued { 0 };
+};
+
+static bool is_readable(int fd)
+{
+    pollfd pfd { fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+static void test_overflow()
+{
+    Ring ring(4, 4);
+    for (u64 i = 1; i <= 4; ++i)
+        ring.queue(IO_RING_OP_NOP, -1, 0, 0, 0, i);
+    EXPECT_EQ(ring.enter(0), 4);
+    for (u64 i = 5; i <= 8; ++i)
+        ring.queue(IO_RING_OP_NOP, -1, 0, 0, 0, i);
+    EXPECT_EQ(ring.enter(0), 4);
+
+    // Only four fit, the rest are held back by the kernel.
+    EXPECT_EQ(ring.available(), 4u);
+    for (u64 i = 1; i <= 4; ++i)
+        EXPECT_EQ(ring.pop().user_data, i);
+
+    // The ring stays readable while completions are held back,
+    // and entering it without submitting anything moves them over.
+    EXPECT_EQ(is_readable(ring.fd()), true);
+    EXPECT_EQ(ring.enter(0), 0);
+    EXPECT_EQ(ring.available(), 4u);
+    for (u64 i = 5; i <= 8; ++i)
+        EXPECT_EQ(ring.pop().user_data, i);
+    EXPECT_EQ(is_readable(ring.fd()), false);
+    puts("PASS overflow");
+}
+
+static void test_read_when_ready()
+{
+    Ring ring(4);
+    int fds[2];
+    int rc = pipe(fds);
+    ASSERT(rc == 0);
+
+    ring.queue(IO_RING_OP_READ, fds[0], IO_RING_CURRENT_OFFSET, 0, 16, 1);
+    EXPECT_EQ(ring.enter(0), 1);
+    EXPECT_EQ(ring.available(), 0u);
+
+    rc = write(fds[1], "hello", 5);
+    ASSERT(rc == 5);
+    EXPECT_EQ(ring.enter(1), 0);
+    auto cqe = ring.pop();
+    EXPECT_EQ(cqe.user_data, 1u);
+    EXPECT_EQ(cqe.result, 5);
+    EXPECT_EQ(memcmp(ring.buffer(), "hello", 5), 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    puts("PASS read when ready");
+}
+
+static void test_cancel()
+{
+    Ring ring(8);
+    int fds[2];
+    int rc = pipe(fds);
+    ASSERT(rc == 0);
+
+    // Neither of these will complete on their own anytime soon.
+    ring.queue(IO_RING_OP_READ, fds[0], IO_RING_CURRENT_OFFSET, 0, 16, 1);
+    ring.queue(IO_RING_OP_TIMEOUT, -1, 60 * 1'000'000'000ull, 0, 0, 2);
+    ring.queue(IO_RING_OP_CANCEL, -1, 1, 0, 0, 3);
+    ring.queue(IO_RING_OP_CANCEL, -1, 2, 0, 0, 4);
+    ring.queue(IO_RING_OP_CANCEL, -1, 1234, 0, 0, 5);
+    EXPECT_EQ(ring.enter(5), 5);
+
+    int results[6] = {};
+    while (ring.available()) {
+        auto cqe = ring.pop();
+        ASSERT(cqe.user_data >= 1 && cqe.user_data <= 5);
+        results[cqe.user_data] = cqe.result;
+    }
+    EXPECT_EQ(results[1], -EINTR);
+    EXPECT_EQ(results[2], -EINTR);
+    EXPECT_EQ(results[3], 0);
+    EXPECT_EQ(results[4], 0);
+    EXPECT_EQ(results[5], -ENOENT);
+
+    close(fds[0]);
+    close(fds[1]);
+    puts("PASS cancel");
+}
+
+static void test_timeout()
+{
+    Ring ring(4);
+    ring.queue(IO_RING_OP_TIMEOUT, -1, 10 * 1'000'000ull, 0, 0, 1);
+    EXPECT_EQ(ring.enter(1), 1);
+    auto cqe = ring.pop();
+    EXPECT_EQ(cqe.user_data, 1u);
+    EXPECT_EQ(cqe.result, -ETIMEDOUT);
+    puts("PASS timeout");
+}
+
+static void test_accept()
+{
+    const char* path = "/tmp/test-io-ring-socket";
+    unlink(path);
+
+    int listen_fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+    ASSERT(listen_fd >= 0);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_LOCAL;
+    strcpy(address.sun_path, path);
+    int rc = bind(listen_fd, (const sockaddr*)&address, sizeof(address));
+    ASSERT(rc == 0);
+    rc = listen(listen_fd, 1);
+    ASSERT(rc == 0);
+
+    Ring ring(4);
+    ring.queue(IO_RING_OP_ACCEPT, listen_fd, 0, 0, 0, 1);
+    EXPECT_EQ(ring.enter(0), 1);
+    EXPECT_EQ(ring.available(), 0u);
+
+    pid_t pid = fork();
+    ASSERT(pid >= 0);
+    if (pid == 0) {
+        int fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (const sockaddr*)&address, sizeof(address)) < 0)
+            _exit(1);
+        write(fd, "x", 1);
+        _exit(0);
+    }
+
+    EXPECT_EQ(ring.enter(1), 0);
+    auto cqe = ring.pop();
+    EXPECT_EQ(cqe.user_data, 1u);
+    if (cqe.result < 0) {
+        fprintf(stderr, "accept failed: %s\n", strerror(-cqe.result));
+        ++s_failures;
+    } else {
+        char byte = 0;
+        EXPECT_EQ(read(cqe.result, &byte, 1), 1);
+        EXPECT_EQ(byte, 'x');
+        close(cqe.result);
+    }
+
+    waitpid(pid, nullptr, 0);
+    close(listen_fd);
+    unlink(path);
+    puts("PASS accept");
+}
+
+int main(int, char**)
+{
+    test_overflow();
+    test_read_when_ready();
+    test_cancel();
+    test_timeout();
+    test_accept();
+    return s_failures ? 1 : 0;
+}
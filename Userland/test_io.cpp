@@ -294,6 +294,87 @@ void test_writev()
     close(pipefds[1]);
 }
 
+void test_readv()
+{
+    int pipefds[2];
+    pipe(pipefds);
+    write(pipefds[1], "HelloFriends", 12);
+
+    char hello[5];
+    char friends[16];
+    iovec iov[2];
+    iov[0].iov_base = hello;
+    iov[0].iov_len = sizeof(hello);
+    iov[1].iov_base = friends;
+    iov[1].iov_len = sizeof(friends);
+    int nread = readv(pipefds[0], iov, 2);
+    if (nread != 12 || memcmp(hello, "Hello", 5) || memcmp(friends, "Friends", 7)) {
+        fprintf(stderr, "Didn't read the expected data from pipe with readv, got %d\n", nread);
+        ASSERT_NOT_REACHED();
+    }
+
+    close(pipefds[0]);
+    close(pipefds[1]);
+}
+
+void test_pread_pwrite()
+{
+    int fd = open("/tmp/pread-test", O_CREAT | O_RDWR | O_TRUNC, 0600);
+    ASSERT(fd >= 0);
+
+    int rc = write(fd, "0123456789", 10);
+    ASSERT(rc == 10);
+    rc = pwrite(fd, "abc", 3, 2);
+    ASSERT(rc == 3);
+
+    // Neither pread() nor pwrite() may move the file offset.
+    if (lseek(fd, 0, SEEK_CUR) != 10) {
+        fprintf(stderr, "pwrite moved the file offset\n");
+        ASSERT_NOT_REACHED();
+    }
+
+    char buffer[16];
+    rc = pread(fd, buffer, 5, 1);
+    if (rc != 5 || memcmp(buffer, "1abc5", 5)) {
+        fprintf(stderr, "Didn't read the expected data with pread\n");
+        ASSERT_NOT_REACHED();
+    }
+    if (lseek(fd, 0, SEEK_CUR) != 10) {
+        fprintf(stderr, "pread moved the file offset\n");
+        ASSERT_NOT_REACHED();
+    }
+
+    char first[3];
+    char second[3];
+    iovec iov[2];
+    iov[0].iov_base = first;
+    iov[0].iov_len = sizeof(first);
+    iov[1].iov_base = second;
+    iov[1].iov_len = sizeof(second);
+    rc = preadv(fd, iov, 2, 4);
+    if (rc != 6 || memcmp(first, "c45", 3) || memcmp(second, "678", 3)) {
+        fprintf(stderr, "Didn't read the expected data with preadv\n");
+        ASSERT_NOT_REACHED();
+    }
+
+    rc = pread(fd, buffer, 1, -1);
+    if (rc >= 0 || errno != EINVAL) {
+        fprintf(stderr, "Expected EINVAL when calling pread with a negative offset\n");
+    }
+
+    int pipefds[2];
+    pipe(pipefds);
+    rc = pread(pipefds[0], buffer, 1, 0);
+    if (rc >= 0 || errno != ESPIPE) {
+        fprintf(stderr, "Expected ESPIPE when calling pread on a pipe\n");
+    }
+    close(pipefds[0]);
+    close(pipefds[1]);
+
+    close(fd);
+    unlink("/tmp/pread-test");
+}
+
 void test_rmdir_root()
 {
     int rc = rmdir("/");
@@ -329,6 +410,8 @@ int main(int, char**)
     test_eoverflow();
     test_rmdir_while_inside_dir();
     test_writev();
+    test_readv();
+    test_pread_pwrite();
     test_rmdir_root();
 
     EXPECT_ERROR_2(EPERM, link, "/", "/home/anon/lolroot");
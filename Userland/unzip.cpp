@@ -28,6 +28,7 @@
 #include <AK/NumberFormat.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
+#include <LibCore/Inflate.h>
 #include <string.h>
 #include <sys/stat.h>
 
@@ -100,8 +101,10 @@ bool unpack_file_for_central_directory_index(off_t central_directory_index, cons
     if (!seek_and_read(buffer, file, local_file_header_index + LFHCompressionMethodOffset, 2))
         return false;
     auto compression_method = buffer[1] << 8 | buffer[0];
-    // FIXME: Remove once any decompression is supported.
-    ASSERT(compression_method == None);
+    if (compression_method != None && compression_method != Deflate) {
+        fprintf(stderr, "unzip: Unsupported compression method %d\n", compression_method);
+        return false;
+    }
 
     if (!seek_and_read(buffer, file, local_file_header_index + LFHCompressedSizeOffset, 4))
         return false;
@@ -138,8 +141,19 @@ bool unpack_file_for_central_directory_index(off_t central_directory_index, cons
         if (!seek_and_read(raw_file_contents, file, local_file_header_index + LFHFileNameBaseOffset + file_name_length + extra_field_length, compressed_file_size))
             return false;
 
-        // FIXME: Try to uncompress data here. We're just ignoring it as no decompression methods are implemented yet.
-        if (!new_file->write(raw_file_contents, compressed_file_size)) {
+        ByteBuffer file_contents;
+        if (compression_method == Deflate) {
+            auto decompressed = Core::Inflate::decompress_all({ raw_file_contents, (size_t)compressed_file_size });
+            if (!decompressed.has_value()) {
+                fprintf(stderr, "Can't decompress file %s\n", file_name);
+                return false;
+            }
+            file_contents = decompressed.release_value();
+        } else {
+            file_contents = ByteBuffer::wrap(raw_file_contents, compressed_file_size);
+        }
+
+        if (!new_file->write(file_contents.data(), file_contents.size())) {
             fprintf(stderr, "Can't write file contents in %s: %s\n", file_name, new_file->error_string());
             return false;
         }